@@ -100,7 +100,7 @@ namespace Cacao {
 		/**
 		 * @brief Access the parent of this actor
 		 *
-		 * @return The parent actor, or a null handle if the parent is the world root
+		 * @return The parent actor, or a null handle if the parent is the world root or the actor has been detached from the world
 		 */
 		ActorHandle GetParent() const;
 
@@ -212,6 +212,7 @@ namespace Cacao {
 
 	  private:
 		Actor(const std::string& name, ActorHandle parent, xg::Guid);
+		Actor(const std::string& name, ActorHandle parent, xg::Guid, const Transform& transform);
 		friend class World;
 
 		std::weak_ptr<Actor> parentPtr;
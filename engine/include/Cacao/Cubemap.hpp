@@ -4,6 +4,7 @@
 #include "Asset.hpp"
 
 #include "libcacaoimage.hpp"
+#include "libcacaoformats.hpp"
 
 #include <memory>
 #include <array>
@@ -28,6 +29,21 @@ namespace Cacao {
 			return std::shared_ptr<Cubemap>(new Cubemap(std::move(faces), addr));
 		}
 
+		/**
+		 * @brief Create a new cubemap from GPU-compressed faces
+		 *
+		 * The face data is uploaded as-is when realized, without being decoded or converted.
+		 *
+		 * @param faces The compressed faces of the cubemap and their mip chains
+		 * @param addr The resource address to associate with the cubemap
+		 *
+		 * @throws BadValueException If the faces have no mip levels or a different number of them
+		 * @throws BadValueException If the address is malformed
+		 */
+		static std::shared_ptr<Cubemap> Create(libcacaoformats::CompressedCubemap&& faces, const std::string& addr) {
+			return std::shared_ptr<Cubemap>(new Cubemap(std::move(faces), addr));
+		}
+
 		///@cond
 		Cubemap(const Cubemap&) = delete;
 		Cubemap(Cubemap&&);
@@ -40,6 +56,7 @@ namespace Cacao {
 		 *
 		 * @throws BadRealizeStateException If the cubemap is already realized
 		 * @throws BadInitStateException If the graphics backend is not initialized or connected
+		 * @throws BadValueException If the cubemap is GPU-compressed in a format that the graphics device does not support
 		 */
 		void Realize();
 
@@ -59,6 +76,7 @@ namespace Cacao {
 
 	  private:
 		Cubemap(std::array<libcacaoimage::Image, 6>&& faces, const std::string& addr);
+		Cubemap(libcacaoformats::CompressedCubemap&& faces, const std::string& addr);
 		friend class PAL;
 		friend class ResourceManager;
 
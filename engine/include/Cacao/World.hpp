@@ -10,6 +10,7 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 namespace Cacao {
 	/**
@@ -77,6 +78,14 @@ namespace Cacao {
 
 		ActorHandle root;
 
+		//Build the actors of column-oriented world data, without attaching the top-level ones to the root
+		//Actors whose parent is not in the data are skipped
+		//If parallel is set, sibling subtrees are built on the engine thread pool
+		static std::vector<ActorHandle> BuildActors(std::shared_ptr<World> world, const libcacaoformats::WorldColumns& columns, bool parallel);
+
+		//Remove a top-level actor from the root, leaving it without a parent
+		void DetachFromRoot(ActorHandle actor);
+
 		//Recursive function for actually running a actor search
 		template<typename P>
 		std::optional<ActorHandle> actorSearchRunner(std::vector<ActorHandle> target, P predicate) const {
@@ -99,5 +108,6 @@ namespace Cacao {
 
 		friend class ResourceManager;
 		friend class Actor;
+		friend class WorldManager;
 	};
 }
\ No newline at end of file
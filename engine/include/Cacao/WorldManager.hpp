@@ -3,9 +3,18 @@
 #include "DllHelper.hpp"
 #include "World.hpp"
 
+#include "libcacaoformats.hpp"
+
 #include <memory>
 
 namespace Cacao {
+	///@brief Settings for streaming the cells of a world in and out around the camera
+	struct WorldStreamingConfig {
+		unsigned int loadRadius = 2;  ///<Cells up to this many cells away from the camera's cell on every axis are loaded
+		unsigned int unloadRadius = 3;///<Cells more than this many cells away from the camera's cell on any axis are unloaded (must be at least loadRadius)
+		std::size_t maxLoadedCells = 0;///<Maximum number of cells loaded or loading at once, with nearer cells taking priority (0 for no limit)
+	};
+
 	/**
 	 * @brief Active world management singleton
 	 */
@@ -51,6 +60,39 @@ namespace Cacao {
 		 */
 		std::string GetActiveWorldAddr();
 
+		/**
+		 * @brief Set the active world to one whose cells are loaded and unloaded around the camera
+		 *
+		 * The world starts out with no actors. Cells near the camera are then decoded and built on the engine thread pool, and attached to the world once they are ready.
+		 *
+		 * @param addr The resource address to associate with the world
+		 * @param cells The cells of the packed world
+		 * @param config Streaming settings
+		 *
+		 * @throws BadValueException If the provided address is malformed
+		 * @throws BadValueException If the unload radius is smaller than the load radius
+		 */
+		void SetActiveStreamedWorld(const std::string& addr, libcacaoformats::PackedWorldCells cells, WorldStreamingConfig config = {});
+
+		/**
+		 * @brief Update the loaded cells of the active world around the camera
+		 *
+		 * Cells that have finished loading are attached, cells that have come into range start loading in the background, and cells that are out of range are unloaded.
+		 * Does nothing if the active world is not streamed.
+		 *
+		 * @note This is called automatically at the start of every dynamic tick
+		 */
+		void UpdateStreaming();
+
+		/**
+		 * @brief Check if a cell of the active world is loaded and attached
+		 *
+		 * @param coords The coordinates of the cell
+		 *
+		 * @return Whether the cell is loaded, which is always false if the active world is not streamed
+		 */
+		bool IsCellLoaded(libcacaoformats::Vec3<int32_t> coords);
+
 		///@cond
 		struct Impl;
 		///@endcond
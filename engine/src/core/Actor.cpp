@@ -38,20 +38,22 @@ namespace Cacao {
 
 	ActorHandle Actor::GetParent() const {
 		ActorHandle hnd;
-		if(isRoot || parentPtr.lock()->isRoot) return hnd;
-		hnd.actor = parentPtr.lock();
+		std::shared_ptr<Actor> parent = parentPtr.lock();
+		if(isRoot || !parent || parent->isRoot) return hnd;
+		hnd.actor = parent;
 		hnd.world = world.lock();
 		return hnd;
 	}
 
 	void Actor::Reparent(ActorHandle newParent) {
-		//Remove ourselves from the current parent
+		//Remove ourselves from the current parent (actors detached from the world have none)
 		std::shared_ptr<Actor> selfPtr = shared_from_this();
-		std::shared_ptr<Actor> parent = parentPtr.lock();
-		auto it = std::find_if(parent->children.begin(), parent->children.end(), [&selfPtr](std::shared_ptr<Actor> a) {
-			return a == selfPtr;
-		});
-		if(it != parent->children.end()) parent->children.erase(it);
+		if(std::shared_ptr<Actor> parent = parentPtr.lock()) {
+			auto it = std::find_if(parent->children.begin(), parent->children.end(), [&selfPtr](std::shared_ptr<Actor> a) {
+				return a == selfPtr;
+			});
+			if(it != parent->children.end()) parent->children.erase(it);
+		}
 
 		//Make sure we aren't parenting to ourselves
 		Check<BadValueException>(newParent.actor != selfPtr, "Cannot parent an Actor to itself!");
@@ -82,7 +84,8 @@ namespace Cacao {
 
 	void Actor::NotifyFunctionallyActiveStateChanged() {
 		bool wasFA = functionallyActive;
-		functionallyActive = (isRoot ? true : parentPtr.lock()->IsActive()) && active;
+		std::shared_ptr<Actor> parent = parentPtr.lock();
+		functionallyActive = (isRoot ? true : (parent && parent->IsActive())) && active;
 		if(wasFA == functionallyActive) return;
 		for(auto child : children) {
 			child->NotifyFunctionallyActiveStateChanged();
@@ -137,7 +140,10 @@ namespace Cacao {
 	}
 
 	Actor::Actor(const std::string& name, ActorHandle parent, xg::Guid guid)
-	  : name(name), guid(guid), transform({0, 0, 0}, {0, 0, 0}, {1, 1, 1}), parentPtr(parent.actor), world(parent->world), active(true), functionallyActive(true) {
+	  : Actor(name, parent, guid, Transform({0, 0, 0}, {0, 0, 0}, {1, 1, 1})) {}
+
+	Actor::Actor(const std::string& name, ActorHandle parent, xg::Guid guid, const Transform& transform)
+	  : name(name), guid(guid), transform(transform), parentPtr(parent.actor), world(parent->world), active(true), functionallyActive(true) {
 		NotifyFunctionallyActiveStateChanged();
 	}
 }
\ No newline at end of file
@@ -24,17 +24,31 @@ namespace Cacao {
 			else
 				Check<BadValueException>(images[i].w == refSz.x && images[i].h == refSz.y, "Not all cubemap faces are the same size!");
 
-			//Convert to 8-bit
-			if(images[i].bitsPerChannel == 16) images[i] = libcacaoimage::Convert16To8BitColor(images[i]);
-
-			//Ensure RGB layout
-			if(images[i].layout != libcacaoimage::Image::Layout::RGB) images[i] = libcacaoimage::ChangeChannelLayout(images[i], libcacaoimage::Image::Layout::RGB);
+			//Convert to 8-bit RGB in one pass
+			libcacaoimage::Normalize(images[i], libcacaoimage::Image::Layout::RGB);
 		}
 
 		//Fill data
 		impl->faces = std::move(images);
 	}
 
+	Cubemap::Cubemap(libcacaoformats::CompressedCubemap&& faces, const std::string& addr)
+	  : Asset(addr) {
+		Check<BadValueException>(ValidateResourceAddr<Cubemap>(addr), "Resource address is malformed!");
+
+		//Create implementation pointer
+		PAL::Get().ConfigureImplPtr(*this);
+
+		//Validate mip chains (the level sizes were already checked when the faces were decoded)
+		Check<BadValueException>(faces.MipLevels() > 0, "Compressed cubemap faces have no mip levels!");
+		for(const std::vector<libcacaoformats::PackedPayload>& face : faces.faces) {
+			Check<BadValueException>(face.size() == faces.MipLevels(), "Not all compressed cubemap faces have the same number of mip levels!");
+		}
+
+		//Fill data
+		impl->compressed.emplace(std::move(faces));
+	}
+
 	Cubemap::~Cubemap() {
 		if(realized) DropRealized();
 	}
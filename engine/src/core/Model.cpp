@@ -203,17 +203,6 @@ namespace Cacao {
 		aiTexture* tex = impl->textureIndex[id];
 		std::string texType(tex->achFormatHint);
 
-		//Unpack texels to bytes
-		std::size_t texelCount = static_cast<std::size_t>(tex->mWidth) * std::clamp(tex->mHeight, (unsigned int)1, UINT32_MAX);
-		std::vector<unsigned char> texelData(texelCount * 4);
-		for(std::size_t i = 0; i < texelCount;) {
-			std::size_t texel = i / 4;
-			texelData[i++] = tex->pcData[texel].b;
-			texelData[i++] = tex->pcData[texel].g;
-			texelData[i++] = tex->pcData[texel].r;
-			texelData[i++] = tex->pcData[texel].a;
-		}
-
 		//Get image data
 		libcacaoimage::Image img;
 
@@ -225,23 +214,26 @@ namespace Cacao {
 			Check<BadValueException>(fmt.compare("web") == 0 || fmt.compare("jpg") == 0 || fmt.compare("x-t") == 0 || fmt.compare("png") == 0 || fmt.compare("tif") == 0,
 				"Cannot get a texture with an unsupported texture format!");
 
-			//Convert texel data to std::vector<char> for streaming purposes
-			//We also obliterate texelData as a part of this because we don't need two copies of the data
-			//And we want to free up memory
-			std::vector<char> charTexels(texelData.size());
-			charTexels.assign(texelData.begin(), texelData.end());
-			texelData.clear();
-			texelData.shrink_to_fit();
-			ibytestream texelstream(charTexels);
-
-			//Try to decode texture data
+			//Try to decode texture data straight from Assimp's buffer, narrowing to the 8-bit color textures are uploaded with while decoding
+			//For compressed textures, the width is the size of the encoded data in bytes
 			try {
-				img = libcacaoimage::decode::DecodeGeneric(texelstream);
+				img = libcacaoimage::decode::DecodeGeneric(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(tex->pcData), tex->mWidth), {.bitsPerChannel = 8});
 			} catch(const std::runtime_error& e) {
 				//We re-throw the exception as a Cacao Engine exception to keep everything tidy
 				Check<ExternalException>(false, std::string("While decoding model embedded texture data: \"") + e.what() + "\"");
 			}
 		} else {
+			//Unpack texels to bytes
+			std::size_t texelCount = static_cast<std::size_t>(tex->mWidth) * tex->mHeight;
+			std::vector<unsigned char> texelData(texelCount * 4);
+			for(std::size_t i = 0; i < texelCount;) {
+				std::size_t texel = i / 4;
+				texelData[i++] = tex->pcData[texel].b;
+				texelData[i++] = tex->pcData[texel].g;
+				texelData[i++] = tex->pcData[texel].r;
+				texelData[i++] = tex->pcData[texel].a;
+			}
+
 			//Set image properties
 			img.w = tex->mWidth;
 			img.h = tex->mHeight;
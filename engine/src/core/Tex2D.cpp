@@ -14,8 +14,11 @@ namespace Cacao {
 		//Create implementation pointer
 		PAL::Get().ConfigureImplPtr(*this);
 
+		//Bring the image to 8-bit in one pass, also expanding RGB to RGBA since three-channel formats are rarely sampleable on GPUs
+		libcacaoimage::Normalize(imageBuffer, imageBuffer.layout == libcacaoimage::Image::Layout::RGB ? libcacaoimage::Image::Layout::RGBA : imageBuffer.layout);
+
 		//Fill data
-		impl->img = (imageBuffer.bitsPerChannel == 16 ? libcacaoimage::Convert16To8BitColor(imageBuffer) : std::move(imageBuffer));
+		impl->img = std::move(imageBuffer);
 	}
 
 	Tex2D::~Tex2D() {
@@ -190,6 +190,9 @@ namespace Cacao {
 		//Freeze input state
 		Input::Get().FreezeInputState();
 
+		//Bring streamed world cells in and out around the camera
+		WorldManager::Get().UpdateStreaming();
+
 		//Acquire active world
 		std::shared_ptr<World> world = WorldManager::Get().GetActiveWorld();
 		if(!world) return;
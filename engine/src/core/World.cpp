@@ -2,7 +2,9 @@
 #include "Cacao/Actor.hpp"
 #include "Cacao/CodeRegistry.hpp"
 #include "Cacao/Component.hpp"
+#include "Cacao/Engine.hpp"
 #include "Cacao/Exceptions.hpp"
+#include "Cacao/Log.hpp"
 #include "Cacao/PerspectiveCamera.hpp"
 #include "Cacao/Resource.hpp"
 #include "Cacao/ResourceManager.hpp"
@@ -13,7 +15,14 @@
 
 #include "libcacaoformats.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace Cacao {
 	World::World(const std::string& addr)
@@ -41,54 +50,127 @@ namespace Cacao {
 			w->skyboxTex = *ResourceManager::Get().Load<Cubemap>(world.skyboxRef);
 		}
 
-		//Process actors and make tree
-		std::unordered_map<xg::Guid, ActorHandle> foundActors;
-		std::unordered_map<xg::Guid, std::vector<libcacaoformats::World::Actor>> awaitingParents;
-		const auto processActor = [w, &foundActors, &awaitingParents](const libcacaoformats::World::Actor& actor) {
-			auto impl = [w, &foundActors, &awaitingParents](const libcacaoformats::World::Actor& actor, auto& iref) mutable {
-				//Generate handle
-				ActorHandle hnd;
-				if(actor.parentGUID == xg::Guid {}) {
-					//Top-level actor
-					hnd = Actor::Create(actor.name, w, actor.guid);
-				} else if(foundActors.contains(actor.parentGUID)) {
-					//The parent has been added to the tree
-					hnd = Actor::Create(actor.name, foundActors[actor.parentGUID], actor.guid);
-				} else {
-					//The parent has not been added to the tree but we'll save this for when it is
-					awaitingParents[actor.parentGUID].push_back(actor);
-					return;
-				}
+		//Build the actors in column-oriented form and attach them
+		libcacaoformats::WorldColumns columns;
+		libcacaoformats::WorldToColumns(world, columns);
+		for(ActorHandle& actor : BuildActors(w, columns, true)) w->ReparentToRoot(actor);
+
+		//Return built world
+		return w;
+	}
+
+	std::vector<ActorHandle> World::BuildActors(std::shared_ptr<World> world, const libcacaoformats::WorldColumns& columns, bool parallel) {
+		const std::size_t count = columns.ActorCount();
 
-				//Register actor object
-				foundActors.insert_or_assign(hnd->guid, hnd);
+		//Ensure every component type is in the code registry, checking each distinct type once
+		std::vector<bool> checkedTypes(columns.stringStarts.size());
+		for(uint32_t type : columns.componentTypes) {
+			if(checkedTypes[type]) continue;
+			Check<NonexistentValueException>(CodeRegistry::Get().HasFactory<Component>(std::string(columns.String(type))), "World contains component of an unknown type! Hint: all component types must be registered in the CodeRegistry.");
+			checkedTypes[type] = true;
+		}
 
-				//Setup transform
-				hnd->transform.SetPosition({actor.initialPos.x, actor.initialPos.y, actor.initialPos.z});
-				hnd->transform.SetRotation({actor.initialRot.x, actor.initialRot.y, actor.initialRot.z});
-				hnd->transform.SetScale({actor.initialScale.x, actor.initialScale.y, actor.initialScale.z});
+		//Find the parent of every actor
+		//Actors whose parent is not in the data (or that are part of a parent cycle) are never reached from a top-level actor, so they are skipped
+		std::unordered_map<xg::Guid, std::size_t> indices;
+		indices.reserve(count);
+		for(std::size_t i = 0; i < count; ++i) indices.try_emplace(xg::Guid(columns.guids[i]), i);
+		std::vector<std::size_t> topLevel;
+		std::vector<std::size_t> parents(count, SIZE_MAX);
+		std::vector<std::size_t> childStarts(count + 1, 0);
+		for(std::size_t i = 0; i < count; ++i) {
+			xg::Guid parentGUID(columns.parentGUIDs[i]);
+			if(parentGUID == xg::Guid {}) {
+				topLevel.push_back(i);
+				continue;
+			}
+			auto parent = indices.find(parentGUID);
+			if(parent == indices.end() || parent->second == i) continue;
+			parents[i] = parent->second;
+			++childStarts[parent->second + 1];
+		}
 
-				//Mount components
-				for(const libcacaoformats::World::Component& comp : actor.components) {
-					//Ensure the type is in the code registry
-					Check<NonexistentValueException>(CodeRegistry::Get().HasFactory<Component>(comp.typeID), "World contains component of an unknown type! Hint: all component types must be registered in the CodeRegistry.");
+		//Group children by parent, keeping their relative order
+		for(std::size_t i = 0; i < count; ++i) childStarts[i + 1] += childStarts[i];
+		std::vector<std::size_t> children(childStarts[count]);
+		{
+			std::vector<std::size_t> cursor(childStarts.begin(), childStarts.end() - 1);
+			for(std::size_t i = 0; i < count; ++i) {
+				if(parents[i] != SIZE_MAX) children[cursor[parents[i]]++] = i;
+			}
+		}
 
-					//Create the component
-					hnd->MountComponent(comp.typeID);
+		//Make an actor
+		//Its transform is passed to the constructor so that the transformation matrix is only computed once
+		const auto build = [&world, &columns](std::size_t i, ActorHandle parent) {
+			const libcacaoformats::Vec3<float>& pos = columns.positions[i];
+			const libcacaoformats::Vec3<float>& rot = columns.rotations[i];
+			const libcacaoformats::Vec3<float>& scale = columns.scales[i];
+			ActorHandle hnd;
+			hnd.actor = std::shared_ptr<Actor>(new Actor(std::string(columns.String(columns.names[i])), parent, xg::Guid(columns.guids[i]), Transform({pos.x, pos.y, pos.z}, {rot.x, rot.y, rot.z}, {scale.x, scale.y, scale.z})));
+			hnd.world = world;
 
-					//TODO: Add the reflection data back in somehow
-				}
+			//Mount components
+			for(uint32_t c = columns.componentStarts[i]; c < columns.componentStarts[i + 1]; ++c) {
+				hnd->MountComponent(std::string(columns.String(columns.componentTypes[c])));
 
-				//Process components that should be children of this one
-				if(awaitingParents.contains(actor.guid))
-					for(const libcacaoformats::World::Actor& ca : awaitingParents[actor.guid]) iref(ca, iref);
-			};
-			impl(actor, impl);
+				//TODO: Add the reflection data back in somehow (compiled worlds store it in binary form, readable with libcacaoformats::ReflectionView)
+			}
+			return hnd;
 		};
-		for(const libcacaoformats::World::Actor& actor : world.actors) processActor(actor);
 
-		//Return built world
-		return w;
+		//Run a task for each element of a list, on the thread pool if requested
+		//The first exception thrown by a task is rethrown once they have all finished
+		const auto runTasks = [parallel](const std::vector<std::size_t>& list, const auto& fn) {
+			if(!parallel || list.size() < 2) {
+				for(std::size_t i : list) fn(i);
+				return;
+			}
+			std::vector<std::exception_ptr> errors(list.size());
+			std::vector<std::size_t> slots(list.size());
+			for(std::size_t i = 0; i < slots.size(); ++i) slots[i] = i;
+			exathread::MultiFuture<void> tasks = Engine::Get().GetThreadPool()->batch(slots, [&list, &fn, &errors](std::size_t slot) {
+				try {
+					fn(list[slot]);
+				} catch(...) {
+					errors[slot] = std::current_exception();
+				}
+			});
+			tasks.await();
+			for(const std::exception_ptr& error : errors) {
+				if(error) std::rethrow_exception(error);
+			}
+		};
+
+		//Build the hierarchy one depth level at a time, starting with the top-level actors
+		//Every actor of a level is built by the task for its parent, so sibling subtrees are built in parallel and each child list is only touched by one task
+		std::vector<ActorHandle> handles(count);
+		runTasks(topLevel, [&](std::size_t i) { handles[i] = build(i, world->root); });
+		std::vector<std::size_t> level = topLevel, nextLevel, levelParents;
+		while(!level.empty()) {
+			levelParents.clear();
+			nextLevel.clear();
+			for(std::size_t p : level) {
+				if(childStarts[p + 1] == childStarts[p]) continue;
+				levelParents.push_back(p);
+				nextLevel.insert(nextLevel.end(), children.begin() + childStarts[p], children.begin() + childStarts[p + 1]);
+			}
+			runTasks(levelParents, [&](std::size_t p) {
+				ActorHandle& parent = handles[p];
+				parent->children.reserve(parent->children.size() + childStarts[p + 1] - childStarts[p]);
+				for(std::size_t c = childStarts[p]; c < childStarts[p + 1]; ++c) {
+					handles[children[c]] = build(children[c], parent);
+					parent->children.push_back(handles[children[c]].actor);
+				}
+			});
+			level.swap(nextLevel);
+		}
+
+		//Return the top-level actors
+		std::vector<ActorHandle> out;
+		out.reserve(topLevel.size());
+		for(std::size_t i : topLevel) out.push_back(handles[i]);
+		return out;
 	}
 
 	World::~World() {}
@@ -97,12 +179,50 @@ namespace Cacao {
 		actor->Reparent(root);
 	}
 
+	void World::DetachFromRoot(ActorHandle actor) {
+		std::erase(root->children, actor.actor);
+		actor->parentPtr.reset();
+	}
+
 	std::vector<ActorHandle> World::GetRootChildren() const {
 		return root->GetAllChildren();
 	}
 
+	//Streaming state of a world, shared with the tasks loading its cells
+	struct WorldStream {
+		enum class CellState {
+			Unloaded,
+			Loading,
+			Cancelled,
+			Loaded,
+			Failed
+		};
+
+		//A cell that a background task has finished building
+		struct FinishedCell {
+			std::size_t idx;
+			std::vector<ActorHandle> actors;
+			bool failed;
+		};
+
+		WorldStream(libcacaoformats::PackedWorldCells cells, WorldStreamingConfig config, std::weak_ptr<World> world)
+		  : cells(std::move(cells)), config(config), world(world) {}
+
+		libcacaoformats::PackedWorldCells cells;
+		WorldStreamingConfig config;
+		std::weak_ptr<World> world;
+
+		//These are only touched from UpdateStreaming
+		std::vector<CellState> states;
+		std::vector<std::vector<ActorHandle>> loaded;
+
+		std::mutex finishedMtx;
+		std::vector<FinishedCell> finished;
+	};
+
 	struct WorldManager::Impl {
 		std::shared_ptr<World> active;
+		std::shared_ptr<WorldStream> stream;
 	};
 
 	WorldManager::WorldManager() {
@@ -135,5 +255,127 @@ namespace Cacao {
 			impl->active = *ResourceManager::Get().Load<World>(addr);
 		}
 		impl->active = std::static_pointer_cast<World>(IMPL(ResourceManager).cache[addr].lock());
+		impl->stream.reset();
+	}
+
+	void WorldManager::SetActiveStreamedWorld(const std::string& addr, libcacaoformats::PackedWorldCells cells, WorldStreamingConfig config) {
+		Check<BadValueException>(config.unloadRadius >= config.loadRadius, "World streaming unload radius must be at least the load radius!");
+
+		//Create the world with no actors
+		std::shared_ptr<World> w = World::Create(addr);
+		w->cam->SetPosition({cells.GetInitialCamPos().x, cells.GetInitialCamPos().y, cells.GetInitialCamPos().z});
+		w->cam->SetRotation({cells.GetInitialCamRot().x, cells.GetInitialCamRot().y, cells.GetInitialCamRot().z});
+		if(!cells.GetSkyboxRef().empty() && Resource::ValidateResourceAddr<Cubemap>(cells.GetSkyboxRef())) {
+			w->skyboxTex = *ResourceManager::Get().Load<Cubemap>(cells.GetSkyboxRef());
+		}
+
+		//Set up streaming state
+		std::shared_ptr<WorldStream> stream = std::make_shared<WorldStream>(std::move(cells), config, w);
+		stream->states.resize(stream->cells.GetCells().size(), WorldStream::CellState::Unloaded);
+		stream->loaded.resize(stream->cells.GetCells().size());
+
+		impl->active = w;
+		impl->stream = stream;
+	}
+
+	void WorldManager::UpdateStreaming() {
+		std::shared_ptr<WorldStream> stream = impl->stream;
+		if(!stream) return;
+		std::shared_ptr<World> world = impl->active;
+		using CellState = WorldStream::CellState;
+
+		//Attach cells that have finished loading
+		{
+			std::lock_guard lk(stream->finishedMtx);
+			for(WorldStream::FinishedCell& cell : stream->finished) {
+				if(cell.failed) {
+					stream->states[cell.idx] = CellState::Failed;
+				} else if(stream->states[cell.idx] == CellState::Cancelled) {
+					//The camera moved away while the cell was loading
+					stream->states[cell.idx] = CellState::Unloaded;
+				} else {
+					for(ActorHandle& actor : cell.actors) world->ReparentToRoot(actor);
+					stream->loaded[cell.idx] = std::move(cell.actors);
+					stream->states[cell.idx] = CellState::Loaded;
+				}
+			}
+			stream->finished.clear();
+		}
+
+		//Find the camera's cell
+		//Unpartitioned worlds have only one cell, which is always in range
+		const float cellSize = stream->cells.GetCellSize();
+		const glm::vec3 camPos = world->cam->GetPosition();
+		const auto toCell = [cellSize](float pos) -> int64_t {
+			if(cellSize <= 0 || !std::isfinite(pos)) return 0;
+			return (int64_t)std::clamp(std::floor(double(pos) / cellSize), double(INT32_MIN) - 1, double(INT32_MAX) + 1);
+		};
+		const int64_t camCell[3] = {toCell(camPos.x), toCell(camPos.y), toCell(camPos.z)};
+		const auto distance = [&stream, &camCell](std::size_t idx) -> int64_t {
+			const libcacaoformats::Vec3<int32_t>& coords = stream->cells.GetCells()[idx].coords;
+			return std::max({std::abs(coords.x - camCell[0]), std::abs(coords.y - camCell[1]), std::abs(coords.z - camCell[2])});
+		};
+		const auto unload = [&stream, &world](std::size_t idx) {
+			for(ActorHandle& actor : stream->loaded[idx]) world->DetachFromRoot(actor);
+			stream->loaded[idx].clear();
+			stream->states[idx] = CellState::Unloaded;
+		};
+
+		//Unload cells that are out of range and find the ones that should be loaded
+		std::vector<std::pair<int64_t, std::size_t>> wanted;
+		std::size_t resident = 0;
+		for(std::size_t i = 0; i < stream->states.size(); ++i) {
+			const int64_t dist = distance(i);
+			CellState& state = stream->states[i];
+			if(dist > stream->config.unloadRadius) {
+				if(state == CellState::Loaded) unload(i);
+				if(state == CellState::Loading) state = CellState::Cancelled;
+			} else if(state == CellState::Unloaded && dist <= stream->config.loadRadius) {
+				wanted.emplace_back(dist, i);
+			}
+			if(state == CellState::Loaded || state == CellState::Loading) ++resident;
+		}
+		std::sort(wanted.begin(), wanted.end());
+
+		//Start loading the nearest cells
+		std::shared_ptr<exathread::Pool> pool = Engine::Get().GetThreadPool();
+		for(const auto& [dist, idx] : wanted) {
+			//If we're over budget, make room by unloading the furthest loaded cell if it's further than this one
+			if(stream->config.maxLoadedCells > 0 && resident >= stream->config.maxLoadedCells) {
+				std::optional<std::size_t> furthest;
+				for(std::size_t i = 0; i < stream->states.size(); ++i) {
+					if(stream->states[i] == CellState::Loaded && distance(i) > dist && (!furthest || distance(i) > distance(*furthest))) furthest = i;
+				}
+				if(!furthest) break;
+				unload(*furthest);
+				--resident;
+			}
+
+			//Decode and build the cell in the background
+			stream->states[idx] = CellState::Loading;
+			++resident;
+			pool->submit([stream, idx]() {
+				WorldStream::FinishedCell result {.idx = idx, .actors = {}, .failed = false};
+				try {
+					if(std::shared_ptr<World> w = stream->world.lock()) {
+						libcacaoformats::WorldColumns columns;
+						stream->cells.DecodeCell(idx, columns);
+						//Cells are already loaded in parallel with each other, so each one is built on this thread
+						result.actors = World::BuildActors(w, columns, false);
+					}
+				} catch(const std::exception& e) {
+					Logger::Engine(Logger::Level::Error) << "Failed to load world cell: " << e.what();
+					result.failed = true;
+				}
+				std::lock_guard lk(stream->finishedMtx);
+				stream->finished.push_back(std::move(result));
+			});
+		}
+	}
+
+	bool WorldManager::IsCellLoaded(libcacaoformats::Vec3<int32_t> coords) {
+		if(!impl->stream) return false;
+		std::optional<std::size_t> idx = impl->stream->cells.FindCell(coords);
+		return idx && impl->stream->states[*idx] == WorldStream::CellState::Loaded;
 	}
 }
\ No newline at end of file
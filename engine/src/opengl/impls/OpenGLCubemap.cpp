@@ -6,7 +6,26 @@
 #include "glad/gl.h"
 #include "libcacaoimage.hpp"
 
+#include <algorithm>
+
 namespace Cacao {
+	//Get the OpenGL internal format of a GPU-compressed cubemap, checking that the context can use it (none of them are core in OpenGL 4.1)
+	GLenum CompressedGLFormat(const libcacaoformats::CompressedCubemap& cubemap) {
+		switch(cubemap.compression) {
+			case libcacaoformats::BlockCompression::BC7:
+				Check<BadValueException>(GLAD_GL_ARB_texture_compression_bptc, "The graphics device does not support the block compression format of this cubemap!");
+				return cubemap.srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB : GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+			case libcacaoformats::BlockCompression::ASTC4x4:
+				Check<BadValueException>(GLAD_GL_KHR_texture_compression_astc_ldr, "The graphics device does not support the block compression format of this cubemap!");
+				return cubemap.srgb ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR : GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+			case libcacaoformats::BlockCompression::ETC2RGBA8:
+				Check<BadValueException>(GLAD_GL_ARB_ES3_compatibility, "The graphics device does not support the block compression format of this cubemap!");
+				return cubemap.srgb ? GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC : GL_COMPRESSED_RGBA8_ETC2_EAC;
+		}
+		Check<BadValueException>(false, "The graphics device does not support the block compression format of this cubemap!");
+		return 0;
+	}
+
 	void OpenGLCubemapImpl::Realize(bool& success) {
 		//Open-GL specific stuff needs to be on the GPU thread
 		std::unique_ptr<OpenGLCommandBuffer> cmd = CBCast<OpenGLCommandBuffer>(CommandBuffer::Create());
@@ -18,19 +37,30 @@ namespace Cacao {
 			//Bind texture
 			glBindTexture(GL_TEXTURE_CUBE_MAP, gpuTex);
 
-			//Transfer face images
-			uint8_t i = 0;
-			for(const libcacaoimage::Image& image : faces) {
-				//Flip image because OpenGL likes it that way
-				libcacaoimage::Image flipped = libcacaoimage::Flip(image);
-
-				//Copy image data to GPU and adjust increment
-				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i++, 0, GL_SRGB8, flipped.w, flipped.h, 0, GL_RGB, GL_UNSIGNED_BYTE, flipped.data.data());
-				GL_CHECK("Failed to upload cubemap face texture data!")
+			if(compressed) {
+				//Transfer compressed face levels as-is
+				GLenum format = CompressedGLFormat(*compressed);
+				for(GLenum i = 0; i < 6; i++) {
+					for(std::size_t level = 0; level < compressed->MipLevels(); level++) {
+						const libcacaoformats::PackedPayload& data = compressed->faces[i][level];
+						glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, GLint(level), format, std::max(compressed->w >> level, 1u), std::max(compressed->h >> level, 1u), 0, GLsizei(data.size()), data.data());
+						GL_CHECK("Failed to upload compressed cubemap face texture data!")
+					}
+				}
+				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, GLint(compressed->MipLevels() - 1));
+			} else {
+				//Transfer face images as-is (unlike 2D textures, OpenGL cube map faces start from the top row, just like Vulkan ones and compressed levels)
+				uint8_t i = 0;
+				for(const libcacaoimage::Image& image : faces) {
+					//Copy image data to GPU and adjust increment
+					glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i++, 0, GL_SRGB8, image.w, image.h, 0, GL_RGB, GL_UNSIGNED_BYTE, image.data.data());
+					GL_CHECK("Failed to upload cubemap face texture data!")
+				}
+				glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
 			}
 
 			//Apply cubemap filtering
-			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, compressed && compressed->MipLevels() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 			//Configure wrapping mode
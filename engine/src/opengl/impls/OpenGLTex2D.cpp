@@ -13,11 +13,12 @@ namespace Cacao {
 		std::unique_ptr<OpenGLCommandBuffer> cmd = CBCast<OpenGLCommandBuffer>(CommandBuffer::Create());
 		cmd->AddTask([this, &success]() {
 			//Flip texture
-			libcacaoimage::Image flipped = libcacaoimage::Flip(img);
+			std::vector<unsigned char> flipped(img.data.size());
+			libcacaoimage::Flip(img, flipped);
 
 			//Get texture format
 			GLenum internalFormat;
-			switch(flipped.layout) {
+			switch(img.layout) {
 				case libcacaoimage::Image::Layout::Grayscale:
 					format = GL_RED;
 					internalFormat = GL_RED;
@@ -40,7 +41,7 @@ namespace Cacao {
 			glBindTexture(GL_TEXTURE_2D, gpuTex);
 
 			//Transfer image data
-			glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, flipped.w, flipped.h, 0, format, GL_UNSIGNED_BYTE, flipped.data.data());
+			glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, img.w, img.h, 0, format, GL_UNSIGNED_BYTE, flipped.data());
 			GL_CHECK("Failed to transfer image data to GPU texture!")
 
 			//Configure and generate mipmaps
@@ -13,6 +13,9 @@ namespace Cacao {
 		//Order: +X, -X, +Y, -Y, +Z, -Z
 		std::array<libcacaoimage::Image, 6> faces;
 
+		//Set instead of the face images for GPU-compressed cubemaps
+		std::optional<libcacaoformats::CompressedCubemap> compressed;
+
 		virtual ~Impl() = default;
 	};
 }
\ No newline at end of file
@@ -148,6 +148,12 @@ namespace Cacao {
 		deviceFeatures2.features.setIndependentBlend(VK_TRUE);
 		deviceFeatures2.features.setOcclusionQueryPrecise(VK_TRUE);
 		deviceFeatures2.features.setPipelineStatisticsQuery(VK_TRUE);
+
+		//Enable whichever GPU block compression formats the device has, so that compressed cubemaps can be uploaded as-is
+		vk::PhysicalDeviceFeatures supportedFeatures = physDev.getFeatures();
+		deviceFeatures2.features.setTextureCompressionBC(supportedFeatures.textureCompressionBC);
+		deviceFeatures2.features.setTextureCompressionASTC_LDR(supportedFeatures.textureCompressionASTC_LDR);
+		deviceFeatures2.features.setTextureCompressionETC2(supportedFeatures.textureCompressionETC2);
 		vk::DeviceCreateInfo deviceCI({}, queueCI, {}, requiredDevExts, nullptr, &deviceFeatures2);
 		try {
 			dev = physDev.createDevice(deviceCI);
@@ -4,14 +4,55 @@
 #include "VulkanModule.hpp"
 #include "CommandBufferCast.hpp"
 
+#include <algorithm>
+#include <span>
+
 namespace Cacao {
+	//Get the Vulkan format of a GPU-compressed cubemap
+	vk::Format CompressedVkFormat(const libcacaoformats::CompressedCubemap& cubemap) {
+		switch(cubemap.compression) {
+			case libcacaoformats::BlockCompression::BC7: return cubemap.srgb ? vk::Format::eBc7SrgbBlock : vk::Format::eBc7UnormBlock;
+			case libcacaoformats::BlockCompression::ASTC4x4: return cubemap.srgb ? vk::Format::eAstc4x4SrgbBlock : vk::Format::eAstc4x4UnormBlock;
+			case libcacaoformats::BlockCompression::ETC2RGBA8: return cubemap.srgb ? vk::Format::eEtc2R8G8B8A8SrgbBlock : vk::Format::eEtc2R8G8B8A8UnormBlock;
+		}
+		return vk::Format::eUndefined;
+	}
+
 	void VulkanCubemapImpl::Realize(bool& success) {
-		//Calculate sizes
-		vk::DeviceSize faceSize = faces[0].w * faces[0].h * 3;
-		vk::DeviceSize totalSize = faceSize * 6;
+		//Lay out the upload buffer: face images one after another, or compressed faces level by level
+		vk::Format format = vk::Format::eR8G8B8Srgb;
+		uint32_t mipLevels = 1;
+		vk::DeviceSize totalSize = 0;
+		std::vector<std::span<const unsigned char>> sources;
+		std::vector<vk::BufferImageCopy2> copies;
+		vk::Extent3D extent;
+		if(compressed) {
+			format = CompressedVkFormat(*compressed);
+			vk::FormatProperties props = vulkan->physDev.getFormatProperties(format);
+			Check<BadValueException>((props.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage) == vk::FormatFeatureFlagBits::eSampledImage, "The graphics device does not support the block compression format of this cubemap!");
+			mipLevels = static_cast<uint32_t>(compressed->MipLevels());
+			extent = vk::Extent3D(compressed->w, compressed->h, 1);
+			for(uint32_t i = 0; i < 6; i++) {
+				for(uint32_t level = 0; level < mipLevels; level++) {
+					//Levels are whole 4x4 blocks (which always keeps them aligned), but the copy extent is in texels
+					vk::Extent3D levelExtent(std::max(compressed->w >> level, 1u), std::max(compressed->h >> level, 1u), 1);
+					copies.emplace_back(totalSize, 0, 0, vk::ImageSubresourceLayers {vk::ImageAspectFlagBits::eColor, level, i, 1}, vk::Offset3D {0}, levelExtent);
+					sources.push_back(compressed->faces[i][level].span());
+					totalSize += sources.back().size();
+				}
+			}
+		} else {
+			extent = vk::Extent3D(faces[0].w, faces[0].h, 1);
+			vk::DeviceSize faceSize = faces[0].w * faces[0].h * 3;
+			for(uint32_t i = 0; i < 6; i++) {
+				copies.emplace_back(totalSize, faces[0].w, faces[0].h, vk::ImageSubresourceLayers {vk::ImageAspectFlagBits::eColor, 0, i, 1}, vk::Offset3D {0}, extent);
+				sources.emplace_back(faces[i].data.data(), faceSize);
+				totalSize += faceSize;
+			}
+		}
 
 		//Allocate GPU texture & data upload buffers
-		vk::ImageCreateInfo texCI(vk::ImageCreateFlagBits::eCubeCompatible, vk::ImageType::e2D, vk::Format::eR8G8B8Srgb, {faces[0].w, faces[0].h, 1}, 1, 1,
+		vk::ImageCreateInfo texCI(vk::ImageCreateFlagBits::eCubeCompatible, vk::ImageType::e2D, format, extent, mipLevels, 6,
 			vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive, 0);
 		vma::AllocationCreateInfo texAllocCI(vma::AllocationCreateFlagBits::eWithinBudget, vma::MemoryUsage::eAutoPreferDevice, vk::MemoryPropertyFlagBits::eDeviceLocal);
 		vk::BufferCreateInfo texUpCI({}, totalSize, vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive, 0);
@@ -27,16 +68,12 @@ namespace Cacao {
 			Check<ExternalException>(false, msg.str());
 		}
 
-		//Make cubemap data contiguous
-		std::vector<unsigned char> contiguous(totalSize);
-		for(unsigned short i = 0; i < faces.size(); i++) {
-			std::memcpy(&contiguous[i * faceSize], faces[i].data.data(), faceSize);
-		}
-
-		//Copy image data to upload buffer
+		//Copy image data straight to upload buffer
 		void* gpuMem;
 		Check<ExternalException>(vulkan->allocator.mapMemory(up.alloc, &gpuMem) == vk::Result::eSuccess, "Failed to map texture upload buffer memory!");
-		std::memcpy(gpuMem, contiguous.data(), totalSize);
+		for(std::size_t i = 0; i < sources.size(); i++) {
+			std::memcpy(static_cast<unsigned char*>(gpuMem) + copies[i].bufferOffset, sources[i].data(), sources[i].size());
+		}
 		vulkan->allocator.unmapMemory(up.alloc);
 
 		//Transfer data from upload buffer to real texture memory
@@ -45,23 +82,18 @@ namespace Cacao {
 		{
 			vk::ImageMemoryBarrier2 barrier(vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eNone,
 				vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eTransferWrite,
-				vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, 0, 0, vi.obj, {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 6});
+				vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, 0, 0, vi.obj, {vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 6});
 			vk::DependencyInfo cdDI({}, {}, {}, barrier);
 			cmd.pipelineBarrier2(cdDI);
 		}
 		{
-			std::vector<vk::BufferImageCopy2> copies;
-			for(unsigned int i = 0; i < faces.size(); i++) {
-				vk::BufferImageCopy2 copy(i * faceSize, faces[0].w, faces[0].h, {vk::ImageAspectFlagBits::eColor, 0, i, 1}, {0}, {faces[0].w, faces[0].h, 1});
-				copies.push_back(copy);
-			}
 			vk::CopyBufferToImageInfo2 copyInfo(up.obj, vi.obj, vk::ImageLayout::eTransferDstOptimal, copies);
 			cmd.copyBufferToImage2(copyInfo);
 		}
 		{
 			vk::ImageMemoryBarrier2 barrier(vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eTransferWrite,
 				vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eShaderSampledRead,
-				vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, 0, 0, vi.obj, {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 6});
+				vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, 0, 0, vi.obj, {vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 6});
 			vk::DependencyInfo cdDI({}, {}, {}, barrier);
 			cmd.pipelineBarrier2(cdDI);
 		}
@@ -71,9 +103,9 @@ namespace Cacao {
 		vulkan->allocator.destroyBuffer(up.obj, up.alloc);
 
 		//Create image view
-		vk::ImageViewCreateInfo viewCI({}, vi.obj, vk::ImageViewType::eCube, vk::Format::eR8G8B8Srgb,
+		vk::ImageViewCreateInfo viewCI({}, vi.obj, vk::ImageViewType::eCube, format,
 			{vk::ComponentSwizzle::eIdentity, vk::ComponentSwizzle::eIdentity, vk::ComponentSwizzle::eIdentity, vk::ComponentSwizzle::eOne},
-			{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 6});
+			{vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 6});
 		vi.view = vulkan->dev.createImageView(viewCI);
 
 		success = true;
@@ -4,6 +4,9 @@
 #include "VulkanModule.hpp"
 #include "CommandBufferCast.hpp"
 
+#include <span>
+#include <vector>
+
 namespace Cacao {
 	void VulkanTex2DImpl::Realize(bool& success) {
 		//Get texture format
@@ -19,11 +22,26 @@ namespace Cacao {
 				break;
 		}
 
+		//Build the rest of the mip chain, filtered in linear space since the texture formats are all sRGB
+		//Every level is tightly packed and laid out one after another in the upload buffer
+		std::vector<libcacaoimage::Image> mips = libcacaoimage::GenerateMipChain(img, libcacaoimage::MipFilter::Box, true, 0);
+		uint32_t mipLevels = static_cast<uint32_t>(mips.size()) + 1;
+		vk::DeviceSize totalSize = 0;
+		std::vector<std::span<const unsigned char>> sources;
+		std::vector<vk::BufferImageCopy2> copies;
+		for(uint32_t level = 0; level < mipLevels; level++) {
+			const libcacaoimage::Image& levelImg = level == 0 ? img : mips[level - 1];
+			vk::DeviceSize levelSize = levelImg.w * levelImg.h * static_cast<uint8_t>(img.layout);
+			copies.emplace_back(totalSize, 0, 0, vk::ImageSubresourceLayers {vk::ImageAspectFlagBits::eColor, level, 0, 1}, vk::Offset3D {0}, vk::Extent3D(levelImg.w, levelImg.h, 1));
+			sources.emplace_back(levelImg.data.data(), levelSize);
+			totalSize += levelSize;
+		}
+
 		//Allocate GPU texture & data upload buffers
-		vk::ImageCreateInfo texCI({}, vk::ImageType::e2D, format, {img.w, img.h, 1}, 1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+		vk::ImageCreateInfo texCI({}, vk::ImageType::e2D, format, {img.w, img.h, 1}, mipLevels, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
 			vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive, 0);
 		vma::AllocationCreateInfo texAllocCI(vma::AllocationCreateFlagBits::eWithinBudget, vma::MemoryUsage::eAutoPreferDevice, vk::MemoryPropertyFlagBits::eDeviceLocal);
-		vk::BufferCreateInfo texUpCI({}, img.w * img.h * static_cast<uint8_t>(img.layout), vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive, 0);
+		vk::BufferCreateInfo texUpCI({}, totalSize, vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive, 0);
 		vma::AllocationCreateInfo texUpAllocCI(vma::AllocationCreateFlagBits::eWithinBudget | vma::AllocationCreateFlagBits::eHostAccessSequentialWrite, vma::MemoryUsage::eAuto,
 			vk::MemoryPropertyFlagBits::eHostVisible);
 		Allocated<vk::Buffer> up;
@@ -39,7 +57,9 @@ namespace Cacao {
 		//Copy image data to upload buffer
 		void* gpuMem;
 		Check<ExternalException>(vulkan->allocator.mapMemory(up.alloc, &gpuMem) == vk::Result::eSuccess, "Failed to map texture upload buffer memory!");
-		std::memcpy(gpuMem, img.data.data(), img.w * img.h * static_cast<uint8_t>(img.layout));
+		for(std::size_t i = 0; i < sources.size(); i++) {
+			std::memcpy(static_cast<unsigned char*>(gpuMem) + copies[i].bufferOffset, sources[i].data(), sources[i].size());
+		}
 		vulkan->allocator.unmapMemory(up.alloc);
 
 		//Transfer data from upload buffer to real texture memory
@@ -49,19 +69,18 @@ namespace Cacao {
 		{
 			vk::ImageMemoryBarrier2 barrier(vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eNone,
 				vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eTransferWrite,
-				vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, 0, 0, vi.obj, {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+				vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, 0, 0, vi.obj, {vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 1});
 			vk::DependencyInfo cdDI({}, {}, {}, barrier);
 			cmd.pipelineBarrier2(cdDI);
 		}
 		{
-			vk::BufferImageCopy2 copy(0UL, 0, 0, {vk::ImageAspectFlagBits::eColor, 0, 0, 1}, {0}, {img.w, img.h, 1});
-			vk::CopyBufferToImageInfo2 copyInfo(up.obj, vi.obj, vk::ImageLayout::eTransferDstOptimal, copy);
+			vk::CopyBufferToImageInfo2 copyInfo(up.obj, vi.obj, vk::ImageLayout::eTransferDstOptimal, copies);
 			cmd.copyBufferToImage2(copyInfo);
 		}
 		{
 			vk::ImageMemoryBarrier2 barrier(vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eTransferWrite,
 				vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eShaderSampledRead,
-				vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, 0, 0, vi.obj, {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+				vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, 0, 0, vi.obj, {vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 1});
 			vk::DependencyInfo cdDI({}, {}, {}, barrier);
 			cmd.pipelineBarrier2(cdDI);
 		}
@@ -73,7 +92,7 @@ namespace Cacao {
 		//Create image view
 		vk::ImageViewCreateInfo viewCI({}, vi.obj, vk::ImageViewType::e2D, format,
 			{vk::ComponentSwizzle::eIdentity, vk::ComponentSwizzle::eIdentity, vk::ComponentSwizzle::eIdentity, vk::ComponentSwizzle::eIdentity},
-			{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+			{vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 1});
 		vi.view = vulkan->dev.createImageView(viewCI);
 
 		success = true;
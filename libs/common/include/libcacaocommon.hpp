@@ -6,6 +6,7 @@
 #include <string>
 #include <cstring>
 #include <functional>
+#include <span>
 #include <stdexcept>
 
 /**
@@ -58,6 +59,7 @@ class bytestreambuf : public std::streambuf {
 	}
 
 	std::streamsize xsputn(const char* s, std::streamsize n) override {
+		if(n <= 0) return 0;
 		std::ptrdiff_t remaining = epptr() - pptr();
 		if(n > remaining) {
 			std::ptrdiff_t offset = pptr() - pbase();
@@ -158,9 +160,8 @@ class bytestreambuf : public std::streambuf {
 class ibytestream : public std::istream {
   public:
 	ibytestream(std::vector<char>& data)
-	  : std::istream(bufInit(data)) {
+	  : std::istream(nullptr), buf(new bytestreambuf(data)) {
 		rdbuf(buf);
-		init(buf);
 	}
 
 	~ibytestream() {
@@ -169,11 +170,6 @@ class ibytestream : public std::istream {
 
   private:
 	bytestreambuf* buf;
-
-	bytestreambuf* bufInit(std::vector<char>& data) {
-		buf = new bytestreambuf(data);
-		return buf;
-	}
 };
 
 /**
@@ -182,9 +178,8 @@ class ibytestream : public std::istream {
 class obytestream : public std::ostream {
   public:
 	obytestream(std::vector<char>& data)
-	  : std::ostream(bufInit(data)) {
+	  : std::ostream(nullptr), buf(new bytestreambuf(data)) {
 		rdbuf(buf);
-		init(buf);
 	}
 
 	~obytestream() {
@@ -193,9 +188,61 @@ class obytestream : public std::ostream {
 
   private:
 	bytestreambuf* buf;
+};
 
-	bytestreambuf* bufInit(std::vector<char>& data) {
-		buf = new bytestreambuf(data);
-		return buf;
+/**
+ * @brief Read-only stream buffer over memory that it does not own
+ */
+class spanstreambuf : public std::streambuf {
+  public:
+	/**
+	 * @brief Create a spanstreambuf from a view of data
+	 *
+	 * @param data The data to read, which must outlive the buffer
+	 */
+	spanstreambuf(std::span<const unsigned char> data) {
+		//The get area is never written through, so casting away const is safe
+		char* begin = const_cast<char*>(reinterpret_cast<const char*>(data.data()));
+		setg(begin, begin, begin + data.size());
 	}
+
+  protected:
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in) override {
+		if(!(which & std::ios_base::in)) return -1;
+		std::streamoff newpos = -1;
+		switch(dir) {
+			case std::ios::beg:
+				newpos = off;
+				break;
+			case std::ios::cur:
+				newpos = gptr() - eback() + off;
+				break;
+			case std::ios::end:
+				newpos = egptr() - eback() + off;
+				break;
+			default:
+				return -1;
+		}
+		if(newpos < 0 || newpos > (egptr() - eback())) return -1;
+		setg(eback(), eback() + newpos, egptr());
+		return newpos;
+	}
+
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override {
+		return seekoff(pos, std::ios::beg, which);
+	}
+};
+
+/**
+ * @brief Byte input stream over memory that it does not own, which avoids copying the data into a vector first
+ */
+class ispanstream : public std::istream {
+  public:
+	ispanstream(std::span<const unsigned char> data)
+	  : std::istream(nullptr), buf(data) {
+		rdbuf(&buf);
+	}
+
+  private:
+	spanstreambuf buf;
 };
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+#ifdef HAS_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+///@brief Get the peak resident memory of the process so far in bytes
+inline std::size_t PeakRSS() {
+#ifdef HAS_WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+	return pmc.PeakWorkingSetSize;
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef HAS_MACOS
+	return usage.ru_maxrss;
+#else
+	return usage.ru_maxrss * 1024;
+#endif
+#endif
+}
@@ -0,0 +1,78 @@
+#include "libcacaoformats.hpp"
+
+#include "BenchUtil.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+
+//Pack layout: enough assets to make the copy obvious, fetched sparsely like a game would
+constexpr std::size_t assetCount = 1024;
+constexpr std::size_t assetSize = 256 * 1024;
+constexpr std::size_t fetchStride = 64;
+
+void Generate(const std::string& path) {
+	libcacaoformats::AssetPack pack;
+	for(std::size_t i = 0; i < assetCount; ++i) {
+		//Cubemaps are stored uncompressed, so the payload is as large as the assets
+		std::vector<unsigned char> data(assetSize);
+		for(std::size_t j = 0; j < assetSize; ++j) data[j] = static_cast<unsigned char>((i * 31 + j * 7) ^ (j >> 8));
+		pack.insert_or_assign("asset" + std::to_string(i), libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Cubemap, .buffer = std::move(data)});
+	}
+	libcacaoformats::PackedEncoder enc;
+	std::ofstream out(path, std::ios::binary);
+	enc.EncodeAssetPack(pack).ExportToStream(out);
+}
+
+int main(int argc, char* argv[]) {
+	if(argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " <generate|stream|mmap> <pack path>" << std::endl;
+		return 1;
+	}
+	std::string mode = argv[1];
+	std::string path = argv[2];
+
+	try {
+		if(mode == "generate") {
+			Generate(path);
+			return 0;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		//Load the container
+		std::optional<libcacaoformats::PackedContainer> container;
+		if(mode == "stream") {
+			std::ifstream in(path, std::ios::binary);
+			container.emplace(libcacaoformats::PackedContainer::FromStream(in));
+		} else if(mode == "mmap") {
+			container.emplace(libcacaoformats::PackedContainer::FromFile(path));
+		} else {
+			std::cerr << "Unknown mode \"" << mode << "\"" << std::endl;
+			return 1;
+		}
+		auto loaded = std::chrono::steady_clock::now();
+
+		//Fetch a sparse subset of the assets
+		libcacaoformats::PackedAssetIndex index = libcacaoformats::PackedAssetIndex::FromContainer(container.value());
+		std::size_t fetched = 0;
+		for(std::size_t i = 0; i < assetCount; i += fetchStride) {
+			fetched += index.Fetch("asset" + std::to_string(i)).buffer.size();
+		}
+		auto done = std::chrono::steady_clock::now();
+
+		std::printf("%s: payload %zu MiB, load %.3f ms, load+fetch %.3f ms (%zu KiB fetched), peak RSS %zu MiB\n", mode.c_str(),
+			container->payload.size() / (1024 * 1024),
+			std::chrono::duration<double, std::milli>(loaded - start).count(),
+			std::chrono::duration<double, std::milli>(done - start).count(),
+			fetched / 1024, PeakRSS() / (1024 * 1024));
+		return 0;
+	} catch(const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,254 @@
+#include "libcacaoformats.hpp"
+#include "libcacaoimage.hpp"
+
+#include "BenchUtil.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//Every allocation in the process goes through these, including the ones made inside the library
+static std::atomic_size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if(void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+//Input sizes: every generator scales its input linearly with these
+struct Scale {
+	const char* name;
+	std::size_t factor;
+};
+constexpr Scale scales[] = {{"small", 1}, {"medium", 8}, {"large", 64}};
+
+//Each case is decoded repeatedly until at least this much time has passed
+constexpr double minSeconds = 0.25;
+constexpr std::size_t minIterations = 3;
+
+struct Case {
+	std::string name;
+	std::size_t bytes;
+	std::function<void()> decode;
+};
+
+libcacaoformats::Material GenerateMaterial(std::size_t scale) {
+	libcacaoformats::Material mat;
+	mat.shader = "shaders/lit.ajs";
+
+	//Packed materials can't have more than 255 keys
+	for(std::size_t i = 0; i < std::min<std::size_t>(16 * scale, 255); ++i) {
+		std::string name = "param" + std::to_string(i);
+		switch(i % 5) {
+			case 0: mat.keys.insert_or_assign(name, int(i)); break;
+			case 1: mat.keys.insert_or_assign(name, (unsigned int)i); break;
+			case 2: mat.keys.insert_or_assign(name, libcacaoformats::Vec3<float> {.x = 0.5f, .y = float(i), .z = -1.0f}); break;
+			case 3: {
+				libcacaoformats::Matrix<float, 4, 4> m;
+				for(int c = 0; c < 4; ++c) m[c] = {float(c), float(i), 1.0f, 0.0f};
+				mat.keys.insert_or_assign(name, m);
+				break;
+			}
+			case 4: mat.keys.insert_or_assign(name, libcacaoformats::Material::TextureRef {.path = "textures/" + name + ".png", .isCubemap = (i % 2 == 0)}); break;
+		}
+	}
+	return mat;
+}
+
+libcacaoformats::World GenerateWorld(std::size_t scale) {
+	libcacaoformats::World world;
+	world.skyboxRef = "sky.ajc";
+	world.initialCamPos = {0.0f, 2.0f, -5.0f};
+	world.initialCamRot = {0.0f, 0.0f, 0.0f};
+	xg::Guid root = xg::newGuid();
+	for(std::size_t i = 0; i < 256 * scale; ++i) {
+		libcacaoformats::World::Actor a;
+		a.guid = (i == 0 ? root : xg::newGuid());
+		a.parentGUID = (i == 0 ? xg::Guid() : root);
+		a.name = "actor" + std::to_string(i);
+		a.initialPos = {float(i % 64) * 4.0f, 0.0f, float(i / 64) * 4.0f};
+		a.initialRot = {0.0f, float(i % 360), 0.0f};
+		a.initialScale = {1.0f, 1.0f, 1.0f};
+		a.components.push_back({.typeID = "MeshRenderer", .reflection = "mesh: meshes/crate.obj\nmaterial: materials/crate.yml"});
+		world.actors.push_back(std::move(a));
+	}
+	return world;
+}
+
+libcacaoformats::AssetPack GenerateAssetPack(std::size_t scale, std::size_t first = 0) {
+	libcacaoformats::AssetPack pack;
+	for(std::size_t i = first; i < first + 32 * scale; ++i) {
+		std::vector<unsigned char> data(16 * 1024);
+		for(std::size_t j = 0; j < data.size(); ++j) data[j] = static_cast<unsigned char>((i * 31 + j * 7) ^ (j >> 8));
+		pack.insert_or_assign("asset" + std::to_string(i), libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Resource, .buffer = std::move(data)});
+	}
+	return pack;
+}
+
+std::array<libcacaoimage::Image, 6> GenerateCubemap(std::size_t scale) {
+	std::array<libcacaoimage::Image, 6> faces;
+	unsigned int side = 32;
+	while(side * side < 32 * 32 * scale) side *= 2;
+	for(std::size_t f = 0; f < 6; ++f) {
+		libcacaoimage::Image& img = faces[f];
+		img.w = img.h = side;
+		img.layout = libcacaoimage::Image::Layout::RGBA;
+		img.bitsPerChannel = 8;
+		img.quality = 100;
+		img.lossy = false;
+		img.data.resize(side * side * 4);
+		for(std::size_t p = 0; p < img.data.size(); ++p) img.data[p] = static_cast<unsigned char>((p * (f + 1)) ^ (p >> 10));
+	}
+	return faces;
+}
+
+void AddCases(std::vector<Case>& cases, std::size_t scale) {
+	libcacaoformats::PackedEncoder penc;
+	libcacaoformats::UnpackedEncoder uenc;
+
+	//Containers are shared with the decode functions so that each case only measures decoding
+	{
+		auto faces = GenerateCubemap(scale);
+		auto c = std::make_shared<libcacaoformats::PackedContainer>(penc.EncodeCubemap(faces));
+		cases.push_back({"packed_cubemap", c->payload.size(), [c]() { libcacaoformats::PackedDecoder().DecodeCubemap(*c); }});
+		cases.push_back({"packed_cubemap_parallel", c->payload.size(), [c]() { libcacaoformats::PackedDecoder().DecodeCubemap(*c, 6); }});
+
+		//GPU-compressed faces with a full mip chain (the contents don't matter since nothing decodes them)
+		libcacaoformats::CompressedCubemap compressed {.compression = libcacaoformats::BlockCompression::BC7, .srgb = true, .w = faces[0].w, .h = faces[0].h, .faces = {}};
+		for(std::vector<libcacaoformats::PackedPayload>& face : compressed.faces) {
+			for(std::size_t level = 0; (faces[0].w >> level) > 0; ++level) face.push_back(std::vector<unsigned char>(compressed.LevelSize(level), static_cast<unsigned char>(level)));
+		}
+		auto cc = std::make_shared<libcacaoformats::PackedContainer>(penc.EncodeCubemap(compressed));
+		cases.push_back({"packed_cubemap_compressed", cc->payload.size(), [cc]() { libcacaoformats::PackedDecoder().DecodeCompressedCubemap(*cc); }});
+
+		//Unpacked cubemaps reference one image file per face
+		auto files = std::make_shared<std::unordered_map<std::string, std::string>>();
+		const char* keys[] = {"right", "left", "top", "bottom", "front", "back"};
+		std::string yaml;
+		std::size_t bytes = 0;
+		for(std::size_t f = 0; f < 6; ++f) {
+			std::stringstream ss;
+			libcacaoimage::encode::EncodePNG(faces[f], ss);
+			std::string path = std::string(keys[f]) + ".png";
+			(*files)[path] = ss.str();
+			bytes += (*files)[path].size();
+			yaml += std::string(keys[f]) + ": " + path + "\n";
+		}
+		bytes += yaml.size();
+		cases.push_back({"unpacked_cubemap", bytes, [files, yaml]() {
+							 std::istringstream in(yaml);
+							 libcacaoformats::UnpackedDecoder().DecodeCubemap(in, [&files](const std::string& path) {
+								 return std::make_unique<std::istringstream>(files->at(path));
+							 });
+						 }});
+	}
+	{
+		std::vector<unsigned char> ir(64 * 1024 * scale);
+		for(std::size_t i = 0; i < ir.size(); ++i) ir[i] = static_cast<unsigned char>(i * 13);
+		libcacaoformats::Material mat = GenerateMaterial(scale);
+		libcacaoformats::MaterialLayout layout = libcacaoformats::ComputeMaterialLayout(mat, libcacaoformats::MaterialBlockRules::Std140);
+		auto c = std::make_shared<libcacaoformats::PackedContainer>(penc.EncodeShader(ir, layout));
+		cases.push_back({"packed_shader", c->payload.size(), [c]() { libcacaoformats::PackedDecoder().DecodeShader(*c); }});
+		cases.push_back({"packed_shader_layout", c->payload.size(), [c]() { libcacaoformats::PackedDecoder().DecodeShaderMaterialLayout(*c); }});
+	}
+	{
+		libcacaoformats::Material mat = GenerateMaterial(scale);
+		auto v1 = std::make_shared<libcacaoformats::PackedContainer>(penc.EncodeMaterial(mat));
+		cases.push_back({"packed_material", v1->payload.size(), [v1]() { libcacaoformats::PackedDecoder().DecodeMaterial(*v1); }});
+		auto v2 = std::make_shared<libcacaoformats::PackedContainer>(penc.EncodeMaterial(mat, libcacaoformats::ComputeMaterialLayout(mat, libcacaoformats::MaterialBlockRules::Std140)));
+		cases.push_back({"packed_material_block", v2->payload.size(), [v2]() { libcacaoformats::PackedDecoder().DecodeMaterial(*v2); }});
+
+		std::stringstream ss;
+		uenc.EncodeMaterial(mat, ss);
+		std::string yaml = ss.str();
+		cases.push_back({"unpacked_material", yaml.size(), [yaml]() {
+							 std::istringstream in(yaml);
+							 libcacaoformats::UnpackedDecoder().DecodeMaterial(in);
+						 }});
+	}
+	{
+		libcacaoformats::World world = GenerateWorld(scale);
+		auto flat = std::make_shared<libcacaoformats::PackedContainer>(penc.EncodeWorld(world));
+		cases.push_back({"packed_world", flat->payload.size(), [flat]() { libcacaoformats::PackedDecoder().DecodeWorld(*flat); }});
+		auto cells = std::make_shared<libcacaoformats::PackedContainer>(penc.EncodeWorld(world, 64.0f));
+		auto columns = std::make_shared<libcacaoformats::WorldColumns>();
+		cases.push_back({"packed_world_columns", cells->payload.size(), [cells, columns]() { libcacaoformats::PackedDecoder().DecodeWorldColumns(*cells, *columns); }});
+
+		std::stringstream ss;
+		uenc.EncodeWorld(world, ss);
+		std::string yaml = ss.str();
+		cases.push_back({"unpacked_world", yaml.size(), [yaml]() {
+							 std::istringstream in(yaml);
+							 libcacaoformats::UnpackedDecoder().DecodeWorld(in);
+						 }});
+	}
+	{
+		libcacaoformats::AssetPack pack = GenerateAssetPack(scale);
+		auto c = std::make_shared<libcacaoformats::PackedContainer>(penc.EncodeAssetPack(pack));
+		cases.push_back({"packed_assetpack", c->payload.size(), [c]() { libcacaoformats::PackedDecoder().DecodeAssetPack(*c); }});
+		auto pool = exathread::Pool::Create(4);
+		cases.push_back({"packed_assetpack_parallel", c->payload.size(), [c, pool]() { libcacaoformats::PackedDecoder().DecodeAssetPackParallel(*c, pool); }});
+
+		//Patch replaces the second half of the pack and adds as many new assets
+		libcacaoformats::AssetPack patchAssets = GenerateAssetPack(scale, 16 * scale);
+		auto patch = std::make_shared<libcacaoformats::PackedContainer>(penc.EncodeAssetPackPatch(patchAssets, {"asset0"}));
+		cases.push_back({"packed_assetpack_overlay", c->payload.size() + patch->payload.size(), [c, patch]() { libcacaoformats::PackedDecoder().OverlayAssetPack(*c, *patch); }});
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if(argc > 2) {
+		std::cerr << "Usage: " << argv[0] << " [case name filter]" << std::endl;
+		return 1;
+	}
+	std::string filter = (argc == 2 ? argv[1] : "");
+
+	try {
+		std::printf("%-28s %-7s %12s %12s %14s %14s\n", "case", "size", "input KiB", "MB/s", "allocs/decode", "peak RSS MiB");
+		for(const Scale& scale : scales) {
+			std::vector<Case> cases;
+			AddCases(cases, scale.factor);
+			for(const Case& c : cases) {
+				if(c.name.find(filter) == std::string::npos) continue;
+
+				//Warm up once, then time as many decodes as fit
+				c.decode();
+				std::size_t allocsBefore = allocations.load();
+				std::size_t iterations = 0;
+				auto start = std::chrono::steady_clock::now();
+				double elapsed = 0;
+				do {
+					c.decode();
+					++iterations;
+					elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				} while(elapsed < minSeconds || iterations < minIterations);
+				std::size_t allocs = allocations.load() - allocsBefore;
+
+				std::printf("%-28s %-7s %12.1f %12.1f %14.1f %14zu\n", c.name.c_str(), scale.name, c.bytes / 1024.0,
+					(double(c.bytes) * iterations / 1e6) / elapsed, double(allocs) / iterations, PeakRSS() / (1024 * 1024));
+			}
+		}
+		return 0;
+	} catch(const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
\ No newline at end of file
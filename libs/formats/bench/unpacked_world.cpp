@@ -0,0 +1,79 @@
+#include "libcacaoformats.hpp"
+
+#include "BenchUtil.hpp"
+
+#include "UnpackedSchema.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+//World layout: a large flat level with a couple of small components per actor
+constexpr std::size_t actorCount = 50000;
+
+void Generate(const std::string& path) {
+	libcacaoformats::World world;
+	world.skyboxRef = "sky.ajc";
+	world.initialCamPos = {0.0f, 2.0f, -5.0f};
+	world.initialCamRot = {0.0f, 0.0f, 0.0f};
+	xg::Guid root = xg::newGuid();
+	for(std::size_t i = 0; i < actorCount; ++i) {
+		libcacaoformats::World::Actor a;
+		a.guid = (i == 0 ? root : xg::newGuid());
+		a.parentGUID = (i == 0 ? xg::Guid() : root);
+		a.name = "actor" + std::to_string(i);
+		a.initialPos = {float(i % 100), 0.0f, float(i / 100)};
+		a.initialRot = {0.0f, float(i % 360), 0.0f};
+		a.initialScale = {1.0f, 1.0f, 1.0f};
+		a.components.push_back({.typeID = "MeshRenderer", .reflection = "mesh: meshes/crate.obj\nmaterial: materials/crate.yml"});
+		a.components.push_back({.typeID = "Light", .reflection = "color:\n  r: 1\n  g: 0.9\n  b: 0.8\nintensity: " + std::to_string(i % 10)});
+		world.actors.push_back(std::move(a));
+	}
+	std::ofstream out(path);
+	libcacaoformats::UnpackedEncoder().EncodeWorld(world, out);
+}
+
+int main(int argc, char* argv[]) {
+	if(argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " <generate|dom|events> <world path>" << std::endl;
+		return 1;
+	}
+	std::string mode = argv[1];
+	std::string path = argv[2];
+
+	try {
+		if(mode == "generate") {
+			Generate(path);
+			return 0;
+		}
+
+		std::ifstream in(path);
+		auto start = std::chrono::steady_clock::now();
+
+		//Decode the world
+		libcacaoformats::World world;
+		if(mode == "dom") {
+			//The old path: load the whole document into YAML::Nodes first
+			YAML::Node root = YAML::Load(in);
+			libcacaoformats::DecodeWorldHeaderNode(root, world);
+			for(const YAML::Node& a : root["actors"]) world.actors.push_back(libcacaoformats::DecodeWorldActorNode(a));
+		} else if(mode == "events") {
+			world = libcacaoformats::UnpackedDecoder().DecodeWorld(in);
+		} else {
+			std::cerr << "Unknown mode \"" << mode << "\"" << std::endl;
+			return 1;
+		}
+		auto done = std::chrono::steady_clock::now();
+
+		std::printf("%s: %zu actors, decode %.3f ms, peak RSS %zu MiB\n", mode.c_str(), world.actors.size(),
+			std::chrono::duration<double, std::milli>(done - start).count(), PeakRSS() / (1024 * 1024));
+		return 0;
+	} catch(const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+//Common helpers for the decoder fuzz harnesses
+//Decoders reject bad input by throwing std::runtime_error, so harnesses catch only that, and anything else that escapes is a bug
+
+#include "libcacaoformats.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Make a container of a given format directly from fuzzer input
+ *
+ * This skips the file header and compression, so that mutations reach the decoder being fuzzed instead of being rejected by the container checks.
+ * The first two bytes of the input are the format version (little-endian), and the rest is the payload.
+ *
+ * @return The container, or nothing if the input is too short
+ */
+inline std::optional<libcacaoformats::PackedContainer> MakeFuzzContainer(libcacaoformats::PackedFormat format, const uint8_t* data, std::size_t size) {
+	if(size < 3) return std::nullopt;
+	uint16_t version = uint16_t(data[0] | (data[1] << 8));
+	return std::optional<libcacaoformats::PackedContainer>(std::in_place, format, version, std::vector<unsigned char>(data + 2, data + size));
+}
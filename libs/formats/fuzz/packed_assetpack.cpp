@@ -0,0 +1,17 @@
+#include "FuzzInput.hpp"
+
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+	std::optional<libcacaoformats::PackedContainer> container = MakeFuzzContainer(libcacaoformats::PackedFormat::AssetPack, data, size);
+	if(!container) return 0;
+
+	try {
+		libcacaoformats::PackedDecoder().DecodeAssetPack(*container);
+	} catch(const std::runtime_error&) {}
+	try {
+		libcacaoformats::PackedAssetIndex index = libcacaoformats::PackedAssetIndex::FromContainer(*container);
+		for(const std::string& name : index.List()) index.Fetch(name);
+	} catch(const std::runtime_error&) {}
+	return 0;
+}
@@ -0,0 +1,22 @@
+#include "FuzzInput.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+	std::span<const unsigned char> input(data, size);
+
+	try {
+		libcacaoformats::PackedContainer::FromMemory(input);
+	} catch(const std::runtime_error&) {}
+	try {
+		std::istringstream stream(std::string(reinterpret_cast<const char*>(data), size));
+		libcacaoformats::PackedContainer::FromStream(stream);
+	} catch(const std::runtime_error&) {}
+	try {
+		std::istringstream stream(std::string(reinterpret_cast<const char*>(data), size));
+		libcacaoformats::PackedContainer::StreamPayload(stream, [](const libcacaoformats::PackedContainer::Header&, std::span<const unsigned char>) {});
+	} catch(const std::runtime_error&) {}
+	return 0;
+}
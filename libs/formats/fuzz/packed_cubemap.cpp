@@ -0,0 +1,21 @@
+#include "FuzzInput.hpp"
+
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+	std::optional<libcacaoformats::PackedContainer> container = MakeFuzzContainer(libcacaoformats::PackedFormat::Cubemap, data, size);
+	if(!container) return 0;
+
+	try {
+		libcacaoformats::PackedDecoder().DecodeCubemap(*container);
+	} catch(const std::runtime_error&) {}
+	try {
+		//Touch both ends of every level so that slices past the payload show up under ASan
+		libcacaoformats::CompressedCubemap cubemap = libcacaoformats::PackedDecoder().DecodeCompressedCubemap(*container);
+		volatile unsigned char sink = 0;
+		for(const std::vector<libcacaoformats::PackedPayload>& face : cubemap.faces) {
+			for(const libcacaoformats::PackedPayload& level : face) sink = sink ^ level[0] ^ level[level.size() - 1];
+		}
+	} catch(const std::runtime_error&) {}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "FuzzInput.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+	std::optional<libcacaoformats::PackedContainer> container = MakeFuzzContainer(libcacaoformats::PackedFormat::Material, data, size);
+	if(!container) return 0;
+
+	try {
+		libcacaoformats::PackedDecoder().DecodeMaterial(*container);
+	} catch(const std::runtime_error&) {}
+	try {
+		libcacaoformats::PackedMaterialBlock block = libcacaoformats::PackedMaterialBlock::FromContainer(*container);
+		block.GetShader();
+		for(std::size_t i = 0; i < block.GetTextureCount(); ++i) block.GetTexture(i);
+	} catch(const std::runtime_error&) {}
+	return 0;
+}
@@ -0,0 +1,14 @@
+#include "FuzzInput.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+	std::optional<libcacaoformats::PackedContainer> container = MakeFuzzContainer(libcacaoformats::PackedFormat::Shader, data, size);
+	if(!container) return 0;
+
+	try {
+		libcacaoformats::PackedDecoder().DecodeShader(*container);
+	} catch(const std::runtime_error&) {}
+	try {
+		libcacaoformats::PackedDecoder().DecodeShaderMaterialLayout(*container);
+	} catch(const std::runtime_error&) {}
+	return 0;
+}
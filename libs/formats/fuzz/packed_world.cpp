@@ -0,0 +1,20 @@
+#include "FuzzInput.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+	std::optional<libcacaoformats::PackedContainer> container = MakeFuzzContainer(libcacaoformats::PackedFormat::World, data, size);
+	if(!container) return 0;
+
+	try {
+		libcacaoformats::PackedDecoder().DecodeWorld(*container);
+	} catch(const std::runtime_error&) {}
+	try {
+		libcacaoformats::WorldColumns columns;
+		libcacaoformats::PackedDecoder().DecodeWorldColumns(*container, columns);
+	} catch(const std::runtime_error&) {}
+	try {
+		libcacaoformats::PackedWorldCells cells = libcacaoformats::PackedWorldCells::FromContainer(*container);
+		libcacaoformats::WorldColumns columns;
+		for(std::size_t i = 0; i < cells.GetCells().size(); ++i) cells.DecodeCell(i, columns);
+	} catch(const std::runtime_error&) {}
+	return 0;
+}
@@ -0,0 +1,31 @@
+#include "FuzzInput.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+//Visit every value, since Open only checks the structure
+static void Walk(const libcacaoformats::ReflectionView& view) {
+	switch(view.GetType()) {
+		case libcacaoformats::ReflectionView::Type::Bool: view.AsBool(); break;
+		case libcacaoformats::ReflectionView::Type::Int: view.AsInt(); break;
+		case libcacaoformats::ReflectionView::Type::Float: view.AsFloat(); break;
+		case libcacaoformats::ReflectionView::Type::String: view.AsString(); break;
+		case libcacaoformats::ReflectionView::Type::Sequence:
+			for(libcacaoformats::ReflectionView element : view) Walk(element);
+			break;
+		case libcacaoformats::ReflectionView::Type::Map:
+			for(libcacaoformats::ReflectionView::Iterator it = view.begin(); it != view.end(); ++it) {
+				view.Find(it.Key());
+				Walk(*it);
+			}
+			break;
+		default: break;
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+	try {
+		Walk(libcacaoformats::ReflectionView::Open(std::string_view(reinterpret_cast<const char*>(data), size)));
+	} catch(const std::runtime_error&) {}
+	return 0;
+}
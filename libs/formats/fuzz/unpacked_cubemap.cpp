@@ -0,0 +1,18 @@
+#include "FuzzInput.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+	std::istringstream stream(std::string(reinterpret_cast<const char*>(data), size));
+
+	//Face images aren't the target here, so every face "file" just contains its path
+	try {
+		libcacaoformats::UnpackedDecoder().DecodeCubemap(stream, [](const std::string& path) {
+			return std::make_unique<std::istringstream>(path);
+		});
+	} catch(const std::runtime_error&) {}
+	return 0;
+}
@@ -0,0 +1,14 @@
+#include "FuzzInput.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+	std::istringstream stream(std::string(reinterpret_cast<const char*>(data), size));
+
+	try {
+		libcacaoformats::UnpackedDecoder().DecodeWorld(stream);
+	} catch(const std::runtime_error&) {}
+	return 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -7,14 +8,24 @@
 #include <array>
 #include <variant>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <istream>
 #include <ostream>
 #include <cstring>
 #include <memory>
+#include <span>
+#include <string_view>
+#include <filesystem>
+#include <optional>
+#include <utility>
 
 #include "crossguid/guid.hpp"
 
 #include "libcacaoimage.hpp"
+#include "libcacaoaudiodecode.hpp"
+
+#include "exathread.hpp"
 
 namespace libcacaoformats {
 	///@brief Two-component vector
@@ -53,6 +64,102 @@ namespace libcacaoformats {
 		World
 	};
 
+	///@brief Compression codecs for packed data
+	enum class PackedCodec : uint8_t {
+		Stored = 0,///<No compression
+		Bzip2 = 1, ///<bzip2, used by all containers written before codecs were selectable
+		Zstd = 2,  ///<Zstandard
+		LZ4 = 3	   ///<LZ4 (high-compression encoder, regular decoder)
+	};
+
+	/**
+	 * @brief Read-only, reference-counted byte buffer holding a packed container payload or asset data
+	 *
+	 * The data is either owned by the payload or borrowed from somewhere else (such as a memory-mapped file).
+	 * Copying or slicing a payload never copies the data; all copies and slices share it.
+	 */
+	class PackedPayload {
+	  public:
+		///@brief Create an empty payload
+		PackedPayload()
+		  : ptr(nullptr), len(0) {}
+
+		/**
+		 * @brief Create a payload that owns its data
+		 *
+		 * @param data The data to take ownership of
+		 */
+		PackedPayload(std::vector<unsigned char> data);
+
+		/**
+		 * @brief Create a payload that borrows its data
+		 *
+		 * @param data The data to borrow
+		 * @param owner An optional object to keep alive for as long as the data is borrowed. If this is empty, the caller must keep the data alive themselves.
+		 */
+		PackedPayload(std::span<const unsigned char> data, std::shared_ptr<const void> owner)
+		  : owner(std::move(owner)), ptr(data.data()), len(data.size()), borrowed(true) {}
+
+		///@brief Get a pointer to the data
+		const unsigned char* data() const {
+			return ptr;
+		}
+
+		///@brief Get the size of the data in bytes
+		std::size_t size() const {
+			return len;
+		}
+
+		///@brief Check if there is no data
+		bool empty() const {
+			return len == 0;
+		}
+
+		///@brief Get a view of the data
+		std::span<const unsigned char> span() const {
+			return std::span<const unsigned char>(ptr, len);
+		}
+
+		const unsigned char* begin() const {
+			return ptr;
+		}
+		const unsigned char* end() const {
+			return ptr + len;
+		}
+		const unsigned char* cbegin() const {
+			return ptr;
+		}
+		const unsigned char* cend() const {
+			return ptr + len;
+		}
+		const unsigned char& operator[](std::size_t idx) const {
+			return ptr[idx];
+		}
+
+		///@brief Check if the data is borrowed rather than owned by this payload
+		bool IsBorrowed() const {
+			return borrowed;
+		}
+
+		/**
+		 * @brief Get a part of the data that shares ownership with this payload
+		 *
+		 * @param offset The offset of the part in bytes
+		 * @param length The size of the part in bytes
+		 *
+		 * @return A payload borrowing the part, which keeps the whole data alive
+		 *
+		 * @throws std::runtime_error If the part is out of range
+		 */
+		PackedPayload Slice(std::size_t offset, std::size_t length) const;
+
+	  private:
+		std::shared_ptr<const void> owner;
+		const unsigned char* ptr;
+		std::size_t len;
+		bool borrowed = false;
+	};
+
 	///@brief Encapsulation of data associated with an asset in an asset pack
 	struct PackedAsset {
 		///@brief Type of asset
@@ -66,8 +173,58 @@ namespace libcacaoformats {
 			Model,
 			Resource///<Type used for arbitrary resource files that aren't Cacao Engine formats
 		};
-		Kind kind;						  ///<Type of asset contained
-		std::vector<unsigned char> buffer;///<Asset file contents buffer
+		Kind kind;			 ///<Type of asset contained
+		PackedPayload buffer;///<Asset file contents buffer, usually shared with the rest of the pack it came from
+	};
+
+	///@brief GPU block compression formats that cubemap faces can be stored in
+	enum class BlockCompression : uint8_t {
+		BC7 = 1,	 ///<BC7 (BPTC), for desktop GPUs
+		ASTC4x4 = 2, ///<ASTC LDR with 4x4 blocks, for mobile and Apple GPUs
+		ETC2RGBA8 = 3///<ETC2 RGBA8 (RGB with EAC alpha), for OpenGL ES and older mobile GPUs
+	};
+
+	/**
+	 * @brief Cubemap whose faces are stored pre-compressed for the GPU, along with their mip chains
+	 *
+	 * Every supported format uses 4x4 texel blocks of 16 bytes, so each level's data is exactly LevelSize bytes and can be uploaded as-is.
+	 */
+	struct CompressedCubemap {
+		BlockCompression compression;///<Block compression format of every level
+		bool srgb;					 ///<Whether the color data is sRGB-encoded (true) or linear (false)
+		unsigned int w;				 ///<Width of the first mip level of each face in texels
+		unsigned int h;				 ///<Height of the first mip level of each face in texels
+
+		///@brief Largest supported face width or height, which is the cubemap size limit of common GPUs and keeps level sizes well within range
+		static constexpr unsigned int maxSize = 16384;
+
+		/**
+		 * @brief Compressed data of each mip level of each face, starting from the full-size level
+		 *
+		 * Faces are in the order of +X face, -X face, +Y face, -Y face, +Z face, -Z face. Every face must have the same number of levels.
+		 * Block rows start from the top of the face, like image cubemap faces, which is how both Vulkan and OpenGL lay out cube map faces.
+		 * When decoded, the levels borrow from the container payload rather than being copied out of it.
+		 */
+		std::array<std::vector<PackedPayload>, 6> faces;
+
+		///@brief Get the number of mip levels of each face
+		std::size_t MipLevels() const {
+			return faces[0].size();
+		}
+
+		/**
+		 * @brief Get the size of a mip level's compressed data
+		 *
+		 * @param level The mip level, where 0 is the full-size level
+		 *
+		 * @return The size in bytes, or the largest uint64_t if it can't be represented (only faces no larger than maxSize are supported anyway)
+		 */
+		uint64_t LevelSize(std::size_t level) const {
+			const uint64_t lw = level < 32 ? std::max<uint64_t>(uint64_t(w) >> level, 1) : 1;
+			const uint64_t lh = level < 32 ? std::max<uint64_t>(uint64_t(h) >> level, 1) : 1;
+			const uint64_t blocks = ((lw + 3) / 4) * ((lh + 3) / 4);
+			return blocks > std::numeric_limits<uint64_t>::max() / 16 ? std::numeric_limits<uint64_t>::max() : blocks * 16;
+		}
 	};
 
 	/**
@@ -77,13 +234,30 @@ namespace libcacaoformats {
 	 */
 	class PackedContainer {
 	  public:
-		const PackedFormat format;				 ///<Type of contents
-		const uint16_t version;					 ///<File type version
-		const std::vector<unsigned char> payload;///<Decompressed payload data
+		const PackedFormat format;	///<Type of contents
+		const uint16_t version;		///<File type version
+		const PackedPayload payload;///<Decompressed payload data
+		const PackedCodec codec;	///<Codec used to compress the payload in the file (when loaded) or on export
+
+		///@brief Size of the chunks compressed payloads are read from streams in
+		static constexpr std::size_t streamChunkSize = 64 * 1024;
+
+		///@brief Size of the independently compressed blocks payloads are split into on export
+		static constexpr std::size_t compressionBlockSize = 4 * 1024 * 1024;
+
+		///@brief Information from the header of a packed file
+		struct Header {
+			PackedFormat format;  ///<Type of contents
+			uint16_t version;	  ///<File type version
+			PackedCodec codec;	  ///<Codec the payload is compressed with
+			uint64_t payloadSize;///<Size of the decompressed payload
+		};
 
 		/**
 		 * @brief Create a PackedContainer from a stream
 		 *
+		 * The payload is decompressed while it is being read, so only streamChunkSize bytes of compressed data are held in memory at a time.
+		 *
 		 * @param stream A stream referencing the contents of a packed file format
 		 *
 		 * @return PackedContainer object
@@ -92,9 +266,54 @@ namespace libcacaoformats {
 		 */
 		static PackedContainer FromStream(std::istream& stream);
 
+		/**
+		 * @brief Decompress the payload of a packed file from a stream in chunks, without ever holding the whole payload
+		 *
+		 * Each chunk is handed to the callback as soon as it has been decompressed. Chunks are at most streamChunkSize bytes and are only valid for the duration of the call.
+		 *
+		 * @param stream A stream referencing the contents of a packed file format
+		 * @param chunkCallback Function to call with the file header and each successive chunk of the payload
+		 *
+		 * @return The file header
+		 *
+		 * @throws std::runtime_error If the stream is not valid, does not represent a valid packed file, or ends early
+		 */
+		static Header StreamPayload(std::istream& stream, const std::function<void(const Header&, std::span<const unsigned char>)>& chunkCallback);
+
+		/**
+		 * @brief Create a PackedContainer from a file by memory-mapping it
+		 *
+		 * If the payload is stored uncompressed, it is borrowed from the mapping instead of being copied. The mapping stays alive as long as the payload does.
+		 *
+		 * @param path The path of a packed file
+		 * @param threads The maximum number of threads to decompress blocks of the payload on (0 uses one per hardware thread)
+		 *
+		 * @return PackedContainer object
+		 *
+		 * @throws std::runtime_error If the file cannot be mapped or does not represent a valid packed file
+		 */
+		static PackedContainer FromFile(const std::filesystem::path& path, unsigned int threads = 1);
+
+		/**
+		 * @brief Create a PackedContainer from a buffer in memory
+		 *
+		 * If the payload is stored uncompressed, it is borrowed from the buffer instead of being copied.
+		 *
+		 * @param data The contents of a packed file
+		 * @param owner An optional object to keep alive for as long as the payload borrows from the buffer. If this is empty, the caller must keep the buffer alive for as long as the container (or any copy of its payload) exists.
+		 * @param threads The maximum number of threads to decompress blocks of the payload on (0 uses one per hardware thread)
+		 *
+		 * @return PackedContainer object
+		 *
+		 * @throws std::runtime_error If the buffer does not represent a valid packed file
+		 */
+		static PackedContainer FromMemory(std::span<const unsigned char> data, std::shared_ptr<const void> owner = {}, unsigned int threads = 1);
+
 		/**
 		 * @brief Create a PackedContainer from a PackedAsset
 		 *
+		 * If the payload is stored uncompressed, it is borrowed from the asset buffer instead of being copied.
+		 *
 		 * @param asset A packed asset from an asset pack
 		 *
 		 * @return PackedContainer object
@@ -110,6 +329,7 @@ namespace libcacaoformats {
 		 * @param ver The version of the format
 		 * @param data The uncompressed data to be stored
 		 *
+		 * @note The container will use the default codec for its format. Use WithCodec to pick a different one.
 		 *
 		 * @throws std::runtime_error If there is no data
 		 */
@@ -122,34 +342,76 @@ namespace libcacaoformats {
 		 * @param ver The version of the format
 		 * @param data The uncompressed data to be stored, autoconverted to unsigned char
 		 *
+		 * @note The container will use the default codec for its format. Use WithCodec to pick a different one.
 		 *
 		 * @throws std::runtime_error If there is no data
 		 */
 		PackedContainer(PackedFormat format, uint16_t ver, std::vector<char>&& data);
 
+		/**
+		 * @brief Create a PackedContainer by manually specifying attributes, using an existing payload
+		 *
+		 * @param format The format code of the container
+		 * @param ver The version of the format
+		 * @param data The uncompressed payload
+		 *
+		 * @note The container will use the default codec for its format. Use WithCodec to pick a different one.
+		 *
+		 * @throws std::runtime_error If there is no data
+		 */
+		PackedContainer(PackedFormat format, uint16_t ver, PackedPayload&& data);
+
+		/**
+		 * @brief Get the codec a format is compressed with by default
+		 *
+		 * Formats whose payload is already compressed (such as cubemaps, which store WebP faces) are stored as-is, small formats that are loaded often use LZ4, and large formats use Zstandard.
+		 *
+		 * @param format The format to check
+		 *
+		 * @return The default codec
+		 */
+		static PackedCodec DefaultCodec(PackedFormat format);
+
+		/**
+		 * @brief Create a copy of this container that will be exported with a different codec
+		 *
+		 * @param newCodec The codec to use
+		 *
+		 * @return PackedContainer object sharing this container's payload
+		 */
+		PackedContainer WithCodec(PackedCodec newCodec) const;
+
 		/**
 		 * @brief Create an empty PackedContainer, only useful for default constructing if needed
 		 *
 		 * @warning This will produce a PackedContainer with no data, the version set to 0 and the type set to Shader. DO NOT USE THIS CONTAINER!
 		 */
 		PackedContainer()
-		  : format(PackedFormat::Shader), version(0), payload() {}
+		  : format(PackedFormat::Shader), version(0), payload(), codec(PackedCodec::Stored) {}
 
 		PackedContainer(const PackedContainer& o)
-		  : format(o.format), version(o.version), payload(o.payload) {}
+		  : format(o.format), version(o.version), payload(o.payload), codec(o.codec) {}
 		PackedContainer(PackedContainer&& o)
-		  : format(o.format), version(o.version), payload(o.payload) {}
+		  : format(o.format), version(o.version), payload(o.payload), codec(o.codec) {}
 		PackedContainer& operator=(const PackedContainer&) = delete;
 		PackedContainer& operator=(PackedContainer&&) = delete;
 
 		/**
 		 * @brief Export a PackedContainer to a buffer
 		 *
+		 * The payload is split into blocks of compressionBlockSize bytes which are compressed independently, so that both compression and decompression can be spread across threads. The output does not depend on the number of threads.
+		 *
 		 * @param stream A stream to output data to
+		 * @param threads The maximum number of threads to compress blocks of the payload on (0 uses one per hardware thread)
+		 *
+		 * @note The payload is compressed with the codec stored in the container. Use WithCodec to pick a different one.
 		 *
 		 * @throws std::runtime_error If the container has no data or data compression fails
 		 */
-		void ExportToStream(std::ostream& stream);
+		void ExportToStream(std::ostream& stream, unsigned int threads = 1);
+
+	  private:
+		PackedContainer(PackedFormat format, uint16_t ver, PackedPayload&& data, PackedCodec codec);
 	};
 
 	///@brief Reference path for shader and associated data
@@ -174,6 +436,115 @@ namespace libcacaoformats {
 		std::unordered_map<std::string, ValueContainer> keys;///<Data associated with shader
 	};
 
+	///@brief Memory layout rules for material parameter blocks
+	enum class MaterialBlockRules : uint8_t {
+		Std140 = 0,///<Uniform buffer layout rules
+		Std430 = 1 ///<Storage buffer layout rules
+	};
+
+	/**
+	 * @brief Layout of the material parameters of a shader
+	 *
+	 * Non-texture parameters live in a single block laid out for upload to the GPU, and texture parameters are bound to individual slots.
+	 * Matrices are stored column-major.
+	 */
+	struct MaterialLayout {
+		MaterialBlockRules rules;///<Rules that the block layout follows
+		uint32_t blockSize;		 ///<Size of the parameter block in bytes
+
+		///@brief A parameter stored in the block
+		struct Member {
+			std::string name;///<Parameter name
+			uint8_t type;	 ///<Index of the parameter type in Material::ValueContainer
+			uint32_t offset; ///<Offset of the parameter from the start of the block
+		};
+		std::vector<Member> members;///<Parameters stored in the block
+
+		///@brief A texture parameter
+		struct Texture {
+			std::string name;///<Parameter name
+			uint32_t slot;	 ///<Texture slot (binding index)
+			bool isCubemap;	 ///<Is this a cubemap (true) or a 2D texture (false)?
+		};
+		std::vector<Texture> textures;///<Texture parameters
+	};
+
+	/**
+	 * @brief Compute a material parameter layout from the keys of a material, for when no shader layout is available
+	 *
+	 * Parameters are placed in the block in order of name, following the provided rules. Textures are given consecutive slots in order of name, starting at 0.
+	 *
+	 * @param mat The material
+	 * @param rules The block layout rules
+	 *
+	 * @return The layout
+	 */
+	MaterialLayout ComputeMaterialLayout(const Material& mat, MaterialBlockRules rules);
+
+	/**
+	 * @brief View of the precompiled parameter block of a packed material
+	 *
+	 * Materials encoded with a layout (version 2) hold their parameters as a block that can be uploaded to the GPU as-is, along with a table of the textures to bind.
+	 * Opening the view does not copy the block or allocate per parameter.
+	 */
+	class PackedMaterialBlock {
+	  public:
+		///@brief A texture to bind
+		struct TextureSlot {
+			uint32_t slot;		  ///<Texture slot (binding index)
+			bool isCubemap;		  ///<Is this a cubemap (true) or a 2D texture (false)?
+			std::string_view path;///<Asset path
+		};
+
+		/**
+		 * @brief Open the parameter block of a packed material
+		 *
+		 * @param container The PackedContainer with the material information, which the view will keep a reference to the payload of
+		 *
+		 * @return The parameter block view
+		 *
+		 * @throws std::runtime_error If the container does not hold a valid material or the material was encoded without a layout
+		 */
+		static PackedMaterialBlock FromContainer(const PackedContainer& container);
+
+		///@brief Get the shader reference path
+		std::string_view GetShader() const;
+
+		///@brief Get the rules the block is laid out with
+		MaterialBlockRules GetRules() const {
+			return rules;
+		}
+
+		///@brief Get the block data, ready for upload
+		std::span<const unsigned char> GetData() const {
+			return payload.span().subspan(blockOffset, blockSize);
+		}
+
+		///@brief Get the number of textures to bind
+		std::size_t GetTextureCount() const {
+			return textureCount;
+		}
+
+		/**
+		 * @brief Get a texture to bind
+		 *
+		 * @param idx The index of the texture, which is in order of slot
+		 *
+		 * @throws std::runtime_error If the index is out of range
+		 */
+		TextureSlot GetTexture(std::size_t idx) const;
+
+	  private:
+		PackedPayload payload;
+		MaterialBlockRules rules;
+		std::size_t blockOffset;
+		std::size_t blockSize;
+		std::size_t textureTableOffset;
+		std::size_t textureCount;
+
+		PackedMaterialBlock() {}
+	};
+
 	///@brief World data, encapsulating list of assets and components used as well as initial world state
 	struct World {
 		std::string skyboxRef;	  ///<Skybox reference path
@@ -183,7 +554,7 @@ namespace libcacaoformats {
 		///@brief Type for components on actors
 		struct Component {
 			std::string typeID;	   ///<ID of component type to instantiate
-			std::string reflection;///<YAML-encoded component reflection data (for use with Silica)
+			std::string reflection;///<Component reflection data (for use with Silica), either YAML-encoded or binary (see ReflectionView)
 		};
 
 		///@brief Type for actors in the world
@@ -199,22 +570,514 @@ namespace libcacaoformats {
 		std::vector<Actor> actors;///<Entities in the world
 	};
 
+	/**
+	 * @brief Column-oriented form of a world, for bulk decoding
+	 *
+	 * Every actor is an index into the per-actor columns, and strings (names and component type IDs) are stored once in a shared table.
+	 * Reusing the same object across decodes reuses the column storage instead of reallocating it.
+	 */
+	struct WorldColumns {
+		std::string skyboxRef;	  ///<Skybox reference path
+		Vec3<float> initialCamPos;///<Initial camera position
+		Vec3<float> initialCamRot;///<Initial camera rotation
+
+		std::vector<std::array<uint8_t, 16>> guids;		 ///<Actor GUID bytes
+		std::vector<std::array<uint8_t, 16>> parentGUIDs;///<Parent actor GUID bytes, or all zeroes for top-level actors
+		std::vector<uint32_t> names;					 ///<String table index of each actor's name
+		std::vector<Vec3<float>> positions;				 ///<Initial actor positions
+		std::vector<Vec3<float>> rotations;				 ///<Initial actor rotations
+		std::vector<Vec3<float>> scales;				 ///<Initial actor scales
+		std::vector<uint32_t> componentStarts;			 ///<Index of the first component of each actor, followed by the total component count
+		std::vector<uint32_t> componentTypes;			 ///<String table index of each component's type ID
+		std::vector<uint64_t> reflectionStarts;			 ///<Offset of each component's reflection data, followed by the total reflection data size
+		std::vector<char> reflectionData;				 ///<Reflection data of every component, back to back
+		std::vector<uint32_t> stringStarts;				 ///<Offset of each string in the string table, followed by the total string data size
+		std::vector<char> stringData;					 ///<String table data
+
+		///@brief Get the number of actors
+		std::size_t ActorCount() const {
+			return guids.size();
+		}
+
+		///@brief Get a string from the string table
+		std::string_view String(uint32_t idx) const {
+			return std::string_view(stringData.data() + stringStarts[idx], stringStarts[idx + 1] - stringStarts[idx]);
+		}
+
+		///@brief Get the reflection data of a component
+		std::string_view Reflection(uint32_t component) const {
+			return std::string_view(reflectionData.data() + reflectionStarts[component], reflectionStarts[component + 1] - reflectionStarts[component]);
+		}
+	};
+
+	/**
+	 * @brief Read-only view of a value in binary component reflection data
+	 *
+	 * Binary reflection data is a compact tree of values converted from YAML reflection data by PackedEncoder::EncodeReflection, so that components can read it without building a YAML document.
+	 * Views point directly into the encoded bytes, so reading values does not allocate.
+	 *
+	 * The encoding is a zero byte (which YAML text can never start with) followed by a single value. Each value is a type byte (the Type enum) and then:
+	 * - Null: nothing
+	 * - Bool: uint8
+	 * - Int: int64
+	 * - Float: double
+	 * - String: uint32 length, bytes
+	 * - Sequence: uint32 element count, uint32 content size, elements
+	 * - Map: uint32 entry count, uint32 content size, then per entry: uint32 key length, key bytes, value
+	 *
+	 * @warning The view does not own the data it points to, so the data must outlive it
+	 */
+	class ReflectionView {
+	  public:
+		///@brief Value types
+		enum class Type : uint8_t {
+			Null = 0,
+			Bool = 1,
+			Int = 2,
+			Float = 3,
+			String = 4,
+			Sequence = 5,
+			Map = 6
+		};
+
+		/**
+		 * @brief Open binary reflection data, checking the entire tree once
+		 *
+		 * @param data The reflection data
+		 *
+		 * @return A view of the top-level value
+		 *
+		 * @throws std::runtime_error If the data is not binary reflection data or is malformed
+		 */
+		static ReflectionView Open(std::string_view data);
+
+		/**
+		 * @brief Check if reflection data is in binary form
+		 *
+		 * @param data The reflection data
+		 *
+		 * @return Whether the data is binary, as opposed to YAML text
+		 */
+		static bool IsBinary(std::string_view data) {
+			return !data.empty() && data[0] == '\0';
+		}
+
+		///@brief Get the type of the value
+		Type GetType() const {
+			return Type(data[0]);
+		}
+
+		/**
+		 * @brief Get the value of a boolean
+		 *
+		 * @throws std::runtime_error If the value is not a boolean
+		 */
+		bool AsBool() const;
+
+		/**
+		 * @brief Get the value of an integer
+		 *
+		 * @throws std::runtime_error If the value is not an integer
+		 */
+		int64_t AsInt() const;
+
+		/**
+		 * @brief Get the value of a floating-point number (integers are converted)
+		 *
+		 * @throws std::runtime_error If the value is not a number
+		 */
+		double AsFloat() const;
+
+		/**
+		 * @brief Get the value of a string
+		 *
+		 * @throws std::runtime_error If the value is not a string
+		 */
+		std::string_view AsString() const;
+
+		/**
+		 * @brief Get the number of elements of a sequence or entries of a map
+		 *
+		 * @return The number of elements or entries, or 0 for other types
+		 */
+		std::size_t Size() const;
+
+		/**
+		 * @brief Get an element of a sequence or the value of an entry of a map
+		 *
+		 * @details Entries are found by skipping over the ones before them, so use begin() and end() to visit every entry instead of calling this in a loop
+		 *
+		 * @param idx The index of the element or entry
+		 *
+		 * @throws std::runtime_error If the value is not a sequence or map or the index is out of range
+		 */
+		ReflectionView operator[](std::size_t idx) const;
+
+		/**
+		 * @brief Get the key of an entry of a map
+		 *
+		 * @details Entries are found by skipping over the ones before them, so use begin() and end() to visit every entry instead of calling this in a loop
+		 *
+		 * @param idx The index of the entry
+		 *
+		 * @throws std::runtime_error If the value is not a map or the index is out of range
+		 */
+		std::string_view Key(std::size_t idx) const;
+
+		class Iterator;
+
+		///@brief Get an iterator to the first element of a sequence or entry of a map, which equals end() for other types
+		Iterator begin() const;
+
+		///@brief Get an iterator past the last element of a sequence or entry of a map
+		Iterator end() const;
+
+		/**
+		 * @brief Find the value of an entry of a map by its key
+		 *
+		 * @param key The key of the entry
+		 *
+		 * @return The value, or nothing if there is no such entry or the value is not a map
+		 */
+		std::optional<ReflectionView> Find(std::string_view key) const;
+
+	  private:
+		std::string_view data;
+
+		ReflectionView(std::string_view data)
+		  : data(data) {}
+	};
+
+	/**
+	 * @brief Iterator over the elements of a sequence or entries of a map in binary reflection data, which walks the entries once
+	 *
+	 * Dereferencing gives the element or the entry's value, and Key gives the entry's key.
+	 */
+	class ReflectionView::Iterator {
+	  public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = ReflectionView;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = ReflectionView;
+
+		Iterator() = default;
+
+		///@brief Get the current element or entry value
+		ReflectionView operator*() const;
+
+		///@brief Get the key of the current map entry, which is empty for sequences
+		std::string_view Key() const;
+
+		Iterator& operator++();
+		Iterator operator++(int) {
+			Iterator old = *this;
+			++*this;
+			return old;
+		}
+
+		bool operator==(const Iterator& other) const {
+			return offset == other.offset && data.data() == other.data.data();
+		}
+
+	  private:
+		friend class ReflectionView;
+
+		std::string_view data;	  ///<Encoded sequence or map being walked
+		bool isMap = false;		  ///<Whether entries have keys
+		std::size_t offset = 0;	  ///<Start of the current entry, including its key
+
+		Iterator(std::string_view data, bool isMap, std::size_t offset)
+		  : data(data), isMap(isMap), offset(offset) {}
+	};
+
+	/**
+	 * @brief Convert a world to column-oriented form, deduplicating strings
+	 *
+	 * @param world The world to convert
+	 * @param out The object to fill, whose existing storage is reused
+	 *
+	 * @throws std::runtime_error If the world is too large to store in column-oriented form
+	 */
+	void WorldToColumns(const World& world, WorldColumns& out);
+
+	/**
+	 * @brief Convert column-oriented world data back into a world
+	 *
+	 * @param columns The columns to convert, which must be consistent with each other
+	 *
+	 * @return The world
+	 */
+	World ColumnsToWorld(const WorldColumns& columns);
+
 	///@brief Decoded asset pack
 	using AssetPack = std::unordered_map<std::string, PackedAsset>;
 
+	///@brief An asset from an asset pack that has been decoded into its in-memory form
+	struct DecodedAsset {
+		PackedAsset::Kind kind;///<Type of asset contained
+
+		/**
+		 * @brief Decoded asset contents
+		 *
+		 * Shaders hold their Slang IR, 2D textures an image, cubemaps their faces (in the same order as PackedDecoder::DecodeCubemap) or their GPU-compressed levels,
+		 * materials a Material object, and sounds their decoded PCM samples.
+		 * Kinds that this library has no decoder for (fonts, models, and resources) hold the asset file contents as-is.
+		 */
+		std::variant<PackedPayload, std::vector<unsigned char>, libcacaoimage::Image, std::array<libcacaoimage::Image, 6>, Material, CompressedCubemap, libcacaoaudiodecode::Result> data;
+	};
+
+	///@brief Asset pack with every asset decoded
+	using DecodedAssetPack = std::unordered_map<std::string, DecodedAsset>;
+
+	/**
+	 * @brief Random-access view of an indexed (version 2 or later) asset pack
+	 *
+	 * Only the table of contents is read when the index is opened. Asset data is read and decompressed on demand.
+	 * Lookups are binary searches over the sorted name hashes in the table of contents, so no per-asset structures are built when opening a pack.
+	 *
+	 * @note Fetching assets is safe to do from multiple threads at once.
+	 */
+	class PackedAssetIndex {
+	  public:
+		///@brief Table of contents record for a single asset
+		struct Entry {
+			PackedAsset::Kind kind;	 ///<Type of asset
+			PackedCodec compression; ///<Compression applied to the stored bytes
+			uint64_t offset;		 ///<Offset of the stored bytes from the start of the pack payload
+			uint64_t compressedSize; ///<Size of the stored bytes
+			uint64_t size;			 ///<Size of the asset once decompressed
+			uint32_t checksum;		 ///<CRC-32 of the decompressed asset
+			bool tombstone = false;	 ///<Whether this entry records the deletion of the asset from the pack being patched, in which case it has no data
+		};
+
+		/**
+		 * @brief Open an asset pack from a stream and read its table of contents
+		 *
+		 * @param stream A seekable stream referencing the contents of an asset pack file, which the index will take ownership of
+		 *
+		 * @return PackedAssetIndex object
+		 *
+		 * @throws std::runtime_error If the stream is not valid or does not represent an indexed asset pack
+		 */
+		static PackedAssetIndex FromStream(std::unique_ptr<std::istream>&& stream);
+
+		/**
+		 * @brief Open an asset pack file by memory-mapping it and read its table of contents
+		 *
+		 * Fetching assets from a mapped pack reads directly from the mapping and never blocks other fetches.
+		 *
+		 * @param path The path of an asset pack file
+		 *
+		 * @return PackedAssetIndex object
+		 *
+		 * @throws std::runtime_error If the file cannot be mapped or does not represent an indexed asset pack
+		 */
+		static PackedAssetIndex FromFile(const std::filesystem::path& path);
+
+		/**
+		 * @brief Index an asset pack that has already been loaded
+		 *
+		 * The index shares the payload of the container, so no asset data is copied.
+		 *
+		 * @param container The PackedContainer with the asset pack information
+		 *
+		 * @return PackedAssetIndex object
+		 *
+		 * @throws std::runtime_error If the container does not hold an indexed asset pack
+		 */
+		static PackedAssetIndex FromContainer(const PackedContainer& container);
+
+		/**
+		 * @brief Layer a patch pack on top of this pack
+		 *
+		 * Lookups check the patch first and fall back to this pack, with tombstones in the patch hiding assets from this pack.
+		 * Nothing is merged up front; both packs stay as they are and are resolved per lookup.
+		 *
+		 * @param patch The index of the patch pack
+		 *
+		 * @return An index of the patched pack
+		 */
+		PackedAssetIndex WithPatch(const PackedAssetIndex& patch) const;
+
+		/**
+		 * @brief Check if the pack contains an asset
+		 *
+		 * @param name The asset address or resource path
+		 *
+		 * @return Whether an asset with that name exists in the pack
+		 */
+		bool Contains(const std::string& name) const;
+
+		/**
+		 * @brief Get the table of contents record of an asset
+		 *
+		 * @param name The asset address or resource path
+		 *
+		 * @return The table of contents record
+		 *
+		 * @throws std::runtime_error If the pack does not contain the asset
+		 */
+		Entry GetEntry(const std::string& name) const;
+
+		/**
+		 * @brief Get the names of all assets in the pack
+		 *
+		 * @return A list of asset addresses and resource paths
+		 */
+		std::vector<std::string> List() const;
+
+		/**
+		 * @brief Get the number of assets in the pack
+		 */
+		std::size_t Size() const;
+
+		/**
+		 * @brief Read and decompress a single asset
+		 *
+		 * If the pack is held in memory and the asset is stored uncompressed, the returned buffer shares the pack's memory instead of copying it.
+		 *
+		 * @param name The asset address or resource path
+		 *
+		 * @return The asset data
+		 *
+		 * @throws std::runtime_error If the pack does not contain the asset, the data could not be read, or the data fails its checksum
+		 */
+		PackedAsset Fetch(const std::string& name) const;
+
+	  private:
+		struct Source;
+		std::shared_ptr<Source> source;
+		std::vector<std::shared_ptr<Source>> patches;
+
+		const Source* Resolve(const std::string& name, Entry& entry) const;
+
+		PackedAssetIndex() {}
+	};
+
+	/**
+	 * @brief Random-access view of the spatial cells of a packed world
+	 *
+	 * Only the cell records are read when the view is opened. The actors of each cell are decoded on demand.
+	 * Worlds without cells (version 2 and older) appear as a single cell at the origin holding every actor.
+	 *
+	 * @note Cells can be decoded from multiple threads at once
+	 */
+	class PackedWorldCells {
+	  public:
+		///@brief A cell of the world
+		struct Cell {
+			Vec3<int32_t> coords;///<Cell coordinates (the position of the cell's minimum corner divided by the cell size)
+			uint64_t actorCount; ///<Number of actors in the cell
+		};
+
+		/**
+		 * @brief Open the cells of a packed world
+		 *
+		 * @param container The PackedContainer with the world information
+		 *
+		 * @return The cell view
+		 *
+		 * @throws std::runtime_error If the container does not hold a valid world
+		 */
+		static PackedWorldCells FromContainer(const PackedContainer& container);
+
+		///@brief Get the skybox reference path
+		const std::string& GetSkyboxRef() const {
+			return skyboxRef;
+		}
+
+		///@brief Get the initial camera position
+		Vec3<float> GetInitialCamPos() const {
+			return initialCamPos;
+		}
+
+		///@brief Get the initial camera rotation
+		Vec3<float> GetInitialCamRot() const {
+			return initialCamRot;
+		}
+
+		///@brief Get the edge length of a cell, or 0 if the world has no cells
+		float GetCellSize() const {
+			return cellSize;
+		}
+
+		///@brief Get the list of cells, sorted by coordinates
+		const std::vector<Cell>& GetCells() const {
+			return cells;
+		}
+
+		/**
+		 * @brief Find a cell by its coordinates
+		 *
+		 * @return The index of the cell, or nothing if no actors start out in that cell
+		 */
+		std::optional<std::size_t> FindCell(Vec3<int32_t> coords) const;
+
+		/**
+		 * @brief Decode the actors of a cell in column-oriented form
+		 *
+		 * The header fields of the output (skybox and initial camera data) are filled in as well.
+		 *
+		 * @param idx The index of the cell
+		 * @param out The object to decode into, whose existing storage is reused
+		 *
+		 * @throws std::runtime_error If the index is out of range or the cell data is invalid
+		 */
+		void DecodeCell(std::size_t idx, WorldColumns& out) const;
+
+	  private:
+		PackedPayload chunks;
+		std::vector<Cell> cells;
+		std::vector<std::pair<uint64_t, uint64_t>> ranges;
+		std::string skyboxRef;
+		Vec3<float> initialCamPos;
+		Vec3<float> initialCamRot;
+		float cellSize = 0;
+
+		PackedWorldCells() {}
+	};
+
 	///@brief Decoder for uncompressed packed format buffers
 	class PackedDecoder {
 	  public:
 		/**
 		 * @brief Extract and decode the images in a cubemap
 		 *
+		 * Faces are decoded straight out of the payload, independently of each other.
+		 *
 		 * @param container The PackedContainer with the cubemap information
+		 * @param threads The maximum number of threads to decode faces on (0 uses one per hardware thread)
 		 *
 		 * @return Decoded cubemap faces in the order of +X face, -X face, +Y face, -Y face, +Z face, -Z face
 		 *
-		 * @throws std::runtime_error If the container does not hold a valid cubemap
+		 * @throws std::runtime_error If the container does not hold a valid cubemap, or holds a GPU-compressed cubemap
 		 */
-		std::array<libcacaoimage::Image, 6> DecodeCubemap(const PackedContainer& container);
+		std::array<libcacaoimage::Image, 6> DecodeCubemap(const PackedContainer& container, unsigned int threads = 1);
+
+		/**
+		 * @brief Check whether a cubemap stores GPU-compressed faces (version 2) rather than encoded images
+		 *
+		 * @param container The PackedContainer with the cubemap information
+		 *
+		 * @return Whether DecodeCompressedCubemap should be used to decode the cubemap instead of DecodeCubemap
+		 *
+		 * @throws std::runtime_error If the container does not hold a cubemap
+		 */
+		bool IsCompressedCubemap(const PackedContainer& container);
+
+		/**
+		 * @brief Extract the GPU-compressed faces of a cubemap
+		 *
+		 * Nothing is decompressed or copied; every level borrows from the container payload.
+		 *
+		 * @param container The PackedContainer with the cubemap information
+		 *
+		 * @return The compressed faces and their mip chains
+		 *
+		 * @throws std::runtime_error If the container does not hold a valid GPU-compressed cubemap
+		 */
+		CompressedCubemap DecodeCompressedCubemap(const PackedContainer& container);
 
 		/**
 		 * @brief Extract the code from a shader
@@ -227,6 +1090,17 @@ namespace libcacaoformats {
 		 */
 		std::vector<unsigned char> DecodeShader(const PackedContainer& container);
 
+		/**
+		 * @brief Extract the material parameter layout stored in a shader
+		 *
+		 * @param container The PackedContainer with the shader information
+		 *
+		 * @return The layout, or nothing if the shader was encoded without one
+		 *
+		 * @throws std::runtime_error If the container does not hold a valid shader
+		 */
+		std::optional<MaterialLayout> DecodeShaderMaterialLayout(const PackedContainer& container);
+
 		/**
 		 * @brief Extract the data from a packed material
 		 *
@@ -249,9 +1123,25 @@ namespace libcacaoformats {
 		 */
 		World DecodeWorld(const PackedContainer& container);
 
+		/**
+		 * @brief Extract the data from a packed world in column-oriented form
+		 *
+		 * For worlds in the column-oriented layout (version 2), each column is filled with a single copy out of the payload, reusing the storage already in the output.
+		 * Partitioned worlds (version 3) have every cell decoded and appended in order. Older worlds are decoded with DecodeWorld and converted.
+		 *
+		 * @param container The PackedContainer with the world information
+		 * @param out The object to decode into
+		 *
+		 * @throws std::runtime_error If the container does not hold a valid world
+		 */
+		void DecodeWorldColumns(const PackedContainer& container, WorldColumns& out);
+
 		/**
 		 * @brief Extract the files from an asset pack
 		 *
+		 * Both the original archive-based packs (version 1) and indexed packs (version 2 and later) are supported. Tombstones in patch packs are skipped.
+		 * To avoid decompressing the entire pack, use a PackedAssetIndex instead.
+		 *
 		 * @param container The PackedContainer with the asset pack information
 		 *
 		 * @return Map of filenames to PackedAsset objects from the asset pack
@@ -259,6 +1149,35 @@ namespace libcacaoformats {
 		 * @throws std::runtime_error If the container does not hold a valid asset pack or the pack has no files
 		 */
 		AssetPack DecodeAssetPack(const PackedContainer& container);
+
+		/**
+		 * @brief Extract and decode every asset in an asset pack using a thread pool
+		 *
+		 * Each asset is fetched, decompressed, and decoded as its own task, and each cubemap face is decoded as a separate task. GPU-compressed cubemaps are borrowed as-is.
+		 * Indexed packs (version 2) fetch their assets on the workers; archive-based packs are extracted up front on the calling thread.
+		 *
+		 * @param container The PackedContainer with the asset pack information
+		 * @param pool The thread pool to run decoding tasks on
+		 *
+		 * @return Map of filenames to decoded assets
+		 *
+		 * @throws std::runtime_error If the container does not hold a valid asset pack, the pool is null, or any asset fails to decode
+		 */
+		DecodedAssetPack DecodeAssetPackParallel(const PackedContainer& container, std::shared_ptr<exathread::Pool> pool);
+
+		/**
+		 * @brief Open an asset pack with a patch pack layered on top
+		 *
+		 * The overlay is resolved per lookup, so no merged pack is built. Both packs must be indexed (version 2 or later).
+		 *
+		 * @param base The PackedContainer with the asset pack to patch
+		 * @param patch The PackedContainer with the patch pack
+		 *
+		 * @return An index of the patched pack
+		 *
+		 * @throws std::runtime_error If either container does not hold an indexed asset pack
+		 */
+		PackedAssetIndex OverlayAssetPack(const PackedContainer& base, const PackedContainer& patch);
 	};
 
 	///@brief Decoder for unpacked file formats
@@ -306,12 +1225,26 @@ namespace libcacaoformats {
 		 * @brief Encode a set of cubemap images faces into a packed cubemap
 		 *
 		 * @param cubemap A list of cubemap faces in the order of +X face, -X face, +Y face, -Y face, +Z face, -Z face
+		 * @param threads The maximum number of threads to encode faces on (0 uses one per hardware thread)
 		 *
 		 * @return A PackedContainer encapsulating the encoded cubemap data, with all faces encoded in PNG format
 		 *
 		 * @throws std::runtime_error If one of the faces holds invalid data or has zero dimensions
 		 */
-		PackedContainer EncodeCubemap(const std::array<libcacaoimage::Image, 6>& cubemap);
+		PackedContainer EncodeCubemap(const std::array<libcacaoimage::Image, 6>& cubemap, unsigned int threads = 1);
+
+		/**
+		 * @brief Encode a set of GPU-compressed cubemap faces into a packed cubemap
+		 *
+		 * The levels are stored as-is so that they can be uploaded without being decoded. Compressing the faces is up to the caller.
+		 *
+		 * @param cubemap The compressed faces and their mip chains
+		 *
+		 * @return A PackedContainer encapsulating the compressed cubemap data
+		 *
+		 * @throws std::runtime_error If the faces have zero dimensions, a different number of levels, more levels than a full mip chain, or a level of the wrong size
+		 */
+		PackedContainer EncodeCubemap(const CompressedCubemap& cubemap);
 
 		/**
 		 * @brief Encode shader IR into a packed shader object
@@ -322,6 +1255,18 @@ namespace libcacaoformats {
 		 */
 		PackedContainer EncodeShader(const std::vector<unsigned char>& ir);
 
+		/**
+		 * @brief Encode shader IR and the layout of its material parameters into a packed shader object
+		 *
+		 * @param ir Shader Slang IR
+		 * @param layout The material parameter layout, as reflected from the shader
+		 *
+		 * @return A PackedContainer encapsulating the shader code and material parameter layout
+		 *
+		 * @throws std::runtime_error If the layout has a parameter that does not fit in the block or an out-of-range type
+		 */
+		PackedContainer EncodeShader(const std::vector<unsigned char>& ir, const MaterialLayout& layout);
+
 		/**
 		 * @brief Encode material data and a shader reference into a packed material
 		 *
@@ -331,6 +1276,20 @@ namespace libcacaoformats {
 		 */
 		PackedContainer EncodeMaterial(const Material& mat);
 
+		/**
+		 * @brief Encode material data along with a precompiled parameter block and texture slot table
+		 *
+		 * The output can still be decoded with PackedDecoder::DecodeMaterial, and its block can be read with PackedMaterialBlock.
+		 *
+		 * @param mat The Material object with the data to encode
+		 * @param layout The material parameter layout of the referenced shader
+		 *
+		 * @return A PackedContainer encapsulating the shader reference, material data, and parameter block
+		 *
+		 * @throws std::runtime_error If the material and layout do not have the same parameters with the same types, or a parameter does not fit in the block
+		 */
+		PackedContainer EncodeMaterial(const Material& mat, const MaterialLayout& layout);
+
 		/**
 		 * @brief Encode world data into a packed format
 		 *
@@ -340,16 +1299,74 @@ namespace libcacaoformats {
 		 */
 		PackedContainer EncodeWorld(const World& world);
 
+		/**
+		 * @brief Encode column-oriented world data into a packed format
+		 *
+		 * @param world The world columns
+		 *
+		 * @return A PackedContainer encapsulating the world data and initial state
+		 *
+		 * @throws std::runtime_error If the columns are inconsistent with each other
+		 */
+		PackedContainer EncodeWorld(const WorldColumns& world);
+
+		/**
+		 * @brief Encode world data into a packed format split into spatial cells
+		 *
+		 * Each actor is placed in the cell that the initial position of its top-level ancestor falls in, so that every cell holds whole actor hierarchies.
+		 * Cells can then be decoded independently of each other with PackedWorldCells.
+		 *
+		 * @param world The decoded World object
+		 * @param cellSize The edge length of a cell, or 0 to encode the world without cells
+		 *
+		 * @return A PackedContainer encapsulating the world data and initial state, in the partitioned (version 3) layout unless the cell size is 0
+		 *
+		 * @throws std::runtime_error If the cell size is negative or not finite, or if an actor is too far from the origin to be placed in a cell
+		 */
+		PackedContainer EncodeWorld(const World& world, float cellSize);
+
+		/**
+		 * @brief Convert YAML component reflection data to the binary form read by ReflectionView
+		 *
+		 * Scalars tagged !!int, !!float, or !!bool keep that type, and quoted or !!str-tagged scalars become strings.
+		 * Other plain scalars become nulls, integers, floating-point numbers, or booleans if they can be read as one (in that order), and strings otherwise.
+		 *
+		 * @param yaml The YAML-encoded reflection data, which is returned as-is if it is already binary
+		 *
+		 * @return The binary reflection data
+		 *
+		 * @throws std::runtime_error If the YAML is invalid or has a map key that is not a scalar
+		 */
+		std::string EncodeReflection(std::string_view yaml);
+
 		/**
 		 * @brief Combine asset pack files into a merged pack
 		 *
+		 * Assets with identical contents are only stored once, with every one of their table of contents entries pointing at the same data.
+		 *
 		 * @param pack A map of filenames to PackedAsset objects from the asset pack
+		 * @param threads The maximum number of threads to compress assets on (0 uses one per hardware thread). The output does not depend on the number of threads.
 		 *
-		 * @return A PackedContainer encapsulating the asset info and asset files
+		 * @return A PackedContainer encapsulating the asset info and asset files, in the indexed (version 3) layout
 		 *
 		 * @throws std::runtime_error If the provided pack data has no assets
 		 */
-		PackedContainer EncodeAssetPack(const AssetPack& pack);
+		PackedContainer EncodeAssetPack(const AssetPack& pack, unsigned int threads = 1);
+
+		/**
+		 * @brief Create a patch pack to layer on top of an existing asset pack
+		 *
+		 * A patch is an ordinary indexed asset pack that also records deleted assets as tombstones. See PackedAssetIndex::WithPatch for loading one.
+		 *
+		 * @param pack A map of filenames to PackedAsset objects for assets that were added or changed
+		 * @param removed The names of assets that were deleted
+		 * @param threads The maximum number of threads to compress assets on (0 uses one per hardware thread). The output does not depend on the number of threads.
+		 *
+		 * @return A PackedContainer encapsulating the patch
+		 *
+		 * @throws std::runtime_error If the patch is empty, or an asset is both changed and deleted
+		 */
+		PackedContainer EncodeAssetPackPatch(const AssetPack& pack, const std::vector<std::string>& removed, unsigned int threads = 1);
 	};
 
 	///@brief Encoder for unpacked file formats
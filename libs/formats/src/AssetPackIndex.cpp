@@ -0,0 +1,446 @@
+#include "libcacaoformats.hpp"
+
+#include "libcacaocommon.hpp"
+#include "AssetPackTOC.hpp"
+#include "Checksum.hpp"
+#include "Codec.hpp"
+#include "ContainerHeader.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include <mutex>
+#include <algorithm>
+#include <unordered_set>
+#include <string_view>
+
+namespace libcacaoformats {
+	uint8_t AssetKindToCode(PackedAsset::Kind kind) {
+		switch(kind) {
+			case PackedAsset::Kind::Shader: return 0;
+			case PackedAsset::Kind::Tex2D: return 1;
+			case PackedAsset::Kind::Cubemap: return 2;
+			case PackedAsset::Kind::Sound: return 3;
+			case PackedAsset::Kind::Material: return 4;
+			case PackedAsset::Kind::Font: return 5;
+			case PackedAsset::Kind::Model: return 6;
+			case PackedAsset::Kind::Resource: return 7;
+		}
+		return 7;
+	}
+
+	PackedAsset::Kind AssetKindFromCode(uint8_t code) {
+		switch(code) {
+			case 0: return PackedAsset::Kind::Shader;
+			case 1: return PackedAsset::Kind::Tex2D;
+			case 2: return PackedAsset::Kind::Cubemap;
+			case 3: return PackedAsset::Kind::Sound;
+			case 4: return PackedAsset::Kind::Material;
+			case 5: return PackedAsset::Kind::Font;
+			case 6: return PackedAsset::Kind::Model;
+			case 7: return PackedAsset::Kind::Resource;
+			default:
+				CheckException(false, "Asset pack entry has out-of-range asset type!");
+				return PackedAsset::Kind::Resource;
+		}
+	}
+
+	AssetPackFooter ReadAssetPackFooter(const unsigned char* footer, uint64_t payloadSize) {
+		CheckException(std::memcmp(footer + 20, assetPackFooterMagic, 4) == 0, "Asset pack footer is invalid!");
+
+		AssetPackFooter out {};
+		std::memcpy(&out.tocOffset, footer, 8);
+		std::memcpy(&out.tocSize, footer + 8, 8);
+		std::memcpy(&out.tocChecksum, footer + 16, 4);
+
+		//The TOC must sit between the asset data and the footer
+		CheckException(out.tocSize >= 4 && out.tocOffset <= payloadSize - assetPackFooterSize && out.tocSize <= payloadSize - assetPackFooterSize - out.tocOffset, "Asset pack footer points outside of the pack!");
+		return out;
+	}
+
+	//Parse a version 2 table of contents
+	std::vector<AssetPackTOCEntry> ReadLegacyAssetPackTOC(const unsigned char* toc, const AssetPackFooter& footer) {
+		//Get entry count
+		uint32_t entryCount = 0;
+		std::memcpy(&entryCount, toc, 4);
+		std::size_t advance = 4;
+		CheckException(entryCount > 0, "Asset pack has no files!");
+
+		std::vector<AssetPackTOCEntry> out;
+		out.reserve(entryCount);
+		for(uint32_t i = 0; i < entryCount; ++i) {
+			AssetPackTOCEntry& ent = out.emplace_back();
+
+			//Get name
+			CheckException(footer.tocSize >= advance + 2, "Asset pack table of contents is too small to contain name string length data!");
+			uint16_t nameLen = 0;
+			std::memcpy(&nameLen, toc + advance, 2);
+			advance += 2;
+			CheckException(nameLen > 0, "Asset pack table of contents has zero-length name string!");
+			CheckException(footer.tocSize >= advance + nameLen, "Asset pack table of contents is too small to contain name string!");
+			ent.first = std::string(reinterpret_cast<const char*>(toc + advance), nameLen);
+			advance += nameLen;
+
+			//Get entry record
+			CheckException(footer.tocSize >= advance + 30, "Asset pack table of contents is too small to contain entry record!");
+			ent.second.kind = AssetKindFromCode(toc[advance++]);
+			ent.second.compression = CodecFromCode(toc[advance++]);
+			std::memcpy(&ent.second.offset, toc + advance, 8);
+			advance += 8;
+			std::memcpy(&ent.second.compressedSize, toc + advance, 8);
+			advance += 8;
+			std::memcpy(&ent.second.size, toc + advance, 8);
+			advance += 8;
+			std::memcpy(&ent.second.checksum, toc + advance, 4);
+			advance += 4;
+		}
+
+		return out;
+	}
+
+	//Serialize the entry count, records, and names of a table of contents
+	void WriteAssetPackTable(std::vector<AssetPackTOCEntry> entries, std::vector<char>& out) {
+		CheckException(entries.size() <= UINT32_MAX, "Asset pack for packed encoding has too many entries!");
+
+		//Sort entries by hash so that they can be binary searched
+		std::vector<std::pair<uint64_t, AssetPackTOCEntry*>> order;
+		order.reserve(entries.size());
+		for(AssetPackTOCEntry& entry : entries) order.emplace_back(NameHash(entry.first), &entry);
+		std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+			return a.first != b.first ? a.first < b.first : a.second->first < b.second->first;
+		});
+
+		//Write entry count
+		const auto put = [&out](const auto& value) {
+			out.insert(out.end(), reinterpret_cast<const char*>(&value), reinterpret_cast<const char*>(&value) + sizeof(value));
+		};
+		put((uint32_t)entries.size());
+
+		//Write records
+		uint64_t nameOffset = 0;
+		for(const auto& [hash, ent] : order) {
+			const auto& [name, entry] = *ent;
+			CheckException(name.size() > 0 && name.size() <= UINT16_MAX, "Asset pack entry for packed encoding has out-of-range name string length!");
+			CheckException(nameOffset + name.size() <= UINT32_MAX, "Asset pack for packed encoding has too much name data!");
+			put(hash);
+			put((uint32_t)nameOffset);
+			put((uint16_t)name.size());
+			if(entry.tombstone) {
+				put(assetPackTombstoneCode);
+				out.insert(out.end(), assetPackRecordSize - 15, 0);
+			} else {
+				put(AssetKindToCode(entry.kind));
+				put(entry.compression);
+				put(entry.offset);
+				put(entry.compressedSize);
+				put(entry.size);
+				put(entry.checksum);
+			}
+			nameOffset += name.size();
+		}
+
+		//Write names
+		for(const auto& [_, ent] : order) {
+			out.insert(out.end(), ent->first.begin(), ent->first.end());
+		}
+	}
+
+	AssetPackTable AssetPackTable::Open(PackedPayload toc, const AssetPackFooter& footer, uint16_t version) {
+		CheckException(toc.size() == footer.tocSize, "Asset pack table of contents has the wrong size!");
+		CheckException(CRC32(toc.data(), toc.size()) == footer.tocChecksum, "Asset pack table of contents is corrupted!");
+		CheckException(version <= assetPackVersion, "Asset pack is a newer version than is supported!");
+
+		//Older tables are rewritten in the current layout
+		if(version < 3) {
+			std::vector<char> converted;
+			WriteAssetPackTable(ReadLegacyAssetPackTOC(toc.data(), footer), converted);
+			toc = PackedPayload(std::vector<unsigned char>(converted.begin(), converted.end()));
+		}
+
+		AssetPackTable out;
+		std::memcpy(&out.count, toc.data(), 4);
+		CheckException(out.count > 0, "Asset pack has no files!");
+		CheckException((toc.size() - 4) / assetPackRecordSize >= out.count, "Asset pack table of contents is too small to contain entry records!");
+		out.data = std::move(toc);
+		out.dataRegionSize = footer.tocOffset;
+		for(std::size_t i = 0; i < out.count; ++i) {
+			if(out.data.data()[4 + i * assetPackRecordSize + 14] == assetPackTombstoneCode) ++out.tombstones;
+		}
+		return out;
+	}
+
+	std::string_view AssetPackTable::Name(std::size_t i) const {
+		const unsigned char* record = data.data() + 4 + i * assetPackRecordSize;
+		uint32_t nameOffset = 0;
+		uint16_t nameLen = 0;
+		std::memcpy(&nameOffset, record + 8, 4);
+		std::memcpy(&nameLen, record + 12, 2);
+
+		const std::size_t namesStart = 4 + count * assetPackRecordSize;
+		CheckException(nameLen > 0 && nameOffset <= data.size() - namesStart && nameLen <= data.size() - namesStart - nameOffset, "Asset pack table of contents entry name points outside of the table!");
+		return std::string_view(reinterpret_cast<const char*>(data.data() + namesStart + nameOffset), nameLen);
+	}
+
+	PackedAssetIndex::Entry AssetPackTable::Record(std::size_t i) const {
+		const unsigned char* record = data.data() + 4 + i * assetPackRecordSize;
+
+		PackedAssetIndex::Entry out {};
+		if(record[14] == assetPackTombstoneCode) {
+			out.kind = PackedAsset::Kind::Resource;
+			out.compression = PackedCodec::Stored;
+			out.tombstone = true;
+			return out;
+		}
+		out.kind = AssetKindFromCode(record[14]);
+		out.compression = CodecFromCode(record[15]);
+		std::memcpy(&out.offset, record + 16, 8);
+		std::memcpy(&out.compressedSize, record + 24, 8);
+		std::memcpy(&out.size, record + 32, 8);
+		std::memcpy(&out.checksum, record + 40, 4);
+
+		//Bounds-check stored data
+		CheckException(out.offset <= dataRegionSize && out.compressedSize <= dataRegionSize - out.offset, "Asset pack entry points outside of the asset data region!");
+		CheckException(out.compression != PackedCodec::Stored || out.compressedSize == out.size, "Asset pack entry has mismatched sizes!");
+		return out;
+	}
+
+	uint64_t AssetPackTable::Hash(std::size_t i) const {
+		uint64_t hash = 0;
+		std::memcpy(&hash, data.data() + 4 + i * assetPackRecordSize, 8);
+		return hash;
+	}
+
+	std::optional<std::size_t> AssetPackTable::Find(std::string_view name) const {
+		//Find the first record with a matching hash
+		const uint64_t hash = NameHash(name);
+		std::size_t lo = 0, hi = count;
+		while(lo < hi) {
+			std::size_t mid = lo + (hi - lo) / 2;
+			if(Hash(mid) < hash) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+
+		//Names with the same hash sit next to each other
+		for(std::size_t i = lo; i < count && Hash(i) == hash; ++i) {
+			if(Name(i) == name) return i;
+		}
+		return std::nullopt;
+	}
+
+	void WriteAssetPackTOC(std::vector<AssetPackTOCEntry> entries, uint64_t tocOffset, std::vector<char>& out) {
+		//Write table
+		const std::size_t tocStart = out.size();
+		WriteAssetPackTable(std::move(entries), out);
+
+		//Write footer
+		const auto put = [&out](const auto& value) {
+			out.insert(out.end(), reinterpret_cast<const char*>(&value), reinterpret_cast<const char*>(&value) + sizeof(value));
+		};
+		uint64_t tocSize = out.size() - tocStart;
+		put(tocOffset);
+		put(tocSize);
+		put(CRC32(reinterpret_cast<const unsigned char*>(out.data() + tocStart), tocSize));
+		out.insert(out.end(), assetPackFooterMagic, assetPackFooterMagic + 4);
+	}
+
+	PackedCodec CompressAssetPackEntry(const PackedAsset& asset, std::vector<char>& out) {
+		const auto store = [&out, &asset]() {
+			out.insert(out.end(), asset.buffer.begin(), asset.buffer.end());
+			return PackedCodec::Stored;
+		};
+
+		//Packed containers and audio are already compressed, and so are most texture formats
+		switch(asset.kind) {
+			case PackedAsset::Kind::Shader:
+			case PackedAsset::Kind::Cubemap:
+			case PackedAsset::Kind::Material:
+			case PackedAsset::Kind::Sound:
+				return store();
+			case PackedAsset::Kind::Tex2D:
+				//Only TGA and TIFF are worth compressing further
+				if(asset.buffer.size() >= 4 && (asset.buffer[0] == 0x89 || asset.buffer[0] == 0xFF || asset.buffer[0] == 'R')) return store();
+				break;
+			default: break;
+		}
+		if(asset.buffer.empty()) return store();
+
+		//Compress
+		std::vector<unsigned char> compressed = Compress(PackedCodec::Zstd, asset.buffer.span());
+
+		//Keep whichever is smaller
+		if(compressed.size() >= asset.buffer.size()) return store();
+		out.insert(out.end(), compressed.cbegin(), compressed.cend());
+		return PackedCodec::Zstd;
+	}
+
+	void DecompressAssetPackEntry(const PackedAssetIndex::Entry& entry, const unsigned char* stored, std::span<unsigned char> out) {
+		Decompress(entry.compression, std::span<const unsigned char>(stored, entry.compressedSize), out);
+		CheckException(CRC32(out.data(), out.size()) == entry.checksum, "Asset pack entry failed checksum verification!");
+	}
+
+	PackedPayload LoadAssetPackEntry(const PackedAssetIndex::Entry& entry, const PackedPayload& payload) {
+		//Stored assets can be handed out without copying
+		if(entry.compression == PackedCodec::Stored) {
+			CheckException(CRC32(payload.data() + entry.offset, entry.size) == entry.checksum, "Asset pack entry failed checksum verification!");
+			return payload.Slice(entry.offset, entry.size);
+		}
+
+		std::vector<unsigned char> out(entry.size);
+		DecompressAssetPackEntry(entry, payload.data() + entry.offset, out);
+		return PackedPayload(std::move(out));
+	}
+
+	struct PackedAssetIndex::Source {
+		//Stream-backed packs
+		std::unique_ptr<std::istream> stream;
+		std::streamoff payloadStart;
+		mutable std::mutex mtx;
+
+		//Memory-backed packs
+		PackedPayload payload;
+
+		AssetPackTable table;
+	};
+
+	PackedAssetIndex PackedAssetIndex::FromStream(std::unique_ptr<std::istream>&& stream) {
+		CheckException(stream && stream->good(), "Data stream for asset pack index is invalid!");
+
+		//Read the container header
+		ContainerHeader header = ReadContainerHeader(*stream);
+		CheckException(header.format == PackedFormat::AssetPack, "Packed container provided for asset pack indexing is not an asset pack!");
+		CheckException(header.version >= 2, "Asset pack is not indexed (version 2 or later); use PackedDecoder::DecodeAssetPack instead!");
+		CheckException(header.codec == PackedCodec::Stored, "Asset pack payload is compressed as a whole and cannot be indexed from a stream; use FromFile or FromContainer instead!");
+		uint64_t payloadSize = header.uncompressedSize;
+		CheckException(payloadSize >= assetPackFooterSize + 4, "Asset pack is too small to contain a table of contents!");
+
+		PackedAssetIndex out;
+		out.source = std::make_shared<Source>();
+		out.source->payloadStart = stream->tellg();
+
+		//Read the footer
+		unsigned char footerBuf[assetPackFooterSize];
+		stream->seekg(out.source->payloadStart + std::streamoff(payloadSize - assetPackFooterSize));
+		stream->read(reinterpret_cast<char*>(footerBuf), assetPackFooterSize);
+		CheckException(stream->gcount() == assetPackFooterSize, "Failed to read asset pack footer!");
+		AssetPackFooter footer = ReadAssetPackFooter(footerBuf, payloadSize);
+
+		//Read the table of contents
+		std::vector<unsigned char> tocBuf(footer.tocSize);
+		stream->seekg(out.source->payloadStart + std::streamoff(footer.tocOffset));
+		stream->read(reinterpret_cast<char*>(tocBuf.data()), footer.tocSize);
+		CheckException(std::size_t(stream->gcount()) == footer.tocSize, "Failed to read asset pack table of contents!");
+		out.source->table = AssetPackTable::Open(std::move(tocBuf), footer, header.version);
+
+		out.source->stream = std::move(stream);
+		return out;
+	}
+
+	PackedAssetIndex PackedAssetIndex::FromContainer(const PackedContainer& container) {
+		CheckException(container.format == PackedFormat::AssetPack, "Packed container provided for asset pack indexing is not an asset pack!");
+		CheckException(container.version >= 2, "Asset pack is not indexed (version 2 or later); use PackedDecoder::DecodeAssetPack instead!");
+		CheckException(container.payload.size() >= assetPackFooterSize + 4, "Asset pack is too small to contain a table of contents!");
+
+		PackedAssetIndex out;
+		out.source = std::make_shared<Source>();
+		out.source->payload = container.payload;
+
+		//Read the table of contents straight out of the payload
+		AssetPackFooter footer = ReadAssetPackFooter(container.payload.data() + container.payload.size() - assetPackFooterSize, container.payload.size());
+		out.source->table = AssetPackTable::Open(container.payload.Slice(footer.tocOffset, footer.tocSize), footer, container.version);
+
+		return out;
+	}
+
+	PackedAssetIndex PackedAssetIndex::FromFile(const std::filesystem::path& path) {
+		return FromContainer(PackedContainer::FromFile(path));
+	}
+
+	PackedAssetIndex PackedAssetIndex::WithPatch(const PackedAssetIndex& patch) const {
+		PackedAssetIndex out = *this;
+		out.patches.push_back(patch.source);
+		out.patches.insert(out.patches.end(), patch.patches.begin(), patch.patches.end());
+		return out;
+	}
+
+	const PackedAssetIndex::Source* PackedAssetIndex::Resolve(const std::string& name, Entry& entry) const {
+		//The topmost layer with an entry for the asset decides where it comes from
+		for(auto layer = patches.crbegin(); layer != patches.crend(); ++layer) {
+			if(std::optional<std::size_t> idx = (*layer)->table.Find(name)) {
+				entry = (*layer)->table.Record(*idx);
+				return entry.tombstone ? nullptr : layer->get();
+			}
+		}
+		if(std::optional<std::size_t> idx = source->table.Find(name)) {
+			entry = source->table.Record(*idx);
+			return entry.tombstone ? nullptr : source.get();
+		}
+		return nullptr;
+	}
+
+	bool PackedAssetIndex::Contains(const std::string& name) const {
+		Entry entry;
+		return Resolve(name, entry) != nullptr;
+	}
+
+	PackedAssetIndex::Entry PackedAssetIndex::GetEntry(const std::string& name) const {
+		Entry entry;
+		CheckException(Resolve(name, entry) != nullptr, "Asset pack does not contain requested asset!");
+		return entry;
+	}
+
+	std::size_t PackedAssetIndex::Size() const {
+		if(patches.empty()) return source->table.Size() - source->table.Tombstones();
+		return List().size();
+	}
+
+	std::vector<std::string> PackedAssetIndex::List() const {
+		std::vector<std::string> out;
+		out.reserve(source->table.Size());
+
+		//Walk the layers from the top down, so that the first time a name is seen decides whether it exists
+		std::unordered_set<std::string_view> seen;
+		const auto walk = [&out, &seen, layered = !patches.empty()](const AssetPackTable& table) {
+			for(std::size_t i = 0; i < table.Size(); ++i) {
+				std::string_view name = table.Name(i);
+				if(layered && !seen.insert(name).second) continue;
+				if(!table.Record(i).tombstone) out.emplace_back(name);
+			}
+		};
+		for(auto layer = patches.crbegin(); layer != patches.crend(); ++layer) walk((*layer)->table);
+		walk(source->table);
+		return out;
+	}
+
+	PackedAsset PackedAssetIndex::Fetch(const std::string& name) const {
+		Entry entry;
+		const Source* layer = Resolve(name, entry);
+		CheckException(layer != nullptr, "Asset pack does not contain requested asset!");
+
+		//Memory-backed packs need no locking
+		if(!layer->stream) {
+			return PackedAsset {.kind = entry.kind, .buffer = LoadAssetPackEntry(entry, layer->payload)};
+		}
+
+		//Read the stored bytes (directly into the output if they aren't compressed)
+		std::vector<unsigned char> stored(entry.compressedSize);
+		{
+			std::lock_guard lk(layer->mtx);
+			layer->stream->clear();
+			layer->stream->seekg(layer->payloadStart + std::streamoff(entry.offset));
+			layer->stream->read(reinterpret_cast<char*>(stored.data()), entry.compressedSize);
+			CheckException(std::size_t(layer->stream->gcount()) == entry.compressedSize, "Failed to read asset data from asset pack!");
+		}
+		if(entry.compression == PackedCodec::Stored) {
+			CheckException(CRC32(stored.data(), stored.size()) == entry.checksum, "Asset pack entry failed checksum verification!");
+			return PackedAsset {.kind = entry.kind, .buffer = std::move(stored)};
+		}
+
+		//Decompress outside of the lock so other fetches can proceed
+		std::vector<unsigned char> out(entry.size);
+		DecompressAssetPackEntry(entry, stored.data(), out);
+		return PackedAsset {.kind = entry.kind, .buffer = std::move(out)};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "libcacaoformats.hpp"
+
+#include <optional>
+#include <span>
+#include <string_view>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+/*
+ * Indexed asset pack (version 3) payload layout
+ *
+ * [asset data]  Stored bytes of every unique asset, back to back, each compressed individually
+ *               Entries for assets with identical contents all point at the same stored bytes
+ * [TOC]         uint32 entry count
+ *               Fixed-size records, sorted by name hash and then by name:
+ *                   uint64 name hash (FNV-1a), uint32 name offset, uint16 name length
+ *                   uint8 kind code, uint8 codec (PackedCodec)
+ *                   uint64 offset, uint64 stored size, uint64 uncompressed size
+ *                   uint32 CRC-32 of the uncompressed data
+ *               Patch packs may also contain tombstone records (kind code 0xFF, all other fields zero), which mark an asset of the patched pack as deleted
+ *               Name bytes of every entry, back to back (name offsets are relative to the start of this block)
+ * [footer]      uint64 TOC offset, uint64 TOC size, uint32 CRC-32 of the TOC, "XTOC"
+ *
+ * All offsets are relative to the start of the payload unless noted. The payload itself is not compressed as a whole.
+ *
+ * Version 2 packs have the same asset data and footer, but a TOC made of variable-length entries in no particular order:
+ *     uint32 entry count, then per entry: uint16 name length, name bytes, and the record fields from kind code onward
+ */
+
+namespace libcacaoformats {
+	inline constexpr std::size_t assetPackFooterSize = 24;
+	inline constexpr char assetPackFooterMagic[4] = {'X', 'T', 'O', 'C'};
+	inline constexpr std::size_t assetPackRecordSize = 44;
+	inline constexpr uint16_t assetPackVersion = 3;
+	inline constexpr uint8_t assetPackTombstoneCode = 0xFF;
+
+	///@brief A named table of contents entry
+	using AssetPackTOCEntry = std::pair<std::string, PackedAssetIndex::Entry>;
+
+	///@brief Decoded asset pack footer
+	struct AssetPackFooter {
+		uint64_t tocOffset;	  ///<Offset of the TOC from the start of the payload
+		uint64_t tocSize;	  ///<Size of the TOC
+		uint32_t tocChecksum;///<CRC-32 of the TOC
+	};
+
+	/**
+	 * @brief Convert an asset kind to its code in the pack metadata
+	 */
+	uint8_t AssetKindToCode(PackedAsset::Kind kind);
+
+	/**
+	 * @brief Convert a code from the pack metadata to an asset kind
+	 *
+	 * @throws std::runtime_error If the code is out of range
+	 */
+	PackedAsset::Kind AssetKindFromCode(uint8_t code);
+
+	/**
+	 * @brief Parse the footer at the end of an indexed asset pack payload
+	 *
+	 * @param footer Pointer to the last assetPackFooterSize bytes of the payload
+	 * @param payloadSize The total size of the payload
+	 *
+	 * @return The decoded footer
+	 *
+	 * @throws std::runtime_error If the footer is invalid or points outside of the payload
+	 */
+	AssetPackFooter ReadAssetPackFooter(const unsigned char* footer, uint64_t payloadSize);
+
+	/**
+	 * @brief Searchable view of an asset pack table of contents
+	 *
+	 * Records are decoded on access, so opening a table does not build any per-entry structures.
+	 */
+	class AssetPackTable {
+	  public:
+		/**
+		 * @brief Open a table of contents
+		 *
+		 * Version 2 tables are converted to the version 3 layout first.
+		 *
+		 * @param toc The TOC data, which the table will keep a reference to
+		 * @param footer The decoded footer describing the TOC
+		 * @param version The asset pack version
+		 *
+		 * @return The table
+		 *
+		 * @throws std::runtime_error If the TOC is corrupted or malformed
+		 */
+		static AssetPackTable Open(PackedPayload toc, const AssetPackFooter& footer, uint16_t version);
+
+		///@brief Get the number of entries, including tombstones
+		std::size_t Size() const {
+			return count;
+		}
+
+		///@brief Get the number of tombstone entries
+		std::size_t Tombstones() const {
+			return tombstones;
+		}
+
+		/**
+		 * @brief Get the name of an entry
+		 *
+		 * @throws std::runtime_error If the name lies outside of the TOC
+		 */
+		std::string_view Name(std::size_t i) const;
+
+		/**
+		 * @brief Decode the record of an entry
+		 *
+		 * @throws std::runtime_error If the record is invalid or points outside of the asset data region
+		 */
+		PackedAssetIndex::Entry Record(std::size_t i) const;
+
+		/**
+		 * @brief Find an entry by name with a binary search over the name hashes
+		 *
+		 * @return The index of the entry, or nothing if there is no such entry
+		 */
+		std::optional<std::size_t> Find(std::string_view name) const;
+
+	  private:
+		PackedPayload data;
+		uint32_t count = 0;
+		std::size_t tombstones = 0;
+		uint64_t dataRegionSize = 0;
+
+		uint64_t Hash(std::size_t i) const;
+	};
+
+	/**
+	 * @brief Serialize a table of contents and footer
+	 *
+	 * Entries are sorted by name hash as they are written.
+	 *
+	 * @param entries The list of entries
+	 * @param tocOffset The offset the TOC will be written at
+	 * @param out The buffer to append to
+	 */
+	void WriteAssetPackTOC(std::vector<AssetPackTOCEntry> entries, uint64_t tocOffset, std::vector<char>& out);
+
+	/**
+	 * @brief Compress an asset for storage in an indexed pack
+	 *
+	 * Assets whose kind is already compressed, or that do not shrink, are stored as-is.
+	 *
+	 * @param asset The asset to compress
+	 * @param out The buffer to append the stored bytes to
+	 *
+	 * @return The codec used
+	 */
+	PackedCodec CompressAssetPackEntry(const PackedAsset& asset, std::vector<char>& out);
+
+	/**
+	 * @brief Decompress and verify the stored bytes of an asset
+	 *
+	 * @param entry The table of contents record of the asset
+	 * @param stored Pointer to the stored bytes, of size entry.compressedSize
+	 * @param out The buffer to decompress into, of size entry.size
+	 *
+	 * @throws std::runtime_error If decompression fails or the data fails its checksum
+	 */
+	void DecompressAssetPackEntry(const PackedAssetIndex::Entry& entry, const unsigned char* stored, std::span<unsigned char> out);
+
+	/**
+	 * @brief Get the verified data of an asset from a pack payload
+	 *
+	 * @param entry The table of contents record of the asset
+	 * @param payload The pack payload
+	 *
+	 * @return A slice of the payload if the asset is stored uncompressed, otherwise a new buffer with the decompressed data
+	 *
+	 * @throws std::runtime_error If decompression fails or the data fails its checksum
+	 */
+	PackedPayload LoadAssetPackEntry(const PackedAssetIndex::Entry& entry, const PackedPayload& payload);
+}
\ No newline at end of file
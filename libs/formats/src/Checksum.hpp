@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace libcacaoformats {
+	//CRC-32 (IEEE 802.3 polynomial, reflected) lookup table
+	inline constexpr std::array<uint32_t, 256> crcTable = []() {
+		std::array<uint32_t, 256> table {};
+		for(uint32_t i = 0; i < 256; ++i) {
+			uint32_t c = i;
+			for(int k = 0; k < 8; ++k) {
+				c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+			}
+			table[i] = c;
+		}
+		return table;
+	}();
+
+	/**
+	 * @brief Calculate the CRC-32 of a block of data
+	 *
+	 * @param data The data to checksum
+	 * @param size The size of the data in bytes
+	 * @param crc A previous checksum to continue from, for checksumming data in pieces
+	 *
+	 * @return The checksum
+	 */
+	inline uint32_t CRC32(const unsigned char* data, std::size_t size, uint32_t crc = 0) {
+		crc = ~crc;
+		for(std::size_t i = 0; i < size; ++i) {
+			crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	/**
+	 * @brief Calculate the 64-bit FNV-1a hash of an asset name
+	 *
+	 * @param name The name to hash
+	 *
+	 * @return The hash
+	 */
+	inline uint64_t NameHash(std::string_view name) {
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for(char c : name) {
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+}
\ No newline at end of file
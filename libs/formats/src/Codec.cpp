@@ -0,0 +1,222 @@
+#include "Codec.hpp"
+
+#include "libcacaocommon.hpp"
+
+#include "bzlib.h"
+#include "zstd.h"
+#include "lz4.h"
+#include "lz4hc.h"
+#include "lz4frame.h"
+
+#include <climits>
+#include <cstring>
+#include <algorithm>
+
+namespace libcacaoformats {
+	PackedCodec CodecFromCode(uint8_t code) {
+		CheckException(code <= static_cast<uint8_t>(PackedCodec::LZ4), "Packed data uses an unknown compression codec!");
+		return static_cast<PackedCodec>(code);
+	}
+
+	std::vector<unsigned char> Compress(PackedCodec codec, std::span<const unsigned char> data) {
+		std::vector<unsigned char> out;
+		switch(codec) {
+			case PackedCodec::Stored:
+				out.assign(data.begin(), data.end());
+				break;
+			case PackedCodec::Bzip2: {
+				//The bzip2 buffer API is limited to 32-bit sizes
+				CheckException(data.size() <= UINT_MAX / 2, "Data is too large to compress with bzip2!");
+				out.resize(data.size() * 1.01 + 600);//This size ratio comes from the bzip2 docs
+				unsigned int destSize = out.size();
+				int status = BZ2_bzBuffToBuffCompress(reinterpret_cast<char*>(out.data()), &destSize, const_cast<char*>(reinterpret_cast<const char*>(data.data())), data.size(), 9, 0, 30);//9 is the compression level, which is the default from the bzip2 command-line tool. 30 is the recommended work factor by the bzip2 docs.
+				CheckException(status == BZ_OK, "Failed to compress data with bzip2!");
+				out.resize(destSize);
+				break;
+			}
+			case PackedCodec::Zstd: {
+				out.resize(ZSTD_compressBound(data.size()));
+				std::size_t destSize = ZSTD_compress(out.data(), out.size(), data.data(), data.size(), 19);//Packing happens offline, so spend the time on a high level; decompression speed barely depends on it
+				CheckException(!ZSTD_isError(destSize), "Failed to compress data with Zstandard!");
+				out.resize(destSize);
+				break;
+			}
+			case PackedCodec::LZ4: {
+				//Use the frame format rather than a raw block so that the data can be decompressed incrementally
+				LZ4F_preferences_t prefs {};
+				prefs.compressionLevel = LZ4HC_CLEVEL_MAX;
+				prefs.frameInfo.contentSize = data.size();
+				out.resize(LZ4F_compressFrameBound(data.size(), &prefs));
+				std::size_t destSize = LZ4F_compressFrame(out.data(), out.size(), data.data(), data.size(), &prefs);
+				CheckException(!LZ4F_isError(destSize), "Failed to compress data with LZ4!");
+				out.resize(destSize);
+				break;
+			}
+		}
+
+		//Free any memory not used
+		out.shrink_to_fit();
+		return out;
+	}
+
+	uint64_t MaxDecompressedSize(PackedCodec codec, uint64_t compressedSize) {
+		//Upper bounds on the compression ratio of each codec:
+		//LZ4 can't encode more than 255 bytes of match per input byte, the densest Zstandard block is a 4-byte RLE block of 128 KiB,
+		//and bzip2's two run-length stages top out at about 46 million to one
+		uint64_t ratio = 1;
+		switch(codec) {
+			case PackedCodec::Stored: ratio = 1; break;
+			case PackedCodec::LZ4: ratio = 256; break;
+			case PackedCodec::Zstd: ratio = 32768; break;
+			case PackedCodec::Bzip2: ratio = 46'000'000; break;
+		}
+		return compressedSize > UINT64_MAX / ratio ? UINT64_MAX : compressedSize * ratio;
+	}
+
+	void Decompress(PackedCodec codec, std::span<const unsigned char> data, std::span<unsigned char> out) {
+		switch(codec) {
+			case PackedCodec::Stored:
+				CheckException(data.size() == out.size(), "Stored data has the wrong size!");
+				std::memcpy(out.data(), data.data(), out.size());
+				break;
+			case PackedCodec::Bzip2: {
+				CheckException(data.size() <= UINT_MAX && out.size() <= UINT_MAX, "Data is too large to decompress with bzip2!");
+				unsigned int outSize = out.size();
+				int status = BZ2_bzBuffToBuffDecompress(reinterpret_cast<char*>(out.data()), &outSize, const_cast<char*>(reinterpret_cast<const char*>(data.data())), data.size(), 0, 0);
+				CheckException(status == BZ_OK && outSize == out.size(), "Failed to decompress bzip2 data!");
+				break;
+			}
+			case PackedCodec::Zstd: {
+				std::size_t outSize = ZSTD_decompress(out.data(), out.size(), data.data(), data.size());
+				CheckException(!ZSTD_isError(outSize) && outSize == out.size(), "Failed to decompress Zstandard data!");
+				break;
+			}
+			case PackedCodec::LZ4: {
+				//The whole frame is available, so a single pass through the incremental decompressor is enough
+				StreamDecompressor dec(codec);
+				std::span<const unsigned char> in = data;
+				std::size_t outSize = 0;
+				while(outSize < out.size()) {
+					std::size_t produced = dec.Run(in, out.subspan(outSize));
+					CheckException(produced > 0, "Failed to decompress LZ4 data!");
+					outSize += produced;
+				}
+				break;
+			}
+		}
+	}
+
+	struct StreamDecompressor::State {
+		bz_stream bz {};
+		ZSTD_DCtx* zstd = nullptr;
+		LZ4F_dctx* lz4 = nullptr;
+	};
+
+	StreamDecompressor::StreamDecompressor(PackedCodec codec)
+	  : codec(codec), state(std::make_unique<State>()) {
+		switch(codec) {
+			case PackedCodec::Stored: break;
+			case PackedCodec::Bzip2:
+				CheckException(BZ2_bzDecompressInit(&state->bz, 0, 0) == BZ_OK, "Failed to create bzip2 decompressor!");
+				break;
+			case PackedCodec::Zstd:
+				state->zstd = ZSTD_createDCtx();
+				CheckException(state->zstd != nullptr, "Failed to create Zstandard decompressor!");
+				break;
+			case PackedCodec::LZ4:
+				CheckException(!LZ4F_isError(LZ4F_createDecompressionContext(&state->lz4, LZ4F_VERSION)), "Failed to create LZ4 decompressor!");
+				break;
+		}
+	}
+
+	StreamDecompressor::~StreamDecompressor() {
+		switch(codec) {
+			case PackedCodec::Stored: break;
+			case PackedCodec::Bzip2:
+				BZ2_bzDecompressEnd(&state->bz);
+				break;
+			case PackedCodec::Zstd:
+				ZSTD_freeDCtx(state->zstd);
+				break;
+			case PackedCodec::LZ4:
+				LZ4F_freeDecompressionContext(state->lz4);
+				break;
+		}
+	}
+
+	std::size_t StreamDecompressor::Run(std::span<const unsigned char>& in, std::span<unsigned char> out) {
+		switch(codec) {
+			case PackedCodec::Stored: {
+				std::size_t n = std::min(in.size(), out.size());
+				std::memcpy(out.data(), in.data(), n);
+				in = in.subspan(n);
+				return n;
+			}
+			case PackedCodec::Bzip2: {
+				//The bzip2 stream API is limited to 32-bit sizes per call
+				state->bz.next_in = const_cast<char*>(reinterpret_cast<const char*>(in.data()));
+				state->bz.avail_in = static_cast<unsigned int>(std::min<std::size_t>(in.size(), UINT_MAX));
+				state->bz.next_out = reinterpret_cast<char*>(out.data());
+				state->bz.avail_out = static_cast<unsigned int>(std::min<std::size_t>(out.size(), UINT_MAX));
+				const unsigned int inBefore = state->bz.avail_in, outBefore = state->bz.avail_out;
+				int status = BZ2_bzDecompress(&state->bz);
+				CheckException(status == BZ_OK || status == BZ_STREAM_END, "Failed to decompress bzip2 data!");
+				in = in.subspan(inBefore - state->bz.avail_in);
+				return outBefore - state->bz.avail_out;
+			}
+			case PackedCodec::Zstd: {
+				ZSTD_inBuffer zin {.src = in.data(), .size = in.size(), .pos = 0};
+				ZSTD_outBuffer zout {.dst = out.data(), .size = out.size(), .pos = 0};
+				std::size_t status = ZSTD_decompressStream(state->zstd, &zout, &zin);
+				CheckException(!ZSTD_isError(status), "Failed to decompress Zstandard data!");
+				in = in.subspan(zin.pos);
+				return zout.pos;
+			}
+			case PackedCodec::LZ4: {
+				std::size_t inSize = in.size(), outSize = out.size();
+				std::size_t status = LZ4F_decompress(state->lz4, out.data(), &outSize, in.data(), &inSize, nullptr);
+				CheckException(!LZ4F_isError(status), "Failed to decompress LZ4 data!");
+				in = in.subspan(inSize);
+				return outSize;
+			}
+		}
+		return 0;
+	}
+
+	void DecompressStream(PackedCodec codec, std::istream& stream, uint64_t compressedSize, uint64_t size, std::span<unsigned char> out, const std::function<void(std::span<const unsigned char>)>& sink) {
+		CheckException(out.empty() || out.size() == size, "Output buffer for stream decompression has the wrong size!");
+
+		StreamDecompressor dec(codec);
+		std::vector<unsigned char> inBuf(PackedContainer::streamChunkSize);
+		std::vector<unsigned char> window(out.empty() ? PackedContainer::streamChunkSize : 0);
+		std::span<const unsigned char> in;
+		uint64_t produced = 0;
+		while(produced < size) {
+			//Refill the input chunk once it has been used up
+			bool refilled = false;
+			if(in.empty()) {
+				CheckException(compressedSize > 0, "Compressed data ended before producing all of its output!");
+				stream.read(reinterpret_cast<char*>(inBuf.data()), std::min<uint64_t>(inBuf.size(), compressedSize));
+				std::size_t got = stream.gcount();
+				CheckException(got > 0, "Compressed data stream ended early!");
+				in = std::span<const unsigned char>(inBuf.data(), got);
+				if(compressedSize != UINT64_MAX) compressedSize -= got;
+				refilled = true;
+			}
+
+			//Decompress into whatever output space remains
+			std::span<unsigned char> dest = out.empty() ? std::span<unsigned char>(window).first(std::min<uint64_t>(window.size(), size - produced)) : out.subspan(produced);
+			const std::size_t inBefore = in.size();
+			std::size_t n = dec.Run(in, dest);
+			CheckException(n > 0 || in.size() < inBefore || refilled, "Compressed data ended before producing all of its output!");
+
+			if(n > 0) {
+				if(sink) sink(dest.first(n));
+				produced += n;
+			}
+		}
+
+		//Skip anything left of the compressed data (such as a trailing checksum) so that the stream ends up right after it
+		if(compressedSize != UINT64_MAX && compressedSize > 0) stream.ignore(compressedSize);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "libcacaoformats.hpp"
+
+#include <span>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <istream>
+#include <cstdint>
+
+namespace libcacaoformats {
+	/**
+	 * @brief Convert a codec code from a file to a codec
+	 *
+	 * @throws std::runtime_error If the code is not a known codec
+	 */
+	PackedCodec CodecFromCode(uint8_t code);
+
+	/**
+	 * @brief Compress a block of data
+	 *
+	 * @param codec The codec to compress with
+	 * @param data The data to compress
+	 *
+	 * @return The compressed data
+	 *
+	 * @throws std::runtime_error If the data is too large for the codec or compression fails
+	 */
+	std::vector<unsigned char> Compress(PackedCodec codec, std::span<const unsigned char> data);
+
+	/**
+	 * @brief Get the most data that a codec could possibly decompress out of some amount of compressed data
+	 *
+	 * This is used to reject corrupt decompressed sizes before anything is allocated for them.
+	 *
+	 * @param codec The codec
+	 * @param compressedSize The size of the compressed data
+	 *
+	 * @return The upper bound on the decompressed size
+	 */
+	uint64_t MaxDecompressedSize(PackedCodec codec, uint64_t compressedSize);
+
+	/**
+	 * @brief Decompress a block of data with a known decompressed size
+	 *
+	 * @param codec The codec the data was compressed with
+	 * @param data The compressed data
+	 * @param out The buffer to decompress into, which must be exactly the decompressed size
+	 *
+	 * @throws std::runtime_error If decompression fails or does not produce exactly the expected amount of data
+	 */
+	void Decompress(PackedCodec codec, std::span<const unsigned char> data, std::span<unsigned char> out);
+
+	/**
+	 * @brief Incremental decompressor for data that arrives in pieces
+	 */
+	class StreamDecompressor {
+	  public:
+		/**
+		 * @brief Create a decompressor
+		 *
+		 * @param codec The codec the data was compressed with
+		 *
+		 * @throws std::runtime_error If the decompressor state could not be created
+		 */
+		explicit StreamDecompressor(PackedCodec codec);
+		~StreamDecompressor();
+
+		StreamDecompressor(const StreamDecompressor&) = delete;
+		StreamDecompressor& operator=(const StreamDecompressor&) = delete;
+
+		/**
+		 * @brief Decompress as much of the available input as fits in the output
+		 *
+		 * @param in The available input, which is advanced past whatever was consumed
+		 * @param out The buffer to write output into
+		 *
+		 * @return The number of bytes written to the output
+		 *
+		 * @throws std::runtime_error If the data is corrupted
+		 */
+		std::size_t Run(std::span<const unsigned char>& in, std::span<unsigned char> out);
+
+	  private:
+		struct State;
+		PackedCodec codec;
+		std::unique_ptr<State> state;
+	};
+
+	/**
+	 * @brief Decompress data with a known decompressed size from a stream, reading it in chunks of PackedContainer::streamChunkSize bytes
+	 *
+	 * @param codec The codec the data was compressed with
+	 * @param stream The stream, positioned at the start of the compressed data
+	 * @param compressedSize The size of the compressed data, or UINT64_MAX if it runs to the end of the stream
+	 * @param size The decompressed size
+	 * @param out A buffer of exactly the decompressed size to write into, or an empty span to decompress through a window of PackedContainer::streamChunkSize bytes
+	 * @param sink Function to call with each piece of output as it is produced, which may be empty if an output buffer is provided
+	 *
+	 * @throws std::runtime_error If the stream ends early or the data is corrupted
+	 */
+	void DecompressStream(PackedCodec codec, std::istream& stream, uint64_t compressedSize, uint64_t size, std::span<unsigned char> out, const std::function<void(std::span<const unsigned char>)>& sink);
+}
\ No newline at end of file
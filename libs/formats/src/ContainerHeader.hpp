@@ -0,0 +1,86 @@
+#pragma once
+
+#include "libcacaoformats.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <vector>
+
+namespace libcacaoformats {
+	/*
+	 * Header preceding the payload of every packed container
+	 *
+	 * Revision 0: CA CA 00, format code, uint16 version, uint64 uncompressed size (payload is one bzip2 stream)
+	 * Revision 1: CA CA 01, format code, uint16 version, uint8 codec, uint64 uncompressed size (payload is one stream)
+	 * Revision 2: CA CA 02, format code, uint16 version, uint8 codec, uint64 uncompressed size, uint32 block size, uint32 block count,
+	 *             then the compressed size of each block as a uint64 (payload is a series of independently compressed blocks of block size bytes each, the last one possibly shorter)
+	 *
+	 * Stored payloads have no blocks in revision 2.
+	 */
+	struct ContainerHeader {
+		PackedFormat format;
+		uint16_t version;
+		PackedCodec codec;
+		uint64_t uncompressedSize;
+		uint32_t blockSize;			///<Uncompressed size of each block
+		std::vector<uint64_t> blocks;///<Compressed size of each block, or empty if the payload is a single stream
+		std::size_t size;			///<Size of the header itself, including the block table
+	};
+	constexpr std::size_t legacyContainerHeaderSize = 14;
+	constexpr std::size_t maxFixedContainerHeaderSize = 23;
+
+	/**
+	 * @brief Get the size of the fixed part of a header starting with a magic number
+	 *
+	 * @param magic Pointer to the first three bytes of the header
+	 *
+	 * @return The fixed header size, which does not include the block table
+	 */
+	std::size_t ContainerHeaderSize(const unsigned char* magic);
+
+	/**
+	 * @brief Parse the fixed part of a packed container header
+	 *
+	 * If the header has a block table, the returned header has the right number of blocks, but their sizes are not filled in yet.
+	 *
+	 * @param header Pointer to the header, which must be at least ContainerHeaderSize(header) bytes long
+	 * @param available The number of bytes available starting at the header, or UINT64_MAX if unknown
+	 *
+	 * @return The decoded header
+	 *
+	 * @throws std::runtime_error If the header is not a valid packed container header, or its block table doesn't fit in the available bytes
+	 */
+	ContainerHeader ParseContainerHeader(const unsigned char* header, uint64_t available = UINT64_MAX);
+
+	/**
+	 * @brief Parse the block table following the fixed part of a packed container header
+	 *
+	 * @param table Pointer to the block table, which must be 8 bytes for each block in the header
+	 * @param header The header to fill in
+	 */
+	void ParseBlockTable(const unsigned char* table, ContainerHeader& header);
+
+	/**
+	 * @brief Check that the payload described by a header could fit in the bytes following it
+	 *
+	 * This catches corrupt sizes before the payload is allocated.
+	 *
+	 * @param header The header, including its block table
+	 * @param bodySize The number of bytes following the header, or UINT64_MAX if unknown
+	 *
+	 * @throws std::runtime_error If the payload can't fit
+	 */
+	void CheckPayloadFits(const ContainerHeader& header, uint64_t bodySize);
+
+	/**
+	 * @brief Read and parse a packed container header, including its block table, from a stream
+	 *
+	 * @param stream The stream, positioned at the start of the header
+	 *
+	 * @return The decoded header
+	 *
+	 * @throws std::runtime_error If the stream is invalid, ends early, or does not start with a valid packed container header
+	 */
+	ContainerHeader ReadContainerHeader(std::istream& stream);
+}
\ No newline at end of file
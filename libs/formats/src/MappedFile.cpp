@@ -0,0 +1,65 @@
+#include "MappedFile.hpp"
+
+#include "libcacaocommon.hpp"
+
+#ifdef HAS_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace libcacaoformats {
+#ifdef HAS_WIN32
+	std::shared_ptr<MappedFile> MappedFile::Open(const std::filesystem::path& path) {
+		std::shared_ptr<MappedFile> out(new MappedFile());
+
+		//Open the file
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		CheckException(file != INVALID_HANDLE_VALUE, "Failed to open file for memory mapping!");
+		LARGE_INTEGER size;
+		CheckException(GetFileSizeEx(file, &size) && size.QuadPart > 0, "File to memory map is empty or its size could not be determined!", [file]() { CloseHandle(file); });
+
+		//Map it (the mapping object keeps the file open, so we can close our handle)
+		out->mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		CheckException(out->mapping, "Failed to create file mapping!");
+		out->ptr = static_cast<const unsigned char*>(MapViewOfFile(out->mapping, FILE_MAP_READ, 0, 0, 0));
+		CheckException(out->ptr, "Failed to map view of file!");
+		out->len = static_cast<std::size_t>(size.QuadPart);
+
+		return out;
+	}
+
+	MappedFile::~MappedFile() {
+		if(ptr) UnmapViewOfFile(ptr);
+		if(mapping) CloseHandle(mapping);
+	}
+#else
+	std::shared_ptr<MappedFile> MappedFile::Open(const std::filesystem::path& path) {
+		std::shared_ptr<MappedFile> out(new MappedFile());
+
+		//Open the file
+		int fd = open(path.c_str(), O_RDONLY);
+		CheckException(fd >= 0, "Failed to open file for memory mapping!");
+		struct stat st;
+		CheckException(fstat(fd, &st) == 0 && st.st_size > 0, "File to memory map is empty or its size could not be determined!", [fd]() { close(fd); });
+
+		//Map it (the mapping keeps its own reference to the file, so we can close our descriptor)
+		void* map = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		CheckException(map != MAP_FAILED, "Failed to memory map file!");
+		out->ptr = static_cast<const unsigned char*>(map);
+		out->len = static_cast<std::size_t>(st.st_size);
+
+		return out;
+	}
+
+	MappedFile::~MappedFile() {
+		if(ptr) munmap(const_cast<unsigned char*>(ptr), len);
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace libcacaoformats {
+	/**
+	 * @brief Read-only memory mapping of a whole file
+	 *
+	 * The mapping stays valid until the object is destroyed, so share ownership of it with anything that borrows its data.
+	 */
+	class MappedFile {
+	  public:
+		/**
+		 * @brief Map a file into memory
+		 *
+		 * @param path The path of the file to map
+		 *
+		 * @return The mapped file
+		 *
+		 * @throws std::runtime_error If the file cannot be opened or mapped, or is empty
+		 */
+		static std::shared_ptr<MappedFile> Open(const std::filesystem::path& path);
+
+		///@brief Get the contents of the file
+		std::span<const unsigned char> Data() const {
+			return std::span<const unsigned char>(ptr, len);
+		}
+
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+	  private:
+		MappedFile() {}
+
+		const unsigned char* ptr = nullptr;
+		std::size_t len = 0;
+#ifdef HAS_WIN32
+		void* mapping = nullptr;
+#endif
+	};
+}
\ No newline at end of file
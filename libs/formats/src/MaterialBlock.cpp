@@ -0,0 +1,331 @@
+#include "libcacaoformats.hpp"
+
+#include "libcacaocommon.hpp"
+
+#include "MaterialBlock.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <set>
+#include <type_traits>
+
+namespace libcacaoformats {
+	//Index of the texture reference type in Material::ValueContainer
+	constexpr uint8_t textureTypeIndex = 21;
+
+	//Placement of a parameter type in a block
+	struct BlockTypeLayout {
+		uint32_t size;		   ///<Space taken up in the block, including padding between matrix columns
+		uint32_t footprint;	   ///<Bytes actually written
+		uint32_t align;		   ///<Required offset alignment
+		uint32_t columnStride;///<Distance between matrix columns
+	};
+
+	static BlockTypeLayout GetBlockTypeLayout(uint8_t type, MaterialBlockRules rules) {
+		//Scalars
+		if(type <= 2) return {4, 4, 4, 0};
+
+		//Vectors (three-component vectors are aligned like four-component ones)
+		if(type <= 11) {
+			const uint32_t n = 2 + (type - 3) % 3;
+			return {4 * n, 4 * n, n == 2 ? 8u : 16u, 0};
+		}
+
+		//Matrices are arrays of column vectors, which std140 pads out to 16 bytes
+		const uint32_t rows = 2 + (type - 12) / 3;
+		const uint32_t cols = 2 + (type - 12) % 3;
+		const uint32_t stride = rules == MaterialBlockRules::Std140 || rows > 2 ? 16 : 8;
+		return {stride * cols, stride * (cols - 1) + 4 * rows, stride, stride};
+	}
+
+	static uint32_t AlignUp(uint32_t value, uint32_t align) {
+		return (value + align - 1) / align * align;
+	}
+
+	MaterialLayout ComputeMaterialLayout(const Material& mat, MaterialBlockRules rules) {
+		MaterialLayout out {.rules = rules, .blockSize = 0, .members = {}, .textures = {}};
+
+		//Sort parameters by name so that the layout doesn't depend on map order
+		std::vector<const std::pair<const std::string, Material::ValueContainer>*> sorted;
+		for(const auto& key : mat.keys) sorted.push_back(&key);
+		std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+		uint32_t offset = 0, maxAlign = 4;
+		for(const auto* key : sorted) {
+			const uint8_t type = (uint8_t)key->second.index();
+			if(type == textureTypeIndex) {
+				out.textures.push_back(MaterialLayout::Texture {.name = key->first, .slot = (uint32_t)out.textures.size(), .isCubemap = std::get<Material::TextureRef>(key->second).isCubemap});
+				continue;
+			}
+			BlockTypeLayout tl = GetBlockTypeLayout(type, rules);
+			offset = AlignUp(offset, tl.align);
+			out.members.push_back(MaterialLayout::Member {.name = key->first, .type = type, .offset = offset});
+			offset += tl.size;
+			maxAlign = std::max(maxAlign, tl.align);
+		}
+
+		//Blocks are padded out to their alignment, which is always 16 bytes under std140
+		out.blockSize = AlignUp(offset, rules == MaterialBlockRules::Std140 ? 16 : maxAlign);
+		return out;
+	}
+
+	void ValidateMaterialLayout(const MaterialLayout& layout) {
+		CheckException(layout.rules == MaterialBlockRules::Std140 || layout.rules == MaterialBlockRules::Std430, "Material layout has invalid block rules!");
+		std::set<std::string_view> names;
+		for(const MaterialLayout::Member& member : layout.members) {
+			CheckException(member.type < textureTypeIndex, "Material layout member has out-of-range type!");
+			CheckException(uint64_t(member.offset) + GetBlockTypeLayout(member.type, layout.rules).footprint <= layout.blockSize, "Material layout member does not fit in the block!");
+			CheckException(!member.name.empty() && member.name.size() <= UINT16_MAX && names.insert(member.name).second, "Material layout has an invalid or duplicate parameter name!");
+		}
+		std::set<uint32_t> slots;
+		for(const MaterialLayout::Texture& texture : layout.textures) {
+			CheckException(slots.insert(texture.slot).second, "Material layout has two textures in the same slot!");
+			CheckException(!texture.name.empty() && texture.name.size() <= UINT16_MAX && names.insert(texture.name).second, "Material layout has an invalid or duplicate parameter name!");
+		}
+	}
+
+	void WriteMaterialLayout(const MaterialLayout& layout, std::ostream& out) {
+		ValidateMaterialLayout(layout);
+		const auto put = [&out](const auto& value) {
+			out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+		};
+		const auto putName = [&out, &put](const std::string& name) {
+			put((uint16_t)name.size());
+			out.write(name.data(), name.size());
+		};
+
+		put(uint8_t(layout.rules));
+		put(layout.blockSize);
+		put((uint32_t)layout.members.size());
+		for(const MaterialLayout::Member& member : layout.members) {
+			put(member.type);
+			put(member.offset);
+			putName(member.name);
+		}
+		put((uint32_t)layout.textures.size());
+		for(const MaterialLayout::Texture& texture : layout.textures) {
+			put(texture.slot);
+			put(uint8_t(texture.isCubemap ? 1 : 0));
+			putName(texture.name);
+		}
+	}
+
+	MaterialLayout ReadMaterialLayout(const unsigned char* data, std::size_t size) {
+		std::size_t advance = 0;
+		const auto take = [&](void* dst, std::size_t len) {
+			CheckException(len <= size - advance, "Shader packed container is too small to contain material layout!");
+			std::memcpy(dst, data + advance, len);
+			advance += len;
+		};
+		const auto takeName = [&](std::string& name) {
+			uint16_t len = 0;
+			take(&len, 2);
+			name.resize(len);
+			take(name.data(), len);
+		};
+
+		MaterialLayout out {};
+		uint8_t rules = 0;
+		uint32_t memberCount = 0, textureCount = 0;
+		take(&rules, 1);
+		out.rules = MaterialBlockRules(rules);
+		take(&out.blockSize, 4);
+		take(&memberCount, 4);
+		CheckException(memberCount <= (size - advance) / 7, "Shader packed container is too small to contain material layout!");
+		out.members.resize(memberCount);
+		for(MaterialLayout::Member& member : out.members) {
+			take(&member.type, 1);
+			take(&member.offset, 4);
+			takeName(member.name);
+		}
+		take(&textureCount, 4);
+		CheckException(textureCount <= (size - advance) / 7, "Shader packed container is too small to contain material layout!");
+		out.textures.resize(textureCount);
+		for(MaterialLayout::Texture& texture : out.textures) {
+			uint8_t isCubemap = 0;
+			take(&texture.slot, 4);
+			take(&isCubemap, 1);
+			texture.isCubemap = isCubemap != 0;
+			takeName(texture.name);
+		}
+		ValidateMaterialLayout(out);
+		return out;
+	}
+
+	PackedContainer PackedEncoder::EncodeShader(const std::vector<unsigned char>& ir, const MaterialLayout& layout) {
+		//Create output container
+		std::vector<char> outBuffer;
+		obytestream out(outBuffer);
+
+		//Write blob size and IR blob
+		uint32_t blobSize = (uint32_t)ir.size();
+		out.write(reinterpret_cast<char*>(&blobSize), 4);
+		out.write(reinterpret_cast<const char*>(ir.data()), blobSize);
+
+		//Write material layout
+		WriteMaterialLayout(layout, out);
+
+		//Create and return packed container
+		return PackedContainer(PackedFormat::Shader, 2, std::move(outBuffer));
+	}
+
+	std::optional<MaterialLayout> PackedDecoder::DecodeShaderMaterialLayout(const PackedContainer& container) {
+		CheckException(container.format == PackedFormat::Shader, "Packed container provided for shader decoding is not a shader!");
+		CheckException(container.version <= 2, "Shader packed container is a newer version than is supported!");
+		if(container.version < 2) return std::nullopt;
+
+		//Skip IR blob
+		CheckException(container.payload.size() >= 4, "Shader packed container is too small to contain code data!");
+		uint32_t blobSize = 0;
+		std::memcpy(&blobSize, container.payload.data(), 4);
+		CheckException(container.payload.size() - 4 >= blobSize, "Shader is not large enough to contain code blob of specified size!");
+
+		return ReadMaterialLayout(container.payload.data() + 4 + blobSize, container.payload.size() - 4 - blobSize);
+	}
+
+	PackedContainer PackedEncoder::EncodeMaterial(const Material& mat, const MaterialLayout& layout) {
+		ValidateMaterialLayout(layout);
+
+		//The material must set exactly the parameters in the layout
+		for(const MaterialLayout::Member& member : layout.members) {
+			auto key = mat.keys.find(member.name);
+			CheckException(key != mat.keys.end(), "Material does not set a parameter of its shader!");
+			CheckException(key->second.index() == member.type, "Material parameter has a different type than the shader parameter!");
+		}
+		for(const MaterialLayout::Texture& texture : layout.textures) {
+			auto key = mat.keys.find(texture.name);
+			CheckException(key != mat.keys.end(), "Material does not set a texture of its shader!");
+			CheckException(key->second.index() == textureTypeIndex && std::get<Material::TextureRef>(key->second).isCubemap == texture.isCubemap, "Material texture has a different type than the shader texture!");
+			CheckException(!std::get<Material::TextureRef>(key->second).path.empty() && std::get<Material::TextureRef>(key->second).path.size() <= UINT16_MAX, "Material key for packed encoding has out-of-range texture reference string length!");
+		}
+		CheckException(mat.keys.size() == layout.members.size() + layout.textures.size(), "Material sets a parameter that its shader does not have!");
+
+		//Start with the plain material data so that the output can still be decoded as a regular material
+		PackedContainer base = EncodeMaterial(mat);
+		std::vector<char> outBuffer(base.payload.begin(), base.payload.end());
+		outBuffer.resize(AlignUp((uint32_t)outBuffer.size(), 16), '\0');
+		const uint64_t blockOffset = outBuffer.size();
+		outBuffer.resize(blockOffset + layout.blockSize, '\0');
+
+		//Fill in the block
+		for(const MaterialLayout::Member& member : layout.members) {
+			char* dst = outBuffer.data() + blockOffset + member.offset;
+			const uint32_t stride = GetBlockTypeLayout(member.type, layout.rules).columnStride;
+			std::visit([dst, stride](const auto& value) {
+				using T = std::decay_t<decltype(value)>;
+				if constexpr(std::is_same_v<T, Material::TextureRef>) {
+					return;
+				} else if constexpr(requires { value.data; }) {
+					//Matrices are written a column at a time
+					for(std::size_t c = 0; c < value.data.size(); ++c) std::memcpy(dst + c * stride, value.data[c].data(), sizeof(value.data[c]));
+				} else {
+					std::memcpy(dst, &value, sizeof(value));
+				}
+			},
+				mat.keys.at(member.name));
+		}
+
+		//Write texture table
+		std::vector<const MaterialLayout::Texture*> textures;
+		for(const MaterialLayout::Texture& texture : layout.textures) textures.push_back(&texture);
+		std::sort(textures.begin(), textures.end(), [](const auto* a, const auto* b) { return a->slot < b->slot; });
+		std::vector<char> tableBuffer;
+		obytestream out(tableBuffer);
+		const auto put = [&out](const auto& value) {
+			out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+		};
+		put((uint32_t)textures.size());
+		uint32_t pathOffset = 0;
+		for(const MaterialLayout::Texture* texture : textures) {
+			const std::string& path = std::get<Material::TextureRef>(mat.keys.at(texture->name)).path;
+			put(texture->slot);
+			put(uint8_t(texture->isCubemap ? 1 : 0));
+			put(uint8_t(0));
+			put((uint16_t)path.size());
+			put(pathOffset);
+			pathOffset += (uint32_t)path.size();
+		}
+		for(const MaterialLayout::Texture* texture : textures) {
+			const std::string& path = std::get<Material::TextureRef>(mat.keys.at(texture->name)).path;
+			out.write(path.data(), path.size());
+		}
+
+		//Write footer
+		put(uint8_t(layout.rules));
+		out.write("\0\0\0", 3);
+		put(layout.blockSize);
+		put(blockOffset);
+		outBuffer.insert(outBuffer.end(), tableBuffer.begin(), tableBuffer.end());
+
+		//Create and return packed container
+		return PackedContainer(PackedFormat::Material, 2, std::move(outBuffer));
+	}
+
+	PackedMaterialBlock PackedMaterialBlock::FromContainer(const PackedContainer& container) {
+		CheckException(container.format == PackedFormat::Material, "Packed container provided for material decoding is not a material!");
+		CheckException(container.version >= 2, "Material packed container has no parameter block!");
+		CheckException(container.version == 2, "Material packed container is a newer version than is supported!");
+		const unsigned char* data = container.payload.data();
+		const std::size_t size = container.payload.size();
+		CheckException(size >= materialBlockFooterSize + 6, "Material packed container is too small to contain parameter block footer!");
+
+		//Read footer
+		PackedMaterialBlock out;
+		out.payload = container.payload;
+		const unsigned char* footer = data + size - materialBlockFooterSize;
+		uint32_t blockSize = 0;
+		uint64_t blockOffset = 0;
+		out.rules = MaterialBlockRules(footer[0]);
+		std::memcpy(&blockSize, footer + 4, 4);
+		std::memcpy(&blockOffset, footer + 8, 8);
+		CheckException(out.rules == MaterialBlockRules::Std140 || out.rules == MaterialBlockRules::Std430, "Material packed container has invalid parameter block rules!");
+		const std::size_t tableEnd = size - materialBlockFooterSize;
+		CheckException(blockOffset <= tableEnd && blockSize <= tableEnd - blockOffset && tableEnd - blockOffset - blockSize >= 4, "Material packed container parameter block is out of range!");
+		out.blockOffset = blockOffset;
+		out.blockSize = blockSize;
+
+		//Check the texture table
+		out.textureTableOffset = out.blockOffset + out.blockSize;
+		uint32_t textureCount = 0;
+		std::memcpy(&textureCount, data + out.textureTableOffset, 4);
+		const std::size_t namesOffset = out.textureTableOffset + 4 + std::size_t(textureCount) * materialTextureRecordSize;
+		CheckException(textureCount <= (tableEnd - out.textureTableOffset - 4) / materialTextureRecordSize, "Material packed container is too small to contain texture table!");
+		out.textureCount = textureCount;
+		for(std::size_t i = 0; i < out.textureCount; ++i) {
+			const unsigned char* record = data + out.textureTableOffset + 4 + i * materialTextureRecordSize;
+			uint16_t pathLen = 0;
+			uint32_t pathOffset = 0;
+			std::memcpy(&pathLen, record + 6, 2);
+			std::memcpy(&pathOffset, record + 8, 4);
+			CheckException(uint64_t(pathOffset) + pathLen <= tableEnd - namesOffset, "Material packed container texture path is out of range!");
+		}
+
+		//Check the shader address string
+		uint16_t saLen = 0;
+		std::memcpy(&saLen, data, 2);
+		CheckException(saLen > 0 && 2u + saLen <= out.blockOffset, "Material packed container has invalid shader address string!");
+		return out;
+	}
+
+	std::string_view PackedMaterialBlock::GetShader() const {
+		uint16_t saLen = 0;
+		std::memcpy(&saLen, payload.data(), 2);
+		return std::string_view(reinterpret_cast<const char*>(payload.data()) + 2, saLen);
+	}
+
+	PackedMaterialBlock::TextureSlot PackedMaterialBlock::GetTexture(std::size_t idx) const {
+		CheckException(idx < textureCount, "Material texture index is out of range!");
+		const unsigned char* record = payload.data() + textureTableOffset + 4 + idx * materialTextureRecordSize;
+		const char* names = reinterpret_cast<const char*>(payload.data()) + textureTableOffset + 4 + textureCount * materialTextureRecordSize;
+		TextureSlot out {};
+		uint16_t pathLen = 0;
+		uint32_t pathOffset = 0;
+		std::memcpy(&out.slot, record, 4);
+		out.isCubemap = record[4] != 0;
+		std::memcpy(&pathLen, record + 6, 2);
+		std::memcpy(&pathOffset, record + 8, 4);
+		out.path = std::string_view(names + pathOffset, pathLen);
+		return out;
+	}
+}
\ No newline at end of file
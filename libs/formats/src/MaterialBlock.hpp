@@ -0,0 +1,55 @@
+#pragma once
+
+#include "libcacaoformats.hpp"
+
+#include <ostream>
+
+/*
+ * Precompiled material (version 2) payload layout
+ *
+ * [keys]      The version 1 payload (shader address string and material keys)
+ * [padding]   Zeroes up to a multiple of 16 bytes
+ * [block]     Parameter block, laid out for upload
+ * [textures]  uint32 texture count
+ *             Fixed-size records, sorted by slot:
+ *                 uint32 slot, uint8 is cubemap, uint8 reserved, uint16 path length, uint32 path offset
+ *             Path bytes of every texture, back to back (path offsets are relative to the start of this block)
+ * [footer]    uint8 block rules, 3 reserved bytes, uint32 block size, uint64 block offset
+ *
+ * Material layouts are stored after the IR blob in version 2 shaders:
+ *
+ * uint8 block rules, uint32 block size
+ * uint32 member count, then per member: uint8 type index, uint32 offset, uint16 name length, name bytes
+ * uint32 texture count, then per texture: uint32 slot, uint8 is cubemap, uint16 name length, name bytes
+ */
+
+namespace libcacaoformats {
+	inline constexpr std::size_t materialBlockFooterSize = 16;
+	inline constexpr std::size_t materialTextureRecordSize = 12;
+
+	/**
+	 * @brief Check that a material layout is usable
+	 *
+	 * @throws std::runtime_error If a member has an out-of-range type or does not fit in the block, or if two textures share a name or slot
+	 */
+	void ValidateMaterialLayout(const MaterialLayout& layout);
+
+	/**
+	 * @brief Serialize a material layout
+	 *
+	 * @throws std::runtime_error If the layout is invalid
+	 */
+	void WriteMaterialLayout(const MaterialLayout& layout, std::ostream& out);
+
+	/**
+	 * @brief Deserialize a material layout
+	 *
+	 * @param data Pointer to the start of the layout
+	 * @param size The number of bytes available
+	 *
+	 * @return The layout
+	 *
+	 * @throws std::runtime_error If the data is too small or the layout is invalid
+	 */
+	MaterialLayout ReadMaterialLayout(const unsigned char* data, std::size_t size);
+}
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "libcacaoformats.hpp"
 
-#include "bzlib.h"
 #include "libcacaocommon.hpp"
+#include "Codec.hpp"
+#include "ContainerHeader.hpp"
+#include "MappedFile.hpp"
+#include "Parallel.hpp"
 
 #include <cstdint>
+#include <algorithm>
 #include <bit>
 
 namespace libcacaoformats {
@@ -13,103 +17,298 @@ namespace libcacaoformats {
 		return out;
 	}
 
-	std::vector<char> Sign(const std::vector<unsigned char>& vec) {
-		std::vector<char> out(vec.size());
-		std::memcpy(out.data(), vec.data(), vec.size() * sizeof(char));
-		return out;
+	PackedPayload::PackedPayload(std::vector<unsigned char> data) {
+		auto owned = std::make_shared<const std::vector<unsigned char>>(std::move(data));
+		ptr = owned->data();
+		len = owned->size();
+		owner = std::move(owned);
+	}
+
+	PackedPayload PackedPayload::Slice(std::size_t offset, std::size_t length) const {
+		CheckException(offset <= len && length <= len - offset, "Payload slice is out of range!");
+		return PackedPayload(std::span<const unsigned char>(ptr + offset, length), owner);
+	}
+
+	PackedCodec PackedContainer::DefaultCodec(PackedFormat format) {
+		switch(format) {
+			case PackedFormat::Cubemap:
+				//Faces are already WebP-compressed, and GPU-compressed faces are uploaded straight out of the payload
+				return PackedCodec::Stored;
+			case PackedFormat::AssetPack:
+				//Entries are compressed individually so that they can be read without decompressing the whole pack
+				return PackedCodec::Stored;
+			case PackedFormat::Shader:
+			case PackedFormat::Material:
+				return PackedCodec::LZ4;
+			case PackedFormat::World:
+				return PackedCodec::Zstd;
+		}
+		return PackedCodec::Zstd;
 	}
 
 	PackedContainer::PackedContainer(PackedFormat format, uint16_t ver, std::vector<unsigned char>&& data)
-	  : format(format), version(ver), payload(data) {
+	  : format(format), version(ver), payload(std::move(data)), codec(DefaultCodec(format)) {
 		CheckException(payload.size() > 0, "Cannot make empty PackedContainer!");
 	}
 
 	PackedContainer::PackedContainer(PackedFormat format, uint16_t ver, std::vector<char>&& data)
-	  : format(format), version(ver), payload(Unsign(data)) {
+	  : format(format), version(ver), payload(Unsign(data)), codec(DefaultCodec(format)) {
+		CheckException(payload.size() > 0, "Cannot make empty PackedContainer!");
+	}
+
+	PackedContainer::PackedContainer(PackedFormat format, uint16_t ver, PackedPayload&& data)
+	  : format(format), version(ver), payload(std::move(data)), codec(DefaultCodec(format)) {
 		CheckException(payload.size() > 0, "Cannot make empty PackedContainer!");
 	}
 
+	PackedContainer::PackedContainer(PackedFormat format, uint16_t ver, PackedPayload&& data, PackedCodec codec)
+	  : format(format), version(ver), payload(std::move(data)), codec(codec) {
+		CheckException(payload.size() > 0, "Cannot make empty PackedContainer!");
+	}
+
+	PackedContainer PackedContainer::WithCodec(PackedCodec newCodec) const {
+		return PackedContainer(format, version, PackedPayload(payload), newCodec);
+	}
+
 	PackedContainer PackedContainer::FromAsset(const PackedAsset& asset) {
 		CheckException(asset.kind == PackedAsset::Kind::Cubemap || asset.kind == PackedAsset::Kind::Material || asset.kind == PackedAsset::Kind::Shader, "Cannot make PackedContainer from asset that is not a cubemap, material, or shader!");
 
-		//Create buffer and stream
-		std::vector<char> buffer = Sign(asset.buffer);
-		ibytestream stream(buffer);
-		return FromStream(stream);
+		//Parse straight out of the asset buffer, keeping it alive for as long as the payload borrows from it
+		return FromMemory(asset.buffer.span(), std::make_shared<const PackedPayload>(asset.buffer));
 	}
 
-	PackedContainer PackedContainer::FromStream(std::istream& stream) {
-		CheckException(stream.good(), "Data stream for packed container is invalid!");
+	ContainerHeader ParseContainerHeader(const unsigned char* header, uint64_t available) {
+		//Check Cacao Engine header
+		CheckException((header[0] & 0xCA) == 0xCA && (header[1] & 0xCA) == 0xCA && header[2] <= 0x02, "Stream is not of a Cacao Engine packed object!");
 
-		//Read 3 bytes to check Cacao Engine header
-		std::string ceHeader(3, '\0');
-		stream.read(ceHeader.data(), ceHeader.size());
-		CheckException((static_cast<unsigned char>(ceHeader[0]) & 0xCA) == 0xCA && (static_cast<unsigned char>(ceHeader[1]) & 0xCA) == 0xCA && (static_cast<unsigned char>(ceHeader[2]) | 0x00) == 0x00, "Stream is not of a Cacao Engine packed object!");
-
-		//Read next byte to check file type
-		unsigned char type;
-		stream.read(reinterpret_cast<char*>(&type), 1);
-		PackedFormat format;
-		switch(type) {
+		//Check file type
+		ContainerHeader out {};
+		switch(header[3]) {
 			case 0xC4:
-				format = PackedFormat::Cubemap;
+				out.format = PackedFormat::Cubemap;
 				break;
 			case 0x1B:
-				format = PackedFormat::Shader;
+				out.format = PackedFormat::Shader;
 				break;
 			case 0x3E:
-				format = PackedFormat::Material;
+				out.format = PackedFormat::Material;
 				break;
 			case 0xAA:
-				format = PackedFormat::AssetPack;
+				out.format = PackedFormat::AssetPack;
 				break;
 			case 0x7A:
-				format = PackedFormat::World;
+				out.format = PackedFormat::World;
 				break;
 			default:
-				format = PackedFormat::Material;//I have to set something here to avoid a compiler warning
 				CheckException(false, "Stream is not a valid Cacao Engine format!");
 				break;
 		}
 
-		//Get format version
-		uint16_t version = 0;
-		stream.read(reinterpret_cast<char*>(&version), 2);
+		//Get format version, codec, and buffer size
+		std::memcpy(&out.version, header + 4, 2);
+		if(header[2] == 0x00) {
+			out.codec = PackedCodec::Bzip2;
+			std::memcpy(&out.uncompressedSize, header + 6, 8);
+			out.size = legacyContainerHeaderSize;
+			return out;
+		}
+		out.codec = CodecFromCode(header[6]);
+		std::memcpy(&out.uncompressedSize, header + 7, 8);
+		out.size = ContainerHeaderSize(header);
+		if(header[2] == 0x01) return out;
+
+		//Get block layout
+		uint32_t blockCount = 0;
+		std::memcpy(&out.blockSize, header + 15, 4);
+		std::memcpy(&blockCount, header + 19, 4);
+		if(out.codec == PackedCodec::Stored) {
+			CheckException(blockCount == 0, "Stored packed container payload has a block table!");
+		} else {
+			CheckException(out.blockSize > 0 && blockCount > 0 && blockCount == (out.uncompressedSize + out.blockSize - 1) / out.blockSize, "Packed container block table does not match the payload size!");
+		}
+		CheckException(available >= out.size && (available - out.size) / sizeof(uint64_t) >= blockCount, "Buffer is too small to contain the packed container block table!");
+		out.blocks.resize(blockCount);
+		out.size += blockCount * sizeof(uint64_t);
+
+		return out;
+	}
+
+	void ParseBlockTable(const unsigned char* table, ContainerHeader& header) {
+		std::memcpy(header.blocks.data(), table, header.blocks.size() * sizeof(uint64_t));
+	}
+
+	void CheckPayloadFits(const ContainerHeader& header, uint64_t bodySize) {
+		if(header.blocks.empty()) {
+			if(header.codec == PackedCodec::Stored) CheckException(header.uncompressedSize <= bodySize, "Packed container payload is truncated!");
+			CheckException(header.uncompressedSize <= MaxDecompressedSize(header.codec, bodySize), "Packed container payload is too small for its decompressed size!");
+			return;
+		}
+
+		//Every block but the last decompresses to the full block size
+		uint64_t compressed = 0;
+		for(std::size_t i = 0; i < header.blocks.size(); ++i) {
+			CheckException(header.blocks[i] <= bodySize - compressed, "Packed container payload is truncated!");
+			compressed += header.blocks[i];
+			const uint64_t size = std::min<uint64_t>(header.blockSize, header.uncompressedSize - uint64_t(i) * header.blockSize);
+			CheckException(size <= MaxDecompressedSize(header.codec, header.blocks[i]), "Packed container block is too small for its decompressed size!");
+		}
+	}
+
+	//Get the number of bytes left in a stream, or UINT64_MAX if it can't be measured (e.g. because it can't seek)
+	uint64_t RemainingStreamSize(std::istream& stream) {
+		const std::istream::pos_type at = stream.tellg();
+		if(at == std::istream::pos_type(-1)) return UINT64_MAX;
+		stream.seekg(0, std::ios::end);
+		const std::istream::pos_type end = stream.tellg();
+		stream.clear();
+		stream.seekg(at);
+		return end == std::istream::pos_type(-1) || end < at ? UINT64_MAX : uint64_t(end - at);
+	}
+
+	std::size_t ContainerHeaderSize(const unsigned char* magic) {
+		switch(magic[2]) {
+			case 0x00: return legacyContainerHeaderSize;
+			case 0x01: return 15;
+			default: return maxFixedContainerHeaderSize;
+		}
+	}
+
+	ContainerHeader ReadContainerHeader(std::istream& stream) {
+		CheckException(stream.good(), "Data stream for packed container is invalid!");
+		const uint64_t available = RemainingStreamSize(stream);
 
-		//Get buffer size
-		uint64_t uncompressedSize = 0;
-		stream.read(reinterpret_cast<char*>(&uncompressedSize), 8);
-		std::vector<unsigned char> uncompressed(uncompressedSize);
+		//Read the fixed part, which is at least as long as a legacy header
+		unsigned char headerBuf[maxFixedContainerHeaderSize];
+		stream.read(reinterpret_cast<char*>(headerBuf), legacyContainerHeaderSize);
+		CheckException(stream.gcount() == legacyContainerHeaderSize, "Stream is too small to contain a packed container header!");
+		const std::size_t fixedSize = ContainerHeaderSize(headerBuf);
+		if(fixedSize > legacyContainerHeaderSize) {
+			stream.read(reinterpret_cast<char*>(headerBuf) + legacyContainerHeaderSize, fixedSize - legacyContainerHeaderSize);
+			CheckException(std::size_t(stream.gcount()) == fixedSize - legacyContainerHeaderSize, "Stream is too small to contain a packed container header!");
+		}
+		ContainerHeader header = ParseContainerHeader(headerBuf, available);
 
-		{
-			//Get compressed payload size
-			std::streampos at = stream.tellg();
-			stream.seekg(0, std::ios::end);
-			std::size_t compressedSize = stream.tellg();
-			stream.seekg(at);
+		//Read the block table
+		if(!header.blocks.empty()) {
+			std::vector<unsigned char> table(header.blocks.size() * sizeof(uint64_t));
+			stream.read(reinterpret_cast<char*>(table.data()), table.size());
+			CheckException(std::size_t(stream.gcount()) == table.size(), "Stream is too small to contain the packed container block table!");
+			ParseBlockTable(table.data(), header);
+		}
+		if(available != UINT64_MAX) CheckPayloadFits(header, available - header.size);
+		return header;
+	}
 
-			//Read compressed payload
-			std::vector<unsigned char> compressed(compressedSize);
-			stream.read(reinterpret_cast<char*>(compressed.data()), compressedSize);
+	//Decompresses a payload from a stream, one block at a time if it has them
+	void DecompressPayload(const ContainerHeader& header, std::istream& stream, std::span<unsigned char> out, const std::function<void(std::span<const unsigned char>)>& sink) {
+		if(header.blocks.empty()) {
+			DecompressStream(header.codec, stream, UINT64_MAX, header.uncompressedSize, out, sink);
+			return;
+		}
+		for(std::size_t i = 0; i < header.blocks.size(); ++i) {
+			const uint64_t start = uint64_t(i) * header.blockSize;
+			const uint64_t size = std::min<uint64_t>(header.blockSize, header.uncompressedSize - start);
+			DecompressStream(header.codec, stream, header.blocks[i], size, out.empty() ? out : out.subspan(start, size), sink);
+		}
+	}
 
-			//Decompress payload
-			unsigned int bzOutSizeSink = uncompressedSize;
-			int status = BZ2_bzBuffToBuffDecompress(reinterpret_cast<char*>(uncompressed.data()), &bzOutSizeSink, reinterpret_cast<char*>(compressed.data()), compressedSize, 0, 0);
-			CheckException(status == BZ_OK, "Failed to decompress packed container payload!");
+	PackedContainer PackedContainer::FromStream(std::istream& stream) {
+		//Read header
+		ContainerHeader header = ReadContainerHeader(stream);
+		CheckException(header.uncompressedSize > 0, "Cannot make empty PackedContainer!");
+		std::vector<unsigned char> uncompressed(header.uncompressedSize);
+
+		if(header.codec == PackedCodec::Stored) {
+			//Read payload as-is
+			stream.read(reinterpret_cast<char*>(uncompressed.data()), header.uncompressedSize);
+			CheckException(static_cast<uint64_t>(stream.gcount()) == header.uncompressedSize, "Packed container payload is truncated!");
+		} else {
+			//Decompress payload as it is read
+			DecompressPayload(header, stream, uncompressed, {});
 		}
 
 		//Create output
-		PackedContainer out(format, version, std::move(uncompressed));
+		PackedContainer out(header.format, header.version, PackedPayload(std::move(uncompressed)), header.codec);
 
 		//Return output
 		return out;
 	}
 
-	void PackedContainer::ExportToStream(std::ostream& stream) {
+	PackedContainer::Header PackedContainer::StreamPayload(std::istream& stream, const std::function<void(const Header&, std::span<const unsigned char>)>& chunkCallback) {
+		CheckException(static_cast<bool>(chunkCallback), "Chunk callback for packed container streaming is empty!");
+
+		//Read header
+		ContainerHeader header = ReadContainerHeader(stream);
+		Header out {.format = header.format, .version = header.version, .codec = header.codec, .payloadSize = header.uncompressedSize};
+
+		//Stream payload through a small window
+		DecompressPayload(header, stream, {}, [&out, &chunkCallback](std::span<const unsigned char> chunk) {
+			chunkCallback(out, chunk);
+		});
+
+		return out;
+	}
+
+	PackedContainer PackedContainer::FromMemory(std::span<const unsigned char> data, std::shared_ptr<const void> owner, unsigned int threads) {
+		CheckException(data.size() >= legacyContainerHeaderSize && data.size() >= ContainerHeaderSize(data.data()), "Buffer is too small to contain a packed container header!");
+
+		//Read header
+		ContainerHeader header = ParseContainerHeader(data.data(), data.size());
+		CheckException(data.size() >= header.size, "Buffer is too small to contain the packed container block table!");
+		if(!header.blocks.empty()) ParseBlockTable(data.data() + (header.size - header.blocks.size() * sizeof(uint64_t)), header);
+		std::span<const unsigned char> body = data.subspan(header.size);
+		CheckPayloadFits(header, body.size());
+
+		if(header.codec == PackedCodec::Stored) {
+			//Borrow the payload directly
+			return PackedContainer(header.format, header.version, PackedPayload(body.first(header.uncompressedSize), std::move(owner)), header.codec);
+		}
+
+		//Decompress payload straight out of the buffer
+		std::vector<unsigned char> uncompressed(header.uncompressedSize);
+		if(header.blocks.empty()) {
+			Decompress(header.codec, body, uncompressed);
+		} else {
+			//Find where each block starts
+			std::vector<uint64_t> offsets(header.blocks.size());
+			uint64_t offset = 0;
+			for(std::size_t i = 0; i < header.blocks.size(); ++i) {
+				offsets[i] = offset;
+				offset += header.blocks[i];
+			}
+
+			//Blocks are independent, so they can be decompressed all at once
+			ParallelFor(header.blocks.size(), threads, [&](std::size_t i) {
+				const uint64_t start = uint64_t(i) * header.blockSize;
+				const uint64_t size = std::min<uint64_t>(header.blockSize, header.uncompressedSize - start);
+				Decompress(header.codec, body.subspan(offsets[i], header.blocks[i]), std::span<unsigned char>(uncompressed).subspan(start, size));
+			});
+		}
+
+		return PackedContainer(header.format, header.version, PackedPayload(std::move(uncompressed)), header.codec);
+	}
+
+	PackedContainer PackedContainer::FromFile(const std::filesystem::path& path, unsigned int threads) {
+		std::shared_ptr<MappedFile> map = MappedFile::Open(path);
+		std::span<const unsigned char> data = map->Data();
+		return FromMemory(data, std::move(map), threads);
+	}
+
+	void PackedContainer::ExportToStream(std::ostream& stream, unsigned int threads) {
 		CheckException(stream.good(), "Output stream for packed container export is invalid!");
 
-		//Write Cacao Engine magic number
-		constexpr unsigned int magic = (std::endian::native == std::endian::little ? 0x00CACA : 0xCACA00);
+		//Compress payload in independent blocks
+		std::vector<std::vector<unsigned char>> blocks;
+		if(codec != PackedCodec::Stored) {
+			blocks.resize((payload.size() + compressionBlockSize - 1) / compressionBlockSize);
+			CheckException(blocks.size() <= UINT32_MAX, "Payload is too large for packed container export!");
+			ParallelFor(blocks.size(), threads, [this, &blocks](std::size_t i) {
+				blocks[i] = Compress(codec, payload.span().subspan(i * compressionBlockSize, std::min(compressionBlockSize, payload.size() - i * compressionBlockSize)));
+			});
+		}
+
+		//Write Cacao Engine magic number (header revision 2)
+		constexpr unsigned int magic = (std::endian::native == std::endian::little ? 0x02CACA : 0xCACA02);
 		stream.write(reinterpret_cast<const char*>(&magic), 3);
 
 		//Write format code
@@ -136,22 +335,34 @@ namespace libcacaoformats {
 		//Write version
 		stream.write(reinterpret_cast<const char*>(&version), 2);
 
+		//Write codec
+		stream.write(reinterpret_cast<const char*>(&codec), 1);
+
 		//Write buffer size
-		std::size_t bufSize = payload.size() * sizeof(unsigned char);
-		stream.write(reinterpret_cast<char*>(&bufSize), sizeof(std::size_t));
+		uint64_t bufSize = payload.size() * sizeof(unsigned char);
+		stream.write(reinterpret_cast<char*>(&bufSize), sizeof(uint64_t));
 
-		//Compress payload
-		std::vector<unsigned char> compressed(bufSize * 1.01 + 600);
-		unsigned int destSize = compressed.size();																																		  //This size ratio comes from the bzip2 docs
-		int status = BZ2_bzBuffToBuffCompress(reinterpret_cast<char*>(compressed.data()), &destSize, const_cast<char*>(reinterpret_cast<const char*>(payload.data())), bufSize, 9, 0, 30);//9 is the compression level, which is the default from the bzip2 command-line tool. 30 is the recommended work factor by the bzip2 docs.
-		CheckException(status == BZ_OK, "Failed to compress payload for packed container export!");
+		//Write block table
+		uint32_t blockSize = blocks.empty() ? 0 : compressionBlockSize;
+		uint32_t blockCount = blocks.size();
+		stream.write(reinterpret_cast<char*>(&blockSize), 4);
+		stream.write(reinterpret_cast<char*>(&blockCount), 4);
+		for(const std::vector<unsigned char>& block : blocks) {
+			uint64_t blockLen = block.size();
+			stream.write(reinterpret_cast<char*>(&blockLen), sizeof(uint64_t));
+		}
 
-		//Trim compressed data to free any memory not used
-		compressed.resize(destSize);
-		compressed.shrink_to_fit();
+		//Write payload as-is if it shouldn't be compressed
+		if(codec == PackedCodec::Stored) {
+			stream.write(reinterpret_cast<const char*>(payload.data()), bufSize);
+			stream << std::flush;
+			return;
+		}
 
 		//Write compressed data
-		stream.write(reinterpret_cast<char*>(compressed.data()), compressed.size());
+		for(const std::vector<unsigned char>& block : blocks) {
+			stream.write(reinterpret_cast<const char*>(block.data()), block.size());
+		}
 
 		//Flush output
 		stream << std::flush;
@@ -2,74 +2,112 @@
 
 #include "libcacaocommon.hpp"
 #include "YAMLValidate.hpp"
+#include "AssetPackTOC.hpp"
+#include "WorldColumns.hpp"
+#include "Parallel.hpp"
 
+#include <bit>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <exception>
 
 #define LIBARCHIVE_STATIC
 #include "archive.h"
 #include "archive_entry.h"
 
 namespace libcacaoformats {
-	std::array<libcacaoimage::Image, 6> PackedDecoder::DecodeCubemap(const PackedContainer& container) {
+	//Locate the encoded face images in a cubemap payload
+	std::array<std::span<const unsigned char>, 6> CubemapFaceData(const PackedContainer& container) {
 		CheckException(container.format == PackedFormat::Cubemap, "Packed container provided for cubemap decoding is not a cubemap!");
+		CheckException(container.version < 2, "Cubemap packed container holds GPU-compressed faces, which must be decoded with DecodeCompressedCubemap!");
 		CheckException(container.payload.size() > 48, "Cubemap packed container is too small to contain face size data!");
 
 		//Get buffer sizes
-		uint64_t pxs, nxs, pys, nys, pzs, nzs;
-		std::memcpy(&pxs, container.payload.data(), 8);
-		std::memcpy(&nxs, container.payload.data() + 8, 8);
-		std::memcpy(&pys, container.payload.data() + 16, 8);
-		std::memcpy(&nys, container.payload.data() + 24, 8);
-		std::memcpy(&pzs, container.payload.data() + 32, 8);
-		std::memcpy(&nzs, container.payload.data() + 40, 8);
-
-		//Extract encoded face buffers
-		std::vector<char> pxFB(pxs), nxFB(nxs), pyFB(pys), nyFB(nys), pzFB(pzs), nzFB(nzs);
+		std::array<uint64_t, 6> sizes;
+		std::memcpy(sizes.data(), container.payload.data(), 48);
+
+		//Slice out face buffers
+		std::array<std::span<const unsigned char>, 6> out {};
 		std::size_t offsetCounter = 48;
-		CheckException(container.payload.size() >= (48 + pxs + nxs + pys + nys + pzs + nzs), "Cubemap packed container is too small to contain face data of given sizes!");
-		std::memcpy(pxFB.data(), container.payload.data() + offsetCounter, pxs);
-		offsetCounter += pxs;
-		std::memcpy(nxFB.data(), container.payload.data() + offsetCounter, nxs);
-		offsetCounter += nxs;
-		std::memcpy(pyFB.data(), container.payload.data() + offsetCounter, pys);
-		offsetCounter += pys;
-		std::memcpy(nyFB.data(), container.payload.data() + offsetCounter, nys);
-		offsetCounter += nys;
-		std::memcpy(pzFB.data(), container.payload.data() + offsetCounter, pzs);
-		offsetCounter += pzs;
-		std::memcpy(nzFB.data(), container.payload.data() + offsetCounter, nzs);
-		offsetCounter += nzs;
-
-		//Decode face buffers
+		for(std::size_t i = 0; i < 6; ++i) {
+			CheckException(sizes[i] <= container.payload.size() - offsetCounter, "Cubemap packed container is too small to contain face data of given sizes!");
+			out[i] = container.payload.span().subspan(offsetCounter, sizes[i]);
+			offsetCounter += sizes[i];
+		}
+		return out;
+	}
+
+	//Decode an encoded image straight from the payload memory
+	libcacaoimage::Image DecodeImageData(std::span<const unsigned char> data) {
+		return libcacaoimage::decode::DecodeGeneric(data);
+	}
+
+	std::array<libcacaoimage::Image, 6> PackedDecoder::DecodeCubemap(const PackedContainer& container, unsigned int threads) {
+		std::array<std::span<const unsigned char>, 6> faces = CubemapFaceData(container);
+
+		//Decode face buffers (faces are independent, so this can happen in parallel)
 		std::array<libcacaoimage::Image, 6> out {};
-		ibytestream pxStream(pxFB);
-		out[0] = libcacaoimage::decode::DecodeGeneric(pxStream);
-		ibytestream nxStream(nxFB);
-		out[1] = libcacaoimage::decode::DecodeGeneric(nxStream);
-		ibytestream pyStream(pyFB);
-		out[2] = libcacaoimage::decode::DecodeGeneric(pyStream);
-		ibytestream nyStream(nyFB);
-		out[3] = libcacaoimage::decode::DecodeGeneric(nyStream);
-		ibytestream pzStream(pzFB);
-		out[4] = libcacaoimage::decode::DecodeGeneric(pzStream);
-		ibytestream nzStream(nzFB);
-		out[5] = libcacaoimage::decode::DecodeGeneric(nzStream);
+		ParallelFor(6, threads, [&faces, &out](std::size_t i) {
+			out[i] = DecodeImageData(faces[i]);
+		});
 
 		//Return result
 		return out;
 	}
 
+	bool PackedDecoder::IsCompressedCubemap(const PackedContainer& container) {
+		CheckException(container.format == PackedFormat::Cubemap, "Packed container provided for cubemap decoding is not a cubemap!");
+		return container.version >= 2;
+	}
+
+	CompressedCubemap PackedDecoder::DecodeCompressedCubemap(const PackedContainer& container) {
+		CheckException(container.format == PackedFormat::Cubemap, "Packed container provided for cubemap decoding is not a cubemap!");
+		CheckException(container.version >= 2, "Cubemap packed container holds encoded images, which must be decoded with DecodeCubemap!");
+		CheckException(container.payload.size() >= 16, "Cubemap packed container is too small to contain compressed face data!");
+
+		//Read header
+		uint8_t compression = 0, flags = 0;
+		uint16_t mipLevels = 0;
+		uint32_t w = 0, h = 0;
+		std::memcpy(&compression, container.payload.data(), 1);
+		std::memcpy(&flags, container.payload.data() + 1, 1);
+		std::memcpy(&mipLevels, container.payload.data() + 2, 2);
+		std::memcpy(&w, container.payload.data() + 4, 4);
+		std::memcpy(&h, container.payload.data() + 8, 4);
+		CheckException(compression >= 1 && compression <= 3, "Cubemap packed container has an unknown block compression format!");
+		CheckException(w > 0 && h > 0, "Cubemap packed container has zero face dimensions!");
+		CheckException(w <= CompressedCubemap::maxSize && h <= CompressedCubemap::maxSize, "Cubemap packed container has face dimensions larger than the supported maximum!");
+		CheckException(mipLevels > 0 && mipLevels <= std::bit_width(std::max(w, h)), "Cubemap packed container has an invalid mip level count!");
+
+		CompressedCubemap out {.compression = BlockCompression(compression), .srgb = (flags & 1) != 0, .w = w, .h = h, .faces = {}};
+
+		//Slice out levels, which are stored face by face
+		std::size_t offsetCounter = 16;
+		for(std::vector<PackedPayload>& face : out.faces) {
+			face.reserve(mipLevels);
+			for(std::size_t level = 0; level < mipLevels; ++level) {
+				const uint64_t size = out.LevelSize(level);
+				CheckException(size <= uint64_t(container.payload.size() - offsetCounter), "Cubemap packed container is too small to contain compressed face data of given dimensions!");
+				face.push_back(container.payload.Slice(offsetCounter, size));
+				offsetCounter += size;
+			}
+		}
+		return out;
+	}
+
 	std::vector<unsigned char> PackedDecoder::DecodeShader(const PackedContainer& container) {
 		CheckException(container.format == PackedFormat::Shader, "Packed container provided for shader decoding is not a shader!");
-		CheckException(container.payload.size() > 5, "Shader packed container is too small to contain code data!");
+		CheckException(container.payload.size() >= 5, "Shader packed container is too small to contain code data!");
 
 		//Get blob size
 		uint32_t blobSize = 0;
 		std::memcpy(&blobSize, container.payload.data(), 4);
 		CheckException(blobSize > 0, "Shader packed container has no code!");
-		CheckException(container.payload.size() > (4 + blobSize), "Shader is not large enough to contain code blob of specified size!");
+		CheckException(container.payload.size() - 4 >= blobSize, "Shader is not large enough to contain code blob of specified size!");
 
 		//Create result
 		std::vector<unsigned char> blob(blobSize);
@@ -92,7 +130,7 @@ namespace libcacaoformats {
 		std::memcpy(&saLen, container.payload.data(), 2);
 		CheckException(saLen > 0, "Material packed container has zero-length shader address string");
 		CheckException(container.payload.size() > 2 + saLen, "Material packed container is too small to contain shader address string!");
-		out.shader = std::string("\0", saLen);
+		out.shader = std::string(saLen, '\0');
 		std::memcpy(out.shader.data(), container.payload.data() + 2, saLen);
 
 		//Get material keys count
@@ -109,8 +147,8 @@ namespace libcacaoformats {
 			CheckException(container.payload.size() > offsetCounter + 1, "Material packed container is too small to contain key name length!");
 			uint8_t keyNameLen = 0;
 			std::memcpy(&keyNameLen, container.payload.data() + offsetCounter++, 1);
-			CheckException(container.payload.size() > offsetCounter + 1, "Material packed container is too small to contain key name string of provided length!");
-			std::string keyName("\0", keyNameLen);
+			CheckException(container.payload.size() > offsetCounter + keyNameLen, "Material packed container is too small to contain key name string of provided length!");
+			std::string keyName(keyNameLen, '\0');
 			std::memcpy(keyName.data(), container.payload.data() + offsetCounter, keyNameLen);
 			offsetCounter += keyNameLen;
 
@@ -479,11 +517,12 @@ namespace libcacaoformats {
 					break;
 				case 3: {
 					Material::TextureRef ref {};
-					CheckException(container.payload.size() > offsetCounter + 1, "Material packed container key is too small to contain texture reference string length!");
-					uint8_t texLen = 0;
-					std::memcpy(&texLen, container.payload.data() + offsetCounter++, 1);
-					CheckException(container.payload.size() > offsetCounter + 1, "Material packed container key is too small to contain texture reference string of provided length!");
-					ref.path = std::string("\0", texLen);
+					uint16_t texLen = 0;
+					CheckException(container.payload.size() > offsetCounter + 2, "Material packed container key is too small to contain texture reference string length!");
+					std::memcpy(&texLen, container.payload.data() + offsetCounter, 2);
+					offsetCounter += 2;
+					CheckException(container.payload.size() >= offsetCounter + texLen, "Material packed container key is too small to contain texture reference string of provided length!");
+					ref.path = std::string(texLen, '\0');
 					std::memcpy(ref.path.data(), container.payload.data() + offsetCounter, texLen);
 					offsetCounter += texLen;
 					ref.isCubemap = (typeInfo & 0b01000000) > 0;
@@ -501,6 +540,14 @@ namespace libcacaoformats {
 
 	World PackedDecoder::DecodeWorld(const PackedContainer& container) {
 		CheckException(container.format == PackedFormat::World, "Packed container provided for world decoding is not a world!");
+
+		//Newer worlds are column-oriented
+		if(container.version >= 2) {
+			WorldColumns columns;
+			DecodeWorldColumns(container, columns);
+			return ColumnsToWorld(columns);
+		}
+
 		CheckException(container.payload.size() > 2, "World packed container is too small to contain skybox address string size data!");
 
 		World out {};
@@ -515,7 +562,7 @@ namespace libcacaoformats {
 			out.skyboxRef = "";
 		} else {
 			CheckException(container.payload.size() > 2 + saLen, "World packed container is too small to contain skybox address string!");
-			out.skyboxRef = std::string("\0", saLen);
+			out.skyboxRef = std::string(saLen, '\0');
 			std::memcpy(out.skyboxRef.data(), container.payload.data() + 2, saLen);
 			advance += saLen;
 		}
@@ -568,7 +615,7 @@ namespace libcacaoformats {
 			advance += 2;
 			CheckException(nameLen > 0, "World packed container actor data has zero-length name string");
 			CheckException(container.payload.size() > advance + nameLen, "World packed container actor data is too small to contain name string!");
-			ent.name = std::string("\0", nameLen);
+			ent.name = std::string(nameLen, '\0');
 			std::memcpy(ent.name.data(), container.payload.data() + advance, nameLen);
 			advance += nameLen;
 
@@ -611,7 +658,7 @@ namespace libcacaoformats {
 				advance += 2;
 				CheckException(typeIdLen > 0, "World packed container component data has zero-length type ID string");
 				CheckException(container.payload.size() > advance + typeIdLen, "World packed container component data is too small to contain type ID string!");
-				comp.typeID = std::string("\0", typeIdLen);
+				comp.typeID = std::string(typeIdLen, '\0');
 				std::memcpy(comp.typeID.data(), container.payload.data() + advance, typeIdLen);
 				advance += typeIdLen;
 
@@ -622,7 +669,7 @@ namespace libcacaoformats {
 				advance += 4;
 				CheckException(rflLen > 0, "World packed container component data has zero-length reflection data");
 				CheckException(container.payload.size() > advance + rflLen, "World packed container component data is too small to contain reflection data of provided size!");
-				comp.reflection = std::string("\0", rflLen);
+				comp.reflection = std::string(rflLen, '\0');
 				std::memcpy(comp.reflection.data(), container.payload.data() + advance, rflLen);
 				advance += rflLen;
 
@@ -644,25 +691,117 @@ namespace libcacaoformats {
 		return out;
 	}
 
+	void PackedDecoder::DecodeWorldColumns(const PackedContainer& container, WorldColumns& out) {
+		CheckException(container.format == PackedFormat::World, "Packed container provided for world decoding is not a world!");
+
+		//Older worlds have to be decoded actor by actor
+		if(container.version < 2) {
+			WorldToColumns(DecodeWorld(container), out);
+			return;
+		}
+
+		//Partitioned worlds have every cell appended in turn
+		if(container.version >= 3) {
+			PackedWorldCells cells = PackedWorldCells::FromContainer(container);
+			WorldToColumns(World {.skyboxRef = cells.GetSkyboxRef(), .initialCamPos = cells.GetInitialCamPos(), .initialCamRot = cells.GetInitialCamRot()}, out);
+			WorldColumns cell;
+			for(std::size_t i = 0; i < cells.GetCells().size(); ++i) {
+				cells.DecodeCell(i, cell);
+				AppendWorldColumns(out, cell);
+			}
+			return;
+		}
+
+		const std::size_t advance = ReadWorldHeader(container.payload.data(), container.payload.size(), out);
+		ReadWorldActors(container.payload.data() + advance, container.payload.size() - advance, out);
+	}
+
 	AssetPack PackedDecoder::DecodeAssetPack(const PackedContainer& container) {
 		CheckException(container.format == PackedFormat::AssetPack, "Packed container provided for asset pack decoding is not an asset pack!");
 
-		//Configure archive object
-		archive* pak = archive_read_new();
-		CheckException(pak, "Unable to create asset pack archive object!");
-		archive_read_support_format_tar(pak);
-		CheckException(archive_read_open_memory(pak, container.payload.data(), container.payload.size() * sizeof(uint8_t)) == ARCHIVE_OK, "Failed to open asset pack archive data!");
+		//Indexed packs have their own layout
+		if(container.version >= 2) {
+			CheckException(container.payload.size() >= assetPackFooterSize + 4, "Asset pack packed container is too small to contain a table of contents!");
+
+			//Read the table of contents
+			AssetPackFooter footer = ReadAssetPackFooter(container.payload.data() + container.payload.size() - assetPackFooterSize, container.payload.size());
+			AssetPackTable table = AssetPackTable::Open(container.payload.Slice(footer.tocOffset, footer.tocSize), footer, container.version);
+			std::vector<PackedAssetIndex::Entry> toc(table.Size());
+			for(std::size_t i = 0; i < table.Size(); ++i) toc[i] = table.Record(i);
+
+			//Compressed assets all get decompressed into one shared arena
+			//Deduplicated assets point at the same stored bytes, so each of those blobs is only decompressed once and its assets share its part of the arena
+			uint64_t arenaSize = 0;
+			std::vector<uint64_t> arenaOffsets(toc.size());
+			std::vector<bool> decompress(toc.size());
+			std::unordered_map<uint64_t, std::size_t> blobs;
+			for(std::size_t i = 0; i < toc.size(); ++i) {
+				const PackedAssetIndex::Entry& entry = toc[i];
+				if(entry.compression == PackedCodec::Stored) continue;
+				auto [blob, inserted] = blobs.try_emplace(entry.offset, i);
+				const PackedAssetIndex::Entry& first = toc[blob->second];
+				if(!inserted && first.compression == entry.compression && first.compressedSize == entry.compressedSize && first.size == entry.size && first.checksum == entry.checksum) {
+					arenaOffsets[i] = arenaOffsets[blob->second];
+					continue;
+				}
+				arenaOffsets[i] = arenaSize;
+				decompress[i] = true;
+				arenaSize += entry.size;
+			}
+			std::vector<unsigned char> arenaBuf(arenaSize);
+			for(std::size_t i = 0; i < toc.size(); ++i) {
+				if(decompress[i]) DecompressAssetPackEntry(toc[i], container.payload.data() + toc[i].offset, std::span<unsigned char>(arenaBuf).subspan(arenaOffsets[i], toc[i].size));
+			}
+			PackedPayload arena(std::move(arenaBuf));
+
+			//Every asset is a view of either the arena or the pack payload itself
+			AssetPack out;
+			out.reserve(toc.size());
+			for(std::size_t i = 0; i < toc.size(); ++i) {
+				const PackedAssetIndex::Entry& entry = toc[i];
+				if(entry.tombstone) continue;
+				PackedPayload buffer = entry.compression == PackedCodec::Stored ? LoadAssetPackEntry(entry, container.payload) : arena.Slice(arenaOffsets[i], entry.size);
+				out.insert_or_assign(std::string(table.Name(i)), PackedAsset {.kind = entry.kind, .buffer = std::move(buffer)});
+			}
+			return out;
+		}
+
+		//Configure archive object (freed on every path out, including errors)
+		using ArchiveHandle = std::unique_ptr<archive, decltype(&archive_read_free)>;
+		const auto openArchive = [&container]() {
+			ArchiveHandle pak(archive_read_new(), &archive_read_free);
+			CheckException(pak.get(), "Unable to create asset pack archive object!");
+			archive_read_support_format_tar(pak.get());
+			CheckException(archive_read_open_memory(pak.get(), container.payload.data(), container.payload.size() * sizeof(uint8_t)) == ARCHIVE_OK, "Failed to open asset pack archive data!");
+			return pak;
+		};
+
+		//Size up the files so they can all be read into one shared arena
+		//Entries can't be larger than the archive they are stored in, so this also rejects corrupt sizes before allocating
+		ArchiveHandle pak = openArchive();
+		archive_entry* entry;
+		uint64_t arenaSize = 0;
+		while(archive_read_next_header(pak.get(), &entry) == ARCHIVE_OK) {
+			la_int64_t size = archive_entry_size(entry);
+			CheckException(size >= 0 && uint64_t(size) <= container.payload.size(), "Asset pack archive entry has an invalid size!");
+			arenaSize += size;
+			archive_read_data_skip(pak.get());
+		}
+		CheckException(arenaSize <= container.payload.size(), "Asset pack archive entries are larger than the archive!");
+		std::vector<unsigned char> arenaBuf(arenaSize);
+		uint64_t arenaAt = 0;
+		pak = openArchive();
 
 		//Create output
 		AssetPack out;
+		std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> arenaRanges;
 
 		//Create check map
 		std::unordered_map<std::string, bool> check;
 
 		//Extract data
-		archive_entry* entry;
 		YAML::Node metaRoot(YAML::NodeType::Undefined);
-		while(archive_read_next_header(pak, &entry) == ARCHIVE_OK) {
+		while(archive_read_next_header(pak.get(), &entry) == ARCHIVE_OK) {
 			std::filesystem::path path(archive_entry_pathname_utf8(entry));
 			std::string filename = path.filename().string();
 
@@ -673,7 +812,7 @@ namespace libcacaoformats {
 
 				//Read data from entry into buffer
 				std::vector<char> metaBuf(size);
-				archive_read_data(pak, metaBuf.data(), size);
+				archive_read_data(pak.get(), metaBuf.data(), size);
 
 				//Load metadata (using byte stream to do easy feed-in from vector)
 				ibytestream input(metaBuf);
@@ -683,7 +822,8 @@ namespace libcacaoformats {
 				la_int64_t size = archive_entry_size(entry);
 
 				//Create PackedAsset. We set everything to a Resource by default because we need something. This gets corrected in the second pass with info from the metadata file if applicable.
-				PackedAsset asset {.kind = PackedAsset::Kind::Resource, .buffer = std::vector<unsigned char>(size)};
+				PackedAsset asset {.kind = PackedAsset::Kind::Resource, .buffer = {}};
+				CheckException(size >= 0 && uint64_t(size) <= arenaSize - arenaAt, "Asset pack archive changed size while being read!");
 
 				//If this is a resource, we need to remove the resource path prefix
 				std::string genericPathStr = path.generic_string();
@@ -693,17 +833,26 @@ namespace libcacaoformats {
 					path = std::filesystem::path(genericPathStr.substr(12, genericPathStr.size()));
 				}
 
-				//Read data from entry into buffer
-				archive_read_data(pak, asset.buffer.data(), size);
+				//Read data from entry into the arena
+				archive_read_data(pak.get(), arenaBuf.data() + arenaAt, size);
 
 				//Create reference name
 				std::string reference = shouldStayRes ? path.string() : filename;
 
 				//Add entry to output
 				out.insert_or_assign(reference, asset);
+				arenaRanges.insert_or_assign(reference, std::make_pair(arenaAt, uint64_t(size)));
 				check.insert_or_assign(reference, shouldStayRes);
+				arenaAt += size;
 			}
 		}
+		pak.reset();
+
+		//Point every asset at its part of the arena
+		PackedPayload arena(std::move(arenaBuf));
+		for(const auto& [reference, range] : arenaRanges) {
+			out.at(reference).buffer = arena.Slice(range.first, range.second);
+		}
 
 		//Check that we actually got a metadata file
 		ValidateYAMLNode(metaRoot, YAML::NodeType::value::Sequence, "asset pack", "Metadata file does not exist in pack or is improperly formatted!");
@@ -763,4 +912,101 @@ namespace libcacaoformats {
 
 		return out;
 	}
+
+	DecodedAssetPack PackedDecoder::DecodeAssetPackParallel(const PackedContainer& container, std::shared_ptr<exathread::Pool> pool) {
+		CheckException(container.format == PackedFormat::AssetPack, "Packed container provided for asset pack decoding is not an asset pack!");
+		CheckException(pool != nullptr, "Cannot decode an asset pack in parallel without a thread pool!");
+
+		//Indexed packs can fetch every asset on a worker, archive-based ones have to be extracted first
+		std::optional<PackedAssetIndex> index;
+		AssetPack extracted;
+		std::vector<std::string> names;
+		if(container.version >= 2) {
+			index.emplace(PackedAssetIndex::FromContainer(container));
+			names = index->List();
+		} else {
+			extracted = DecodeAssetPack(container);
+			names.reserve(extracted.size());
+			for(const auto& [name, _] : extracted) names.push_back(name);
+		}
+
+		//Run a set of tasks on the pool and rethrow the first failure once they have all finished
+		const auto runTasks = [&pool](std::size_t count, const std::function<void(std::size_t)>& task) {
+			std::vector<std::size_t> indices(count);
+			std::iota(indices.begin(), indices.end(), 0);
+			std::vector<std::exception_ptr> errors(count);
+			pool->batch(indices, [&task, &errors](std::size_t i) {
+					try {
+						task(i);
+					} catch(...) {
+						errors[i] = std::current_exception();
+					}
+				}).await();
+			for(const std::exception_ptr& e : errors) {
+				if(e) std::rethrow_exception(e);
+			}
+		};
+
+		//Fetch and decode assets
+		//Cubemaps are only opened here so that their faces can be decoded as separate tasks afterwards
+		std::vector<DecodedAsset> decoded(names.size());
+		std::vector<std::optional<PackedContainer>> cubemaps(names.size());
+		runTasks(names.size(), [&](std::size_t i) {
+			PackedAsset asset = index ? index->Fetch(names[i]) : extracted.at(names[i]);
+			decoded[i].kind = asset.kind;
+			switch(asset.kind) {
+				case PackedAsset::Kind::Shader:
+					decoded[i].data = DecodeShader(PackedContainer::FromAsset(asset));
+					break;
+				case PackedAsset::Kind::Material:
+					decoded[i].data = DecodeMaterial(PackedContainer::FromAsset(asset));
+					break;
+				case PackedAsset::Kind::Tex2D:
+					decoded[i].data = DecodeImageData(asset.buffer.span());
+					break;
+				case PackedAsset::Kind::Cubemap: {
+					PackedContainer cubemap = PackedContainer::FromAsset(asset);
+					if(IsCompressedCubemap(cubemap)) {
+						decoded[i].data = DecodeCompressedCubemap(cubemap);
+					} else {
+						cubemaps[i].emplace(std::move(cubemap));
+						decoded[i].data = std::array<libcacaoimage::Image, 6> {};
+					}
+					break;
+				}
+				case PackedAsset::Kind::Sound: {
+					ispanstream stream(asset.buffer.span());
+					decoded[i].data = libcacaoaudiodecode::DecodeAudio(stream);
+					break;
+				}
+				default:
+					decoded[i].data = std::move(asset.buffer);
+					break;
+			}
+		});
+
+		//Decode cubemap faces
+		std::vector<std::pair<std::size_t, std::size_t>> faceTasks;
+		std::vector<std::array<std::span<const unsigned char>, 6>> faceData(names.size());
+		for(std::size_t i = 0; i < names.size(); ++i) {
+			if(!cubemaps[i]) continue;
+			faceData[i] = CubemapFaceData(*cubemaps[i]);
+			for(std::size_t face = 0; face < 6; ++face) faceTasks.emplace_back(i, face);
+		}
+		runTasks(faceTasks.size(), [&](std::size_t t) {
+			const auto [i, face] = faceTasks[t];
+			std::get<std::array<libcacaoimage::Image, 6>>(decoded[i].data)[face] = DecodeImageData(faceData[i][face]);
+		});
+
+		//Assemble result
+		DecodedAssetPack out;
+		for(std::size_t i = 0; i < names.size(); ++i) {
+			out.insert_or_assign(std::move(names[i]), std::move(decoded[i]));
+		}
+		return out;
+	}
+
+	PackedAssetIndex PackedDecoder::OverlayAssetPack(const PackedContainer& base, const PackedContainer& patch) {
+		return PackedAssetIndex::FromContainer(base).WithPatch(PackedAssetIndex::FromContainer(patch));
+	}
 }
\ No newline at end of file
@@ -3,19 +3,24 @@
 #include "libcacaocommon.hpp"
 #include "libcacaoimage.hpp"
 
+#include "AssetPackTOC.hpp"
+#include "Checksum.hpp"
+#include "Parallel.hpp"
+#include "WorldColumns.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <cstring>
+#include <limits>
+#include <map>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
-#include <iostream>
-
-#define LIBARCHIVE_STATIC
-#include "yaml-cpp/yaml.h"
-#include "archive.h"
-#include "archive_entry.h"
-#include "bzlib.h"
 
 namespace libcacaoformats {
-	PackedContainer PackedEncoder::EncodeCubemap(const std::array<libcacaoimage::Image, 6>& cubemap) {
+	PackedContainer PackedEncoder::EncodeCubemap(const std::array<libcacaoimage::Image, 6>& cubemap, unsigned int threads) {
 		//Validate input
 		for(const libcacaoimage::Image& buf : cubemap) {
 			CheckException(buf.w > 0 && buf.h > 0, "Cubemap face for packed encoding has invalid dimensions or channel count!");
@@ -35,11 +40,19 @@ namespace libcacaoformats {
 		out.write(reinterpret_cast<char*>(&zero), sizeof(uint64_t));
 		out.write(reinterpret_cast<char*>(&zero), sizeof(uint64_t));
 
-		//Encode face data and write it out, manipulating sizes as we do so
-		for(uint8_t i = 0; i < 6; i++) {
+		//Encode face data (faces are independent, so this can happen in parallel)
+		std::array<std::vector<char>, 6> faces;
+		ParallelFor(6, threads, [&cubemap, &faces](std::size_t i) {
 			libcacaoimage::Image img = cubemap[i];
 			img.lossy = false;
-			uint64_t size = libcacaoimage::encode::EncodeWebP(img, out);
+			obytestream faceOut(faces[i]);
+			libcacaoimage::encode::EncodeWebP(img, faceOut);
+		});
+
+		//Write face data out, manipulating sizes as we do so
+		for(uint8_t i = 0; i < 6; i++) {
+			uint64_t size = faces[i].size();
+			out.write(faces[i].data(), size);
 			std::memcpy(outBuffer.data() + (i * sizeof(uint64_t)), &size, sizeof(uint64_t));
 		}
 
@@ -47,6 +60,50 @@ namespace libcacaoformats {
 		return PackedContainer(PackedFormat::Cubemap, 1, std::move(outBuffer));
 	}
 
+	PackedContainer PackedEncoder::EncodeCubemap(const CompressedCubemap& cubemap) {
+		//Validate input
+		CheckException(cubemap.compression >= BlockCompression::BC7 && cubemap.compression <= BlockCompression::ETC2RGBA8, "Compressed cubemap for packed encoding has an unknown block compression format!");
+		CheckException(cubemap.w > 0 && cubemap.h > 0, "Compressed cubemap for packed encoding has zero face dimensions!");
+		CheckException(cubemap.w <= CompressedCubemap::maxSize && cubemap.h <= CompressedCubemap::maxSize, "Compressed cubemap for packed encoding has face dimensions larger than the supported maximum!");
+		const std::size_t mipLevels = cubemap.MipLevels();
+		CheckException(mipLevels > 0 && mipLevels <= std::size_t(std::bit_width(std::max(cubemap.w, cubemap.h))), "Compressed cubemap for packed encoding has an invalid mip level count!");
+		for(const std::vector<PackedPayload>& face : cubemap.faces) {
+			CheckException(face.size() == mipLevels, "Compressed cubemap faces for packed encoding have different mip level counts!");
+			for(std::size_t level = 0; level < mipLevels; ++level) {
+				CheckException(face[level].size() == cubemap.LevelSize(level), "Compressed cubemap level for packed encoding does not match the size of its dimensions!");
+			}
+		}
+
+		//Create output buffer
+		uint64_t levelsSize = 0;
+		for(std::size_t level = 0; level < mipLevels; ++level) levelsSize += cubemap.LevelSize(level);
+		CheckException(16 + levelsSize * 6 <= std::numeric_limits<std::size_t>::max(), "Compressed cubemap for packed encoding is too large to fit in memory!");
+		std::vector<unsigned char> outBuffer(std::size_t(16 + levelsSize * 6));
+
+		//Write header (the 16 bytes keep every level aligned to the block size, as GPU upload buffers require)
+		const uint8_t compression = uint8_t(cubemap.compression);
+		const uint8_t flags = cubemap.srgb ? 1 : 0;
+		const uint16_t levels = uint16_t(mipLevels);
+		const uint32_t w = cubemap.w, h = cubemap.h;
+		std::memcpy(outBuffer.data(), &compression, 1);
+		std::memcpy(outBuffer.data() + 1, &flags, 1);
+		std::memcpy(outBuffer.data() + 2, &levels, 2);
+		std::memcpy(outBuffer.data() + 4, &w, 4);
+		std::memcpy(outBuffer.data() + 8, &h, 4);
+
+		//Write levels face by face
+		std::size_t offsetCounter = 16;
+		for(const std::vector<PackedPayload>& face : cubemap.faces) {
+			for(const PackedPayload& level : face) {
+				std::memcpy(outBuffer.data() + offsetCounter, level.data(), level.size());
+				offsetCounter += level.size();
+			}
+		}
+
+		//Create and return packed container
+		return PackedContainer(PackedFormat::Cubemap, 2, std::move(outBuffer));
+	}
+
 	PackedContainer PackedEncoder::EncodeShader(const std::vector<unsigned char>& ir) {
 		//Create output container
 		std::vector<char> outBuffer;
@@ -131,14 +188,14 @@ namespace libcacaoformats {
 						typeInfo = 0b00110000;
 						Vec4<int> vec = std::get<5>(key.second);
 						int value[] = {vec.x, vec.y, vec.z, vec.w};
-						out.write(reinterpret_cast<char*>(&value), sizeof(value));
+						data.write(reinterpret_cast<char*>(&value), sizeof(value));
 						break;
 					}
 					case 6: {
 						typeInfo = 0b00010001;
 						Vec2<unsigned int> vec = std::get<6>(key.second);
 						unsigned int value[] = {vec.x, vec.y};
-						out.write(reinterpret_cast<char*>(&value), sizeof(value));
+						data.write(reinterpret_cast<char*>(&value), sizeof(value));
 						break;
 					}
 					case 7: {
@@ -350,206 +407,221 @@ namespace libcacaoformats {
 		return PackedContainer(PackedFormat::Material, 1, std::move(outBuffer));
 	}
 
+	///@brief Check the string lengths of a world for packed encoding
+	static void ValidateWorldStrings(const World& world) {
+		for(const World::Actor& actor : world.actors) {
+			CheckException(actor.name.size() > 0 && actor.name.size() <= UINT16_MAX, "World actor for packed encoding has out-of-range name string length!");
+			for(const World::Component& component : actor.components) {
+				CheckException(component.typeID.size() > 0 && component.typeID.size() <= UINT16_MAX, "World actor component for packed encoding has out-of-range type ID string length!");
+			}
+		}
+	}
+
 	PackedContainer PackedEncoder::EncodeWorld(const World& world) {
+		ValidateWorldStrings(world);
+
+		//Worlds are stored in column-oriented form
+		WorldColumns columns;
+		WorldToColumns(world, columns);
+		return EncodeWorld(columns);
+	}
+
+	PackedContainer PackedEncoder::EncodeWorld(const WorldColumns& world) {
 		//Create output container
 		std::vector<char> outBuffer;
 		obytestream out(outBuffer);
+		WriteWorldHeader(world, out);
+		WriteWorldActors(world, out);
 
-		//Write skybox address string
-		uint16_t skyboxLen = (uint16_t)world.skyboxRef.size();
-		out.write(reinterpret_cast<char*>(&skyboxLen), 2);
-		if(skyboxLen > 0) out << world.skyboxRef;
-
-		//Write initial camera data
-		float initialCamData[] = {world.initialCamPos.x, world.initialCamPos.y, world.initialCamPos.z, world.initialCamRot.x, world.initialCamRot.y, world.initialCamRot.z};
-		out.write(reinterpret_cast<char*>(&initialCamData), sizeof(initialCamData));
-
-		//Write actor count
-		uint64_t actorCount = world.actors.size();
-		out.write(reinterpret_cast<char*>(&actorCount), 8);
-
-		//Write actors
-		for(const World::Actor& actor : world.actors) {
-			//Write actor and parent GUIDs
-			out.write(reinterpret_cast<const char*>(actor.guid.bytes().data()), 16);
-			out.write(reinterpret_cast<const char*>(actor.parentGUID.bytes().data()), 16);
-
-			//Write actor name string
-			CheckException(actor.name.size() > 0 && actor.name.size() <= UINT16_MAX, "World actor for packed encoding has out-of-range name string length!");
-			uint16_t enLen = (uint8_t)actor.name.size();
-			out.write(reinterpret_cast<char*>(&enLen), 2);
-			out << actor.name;
-
-			//Write initial transform data
-			float transformData[] = {actor.initialPos.x, actor.initialPos.y, actor.initialPos.z, actor.initialRot.x, actor.initialRot.y, actor.initialRot.z, actor.initialScale.x, actor.initialScale.y, actor.initialScale.z};
-			out.write(reinterpret_cast<char*>(transformData), sizeof(transformData));
-
-			//Write component count
-			CheckException(actor.components.size() > 0 && actor.components.size() <= UINT8_MAX, "World actor for packed encoding has invalid component count!");
-			uint8_t compCount = (uint8_t)actor.components.size();
-			out.write(reinterpret_cast<char*>(&compCount), 1);
+		//Create and return packed container
+		return PackedContainer(PackedFormat::World, 2, std::move(outBuffer));
+	}
 
-			//Write components
-			for(const World::Component& component : actor.components) {
-				//Write type ID string
-				CheckException(component.typeID.size() > 0 && component.typeID.size() <= UINT16_MAX, "World actor component for packed encoding has out-of-range type ID string length!");
-				uint16_t tiLen = (uint16_t)component.typeID.size();
-				out.write(reinterpret_cast<char*>(&tiLen), 2);
-				out << component.typeID;
-
-				//Write reflection data
-				CheckException(component.reflection.size() > 0 && component.reflection.size() <= UINT32_MAX, "World actor component for packed encoding has out-of-range reflection data size!");
-				uint32_t rdLen = (uint32_t)component.reflection.size();
-				out.write(reinterpret_cast<char*>(&rdLen), 4);
-				out.write(const_cast<char*>(component.reflection.data()), rdLen);
-
-				//Write component separator
-				out.write("\0\0", 2);
+	PackedContainer PackedEncoder::EncodeWorld(const World& world, float cellSize) {
+		CheckException(std::isfinite(cellSize) && cellSize >= 0, "World cell size for packed encoding must be finite and not negative!");
+		if(cellSize == 0) return EncodeWorld(world);
+		ValidateWorldStrings(world);
+
+		//Find the top-level ancestor of every actor
+		//Actors whose parent is missing from the world count as top-level, and the walk is bounded so that parent cycles can't hang it
+		const std::size_t actorCount = world.actors.size();
+		std::unordered_map<xg::Guid, std::size_t> indices;
+		indices.reserve(actorCount);
+		for(std::size_t i = 0; i < actorCount; ++i) indices.try_emplace(world.actors[i].guid, i);
+		std::vector<std::size_t> topLevel(actorCount, SIZE_MAX);
+		std::vector<std::size_t> chain;
+		for(std::size_t i = 0; i < actorCount; ++i) {
+			if(topLevel[i] != SIZE_MAX) continue;
+			chain.clear();
+			std::size_t root = i;
+			for(std::size_t j = i;;) {
+				chain.push_back(j);
+				if(topLevel[j] != SIZE_MAX) {
+					root = topLevel[j];
+					break;
+				}
+				auto parent = indices.find(world.actors[j].parentGUID);
+				if(parent == indices.end() || chain.size() > actorCount) {
+					root = j;
+					break;
+				}
+				j = parent->second;
 			}
+			for(std::size_t j : chain) topLevel[j] = root;
+		}
 
-			//Write actor separator
-			out << "%e";
+		//Group actors by the cell their top-level ancestor starts in, keeping their relative order
+		const auto toCell = [cellSize](float pos) {
+			const float cell = std::floor(pos / cellSize);
+			CheckException(cell >= float(INT32_MIN) && cell < float(INT32_MAX), "World actor for packed encoding is too far from the origin to be placed in a cell!");
+			return (int32_t)cell;
+		};
+		std::map<std::array<int32_t, 3>, World> cells;
+		for(std::size_t i = 0; i < actorCount; ++i) {
+			const Vec3<float>& pos = world.actors[topLevel[i]].initialPos;
+			cells[{toCell(pos.x), toCell(pos.y), toCell(pos.z)}].actors.push_back(world.actors[i]);
+		}
+		CheckException(cells.size() <= UINT32_MAX, "World for packed encoding has too many cells!");
+
+		//Encode every cell as its own chunk
+		std::vector<std::vector<char>> chunks;
+		chunks.reserve(cells.size());
+		WorldColumns columns;
+		for(const auto& [coords, cell] : cells) {
+			WorldToColumns(cell, columns);
+			obytestream chunk(chunks.emplace_back());
+			WriteWorldActors(columns, chunk);
 		}
 
+		//Create output container
+		std::vector<char> outBuffer;
+		obytestream out(outBuffer);
+		const auto put = [&out](const auto& value) {
+			out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+		};
+		columns.skyboxRef = world.skyboxRef;
+		columns.initialCamPos = world.initialCamPos;
+		columns.initialCamRot = world.initialCamRot;
+		WriteWorldHeader(columns, out);
+
+		//Write cell records
+		put(cellSize);
+		put((uint32_t)cells.size());
+		uint64_t chunkOffset = 0;
+		std::size_t chunkIdx = 0;
+		for(const auto& [coords, cell] : cells) {
+			put(coords);
+			put((uint64_t)cell.actors.size());
+			put(chunkOffset);
+			put((uint64_t)chunks[chunkIdx].size());
+			chunkOffset += chunks[chunkIdx++].size();
+		}
+
+		//Write chunks
+		for(const std::vector<char>& chunk : chunks) out.write(chunk.data(), chunk.size());
+
 		//Create and return packed container
-		return PackedContainer(PackedFormat::World, 1, std::move(outBuffer));
+		return PackedContainer(PackedFormat::World, 3, std::move(outBuffer));
 	}
 
-	PackedContainer PackedEncoder::EncodeAssetPack(const AssetPack& pack) {
-		//Validate inputs
+	PackedContainer PackedEncoder::EncodeAssetPack(const AssetPack& pack, unsigned int threads) {
 		CheckException(pack.size() > 0, "Cannot encode asset pack with no assets!");
+		return EncodeAssetPackPatch(pack, {}, threads);
+	}
 
-		//Calculate initial output buffer capacity
+	PackedContainer PackedEncoder::EncodeAssetPackPatch(const AssetPack& pack, const std::vector<std::string>& removed, unsigned int threads) {
+		//Validate inputs
+		CheckException(pack.size() + removed.size() > 0, "Cannot encode asset pack patch with no changes!");
+		CheckException(pack.size() + removed.size() <= UINT32_MAX, "Cannot encode asset pack with more than 2^32 entries!");
+		std::unordered_set<std::string> removedSet(removed.begin(), removed.end());
+		CheckException(removedSet.size() == removed.size(), "Asset pack patch deletes the same asset more than once!");
+		for(const std::string& name : removed) {
+			CheckException(!pack.contains(name), "Asset pack patch both changes and deletes the same asset!");
+		}
+
+		//Sort the asset names so that encoding the same pack twice gives the same output
+		std::vector<const AssetPack::value_type*> sorted;
+		sorted.reserve(pack.size());
 		std::size_t outInitialCapacity = 0;
-		for(const auto& [_, a] : pack) {
-			outInitialCapacity += a.buffer.size();
+		for(const auto& asset : pack) {
+			if(asset.first.find_first_of("/") != std::string::npos) CheckException(asset.second.kind == PackedAsset::Kind::Resource, "Asset pack entry contains nested files not marked as resources!");
+			sorted.push_back(&asset);
+			outInitialCapacity += asset.second.buffer.size();
 		}
-		outInitialCapacity *= 1.25;
+		std::sort(sorted.begin(), sorted.end(), [](const AssetPack::value_type* a, const AssetPack::value_type* b) { return a->first < b->first; });
 
 		//Create output container
-		std::vector<char> outBuffer(outInitialCapacity);
-		std::size_t used = 0;
-
-		//Create metadata file emitter
-		YAML::Emitter yml;
-		yml << YAML::BeginSeq;
-
-		//Configure archive object
-		archive* pak = archive_write_new();
-		CheckException(pak, "Unable to create asset pack archive object!");
-		archive_write_set_format_pax_restricted(pak);
-		CheckException(archive_write_open_memory(pak, outBuffer.data(), outBuffer.capacity() * sizeof(char), &used) == ARCHIVE_OK, "Failed to open archive object for asset pack encoding!");
-
-		//Write files
-		archive_entry* entry = archive_entry_new();
-		CheckException(entry, "Unable to create asset pack entry object");
-		for(const auto& asset : pack) {
-			//Reset entry object
-			entry = archive_entry_clear(entry);
-
-			//Fill out entry data
-			std::stringstream pathStream;
-			if(auto hasSlash = asset.first.find_first_of("/") != std::string::npos; asset.second.kind == PackedAsset::Kind::Resource || hasSlash) {
-				CheckException(asset.second.kind == PackedAsset::Kind::Resource, "Asset pack entry contains nested files not marked as resources!");
-				pathStream << "__$CacaoRes/";
-			}
-			pathStream << asset.first;
-			std::string pathname = pathStream.str();
-			archive_entry_set_pathname_utf8(entry, pathname.c_str());
-			archive_entry_set_size(entry, asset.second.buffer.size() * sizeof(unsigned char));
-			archive_entry_set_filetype(entry, AE_IFREG);
-			archive_entry_set_perm(entry, 0644);
-
-			//Write entry header
-			int stat = archive_write_header(pak, entry);
-			if(stat != ARCHIVE_OK) {
-				if(used > outBuffer.capacity() * sizeof(char)) {
-					//Resize the buffer and try again
-					outBuffer.reserve(outBuffer.size() * 1.5);
-					CheckException(archive_write_header(pak, entry) == ARCHIVE_OK, "Failed to write archive entry header for asset pack encoding!");
-				} else {
-					CheckException(false, "Failed to write archive entry header for asset pack encoding!");
-				}
+		std::vector<char> outBuffer;
+		outBuffer.reserve(outInitialCapacity);
+
+		//Checksum every asset
+		std::vector<AssetPackTOCEntry> toc(sorted.size());
+		ParallelFor(sorted.size(), threads, [&sorted, &toc](std::size_t i) {
+			const AssetPack::value_type* asset = sorted[i];
+			PackedAssetIndex::Entry& entry = toc[i].second;
+			toc[i].first = asset->first;
+			entry.kind = asset->second.kind;
+			entry.size = asset->second.buffer.size();
+			entry.checksum = CRC32(asset->second.buffer.data(), asset->second.buffer.size());
+		});
+
+		//Find assets with identical contents so that each unique blob is only stored once
+		//Matching sizes and checksums are only candidates, the bytes still have to be compared
+		std::vector<std::size_t> blobs;
+		std::vector<std::size_t> blobOf(sorted.size());
+		std::unordered_map<uint64_t, std::vector<std::size_t>> candidates;
+		for(std::size_t i = 0; i < sorted.size(); ++i) {
+			std::vector<std::size_t>& matches = candidates[toc[i].second.size ^ (uint64_t(toc[i].second.checksum) << 32)];
+			auto match = std::find_if(matches.cbegin(), matches.cend(), [&](std::size_t blob) {
+				const PackedPayload& a = sorted[blobs[blob]]->second.buffer;
+				const PackedPayload& b = sorted[i]->second.buffer;
+				return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+			});
+			if(match != matches.cend()) {
+				blobOf[i] = *match;
+			} else {
+				blobOf[i] = blobs.size();
+				matches.push_back(blobs.size());
+				blobs.push_back(i);
 			}
+		}
 
-			//Write file data
-			archive_write_data(pak, asset.second.buffer.data(), asset.second.buffer.size() * sizeof(unsigned char));
-
-			//Skip metadata if resource
-			if(asset.second.kind == PackedAsset::Kind::Resource) continue;
-
-			//Output metadata entry
-			yml << YAML::BeginMap << YAML::Key << "asset" << YAML::Value << asset.first << YAML::Key << "type" << YAML::Value;
-			switch(asset.second.kind) {
-				case PackedAsset::Kind::Shader:
-					yml << 0;
-					break;
-				case PackedAsset::Kind::Tex2D:
-					yml << 1;
-					break;
-				case PackedAsset::Kind::Cubemap:
-					yml << 2;
-					break;
-				case PackedAsset::Kind::Sound:
-					yml << 3;
-					break;
-				case PackedAsset::Kind::Material:
-					yml << 4;
-					break;
-				case PackedAsset::Kind::Font:
-					yml << 5;
-					break;
-				case PackedAsset::Kind::Model:
-					yml << 6;
-					break;
-				default:
-					yml << -1;
-					break;
-			}
-			yml << YAML::EndMap;
+		//Compress every unique blob on its own (blobs are independent, so this can happen in parallel)
+		std::vector<std::vector<char>> stored(blobs.size());
+		std::vector<PackedCodec> codecs(blobs.size());
+		ParallelFor(blobs.size(), threads, [&sorted, &blobs, &stored, &codecs](std::size_t b) {
+			codecs[b] = CompressAssetPackEntry(sorted[blobs[b]]->second, stored[b]);
+		});
+
+		//Write blob data in order, recording where each blob ends up
+		std::vector<uint64_t> blobOffsets(blobs.size());
+		std::vector<uint64_t> blobSizes(blobs.size());
+		for(std::size_t b = 0; b < blobs.size(); ++b) {
+			blobOffsets[b] = outBuffer.size();
+			blobSizes[b] = stored[b].size();
+			outBuffer.insert(outBuffer.end(), stored[b].cbegin(), stored[b].cend());
+			std::vector<char>().swap(stored[b]);
 		}
-		yml << YAML::EndSeq;
-
-		//Now we do the whole writing stuff again for the metadata file
-		{
-			//Get data
-			std::string meta(yml.c_str());
-
-			//Reset entry object
-			entry = archive_entry_clear(entry);
-
-			//Fill out entry data
-			archive_entry_set_pathname_utf8(entry, "__$CacaoMeta0");
-			archive_entry_set_size(entry, meta.size() * sizeof(char));
-			archive_entry_set_filetype(entry, AE_IFREG);
-			archive_entry_set_perm(entry, 0644);
-
-			//Write entry header
-			int stat = archive_write_header(pak, entry);
-			if(stat != ARCHIVE_OK) {
-				std::cout << archive_error_string(pak) << std::endl;
-				if(used > outBuffer.capacity() * sizeof(char)) {
-					//Resize the buffer and try again
-					outBuffer.reserve(outBuffer.size() * 1.5);
-					CheckException(archive_write_header(pak, entry) == ARCHIVE_OK, "Failed to write metadata file entry header for asset pack encoding!");
-				} else {
-					CheckException(false, "Failed to write metadata file entry header for asset pack encoding!");
-				}
-			}
 
-			//Write file data
-			archive_write_data(pak, meta.c_str(), meta.size() * sizeof(unsigned char));
+		//Point every entry at its blob
+		for(std::size_t i = 0; i < sorted.size(); ++i) {
+			PackedAssetIndex::Entry& entry = toc[i].second;
+			entry.offset = blobOffsets[blobOf[i]];
+			entry.compressedSize = blobSizes[blobOf[i]];
+			entry.compression = codecs[blobOf[i]];
 		}
 
-		//Close and free archive object
-		CheckException(archive_write_close(pak) == ARCHIVE_OK, "Failed to close asset pack archive object!");
-		CheckException(archive_write_free(pak) == ARCHIVE_OK, "Failed to free asset pack archive object!");
+		//Record deletions
+		for(const std::string& name : removed) {
+			PackedAssetIndex::Entry tombstone {};
+			tombstone.tombstone = true;
+			toc.emplace_back(name, tombstone);
+		}
 
-		//Trim output buffer to free any memory not used
-		outBuffer.resize(used);
-		outBuffer.shrink_to_fit();
+		//Write table of contents and footer
+		WriteAssetPackTOC(std::move(toc), outBuffer.size(), outBuffer);
 
 		//Create and return packed container
-		return PackedContainer(PackedFormat::AssetPack, 1, std::move(outBuffer));
+		return PackedContainer(PackedFormat::AssetPack, assetPackVersion, std::move(outBuffer));
 	}
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libcacaoformats {
+	/**
+	 * @brief Run a function for every index in a range, spread across several threads
+	 *
+	 * Indices are handed out one at a time, so uneven workloads still balance. If any call throws, no new indices are started and the first exception is rethrown once all threads have stopped.
+	 *
+	 * @param count The number of indices
+	 * @param threads The maximum number of threads to use, including the calling thread (0 uses one per hardware thread)
+	 * @param func The function to call with each index
+	 */
+	inline void ParallelFor(std::size_t count, unsigned int threads, const std::function<void(std::size_t)>& func) {
+		if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+		threads = static_cast<unsigned int>(std::min<std::size_t>(threads, count));
+
+		//Don't bother spawning anything for serial work
+		if(threads <= 1) {
+			for(std::size_t i = 0; i < count; ++i) func(i);
+			return;
+		}
+
+		std::atomic_size_t next = 0;
+		std::atomic_bool failed = false;
+		std::exception_ptr error;
+		std::mutex errorMtx;
+		const auto worker = [&]() {
+			for(std::size_t i = next++; i < count && !failed; i = next++) {
+				try {
+					func(i);
+				} catch(...) {
+					std::lock_guard lk(errorMtx);
+					if(!error) error = std::current_exception();
+					failed = true;
+				}
+			}
+		};
+
+		//The calling thread does its share too
+		std::vector<std::thread> pool;
+		pool.reserve(threads - 1);
+		for(unsigned int t = 1; t < threads; ++t) pool.emplace_back(worker);
+		worker();
+		for(std::thread& t : pool) t.join();
+
+		if(error) std::rethrow_exception(error);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,313 @@
+#include "libcacaoformats.hpp"
+
+#include "libcacaocommon.hpp"
+
+#include "Reflection.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <cstring>
+#include <limits>
+
+namespace libcacaoformats {
+	//Deeper trees are rejected so that checking and converting them can't overflow the stack
+	constexpr unsigned int maxReflectionDepth = 256;
+
+	static uint32_t ReadU32(const char* at) {
+		uint32_t out;
+		std::memcpy(&out, at, 4);
+		return out;
+	}
+
+	static void AppendU32(std::string& out, std::size_t value) {
+		CheckException(value <= UINT32_MAX, "Component reflection data is too large to convert to binary!");
+		uint32_t v = (uint32_t)value;
+		out.append(reinterpret_cast<const char*>(&v), 4);
+	}
+
+	//Size of the header of a value, which is all of the value for scalars
+	static std::size_t HeaderSize(ReflectionView::Type type) {
+		switch(type) {
+			case ReflectionView::Type::Null: return 1;
+			case ReflectionView::Type::Bool: return 2;
+			case ReflectionView::Type::Int: return 9;
+			case ReflectionView::Type::Float: return 9;
+			case ReflectionView::Type::String: return 5;
+			default: return 9;
+		}
+	}
+
+	//Total size of a value, which must have already been checked
+	static std::size_t ValueSize(const char* at) {
+		ReflectionView::Type type = ReflectionView::Type(*at);
+		if(type == ReflectionView::Type::String) return 5 + ReadU32(at + 1);
+		if(type == ReflectionView::Type::Sequence || type == ReflectionView::Type::Map) return 9 + ReadU32(at + 5);
+		return HeaderSize(type);
+	}
+
+	//Check a value and return its total size
+	static std::size_t CheckValue(const char* at, std::size_t avail, unsigned int depth) {
+		CheckException(avail >= 1 && uint8_t(*at) <= uint8_t(ReflectionView::Type::Map), "Binary reflection data has an invalid value type!");
+		ReflectionView::Type type = ReflectionView::Type(*at);
+		const std::size_t header = HeaderSize(type);
+		CheckException(avail >= header, "Binary reflection data is too small to contain value!");
+		if(type == ReflectionView::Type::String) {
+			CheckException(ReadU32(at + 1) <= avail - header, "Binary reflection data is too small to contain string!");
+			return header + ReadU32(at + 1);
+		}
+		if(type != ReflectionView::Type::Sequence && type != ReflectionView::Type::Map) return header;
+
+		//Check every child and make sure they add up to the content size
+		CheckException(depth < maxReflectionDepth, "Binary reflection data is nested too deeply!");
+		const uint32_t count = ReadU32(at + 1);
+		const uint32_t contentSize = ReadU32(at + 5);
+		CheckException(contentSize <= avail - header, "Binary reflection data is too small to contain container contents!");
+		std::size_t advance = header;
+		const std::size_t end = header + contentSize;
+		for(uint32_t i = 0; i < count; ++i) {
+			if(type == ReflectionView::Type::Map) {
+				CheckException(end - advance >= 4 && ReadU32(at + advance) <= end - advance - 4, "Binary reflection data is too small to contain map key!");
+				advance += 4 + ReadU32(at + advance);
+			}
+			advance += CheckValue(at + advance, end - advance, depth + 1);
+		}
+		CheckException(advance == end, "Binary reflection data container has the wrong content size!");
+		return end;
+	}
+
+	ReflectionView ReflectionView::Open(std::string_view data) {
+		CheckException(IsBinary(data), "Reflection data is not in binary form!");
+		data.remove_prefix(1);
+		CheckException(CheckValue(data.data(), data.size(), 0) == data.size(), "Binary reflection data has trailing bytes!");
+		return ReflectionView(data);
+	}
+
+	bool ReflectionView::AsBool() const {
+		CheckException(GetType() == Type::Bool, "Reflection value is not a boolean!");
+		return data[1] != 0;
+	}
+
+	int64_t ReflectionView::AsInt() const {
+		CheckException(GetType() == Type::Int, "Reflection value is not an integer!");
+		int64_t out;
+		std::memcpy(&out, data.data() + 1, 8);
+		return out;
+	}
+
+	double ReflectionView::AsFloat() const {
+		if(GetType() == Type::Int) return double(AsInt());
+		CheckException(GetType() == Type::Float, "Reflection value is not a number!");
+		double out;
+		std::memcpy(&out, data.data() + 1, 8);
+		return out;
+	}
+
+	std::string_view ReflectionView::AsString() const {
+		CheckException(GetType() == Type::String, "Reflection value is not a string!");
+		return data.substr(5, ReadU32(data.data() + 1));
+	}
+
+	std::size_t ReflectionView::Size() const {
+		if(GetType() != Type::Sequence && GetType() != Type::Map) return 0;
+		return ReadU32(data.data() + 1);
+	}
+
+	ReflectionView ReflectionView::operator[](std::size_t idx) const {
+		CheckException(GetType() == Type::Sequence || GetType() == Type::Map, "Reflection value is not a sequence or map!");
+		CheckException(idx < Size(), "Reflection element index is out of range!");
+
+		//Skip over the elements before this one
+		const bool isMap = GetType() == Type::Map;
+		std::size_t advance = 9;
+		for(std::size_t i = 0;; ++i) {
+			if(isMap) advance += 4 + ReadU32(data.data() + advance);
+			const std::size_t size = ValueSize(data.data() + advance);
+			if(i == idx) return ReflectionView(data.substr(advance, size));
+			advance += size;
+		}
+	}
+
+	std::string_view ReflectionView::Key(std::size_t idx) const {
+		CheckException(GetType() == Type::Map, "Reflection value is not a map!");
+		CheckException(idx < Size(), "Reflection entry index is out of range!");
+		std::size_t advance = 9;
+		for(std::size_t i = 0;; ++i) {
+			const uint32_t keyLen = ReadU32(data.data() + advance);
+			if(i == idx) return data.substr(advance + 4, keyLen);
+			advance += 4 + keyLen;
+			advance += ValueSize(data.data() + advance);
+		}
+	}
+
+	ReflectionView::Iterator ReflectionView::begin() const {
+		const bool isContainer = GetType() == Type::Sequence || GetType() == Type::Map;
+		return Iterator(data, GetType() == Type::Map, isContainer ? 9 : data.size());
+	}
+
+	ReflectionView::Iterator ReflectionView::end() const {
+		return Iterator(data, GetType() == Type::Map, data.size());
+	}
+
+	ReflectionView ReflectionView::Iterator::operator*() const {
+		const std::size_t at = isMap ? offset + 4 + ReadU32(data.data() + offset) : offset;
+		return ReflectionView(data.substr(at, ValueSize(data.data() + at)));
+	}
+
+	std::string_view ReflectionView::Iterator::Key() const {
+		if(!isMap) return {};
+		return data.substr(offset + 4, ReadU32(data.data() + offset));
+	}
+
+	ReflectionView::Iterator& ReflectionView::Iterator::operator++() {
+		if(isMap) offset += 4 + ReadU32(data.data() + offset);
+		offset += ValueSize(data.data() + offset);
+		return *this;
+	}
+
+	std::optional<ReflectionView> ReflectionView::Find(std::string_view key) const {
+		if(GetType() != Type::Map) return std::nullopt;
+		std::size_t advance = 9;
+		for(std::size_t i = 0; i < Size(); ++i) {
+			const uint32_t keyLen = ReadU32(data.data() + advance);
+			std::string_view entryKey = data.substr(advance + 4, keyLen);
+			advance += 4 + keyLen;
+			const std::size_t size = ValueSize(data.data() + advance);
+			if(entryKey == key) return ReflectionView(data.substr(advance, size));
+			advance += size;
+		}
+		return std::nullopt;
+	}
+
+	//Append the binary form of a YAML node
+	static void AppendNode(const YAML::Node& node, std::string& out, unsigned int depth) {
+		CheckException(depth < maxReflectionDepth, "Component reflection data is nested too deeply!");
+		const auto putType = [&out](ReflectionView::Type type) { out.push_back(char(type)); };
+		switch(node.Type()) {
+			case YAML::NodeType::Undefined:
+			case YAML::NodeType::Null:
+				putType(ReflectionView::Type::Null);
+				return;
+			case YAML::NodeType::Scalar: {
+				//Explicitly tagged scalars keep the type they were declared with
+				const std::string& tag = node.Tag();
+				int64_t i;
+				double d;
+				bool b;
+				if(tag == "tag:yaml.org,2002:int") {
+					CheckException(YAML::convert<int64_t>::decode(node, i), "Component reflection data has an integer-tagged value that is not an integer!");
+					putType(ReflectionView::Type::Int);
+					out.append(reinterpret_cast<const char*>(&i), 8);
+					return;
+				} else if(tag == "tag:yaml.org,2002:float") {
+					CheckException(YAML::convert<double>::decode(node, d), "Component reflection data has a float-tagged value that is not a number!");
+					putType(ReflectionView::Type::Float);
+					out.append(reinterpret_cast<const char*>(&d), 8);
+					return;
+				} else if(tag == "tag:yaml.org,2002:bool") {
+					CheckException(YAML::convert<bool>::decode(node, b), "Component reflection data has a boolean-tagged value that is not a boolean!");
+					putType(ReflectionView::Type::Bool);
+					out.push_back(b ? 1 : 0);
+					return;
+				}
+
+				//Otherwise, quoted and string-tagged scalars are always strings and plain ones are read as the first type that fits
+				const bool quoted = tag == "!" || tag == "tag:yaml.org,2002:str";
+				if(!quoted && YAML::convert<int64_t>::decode(node, i)) {
+					putType(ReflectionView::Type::Int);
+					out.append(reinterpret_cast<const char*>(&i), 8);
+					return;
+				} else if(!quoted && YAML::convert<double>::decode(node, d)) {
+					putType(ReflectionView::Type::Float);
+					out.append(reinterpret_cast<const char*>(&d), 8);
+					return;
+				} else if(!quoted && YAML::convert<bool>::decode(node, b)) {
+					putType(ReflectionView::Type::Bool);
+					out.push_back(b ? 1 : 0);
+					return;
+				}
+				putType(ReflectionView::Type::String);
+				AppendU32(out, node.Scalar().size());
+				out.append(node.Scalar());
+				return;
+			}
+			case YAML::NodeType::Sequence:
+			case YAML::NodeType::Map: {
+				const bool isMap = node.IsMap();
+				putType(isMap ? ReflectionView::Type::Map : ReflectionView::Type::Sequence);
+				AppendU32(out, node.size());
+
+				//The content size is filled in once the children are written
+				const std::size_t sizeAt = out.size();
+				AppendU32(out, 0);
+				if(isMap) {
+					for(const auto& entry : node) {
+						CheckException(entry.first.IsScalar(), "Component reflection data has a map key that is not a scalar!");
+						AppendU32(out, entry.first.Scalar().size());
+						out.append(entry.first.Scalar());
+						AppendNode(entry.second, out, depth + 1);
+					}
+				} else {
+					for(const YAML::Node& element : node) AppendNode(element, out, depth + 1);
+				}
+				const std::size_t contentSize = out.size() - sizeAt - 4;
+				CheckException(contentSize <= UINT32_MAX, "Component reflection data is too large to convert to binary!");
+				uint32_t cs = (uint32_t)contentSize;
+				std::memcpy(out.data() + sizeAt, &cs, 4);
+				return;
+			}
+		}
+	}
+
+	std::string PackedEncoder::EncodeReflection(std::string_view yaml) {
+		if(ReflectionView::IsBinary(yaml)) return std::string(yaml);
+
+		//Parse the YAML
+		YAML::Node root;
+		try {
+			root = YAML::Load(std::string(yaml));
+		} catch(...) {
+			CheckException(false, "Failed to parse component reflection data!");
+		}
+
+		//Convert it
+		std::string out(1, '\0');
+		AppendNode(root, out, 0);
+		return out;
+	}
+
+	YAML::Node ReflectionToYAML(const ReflectionView& view) {
+		switch(view.GetType()) {
+			case ReflectionView::Type::Null: return YAML::Node(YAML::NodeType::Null);
+			case ReflectionView::Type::Bool: return YAML::Node(view.AsBool());
+			case ReflectionView::Type::Int: return YAML::Node(view.AsInt());
+			case ReflectionView::Type::Float: {
+				//Whole numbers are written with a fraction so that they are read back as floating-point instead of as integers
+				YAML::Node out(view.AsFloat());
+				const std::string& text = out.Scalar();
+				if(text.find_first_of(".eEn") == std::string::npos) out = text + ".0";
+				return out;
+			}
+			case ReflectionView::Type::String: {
+				//Strings that would be read back as another type (like "007", "yes", or "null") are tagged so that they stay strings
+				YAML::Node out(std::string(view.AsString()));
+				int64_t i;
+				double d;
+				bool b;
+				const std::string& text = out.Scalar();
+				if(text.empty() || text == "~" || text == "null" || text == "Null" || text == "NULL" || YAML::convert<int64_t>::decode(out, i) || YAML::convert<double>::decode(out, d) || YAML::convert<bool>::decode(out, b)) out.SetTag("tag:yaml.org,2002:str");
+				return out;
+			}
+			case ReflectionView::Type::Sequence: {
+				YAML::Node out(YAML::NodeType::Sequence);
+				for(ReflectionView element : view) out.push_back(ReflectionToYAML(element));
+				return out;
+			}
+			case ReflectionView::Type::Map: {
+				YAML::Node out(YAML::NodeType::Map);
+				for(ReflectionView::Iterator it = view.begin(); it != view.end(); ++it) out[std::string(it.Key())] = ReflectionToYAML(*it);
+				return out;
+			}
+		}
+		return YAML::Node();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "libcacaoformats.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+namespace libcacaoformats {
+	/**
+	 * @brief Convert binary reflection data back into a YAML node
+	 *
+	 * Every value keeps its type when the node is emitted and encoded again. Floats always have a fraction, and strings that look like another type are tagged !!str.
+	 *
+	 * @param view The top-level value of the reflection data
+	 *
+	 * @return The YAML node
+	 */
+	YAML::Node ReflectionToYAML(const ReflectionView& view);
+}
\ No newline at end of file
@@ -2,10 +2,14 @@
 
 #include "libcacaocommon.hpp"
 #include "YAMLValidate.hpp"
+#include "YAMLEvents.hpp"
+#include "UnpackedSchema.hpp"
 
 #include "yaml-cpp/yaml.h"
 
 #include <iostream>
+#include <optional>
+#include <string_view>
 
 namespace libcacaoformats {
 	unsigned int stou(std::string value) {
@@ -14,6 +18,15 @@ namespace libcacaoformats {
 		return (unsigned int)i;
 	}
 
+	//Get the index of a material key base type, or -1 if it is invalid
+	static int MaterialBaseType(std::string_view name) {
+		constexpr std::array<std::string_view, 5> okTypes = {{"int", "uint", "float", "tex2d", "cubemap"}};
+		for(int i = 0; i < (int)okTypes.size(); ++i) {
+			if(okTypes[i] == name) return i;
+		}
+		return -1;
+	}
+
 	std::array<libcacaoimage::Image, 6> UnpackedDecoder::DecodeCubemap(std::istream& data, std::function<std::unique_ptr<std::istream>(const std::string&)> loader) {
 		CheckException(data.good(), "Data stream for unpacked cubemap is invalid!");
 
@@ -66,39 +79,28 @@ namespace libcacaoformats {
 		return out;
 	}
 
-	Material UnpackedDecoder::DecodeMaterial(std::istream& data) {
-		CheckException(data.good(), "Data stream for unpacked material is invalid!");
-
-		//Load YAML
-		YAML::Node root;
-		try {
-			root = YAML::Load(data);
-		} catch(...) {
-			CheckException(false, "Failed to parse unpacked material data stream!");
-		}
-
+	template<typename NodeT>
+	Material DecodeMaterialNode(const NodeT& root) {
 		Material out;
 
 		//Validate and parse structure
-		YAML::Node shader = root["shader"];
+		NodeT shader = root["shader"];
 		ValidateYAMLNode(shader, YAML::NodeType::value::Scalar, "unpacked material data", "shader reference");
 		out.shader = shader.Scalar();
-		YAML::Node dataRoot = root["data"];
+		NodeT dataRoot = root["data"];
 		ValidateYAMLNode(dataRoot, YAML::NodeType::Sequence, "unpacked material data", "key list");
-		for(const YAML::Node& node : dataRoot) {
-			constexpr std::array<const char*, 5> okTypes = {{"int", "uint", "float", "tex2d", "cubemap"}};
+		for(const NodeT& node : dataRoot) {
 			ValidateYAMLNode(node["name"], YAML::NodeType::value::Scalar, "unpacked material data key", "key name");
-			ValidateYAMLNode(node["baseType"], YAML::NodeType::value::Scalar, [&okTypes](const YAML::Node& node2) {
-				auto it = std::find(okTypes.begin(), okTypes.end(), std::string(node2.Scalar().c_str()));
-				return (it != okTypes.end() ? "" : "Invalid base type"); }, "unpacked material data key", "key base type");
-			ValidateYAMLNode(node["x"], YAML::NodeType::value::Scalar, [](const YAML::Node& node2) {
+			ValidateYAMLNode(node["baseType"], YAML::NodeType::value::Scalar, [](const NodeT& node2) {
+				return (MaterialBaseType(node2.Scalar()) >= 0 ? "" : "Invalid base type"); }, "unpacked material data key", "key base type");
+			ValidateYAMLNode(node["x"], YAML::NodeType::value::Scalar, [](const NodeT& node2) {
 				try {
 					int val = std::stoi(node2.Scalar().c_str(), nullptr);
 					return (val > 0 && val < 5) ? "" : "Invalid size value";
 				} catch(...) {
 					return "Unable to convert value to integer";
 				} }, "unpacked material data key", "key x size");
-			ValidateYAMLNode(node["y"], YAML::NodeType::value::Scalar, [](const YAML::Node& node2) {
+			ValidateYAMLNode(node["y"], YAML::NodeType::value::Scalar, [](const NodeT& node2) {
 				try {
 					int val = std::stoi(node2.Scalar().c_str(), nullptr);
 					return (val > 0 && val < 5) ? "" : "Invalid size value";
@@ -106,12 +108,9 @@ namespace libcacaoformats {
 					return "Unable to convert value to integer";
 				} }, "unpacked material data key", "key y size");
 			Material::ValueContainer value;
-			const auto valFunc = [&node, &value, &okTypes](const YAML::Node& node2) {
-				int idx = 0;
-				for(; idx < okTypes.size(); idx++) {
-					if(node["baseType"].Scalar().compare(okTypes[idx]) == 0) break;
-				}
-				if(idx > 4) return "Invalid base type";
+			const auto valFunc = [&node, &value](const NodeT& node2) -> std::string {
+				int idx = MaterialBaseType(node["baseType"].Scalar());
+				if(idx < 0) return "Invalid base type";
 				Vec2<int> size;
 				try {
 					size.x = std::stoi(node["x"].Scalar().c_str(), nullptr);
@@ -128,7 +127,7 @@ namespace libcacaoformats {
 				}
 				if(idx >= 3 && size.y != 1) return "Invalid y size value for texture";
 				if(idx >= 3) {
-					value = Material::TextureRef {.path = node2.Scalar(), .isCubemap = idx == 5};
+					value = Material::TextureRef {.path = node2.Scalar(), .isCubemap = idx == 4};
 					return "";
 				}
 				if(!(size.y != 1 || (size.x == 1 && size.y == 1))) return "Invalid y size for an x size 1";
@@ -309,7 +308,7 @@ namespace libcacaoformats {
 									v.data[0][2] = std::strtof(node2[0][2].Scalar().c_str(), nullptr);
 									v.data[1][0] = std::strtof(node2[1][0].Scalar().c_str(), nullptr);
 									v.data[1][1] = std::strtof(node2[1][1].Scalar().c_str(), nullptr);
-									v.data[1][2] = std::strtof(node2[1][0].Scalar().c_str(), nullptr);
+									v.data[1][2] = std::strtof(node2[1][2].Scalar().c_str(), nullptr);
 									v.data[2][0] = std::strtof(node2[2][0].Scalar().c_str(), nullptr);
 									v.data[2][1] = std::strtof(node2[2][1].Scalar().c_str(), nullptr);
 									v.data[2][2] = std::strtof(node2[2][2].Scalar().c_str(), nullptr);
@@ -340,8 +339,8 @@ namespace libcacaoformats {
 								}
 								case 14: {
 									if(!(node2.IsSequence() && node2.size() == 2)) return "Non-2-row matrix supplied for 4x2 matrix key";
-									if(!(node2[0].IsSequence() && node2[0].size() == 4 && node2[0][0].IsScalar() && node2[0][1].IsScalar() && node[0][2].IsScalar() && node[0][3].IsScalar())) return "Non-4 float sequence supplied at row 1 of 4x2 matrix";
-									if(!(node2[1].IsSequence() && node2[1].size() == 4 && node2[1][0].IsScalar() && node2[1][1].IsScalar() && node[1][2].IsScalar() && node[1][3].IsScalar())) return "Non-4 float sequence supplied at row 2 of 4x2 matrix";
+									if(!(node2[0].IsSequence() && node2[0].size() == 4 && node2[0][0].IsScalar() && node2[0][1].IsScalar() && node2[0][2].IsScalar() && node2[0][3].IsScalar())) return "Non-4 float sequence supplied at row 1 of 4x2 matrix";
+									if(!(node2[1].IsSequence() && node2[1].size() == 4 && node2[1][0].IsScalar() && node2[1][1].IsScalar() && node2[1][2].IsScalar() && node2[1][3].IsScalar())) return "Non-4 float sequence supplied at row 2 of 4x2 matrix";
 									Matrix<float, 4, 2> v;
 									v.data[0][0] = std::strtof(node2[0][0].Scalar().c_str(), nullptr);
 									v.data[0][1] = std::strtof(node2[0][1].Scalar().c_str(), nullptr);
@@ -356,9 +355,9 @@ namespace libcacaoformats {
 								}
 								case 15: {
 									if(!(node2.IsSequence() && node2.size() == 3)) return "Non-3-row matrix supplied for 4x3 matrix key";
-									if(!(node2[0].IsSequence() && node2[0].size() == 4 && node2[0][0].IsScalar() && node2[0][1].IsScalar() && node[0][2].IsScalar() && node[0][3].IsScalar())) return "Non-4 float sequence supplied at row 1 of 4x3 matrix";
-									if(!(node2[1].IsSequence() && node2[1].size() == 4 && node2[1][0].IsScalar() && node2[1][1].IsScalar() && node[1][2].IsScalar() && node[1][3].IsScalar())) return "Non-4 float sequence supplied at row 2 of 4x3 matrix";
-									if(!(node2[2].IsSequence() && node2[2].size() == 4 && node2[2][0].IsScalar() && node2[2][1].IsScalar() && node[2][2].IsScalar() && node[2][3].IsScalar())) return "Non-4 float sequence supplied at row 3 of 4x3 matrix";
+									if(!(node2[0].IsSequence() && node2[0].size() == 4 && node2[0][0].IsScalar() && node2[0][1].IsScalar() && node2[0][2].IsScalar() && node2[0][3].IsScalar())) return "Non-4 float sequence supplied at row 1 of 4x3 matrix";
+									if(!(node2[1].IsSequence() && node2[1].size() == 4 && node2[1][0].IsScalar() && node2[1][1].IsScalar() && node2[1][2].IsScalar() && node2[1][3].IsScalar())) return "Non-4 float sequence supplied at row 2 of 4x3 matrix";
+									if(!(node2[2].IsSequence() && node2[2].size() == 4 && node2[2][0].IsScalar() && node2[2][1].IsScalar() && node2[2][2].IsScalar() && node2[2][3].IsScalar())) return "Non-4 float sequence supplied at row 3 of 4x3 matrix";
 									Matrix<float, 4, 3> v;
 									v.data[0][0] = std::strtof(node2[0][0].Scalar().c_str(), nullptr);
 									v.data[0][1] = std::strtof(node2[0][1].Scalar().c_str(), nullptr);
@@ -366,7 +365,7 @@ namespace libcacaoformats {
 									v.data[0][3] = std::strtof(node2[0][3].Scalar().c_str(), nullptr);
 									v.data[1][0] = std::strtof(node2[1][0].Scalar().c_str(), nullptr);
 									v.data[1][1] = std::strtof(node2[1][1].Scalar().c_str(), nullptr);
-									v.data[1][2] = std::strtof(node2[1][0].Scalar().c_str(), nullptr);
+									v.data[1][2] = std::strtof(node2[1][2].Scalar().c_str(), nullptr);
 									v.data[1][3] = std::strtof(node2[1][3].Scalar().c_str(), nullptr);
 									v.data[2][0] = std::strtof(node2[2][0].Scalar().c_str(), nullptr);
 									v.data[2][1] = std::strtof(node2[2][1].Scalar().c_str(), nullptr);
@@ -377,10 +376,10 @@ namespace libcacaoformats {
 								}
 								case 16: {
 									if(!(node2.IsSequence() && node2.size() == 4)) return "Non-4-row matrix supplied for 4x4 matrix key";
-									if(!(node2[0].IsSequence() && node2[0].size() == 4 && node2[0][0].IsScalar() && node2[0][1].IsScalar() && node[0][2].IsScalar() && node[0][3].IsScalar())) return "Non-4 float sequence supplied at row 1 of 4x4 matrix";
-									if(!(node2[1].IsSequence() && node2[1].size() == 4 && node2[1][0].IsScalar() && node2[1][1].IsScalar() && node[1][2].IsScalar() && node[1][3].IsScalar())) return "Non-4 float sequence supplied at row 2 of 4x4 matrix";
-									if(!(node2[2].IsSequence() && node2[2].size() == 4 && node2[2][0].IsScalar() && node2[2][1].IsScalar() && node[2][2].IsScalar() && node[2][3].IsScalar())) return "Non-4 float sequence supplied at row 3 of 4x4 matrix";
-									if(!(node2[3].IsSequence() && node2[3].size() == 4 && node2[3][0].IsScalar() && node2[3][1].IsScalar() && node[3][2].IsScalar() && node[3][3].IsScalar())) return "Non-4 float sequence supplied at row 4 of 4x4 matrix";
+									if(!(node2[0].IsSequence() && node2[0].size() == 4 && node2[0][0].IsScalar() && node2[0][1].IsScalar() && node2[0][2].IsScalar() && node2[0][3].IsScalar())) return "Non-4 float sequence supplied at row 1 of 4x4 matrix";
+									if(!(node2[1].IsSequence() && node2[1].size() == 4 && node2[1][0].IsScalar() && node2[1][1].IsScalar() && node2[1][2].IsScalar() && node2[1][3].IsScalar())) return "Non-4 float sequence supplied at row 2 of 4x4 matrix";
+									if(!(node2[2].IsSequence() && node2[2].size() == 4 && node2[2][0].IsScalar() && node2[2][1].IsScalar() && node2[2][2].IsScalar() && node2[2][3].IsScalar())) return "Non-4 float sequence supplied at row 3 of 4x4 matrix";
+									if(!(node2[3].IsSequence() && node2[3].size() == 4 && node2[3][0].IsScalar() && node2[3][1].IsScalar() && node2[3][2].IsScalar() && node2[3][3].IsScalar())) return "Non-4 float sequence supplied at row 4 of 4x4 matrix";
 									Matrix<float, 4, 4> v;
 									v.data[0][0] = std::strtof(node2[0][0].Scalar().c_str(), nullptr);
 									v.data[0][1] = std::strtof(node2[0][1].Scalar().c_str(), nullptr);
@@ -411,41 +410,42 @@ namespace libcacaoformats {
 				}
 				return "";
 			};
-			try {
-				ValidateYAMLNode(node["value"], valFunc, "unpacked material data key", "key value");
-				out.keys.insert_or_assign(node["name"].Scalar(), value);
-			} catch(...) {
-				std::rethrow_exception(std::current_exception());
-			}
+			ValidateYAMLNode<NodeT>(node["value"], valFunc, "unpacked material data key", "key value");
+			out.keys.insert_or_assign(node["name"].Scalar(), value);
 		}
 
 		//Return result
 		return out;
 	}
 
-	World UnpackedDecoder::DecodeWorld(std::istream& data) {
+
+	Material UnpackedDecoder::DecodeMaterial(std::istream& data) {
 		CheckException(data.good(), "Data stream for unpacked material is invalid!");
 
 		//Load YAML
-		YAML::Node root;
+		std::optional<YAMLEventDocument> doc;
 		try {
-			root = YAML::Load(data);
+			doc.emplace(data);
 		} catch(...) {
 			CheckException(false, "Failed to parse unpacked material data stream!");
 		}
 
+		return DecodeMaterialNode(doc->Root());
+	}
+
+	template<typename NodeT>
+	void DecodeWorldHeaderNode(const NodeT& root, World& out) {
 		//Validate and parse structure
-		World out;
-		YAML::Node sky = root["skybox"];
+		NodeT sky = root["skybox"];
 		if(sky) {
 			ValidateYAMLNode(sky, YAML::NodeType::value::Scalar, "unpacked world data", "skybox asset path");
 			out.skyboxRef = sky.Scalar();
 		} else {
 			out.skyboxRef = "";
 		}
-		YAML::Node cam = root["cam"];
-		ValidateYAMLNode(cam, YAML::NodeType::value::Map, [&out](const YAML::Node& node) {
-			YAML::Node p = node["position"], r = node["rotation"];
+		NodeT cam = root["cam"];
+		ValidateYAMLNode(cam, YAML::NodeType::value::Map, [&out](const NodeT& node) {
+			NodeT p = node["position"], r = node["rotation"];
 			try {
 				if(!(p.IsMap() && p["x"].IsScalar() && p["y"].IsScalar() && p["z"].IsScalar())) return "Expected 'x', 'y', and 'z' scalar values for camera initial position";
 				out.initialCamPos.x = std::strtof(p["x"].Scalar().c_str(), nullptr);
@@ -460,96 +460,123 @@ namespace libcacaoformats {
 			}
 			return ""; }, "unpacked world data", "initial camera state");
 		ValidateYAMLNode(root["actors"], YAML::NodeType::value::Sequence, "unpacked world data", "actors list");
-		for(const YAML::Node& e : root["actors"]) {
-			World::Actor actor;
-
-			YAML::Node name = e["name"];
-			ValidateYAMLNode(name, YAML::NodeType::value::Scalar, "unpacked world actor", "actor name");
-			actor.name = name.Scalar();
-
-			YAML::Node guid = e["guid"];
-			ValidateYAMLNode(guid, YAML::NodeType::value::Scalar, [](const YAML::Node& node) {
-				for(char c : node.Scalar()) {
-					if(c == '-') continue;
-					if(c < 48 || c > 102 || (c > 57 && c < 97)) {
-						std::stringstream ss;
-						ss << "Invalid GUID character \"" << c << "\"";
-						return ss.str();
-					}
+	}
+
+	template<typename NodeT>
+	World::Actor DecodeWorldActorNode(const NodeT& e) {
+		World::Actor actor;
+
+		NodeT name = e["name"];
+		ValidateYAMLNode(name, YAML::NodeType::value::Scalar, "unpacked world actor", "actor name");
+		actor.name = name.Scalar();
+
+		NodeT guid = e["guid"];
+		ValidateYAMLNode(guid, YAML::NodeType::value::Scalar, [](const NodeT& node) {
+			for(char c : node.Scalar()) {
+				if(c == '-') continue;
+				if(c < 48 || c > 102 || (c > 57 && c < 97)) {
+					std::stringstream ss;
+					ss << "Invalid GUID character \"" << c << "\"";
+					return ss.str();
 				}
-				return std::string(""); }, "unpacked world actor", "GUID");
-			actor.guid = xg::Guid(guid.Scalar());
-
-			YAML::Node parentGUID = e["parent"];
-			ValidateYAMLNode(parentGUID, YAML::NodeType::value::Scalar, [](const YAML::Node& node) {
-				for(char c : node.Scalar()) {
-					if(c == '-') continue;
-					if(c < 48 || c > 102 || (c > 57 && c < 97)) {
-						std::stringstream ss;
-						ss << "Invalid GUID character \"" << c << "\"";
-						return ss.str();
-					}
+			}
+			return std::string(""); }, "unpacked world actor", "GUID");
+		actor.guid = xg::Guid(guid.Scalar());
+
+		NodeT parentGUID = e["parent"];
+		ValidateYAMLNode(parentGUID, YAML::NodeType::value::Scalar, [](const NodeT& node) {
+			for(char c : node.Scalar()) {
+				if(c == '-') continue;
+				if(c < 48 || c > 102 || (c > 57 && c < 97)) {
+					std::stringstream ss;
+					ss << "Invalid GUID character \"" << c << "\"";
+					return ss.str();
 				}
-				return std::string(""); }, "unpacked world actor", "parent GUID");
-			actor.parentGUID = xg::Guid(parentGUID.Scalar());
-
-			YAML::Node transform = e["transform"];
-			ValidateYAMLNode(transform, YAML::NodeType::value::Map, "unpacked world actor", "initial transform");
-
-			YAML::Node pos = transform["position"];
-			ValidateYAMLNode(pos, YAML::NodeType::value::Map, [](const YAML::Node& node) {
-				if(!node["x"].IsScalar()) return "X value is not a scalar";
-				if(!node["y"].IsScalar()) return "Y value is not a scalar";
-				if(!node["z"].IsScalar()) return "Z value is not a scalar";
-				return ""; }, "unpacked world actor transform", "position property");
-			actor.initialPos.x = std::strtof(pos["x"].Scalar().c_str(), nullptr);
-			actor.initialPos.y = std::strtof(pos["y"].Scalar().c_str(), nullptr);
-			actor.initialPos.z = std::strtof(pos["z"].Scalar().c_str(), nullptr);
-
-			YAML::Node rot = transform["rotation"];
-			ValidateYAMLNode(rot, YAML::NodeType::value::Map, [](const YAML::Node& node) {
-				if(!node["x"].IsScalar()) return "X value is not a scalar";
-				if(!node["y"].IsScalar()) return "Y value is not a scalar";
-				if(!node["z"].IsScalar()) return "Z value is not a scalar";
-				return ""; }, "unpacked world actor transform", "rotation property");
-			actor.initialRot.x = std::strtof(rot["x"].Scalar().c_str(), nullptr);
-			actor.initialRot.y = std::strtof(rot["y"].Scalar().c_str(), nullptr);
-			actor.initialRot.z = std::strtof(rot["z"].Scalar().c_str(), nullptr);
-
-			YAML::Node scl = transform["scale"];
-			ValidateYAMLNode(scl, YAML::NodeType::value::Map, [](const YAML::Node& node) {
-				if(!node["x"].IsScalar()) return "X value is not a scalar";
-				if(!node["y"].IsScalar()) return "Y value is not a scalar";
-				if(!node["z"].IsScalar()) return "Z value is not a scalar";
-				return ""; }, "unpacked world actor transform", "scale property");
-			actor.initialScale.x = std::strtof(scl["x"].Scalar().c_str(), nullptr);
-			actor.initialScale.y = std::strtof(scl["y"].Scalar().c_str(), nullptr);
-			actor.initialScale.z = std::strtof(scl["z"].Scalar().c_str(), nullptr);
-
-			YAML::Node components = e["components"];
-			ValidateYAMLNode(components, YAML::NodeType::value::Sequence, "unpacked world actor", "component list");
-			for(const YAML::Node& c : components) {
-				World::Component component;
-
-				YAML::Node id = c["id"];
-				ValidateYAMLNode(id, YAML::NodeType::value::Scalar, "unpacked world actor component", "component ID");
-				component.typeID = id.Scalar();
-
-				YAML::Node rfl = c["rfl"];
-				ValidateYAMLNode(rfl, [](const YAML::Node& node) { return (node.IsDefined() ? "" : "Reflection data doesn't exist"); }, "unpacked world actor component", "component reflection data");
-
-				//We use this to get the reflection data node back out as a string
-				YAML::Emitter emitter;
-				emitter << rfl;
-				component.reflection = emitter.c_str();
-
-				actor.components.push_back(component);
 			}
+			return std::string(""); }, "unpacked world actor", "parent GUID");
+		actor.parentGUID = xg::Guid(parentGUID.Scalar());
+
+		NodeT transform = e["transform"];
+		ValidateYAMLNode(transform, YAML::NodeType::value::Map, "unpacked world actor", "initial transform");
+
+		NodeT pos = transform["position"];
+		ValidateYAMLNode(pos, YAML::NodeType::value::Map, [](const NodeT& node) {
+			if(!node["x"].IsScalar()) return "X value is not a scalar";
+			if(!node["y"].IsScalar()) return "Y value is not a scalar";
+			if(!node["z"].IsScalar()) return "Z value is not a scalar";
+			return ""; }, "unpacked world actor transform", "position property");
+		actor.initialPos.x = std::strtof(pos["x"].Scalar().c_str(), nullptr);
+		actor.initialPos.y = std::strtof(pos["y"].Scalar().c_str(), nullptr);
+		actor.initialPos.z = std::strtof(pos["z"].Scalar().c_str(), nullptr);
+
+		NodeT rot = transform["rotation"];
+		ValidateYAMLNode(rot, YAML::NodeType::value::Map, [](const NodeT& node) {
+			if(!node["x"].IsScalar()) return "X value is not a scalar";
+			if(!node["y"].IsScalar()) return "Y value is not a scalar";
+			if(!node["z"].IsScalar()) return "Z value is not a scalar";
+			return ""; }, "unpacked world actor transform", "rotation property");
+		actor.initialRot.x = std::strtof(rot["x"].Scalar().c_str(), nullptr);
+		actor.initialRot.y = std::strtof(rot["y"].Scalar().c_str(), nullptr);
+		actor.initialRot.z = std::strtof(rot["z"].Scalar().c_str(), nullptr);
+
+		NodeT scl = transform["scale"];
+		ValidateYAMLNode(scl, YAML::NodeType::value::Map, [](const NodeT& node) {
+			if(!node["x"].IsScalar()) return "X value is not a scalar";
+			if(!node["y"].IsScalar()) return "Y value is not a scalar";
+			if(!node["z"].IsScalar()) return "Z value is not a scalar";
+			return ""; }, "unpacked world actor transform", "scale property");
+		actor.initialScale.x = std::strtof(scl["x"].Scalar().c_str(), nullptr);
+		actor.initialScale.y = std::strtof(scl["y"].Scalar().c_str(), nullptr);
+		actor.initialScale.z = std::strtof(scl["z"].Scalar().c_str(), nullptr);
+
+		NodeT components = e["components"];
+		ValidateYAMLNode(components, YAML::NodeType::value::Sequence, "unpacked world actor", "component list");
+		for(const NodeT& c : components) {
+			World::Component component;
+
+			NodeT id = c["id"];
+			ValidateYAMLNode(id, YAML::NodeType::value::Scalar, "unpacked world actor component", "component ID");
+			component.typeID = id.Scalar();
+
+			NodeT rfl = c["rfl"];
+			ValidateYAMLNode(rfl, [](const NodeT& node) { return (node.IsDefined() ? "" : "Reflection data doesn't exist"); }, "unpacked world actor component", "component reflection data");
+
+			//We use this to get the reflection data node back out as a string
+			YAML::Emitter emitter;
+			EmitYAML(emitter, rfl);
+			component.reflection = emitter.c_str();
+
+			actor.components.push_back(component);
+		}
+
+		return actor;
+	}
+
+	World UnpackedDecoder::DecodeWorld(std::istream& data) {
+		CheckException(data.good(), "Data stream for unpacked material is invalid!");
 
-			out.actors.push_back(actor);
+		//Load YAML, decoding actors as soon as each one has been parsed
+		World out;
+		std::optional<YAMLEventDocument> doc;
+		try {
+			doc.emplace(data, "actors", [&out](const YAMLEventNode& actor) {
+				out.actors.push_back(DecodeWorldActorNode(actor));
+			});
+		} catch(const YAML::Exception&) {
+			CheckException(false, "Failed to parse unpacked material data stream!");
 		}
 
+		//Validate and parse the rest of the structure
+		DecodeWorldHeaderNode(doc->Root(), out);
+
 		//Return result
 		return out;
 	}
+
+	template Material DecodeMaterialNode(const YAML::Node&);
+	template Material DecodeMaterialNode(const YAMLEventNode&);
+	template void DecodeWorldHeaderNode(const YAML::Node&, World&);
+	template void DecodeWorldHeaderNode(const YAMLEventNode&, World&);
+	template World::Actor DecodeWorldActorNode(const YAML::Node&);
+	template World::Actor DecodeWorldActorNode(const YAMLEventNode&);
 }
\ No newline at end of file
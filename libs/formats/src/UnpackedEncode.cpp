@@ -2,6 +2,8 @@
 
 #include "libcacaocommon.hpp"
 
+#include "Reflection.hpp"
+
 #include "yaml-cpp/yaml.h"
 
 namespace libcacaoformats {
@@ -391,7 +393,7 @@ namespace libcacaoformats {
 				yml << YAML::Key << "id" << YAML::Value << c.typeID;
 
 				//Remake YAML node to embed
-				YAML::Node rflNode = YAML::Load(c.reflection);
+				YAML::Node rflNode = ReflectionView::IsBinary(c.reflection) ? ReflectionToYAML(ReflectionView::Open(c.reflection)) : YAML::Load(c.reflection);
 				yml << YAML::Key << "rfl" << rflNode;
 
 				yml << YAML::EndMap;
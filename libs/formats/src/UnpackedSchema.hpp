@@ -0,0 +1,49 @@
+#pragma once
+
+#include "libcacaoformats.hpp"
+
+#include "YAMLEvents.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+/*
+ * Schema decoding for unpacked materials and worlds
+ *
+ * These work on either a YAMLEventNode or a YAML::Node. UnpackedDecoder uses YAMLEventNode, which is much faster;
+ * the YAML::Node versions decode exactly the same way and exist so that the two can be compared in benchmarks.
+ */
+
+namespace libcacaoformats {
+	/**
+	 * @brief Decode a material from the root node of an unpacked material
+	 *
+	 * @throws std::runtime_error If the data does not represent a valid material
+	 */
+	template<typename NodeT>
+	Material DecodeMaterialNode(const NodeT& root);
+
+	/**
+	 * @brief Decode everything except the actors from the root node of an unpacked world
+	 *
+	 * The actor list is only checked to be a sequence.
+	 *
+	 * @throws std::runtime_error If the data does not represent a valid world
+	 */
+	template<typename NodeT>
+	void DecodeWorldHeaderNode(const NodeT& root, World& out);
+
+	/**
+	 * @brief Decode an element of the actor list of an unpacked world
+	 *
+	 * @throws std::runtime_error If the data does not represent a valid actor
+	 */
+	template<typename NodeT>
+	World::Actor DecodeWorldActorNode(const NodeT& node);
+
+	extern template Material DecodeMaterialNode(const YAML::Node&);
+	extern template Material DecodeMaterialNode(const YAMLEventNode&);
+	extern template void DecodeWorldHeaderNode(const YAML::Node&, World&);
+	extern template void DecodeWorldHeaderNode(const YAMLEventNode&, World&);
+	extern template World::Actor DecodeWorldActorNode(const YAML::Node&);
+	extern template World::Actor DecodeWorldActorNode(const YAMLEventNode&);
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "libcacaoformats.hpp"
+
+#include "libcacaocommon.hpp"
+
+#include "WorldColumns.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+
+namespace libcacaoformats {
+	static bool CellBefore(const Vec3<int32_t>& a, const Vec3<int32_t>& b) {
+		return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+	}
+
+	PackedWorldCells PackedWorldCells::FromContainer(const PackedContainer& container) {
+		CheckException(container.format == PackedFormat::World, "Packed container provided for world decoding is not a world!");
+		CheckException(container.version <= 3, "World packed container is a newer version than is supported!");
+		PackedWorldCells out;
+
+		//Unpartitioned worlds are one cell at the origin
+		if(container.version < 3) {
+			WorldColumns columns;
+			PackedDecoder().DecodeWorldColumns(container, columns);
+			out.skyboxRef = columns.skyboxRef;
+			out.initialCamPos = columns.initialCamPos;
+			out.initialCamRot = columns.initialCamRot;
+
+			//Re-encode the actors as a chunk so that every version decodes cells the same way
+			std::vector<char> chunk;
+			{
+				obytestream chunkStream(chunk);
+				WriteWorldActors(columns, chunkStream);
+			}
+			out.chunks = PackedPayload(std::vector<unsigned char>(chunk.begin(), chunk.end()));
+			out.cells.push_back(Cell {.coords = {0, 0, 0}, .actorCount = columns.ActorCount()});
+			out.ranges.emplace_back(0, out.chunks.size());
+			return out;
+		}
+
+		//Read header
+		const unsigned char* data = container.payload.data();
+		const std::size_t size = container.payload.size();
+		WorldColumns header;
+		std::size_t advance = ReadWorldHeader(data, size, header);
+		out.skyboxRef = std::move(header.skyboxRef);
+		out.initialCamPos = header.initialCamPos;
+		out.initialCamRot = header.initialCamRot;
+		const auto take = [&](void* dst, std::size_t len, const char* what) {
+			CheckException(len <= size - advance, what);
+			std::memcpy(dst, data + advance, len);
+			advance += len;
+		};
+
+		//Read cell records
+		uint32_t cellCount = 0;
+		take(&out.cellSize, 4, "World packed container is too small to contain cell size!");
+		take(&cellCount, 4, "World packed container is too small to contain cell count!");
+		CheckException(std::isfinite(out.cellSize) && out.cellSize > 0, "World packed container has invalid cell size!");
+		CheckException(cellCount <= (size - advance) / 36, "World packed container is too small to contain cell records!");
+		out.cells.resize(cellCount);
+		out.ranges.resize(cellCount);
+		for(uint32_t i = 0; i < cellCount; ++i) {
+			int32_t coords[3];
+			take(coords, sizeof(coords), "World packed container is too small to contain cell records!");
+			out.cells[i].coords = Vec3<int32_t> {.x = coords[0], .y = coords[1], .z = coords[2]};
+			take(&out.cells[i].actorCount, 8, "World packed container is too small to contain cell records!");
+			take(&out.ranges[i].first, 8, "World packed container is too small to contain cell records!");
+			take(&out.ranges[i].second, 8, "World packed container is too small to contain cell records!");
+			if(i > 0) CheckException(CellBefore(out.cells[i - 1].coords, out.cells[i].coords), "World packed container cell records are not sorted!");
+		}
+
+		//Make sure every chunk is in range
+		out.chunks = container.payload.Slice(advance, size - advance);
+		for(const auto& [offset, chunkSize] : out.ranges) {
+			CheckException(offset <= out.chunks.size() && chunkSize <= out.chunks.size() - offset, "World packed container cell data is out of range!");
+		}
+		return out;
+	}
+
+	std::optional<std::size_t> PackedWorldCells::FindCell(Vec3<int32_t> coords) const {
+		auto it = std::lower_bound(cells.begin(), cells.end(), coords, [](const Cell& cell, const Vec3<int32_t>& c) { return CellBefore(cell.coords, c); });
+		if(it == cells.end() || CellBefore(coords, it->coords)) return std::nullopt;
+		return std::size_t(it - cells.begin());
+	}
+
+	void PackedWorldCells::DecodeCell(std::size_t idx, WorldColumns& out) const {
+		CheckException(idx < cells.size(), "World cell index is out of range!");
+		out.skyboxRef = skyboxRef;
+		out.initialCamPos = initialCamPos;
+		out.initialCamRot = initialCamRot;
+		ReadWorldActors(chunks.data() + ranges[idx].first, ranges[idx].second, out);
+		CheckException(out.ActorCount() == cells[idx].actorCount, "World packed container cell has a different actor count than its record!");
+	}
+}
\ No newline at end of file
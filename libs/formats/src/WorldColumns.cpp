@@ -0,0 +1,267 @@
+#include "WorldColumns.hpp"
+
+#include "libcacaocommon.hpp"
+
+#include <cstring>
+#include <climits>
+#include <unordered_map>
+
+namespace libcacaoformats {
+	void WorldToColumns(const World& world, WorldColumns& out) {
+		CheckException(world.actors.size() < UINT32_MAX, "World has too many actors to store in column-oriented form!");
+		out.skyboxRef = world.skyboxRef;
+		out.initialCamPos = world.initialCamPos;
+		out.initialCamRot = world.initialCamRot;
+
+		//Reset columns without giving up their storage
+		const std::size_t actorCount = world.actors.size();
+		out.guids.resize(actorCount);
+		out.parentGUIDs.resize(actorCount);
+		out.names.resize(actorCount);
+		out.positions.resize(actorCount);
+		out.rotations.resize(actorCount);
+		out.scales.resize(actorCount);
+		out.componentStarts.clear();
+		out.componentTypes.clear();
+		out.reflectionStarts.clear();
+		out.reflectionData.clear();
+		out.stringStarts.clear();
+		out.stringData.clear();
+
+		//Identical strings share one table entry
+		std::unordered_map<std::string_view, uint32_t> stringIDs;
+		const auto intern = [&out, &stringIDs](std::string_view str) {
+			auto [it, added] = stringIDs.try_emplace(str, (uint32_t)out.stringStarts.size());
+			if(added) {
+				CheckException(out.stringData.size() + str.size() <= UINT32_MAX, "World has too much string data to store in column-oriented form!");
+				out.stringStarts.push_back((uint32_t)out.stringData.size());
+				out.stringData.insert(out.stringData.end(), str.begin(), str.end());
+			}
+			return it->second;
+		};
+
+		for(std::size_t i = 0; i < actorCount; ++i) {
+			const World::Actor& actor = world.actors[i];
+			std::memcpy(out.guids[i].data(), actor.guid.bytes().data(), 16);
+			std::memcpy(out.parentGUIDs[i].data(), actor.parentGUID.bytes().data(), 16);
+			out.names[i] = intern(actor.name);
+			out.positions[i] = actor.initialPos;
+			out.rotations[i] = actor.initialRot;
+			out.scales[i] = actor.initialScale;
+
+			CheckException(out.componentTypes.size() + actor.components.size() < UINT32_MAX, "World has too many components to store in column-oriented form!");
+			out.componentStarts.push_back((uint32_t)out.componentTypes.size());
+			for(const World::Component& component : actor.components) {
+				out.componentTypes.push_back(intern(component.typeID));
+				out.reflectionStarts.push_back(out.reflectionData.size());
+				out.reflectionData.insert(out.reflectionData.end(), component.reflection.begin(), component.reflection.end());
+			}
+		}
+
+		//Close off the offset columns
+		out.componentStarts.push_back((uint32_t)out.componentTypes.size());
+		out.reflectionStarts.push_back(out.reflectionData.size());
+		out.stringStarts.push_back((uint32_t)out.stringData.size());
+	}
+
+	World ColumnsToWorld(const WorldColumns& columns) {
+		World out {};
+		out.skyboxRef = columns.skyboxRef;
+		out.initialCamPos = columns.initialCamPos;
+		out.initialCamRot = columns.initialCamRot;
+
+		out.actors.resize(columns.ActorCount());
+		for(std::size_t i = 0; i < columns.ActorCount(); ++i) {
+			World::Actor& actor = out.actors[i];
+			actor.guid = xg::Guid(columns.guids[i]);
+			actor.parentGUID = xg::Guid(columns.parentGUIDs[i]);
+			actor.name = columns.String(columns.names[i]);
+			actor.initialPos = columns.positions[i];
+			actor.initialRot = columns.rotations[i];
+			actor.initialScale = columns.scales[i];
+
+			actor.components.resize(columns.componentStarts[i + 1] - columns.componentStarts[i]);
+			for(uint32_t c = columns.componentStarts[i], j = 0; c < columns.componentStarts[i + 1]; ++c, ++j) {
+				actor.components[j].typeID = columns.String(columns.componentTypes[c]);
+				actor.components[j].reflection = columns.Reflection(c);
+			}
+		}
+		return out;
+	}
+
+	void ValidateWorldColumns(const WorldColumns& columns) {
+		const std::size_t actorCount = columns.guids.size();
+		const std::size_t componentCount = columns.componentTypes.size();
+		const std::size_t stringCount = columns.stringStarts.empty() ? 0 : columns.stringStarts.size() - 1;
+
+		//Column sizes
+		CheckException(columns.parentGUIDs.size() == actorCount && columns.names.size() == actorCount && columns.positions.size() == actorCount && columns.rotations.size() == actorCount && columns.scales.size() == actorCount, "World actor columns have mismatched sizes!");
+		CheckException(columns.componentStarts.size() == actorCount + 1 && columns.reflectionStarts.size() == componentCount + 1 && !columns.stringStarts.empty(), "World offset columns have the wrong sizes!");
+
+		//Offsets must run forward and end at the size of what they index
+		const auto checkOffsets = [](const auto& starts, std::size_t total) {
+			if(starts.front() != 0 || starts.back() != total) return false;
+			for(std::size_t i = 1; i < starts.size(); ++i) {
+				if(starts[i] < starts[i - 1]) return false;
+			}
+			return true;
+		};
+		CheckException(checkOffsets(columns.componentStarts, componentCount), "World component offsets are out of range!");
+		CheckException(checkOffsets(columns.reflectionStarts, columns.reflectionData.size()), "World reflection data offsets are out of range!");
+		CheckException(checkOffsets(columns.stringStarts, columns.stringData.size()), "World string table offsets are out of range!");
+
+		//String references
+		for(uint32_t name : columns.names) {
+			CheckException(name < stringCount, "World actor name string index is out of range!");
+		}
+		for(uint32_t type : columns.componentTypes) {
+			CheckException(type < stringCount, "World component type ID string index is out of range!");
+		}
+	}
+
+	void WriteWorldHeader(const WorldColumns& world, std::ostream& out) {
+		CheckException(world.skyboxRef.size() <= UINT16_MAX, "World for packed encoding has too long skybox address string!");
+
+		//Write skybox address string
+		uint16_t saLen = (uint16_t)world.skyboxRef.size();
+		out.write(reinterpret_cast<const char*>(&saLen), 2);
+		out.write(world.skyboxRef.data(), world.skyboxRef.size());
+
+		//Write initial camera data
+		float initialCamData[] = {world.initialCamPos.x, world.initialCamPos.y, world.initialCamPos.z, world.initialCamRot.x, world.initialCamRot.y, world.initialCamRot.z};
+		out.write(reinterpret_cast<const char*>(initialCamData), sizeof(initialCamData));
+	}
+
+	std::size_t ReadWorldHeader(const unsigned char* data, std::size_t size, WorldColumns& out) {
+		std::size_t advance = 0;
+		const auto take = [&](void* dst, std::size_t len, const char* what) {
+			CheckException(len <= size - advance, what);
+			std::memcpy(dst, data + advance, len);
+			advance += len;
+		};
+
+		//Get skybox address string
+		uint16_t saLen = 0;
+		take(&saLen, 2, "World packed container is too small to contain skybox address string size data!");
+		out.skyboxRef.resize(saLen);
+		take(out.skyboxRef.data(), saLen, "World packed container is too small to contain skybox address string!");
+
+		//Get initial camera data
+		float initialCamData[6];
+		take(initialCamData, sizeof(initialCamData), "World packed container is too small to contain initial camera data!");
+		out.initialCamPos = Vec3<float> {.x = initialCamData[0], .y = initialCamData[1], .z = initialCamData[2]};
+		out.initialCamRot = Vec3<float> {.x = initialCamData[3], .y = initialCamData[4], .z = initialCamData[5]};
+		return advance;
+	}
+
+	void WriteWorldActors(const WorldColumns& world, std::ostream& out) {
+		ValidateWorldColumns(world);
+		const auto put = [&out](const auto& value) {
+			out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+		};
+		const auto putColumn = [&out](const auto& column) {
+			out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(column[0]));
+		};
+
+		//Write counts
+		put((uint64_t)world.ActorCount());
+		put((uint64_t)world.componentTypes.size());
+		put((uint32_t)(world.stringStarts.size() - 1));
+		put((uint64_t)world.stringData.size());
+		put((uint64_t)world.reflectionData.size());
+
+		//Write columns
+		putColumn(world.guids);
+		putColumn(world.parentGUIDs);
+		putColumn(world.names);
+		putColumn(world.positions);
+		putColumn(world.rotations);
+		putColumn(world.scales);
+		putColumn(world.componentStarts);
+		putColumn(world.componentTypes);
+		putColumn(world.reflectionStarts);
+		putColumn(world.stringStarts);
+		putColumn(world.stringData);
+		putColumn(world.reflectionData);
+	}
+
+	void ReadWorldActors(const unsigned char* data, std::size_t size, WorldColumns& out) {
+		std::size_t advance = 0;
+		const auto take = [&](void* dst, std::size_t len, const char* what) {
+			CheckException(len <= size - advance, what);
+			std::memcpy(dst, data + advance, len);
+			advance += len;
+		};
+
+		//Get counts
+		uint64_t actorCount = 0, componentCount = 0, stringDataSize = 0, reflectionDataSize = 0;
+		uint32_t stringCount = 0;
+		take(&actorCount, 8, "World packed container is too small to contain actor count!");
+		take(&componentCount, 8, "World packed container is too small to contain component count!");
+		take(&stringCount, 4, "World packed container is too small to contain string count!");
+		take(&stringDataSize, 8, "World packed container is too small to contain string data size!");
+		take(&reflectionDataSize, 8, "World packed container is too small to contain reflection data size!");
+
+		//Make sure every column fits before allocating anything
+		//Each count is bounded by the payload size first so that the column size sums can't overflow
+		const std::size_t remaining = size - advance;
+		CheckException(actorCount < remaining && componentCount < remaining && stringDataSize <= remaining && reflectionDataSize <= remaining, "World packed container is too small to contain actor data!");
+		const uint64_t columnsSize = actorCount * (16 + 16 + 4 + 36 + 4) + 4 + componentCount * (4 + 8) + 8 + (uint64_t(stringCount) + 1) * 4 + stringDataSize + reflectionDataSize;
+		CheckException(columnsSize <= remaining, "World packed container is too small to contain actor data!");
+
+		//Copy out columns
+		const auto takeColumn = [&](auto& column, std::size_t count) {
+			column.resize(count);
+			if(count > 0) std::memcpy(column.data(), data + advance, count * sizeof(column[0]));
+			advance += count * sizeof(column[0]);
+		};
+		takeColumn(out.guids, actorCount);
+		takeColumn(out.parentGUIDs, actorCount);
+		takeColumn(out.names, actorCount);
+		takeColumn(out.positions, actorCount);
+		takeColumn(out.rotations, actorCount);
+		takeColumn(out.scales, actorCount);
+		takeColumn(out.componentStarts, actorCount + 1);
+		takeColumn(out.componentTypes, componentCount);
+		takeColumn(out.reflectionStarts, componentCount + 1);
+		takeColumn(out.stringStarts, std::size_t(stringCount) + 1);
+		takeColumn(out.stringData, stringDataSize);
+		takeColumn(out.reflectionData, reflectionDataSize);
+
+		//Make sure all indices and offsets are in range
+		ValidateWorldColumns(out);
+	}
+
+	void AppendWorldColumns(WorldColumns& dst, const WorldColumns& src) {
+		//An empty destination may not have its offset columns closed off yet
+		if(dst.componentStarts.empty()) dst.componentStarts.push_back(0);
+		if(dst.reflectionStarts.empty()) dst.reflectionStarts.push_back(0);
+		if(dst.stringStarts.empty()) dst.stringStarts.push_back(0);
+
+		const uint32_t componentBase = (uint32_t)dst.componentTypes.size();
+		const uint64_t reflectionBase = dst.reflectionData.size();
+		const uint32_t stringBase = (uint32_t)(dst.stringStarts.size() - 1);
+		const uint32_t stringDataBase = (uint32_t)dst.stringData.size();
+		CheckException(uint64_t(dst.ActorCount()) + src.ActorCount() < UINT32_MAX && uint64_t(componentBase) + src.componentTypes.size() < UINT32_MAX, "Combined world has too many actors or components to store in column-oriented form!");
+		CheckException(uint64_t(stringBase) + src.stringStarts.size() < UINT32_MAX && uint64_t(stringDataBase) + src.stringData.size() <= UINT32_MAX, "Combined world has too much string data to store in column-oriented form!");
+
+		//Per-actor columns are copied as-is, except for string indices
+		dst.guids.insert(dst.guids.end(), src.guids.begin(), src.guids.end());
+		dst.parentGUIDs.insert(dst.parentGUIDs.end(), src.parentGUIDs.begin(), src.parentGUIDs.end());
+		for(uint32_t name : src.names) dst.names.push_back(name + stringBase);
+		dst.positions.insert(dst.positions.end(), src.positions.begin(), src.positions.end());
+		dst.rotations.insert(dst.rotations.end(), src.rotations.begin(), src.rotations.end());
+		dst.scales.insert(dst.scales.end(), src.scales.begin(), src.scales.end());
+
+		//Offset columns drop their closing entry before the appended entries are rebased
+		dst.componentStarts.pop_back();
+		for(uint32_t start : src.componentStarts) dst.componentStarts.push_back(start + componentBase);
+		for(uint32_t type : src.componentTypes) dst.componentTypes.push_back(type + stringBase);
+		dst.reflectionStarts.pop_back();
+		for(uint64_t start : src.reflectionStarts) dst.reflectionStarts.push_back(start + reflectionBase);
+		dst.reflectionData.insert(dst.reflectionData.end(), src.reflectionData.begin(), src.reflectionData.end());
+		dst.stringStarts.pop_back();
+		for(uint32_t start : src.stringStarts) dst.stringStarts.push_back(start + stringDataBase);
+		dst.stringData.insert(dst.stringData.end(), src.stringData.begin(), src.stringData.end());
+	}
+}
\ No newline at end of file
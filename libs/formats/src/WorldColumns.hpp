@@ -0,0 +1,99 @@
+#pragma once
+
+#include "libcacaoformats.hpp"
+
+#include <ostream>
+#include <type_traits>
+
+/*
+ * Column-oriented world (version 2) payload layout
+ *
+ * uint16 skybox address length, skybox address bytes
+ * 6 floats: initial camera position and rotation
+ * uint64 actor count (N), uint64 component count (M), uint32 string count (K), uint64 string data size, uint64 reflection data size
+ * Columns, back to back:
+ *     N × 16 bytes   actor GUIDs
+ *     N × 16 bytes   parent GUIDs
+ *     N × uint32     name string indices
+ *     N × 3 floats   initial positions
+ *     N × 3 floats   initial rotations
+ *     N × 3 floats   initial scales
+ *     (N+1) × uint32 first component index of each actor, then M
+ *     M × uint32     component type ID string indices
+ *     (M+1) × uint64 reflection data offset of each component, then the reflection data size
+ *     (K+1) × uint32 string offset of each string, then the string data size
+ *     string data
+ *     reflection data
+ *
+ * Partitioned world (version 3) payload layout
+ *
+ * uint16 skybox address length, skybox address bytes
+ * 6 floats: initial camera position and rotation
+ * float cell size, uint32 cell count (C)
+ * C × cell records, sorted by coordinates:
+ *     3 × int32 cell coordinates, uint64 actor count, uint64 chunk offset, uint64 chunk size
+ * Chunks, back to back (offsets are relative to the end of the cell records)
+ *     Each chunk holds the actors of one cell, laid out like a version 2 payload from the counts onward
+ */
+
+namespace libcacaoformats {
+	//Columns are copied to and from the payload as raw bytes
+	static_assert(sizeof(Vec3<float>) == 12 && std::is_trivially_copyable_v<Vec3<float>>, "Vec3<float> must be tightly packed!");
+
+	/**
+	 * @brief Check that world columns are consistent with each other
+	 *
+	 * @throws std::runtime_error If a column has the wrong size or an index or offset is out of range
+	 */
+	void ValidateWorldColumns(const WorldColumns& columns);
+
+	/**
+	 * @brief Write the skybox address and initial camera data of a world
+	 *
+	 * @throws std::runtime_error If the skybox address is too long
+	 */
+	void WriteWorldHeader(const WorldColumns& world, std::ostream& out);
+
+	/**
+	 * @brief Read the skybox address and initial camera data of a world
+	 *
+	 * @param data Pointer to the start of the payload
+	 * @param size The size of the payload
+	 * @param out The object to fill the header fields of
+	 *
+	 * @return The number of bytes read
+	 *
+	 * @throws std::runtime_error If the payload is too small
+	 */
+	std::size_t ReadWorldHeader(const unsigned char* data, std::size_t size, WorldColumns& out);
+
+	/**
+	 * @brief Write the counts and columns of a world
+	 *
+	 * @throws std::runtime_error If the columns are inconsistent with each other
+	 */
+	void WriteWorldActors(const WorldColumns& world, std::ostream& out);
+
+	/**
+	 * @brief Read the counts and columns of a world, leaving the header fields alone
+	 *
+	 * @param data Pointer to the start of the counts
+	 * @param size The number of bytes available
+	 * @param out The object to decode into, whose existing storage is reused
+	 *
+	 * @throws std::runtime_error If the data is too small or the columns are inconsistent with each other
+	 */
+	void ReadWorldActors(const unsigned char* data, std::size_t size, WorldColumns& out);
+
+	/**
+	 * @brief Append the actors of one set of world columns to another, leaving the header fields alone
+	 *
+	 * Strings are not deduplicated across the two sets.
+	 *
+	 * @param dst The columns to append to
+	 * @param src The columns to append
+	 *
+	 * @throws std::runtime_error If the combined columns would be too large
+	 */
+	void AppendWorldColumns(WorldColumns& dst, const WorldColumns& src);
+}
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "YAMLEvents.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+namespace libcacaoformats {
+	//Event handler that fills in a YAMLEventDocument
+	class YAMLEventBuilder : public YAML::EventHandler {
+	  public:
+		YAMLEventBuilder(YAMLEventDocument& doc, std::string_view streamKey, std::function<void(const YAMLEventNode&)>& onElement)
+		  : doc(doc), streamKey(streamKey), onElement(onElement) {}
+
+		void OnDocumentStart(const YAML::Mark&) override {}
+		void OnDocumentEnd() override {}
+
+		void OnNull(const YAML::Mark&, YAML::anchor_t anchor) override {
+			Close(Open(YAML::NodeType::Null, "", anchor, YAML::EmitterStyle::Default));
+		}
+
+		void OnAlias(const YAML::Mark& mark, YAML::anchor_t anchor) override {
+			auto target = anchors.find(anchor);
+			if(target == anchors.end()) throw YAML::ParserException(mark, "alias refers to a node that is no longer available");
+			uint32_t i = Open(YAML::NodeType::Null, "", 0, YAML::EmitterStyle::Default);
+			doc.entries[i].alias = target->second;
+			Close(i);
+		}
+
+		void OnScalar(const YAML::Mark&, const std::string& tag, YAML::anchor_t anchor, const std::string& value) override {
+			uint32_t i = Open(YAML::NodeType::Scalar, tag, anchor, YAML::EmitterStyle::Default);
+			doc.entries[i].scalar = value;
+			Close(i);
+		}
+
+		void OnSequenceStart(const YAML::Mark&, const std::string& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) override {
+			uint32_t i = Open(YAML::NodeType::Sequence, tag, anchor, style);
+
+			//The streamed sequence is the value of a root map entry whose key we just saw
+			if(onElement && streamed == YAMLEventDocument::npos && stack.size() == 1 && stack[0].index == 0 && doc.entries[0].type == YAML::NodeType::Map && doc.entries[0].children % 2 == 1) {
+				const YAMLEventDocument::Entry& key = doc.entries[stack[0].lastChild];
+				if(key.type == YAML::NodeType::Scalar && key.scalar == streamKey) streamed = i;
+			}
+
+			stack.push_back({.index = i, .lastChild = YAMLEventDocument::npos});
+		}
+
+		void OnSequenceEnd() override {
+			uint32_t i = stack.back().index;
+			stack.pop_back();
+			Close(i);
+		}
+
+		void OnMapStart(const YAML::Mark&, const std::string& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) override {
+			stack.push_back({.index = Open(YAML::NodeType::Map, tag, anchor, style), .lastChild = YAMLEventDocument::npos});
+		}
+
+		void OnMapEnd() override {
+			uint32_t i = stack.back().index;
+			stack.pop_back();
+			Close(i);
+		}
+
+	  private:
+		struct Frame {
+			uint32_t index;
+			uint32_t lastChild;
+		};
+
+		YAMLEventDocument& doc;
+		std::string_view streamKey;
+		std::function<void(const YAMLEventNode&)>& onElement;
+		std::vector<Frame> stack;
+		std::unordered_map<YAML::anchor_t, uint32_t> anchors;
+		uint32_t streamed = YAMLEventDocument::npos;
+
+		uint32_t Open(YAML::NodeType::value type, const std::string& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) {
+			if(doc.entries.size() >= YAMLEventDocument::keptBase) throw YAML::Exception(YAML::Mark::null_mark(), "document has too many nodes");
+			uint32_t i = (uint32_t)doc.entries.size();
+			doc.entries.push_back({.type = type, .style = style, .end = i + 1, .children = 0, .alias = YAMLEventDocument::npos, .anchor = anchor, .tag = tag, .scalar = {}});
+			if(anchor != 0) anchors[anchor] = i;
+			return i;
+		}
+
+		void Close(uint32_t i) {
+			doc.entries[i].end = (uint32_t)doc.entries.size();
+			if(stack.empty()) return;
+			Frame& parent = stack.back();
+			++doc.entries[parent.index].children;
+			parent.lastChild = i;
+
+			//Hand off and forget streamed elements, except for anchored nodes that later aliases may refer to
+			if(parent.index == streamed) {
+				onElement(YAMLEventNode(&doc, i));
+				Keep(i);
+				doc.entries.resize(i);
+			}
+		}
+
+		//Move the anchored subtrees of the entries from first on to the kept table
+		void Keep(uint32_t first) {
+			//Find the outermost anchored subtrees and where they will go
+			std::vector<std::pair<uint32_t, uint32_t>> moved;
+			uint64_t next = YAMLEventDocument::keptBase + doc.kept.size();
+			for(uint32_t j = first; j < doc.entries.size();) {
+				if(doc.entries[j].anchor == 0) {
+					++j;
+					continue;
+				}
+				moved.emplace_back(j, (uint32_t)next);
+				next += doc.entries[j].end - j;
+				if(next >= YAMLEventDocument::npos) throw YAML::Exception(YAML::Mark::null_mark(), "document has too many anchored nodes");
+				j = doc.entries[j].end;
+			}
+			if(moved.empty()) return;
+
+			//Every anchored entry is inside one of the moved subtrees, so that is where aliases to discarded entries point
+			const auto relocate = [first, &moved](uint32_t idx) {
+				if(idx < first || idx >= YAMLEventDocument::keptBase) return idx;
+				auto range = std::prev(std::upper_bound(moved.begin(), moved.end(), idx, [](uint32_t v, const std::pair<uint32_t, uint32_t>& m) { return v < m.first; }));
+				return range->second + (idx - range->first);
+			};
+			for(const auto& [start, to] : moved) {
+				for(uint32_t k = start, end = doc.entries[start].end; k < end; ++k) {
+					YAMLEventDocument::Entry& e = doc.kept.emplace_back(std::move(doc.entries[k]));
+					e.end = e.end - start + to;
+					if(e.alias != YAMLEventDocument::npos) e.alias = relocate(e.alias);
+				}
+			}
+			for(auto& anchor : anchors) anchor.second = relocate(anchor.second);
+		}
+	};
+
+	YAMLEventDocument::YAMLEventDocument(std::istream& data, std::string_view streamKey, std::function<void(const YAMLEventNode&)> onElement) {
+		YAML::Parser parser(data);
+		YAMLEventBuilder builder(*this, streamKey, onElement);
+		parser.HandleNextDocument(builder);
+	}
+
+	YAMLEventNode YAMLEventDocument::Root() const {
+		return entries.empty() ? YAMLEventNode() : YAMLEventNode(this, 0);
+	}
+
+	YAMLEventNode::YAMLEventNode(const YAMLEventDocument* doc, uint32_t idx)
+	  : doc(doc), idx(idx) {
+		if(IsDefined() && doc->At(idx).alias != YAMLEventDocument::npos) this->idx = doc->At(idx).alias;
+	}
+
+	const std::string& YAMLEventNode::Scalar() const {
+		static const std::string empty;
+		return IsScalar() ? Get().scalar : empty;
+	}
+
+	std::size_t YAMLEventNode::size() const {
+		switch(Type()) {
+			case YAML::NodeType::Sequence: return Get().children;
+			case YAML::NodeType::Map: return Get().children / 2;
+			default: return 0;
+		}
+	}
+
+	YAMLEventNode YAMLEventNode::operator[](std::string_view key) const {
+		if(!IsMap()) return YAMLEventNode();
+		for(uint32_t k = idx + 1; k < Get().end;) {
+			uint32_t v = doc->At(k).end;
+			YAMLEventNode keyNode(doc, k);
+			if(keyNode.IsScalar() && keyNode.Scalar() == key) return YAMLEventNode(doc, v);
+			k = doc->At(v).end;
+		}
+		return YAMLEventNode();
+	}
+
+	YAMLEventNode YAMLEventNode::operator[](std::size_t i) const {
+		if(!IsSequence()) return YAMLEventNode();
+		for(auto it = begin(); it != end(); ++it, --i) {
+			if(i == 0) return *it;
+		}
+		return YAMLEventNode();
+	}
+
+	YAMLEventNode::iterator YAMLEventNode::begin() const {
+		return IsSequence() ? iterator(doc, idx + 1) : iterator(doc, 0);
+	}
+
+	YAMLEventNode::iterator YAMLEventNode::end() const {
+		return IsSequence() ? iterator(doc, Get().end) : iterator(doc, 0);
+	}
+
+	void EmitYAML(YAML::Emitter& emitter, const YAMLEventNode& node) {
+		//This mirrors what yaml-cpp does when emitting a YAML::Node (it doesn't export the event handler it uses for that)
+		if(!node.IsDefined()) return;
+		const YAMLEventDocument::Entry& e = node.Get();
+		if(!e.tag.empty() && e.tag != "?" && e.tag != "!") emitter << YAML::VerbatimTag(e.tag);
+		switch(e.type) {
+			case YAML::NodeType::Null:
+				emitter << YAML::Null;
+				break;
+			case YAML::NodeType::Scalar:
+				emitter << e.scalar;
+				break;
+			case YAML::NodeType::Sequence:
+				if(e.style == YAML::EmitterStyle::Block) emitter << YAML::Block;
+				if(e.style == YAML::EmitterStyle::Flow) emitter << YAML::Flow;
+				emitter << YAML::BeginSeq;
+				for(YAMLEventNode child : node) EmitYAML(emitter, child);
+				emitter << YAML::EndSeq;
+				break;
+			case YAML::NodeType::Map:
+				if(e.style == YAML::EmitterStyle::Block) emitter << YAML::Block;
+				if(e.style == YAML::EmitterStyle::Flow) emitter << YAML::Flow;
+				emitter << YAML::BeginMap;
+				for(uint32_t k = node.idx + 1; k < e.end; k = node.doc->At(k).end) {
+					uint32_t v = node.doc->At(k).end;
+					emitter << YAML::Key;
+					EmitYAML(emitter, YAMLEventNode(node.doc, k));
+					emitter << YAML::Value;
+					EmitYAML(emitter, YAMLEventNode(node.doc, v));
+					k = v;
+				}
+				emitter << YAML::EndMap;
+				break;
+			default: break;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "yaml-cpp/yaml.h"
+#include "yaml-cpp/eventhandler.h"
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace libcacaoformats {
+	class YAMLEventNode;
+
+	/**
+	 * @brief Lightweight YAML document built directly from parser events
+	 *
+	 * This replaces YAML::Load for the unpacked formats we decode ourselves. Nodes are stored depth-first in one flat table instead of as a graph of
+	 * reference-counted objects, and the elements of one top-level sequence can be handed to a callback as soon as they are parsed and then discarded,
+	 * so large worlds never have to be held in memory all at once.
+	 *
+	 * Aliases are resolved to the node they refer to. Anchored nodes inside streamed elements are kept when the rest of the element is discarded, so
+	 * later elements can still alias them.
+	 */
+	class YAMLEventDocument {
+	  public:
+		/**
+		 * @brief Parse the first document in a stream
+		 *
+		 * @param data The stream to parse
+		 *
+		 * @throws YAML::Exception If the data is not valid YAML
+		 */
+		explicit YAMLEventDocument(std::istream& data)
+		  : YAMLEventDocument(data, "", nullptr) {}
+
+		/**
+		 * @brief Parse the first document in a stream, streaming the elements of a top-level sequence to a callback
+		 *
+		 * The elements are not kept in the document, so that sequence will appear empty.
+		 *
+		 * @param data The stream to parse
+		 * @param streamKey The key of the sequence in the root map
+		 * @param onElement The function to call with each element of the sequence, in order
+		 *
+		 * @throws YAML::Exception If the data is not valid YAML
+		 * @throws std::exception Anything thrown by the callback
+		 */
+		YAMLEventDocument(std::istream& data, std::string_view streamKey, std::function<void(const YAMLEventNode&)> onElement);
+
+		YAMLEventDocument(const YAMLEventDocument&) = delete;
+		YAMLEventDocument& operator=(const YAMLEventDocument&) = delete;
+
+		///@brief Get the root node, which is undefined if the stream had no document
+		YAMLEventNode Root() const;
+
+	  private:
+		friend class YAMLEventNode;
+		friend class YAMLEventBuilder;
+		friend void EmitYAML(YAML::Emitter&, const YAMLEventNode&);
+
+		static constexpr uint32_t npos = UINT32_MAX;
+		static constexpr uint32_t keptBase = 0x80000000;///<Index of the first kept entry
+
+		struct Entry {
+			YAML::NodeType::value type;
+			YAML::EmitterStyle::value style;
+			uint32_t end;		///<Index one past the last descendant
+			uint32_t children;	///<Number of direct children (keys and values both count for maps)
+			uint32_t alias;		///<Index of the aliased node, or npos if this is not an alias
+			YAML::anchor_t anchor;///<Anchor ID from the parser, or 0
+			std::string tag;
+			std::string scalar;
+		};
+		std::vector<Entry> entries;
+		std::vector<Entry> kept;///<Anchored subtrees of discarded streamed elements, indexed from keptBase
+
+		const Entry& At(uint32_t idx) const {
+			return idx >= keptBase ? kept[idx - keptBase] : entries[idx];
+		}
+	};
+
+	///@brief Reference to a node of a YAMLEventDocument, with the part of the YAML::Node interface that the decoders use
+	class YAMLEventNode {
+	  public:
+		///@brief Create an undefined node
+		YAMLEventNode()
+		  : doc(nullptr), idx(YAMLEventDocument::npos) {}
+
+		bool IsDefined() const {
+			return idx != YAMLEventDocument::npos;
+		}
+		explicit operator bool() const {
+			return IsDefined();
+		}
+		YAML::NodeType::value Type() const {
+			return IsDefined() ? Get().type : YAML::NodeType::Undefined;
+		}
+		bool IsNull() const {
+			return Type() == YAML::NodeType::Null;
+		}
+		bool IsScalar() const {
+			return Type() == YAML::NodeType::Scalar;
+		}
+		bool IsSequence() const {
+			return Type() == YAML::NodeType::Sequence;
+		}
+		bool IsMap() const {
+			return Type() == YAML::NodeType::Map;
+		}
+
+		///@brief Get the scalar value, or an empty string if this is not a scalar
+		const std::string& Scalar() const;
+
+		///@brief Get the number of elements of a sequence or entries of a map
+		std::size_t size() const;
+
+		///@brief Look up a map value by key, returning an undefined node if there is no such key or this is not a map
+		YAMLEventNode operator[](std::string_view key) const;
+
+		///@brief Get a sequence element, returning an undefined node if it is out of range or this is not a sequence
+		YAMLEventNode operator[](std::size_t i) const;
+
+		///@brief Iterator over the elements of a sequence
+		class iterator {
+		  public:
+			YAMLEventNode operator*() const {
+				return YAMLEventNode(doc, idx);
+			}
+			iterator& operator++() {
+				idx = doc->At(idx).end;
+				return *this;
+			}
+			bool operator==(const iterator& other) const {
+				return idx == other.idx;
+			}
+
+		  private:
+			friend class YAMLEventNode;
+			const YAMLEventDocument* doc;
+			uint32_t idx;
+
+			iterator(const YAMLEventDocument* doc, uint32_t idx)
+			  : doc(doc), idx(idx) {}
+		};
+		iterator begin() const;
+		iterator end() const;
+
+	  private:
+		friend class YAMLEventDocument;
+		friend class YAMLEventBuilder;
+		friend void EmitYAML(YAML::Emitter&, const YAMLEventNode&);
+		const YAMLEventDocument* doc;
+		uint32_t idx;
+
+		YAMLEventNode(const YAMLEventDocument* doc, uint32_t idx);
+
+		const YAMLEventDocument::Entry& Get() const {
+			return doc->At(idx);
+		}
+	};
+
+	/**
+	 * @brief Write a node to an emitter
+	 *
+	 * This produces the same output as emitting the equivalent YAML::Node, except that aliases are expanded.
+	 */
+	void EmitYAML(YAML::Emitter& emitter, const YAMLEventNode& node);
+
+	///@brief Write a node to an emitter
+	inline void EmitYAML(YAML::Emitter& emitter, const YAML::Node& node) {
+		emitter << node;
+	}
+}
\ No newline at end of file
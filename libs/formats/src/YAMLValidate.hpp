@@ -3,6 +3,8 @@
 #include "libcacaocommon.hpp"
 
 #include <functional>
+#include <sstream>
+#include <type_traits>
 
 #include "yaml-cpp/yaml.h"
 
@@ -10,14 +12,15 @@ namespace libcacaoformats {
 	/**
 	 * @brief Validates a YAML node
 	 *
-	 * @param node The node to examine
+	 * @param node The node to examine (a YAML::Node or a YAMLEventNode)
 	 * @param predicate A function to execute for further validation, returning an empty string if check passes and an error message if not
 	 * @param context Some context for the error message as to what is being parsed
 	 * @param what A human-friendly description of what node is being parsed
 	 *
 	 * @throws std::runtime_error If a check fails
 	 */
-	inline void ValidateYAMLNode(const YAML::Node& node, std::function<std::string(const YAML::Node&)> predicate, const std::string& context, const std::string& what) {
+	template<typename NodeT>
+	void ValidateYAMLNode(const NodeT& node, std::type_identity_t<std::function<std::string(const NodeT&)>> predicate, const std::string& context, const std::string& what) {
 		//Set up error message stream
 		std::stringstream stream;
 		stream << "While parsing " << context << ", " << what << " node is invalid: ";
@@ -32,13 +35,15 @@ namespace libcacaoformats {
 	}
 
 	//Convenience wrapper for checking the type of the node
-	inline void ValidateYAMLNode(const YAML::Node& node, YAML::NodeType::value type, const std::string& context, const std::string& what) {
-		ValidateYAMLNode(node, [&type](const YAML::Node& node) { return (node.Type() == type ? "" : "Node is of improper type!"); }, context, what);
+	template<typename NodeT>
+	void ValidateYAMLNode(const NodeT& node, YAML::NodeType::value type, const std::string& context, const std::string& what) {
+		ValidateYAMLNode<NodeT>(node, [&type](const NodeT& node) { return (node.Type() == type ? "" : "Node is of improper type!"); }, context, what);
 	}
 
 	//Convenience wrapper for checking the type of the node AND doing a user predicate
-	inline void ValidateYAMLNode(const YAML::Node& node, YAML::NodeType::value type, std::function<std::string(const YAML::Node&)> predicate, const std::string& context, const std::string& what) {
-		ValidateYAMLNode(node, [&type, &predicate](const YAML::Node& node) { 
+	template<typename NodeT>
+	void ValidateYAMLNode(const NodeT& node, YAML::NodeType::value type, std::type_identity_t<std::function<std::string(const NodeT&)>> predicate, const std::string& context, const std::string& what) {
+		ValidateYAMLNode<NodeT>(node, [&type, &predicate](const NodeT& node) { 
             if(std::string result = predicate(node); !result.empty()) CheckException(false, result);
             return (node.Type() == type ? "" : "Node is of improper type!"); }, context, what);
 	}
@@ -0,0 +1,369 @@
+#include "libcacaoformats.hpp"
+#include "libcacaocommon.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+
+int main() {
+	try {
+		//Generate some asset data
+		std::vector<unsigned char> shaderData = {0xCA, 0xCA, 0x00, 0x1B, 1, 2, 3, 4, 5, 6, 7, 8};
+		std::string objText;
+		for(int i = 0; i < 500; ++i) objText += "v 1.0 2.0 3.0\n";
+		std::vector<unsigned char> modelData(objText.begin(), objText.end());
+		std::vector<unsigned char> resData = {'h', 'e', 'l', 'l', 'o'};
+
+		//Write it
+		{
+			libcacaoformats::AssetPack pack;
+			pack.insert_or_assign("aShader", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Shader, .buffer = shaderData});
+			pack.insert_or_assign("aModel", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Model, .buffer = modelData});
+			pack.insert_or_assign("some/nested/res.txt", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Resource, .buffer = resData});
+			libcacaoformats::PackedEncoder enc;
+			std::ofstream str("./out.xak", std::ios::binary);
+			enc.EncodeAssetPack(pack).ExportToStream(str);
+			str.close();
+
+			//Compressing assets in parallel must not change the output
+			std::vector<char> serial, parallel;
+			{
+				obytestream out(serial);
+				enc.EncodeAssetPack(pack, 1).ExportToStream(out);
+			}
+			{
+				obytestream out(parallel);
+				enc.EncodeAssetPack(pack, 3).ExportToStream(out);
+			}
+			if(serial != parallel) throw std::runtime_error("Parallel encoding differs from serial encoding!");
+		}
+
+		//Read it all at once
+		{
+			std::ifstream str("./out.xak", std::ios::binary);
+			libcacaoformats::PackedDecoder dec;
+			libcacaoformats::PackedContainer container = libcacaoformats::PackedContainer::FromStream(str);
+			libcacaoformats::AssetPack pack = dec.DecodeAssetPack(container);
+			str.close();
+			if(pack.size() != 3) throw std::runtime_error("Wrong amount of assets!");
+			if(pack.at("aShader").kind != libcacaoformats::PackedAsset::Kind::Shader || !std::ranges::equal(pack.at("aShader").buffer, shaderData)) throw std::runtime_error("Wrong shader asset!");
+			if(pack.at("aModel").kind != libcacaoformats::PackedAsset::Kind::Model || !std::ranges::equal(pack.at("aModel").buffer, modelData)) throw std::runtime_error("Wrong model asset!");
+			if(pack.at("some/nested/res.txt").kind != libcacaoformats::PackedAsset::Kind::Resource || !std::ranges::equal(pack.at("some/nested/res.txt").buffer, resData)) throw std::runtime_error("Wrong resource!");
+		}
+
+		//Read it through the index
+		{
+			libcacaoformats::PackedAssetIndex index = libcacaoformats::PackedAssetIndex::FromStream(std::make_unique<std::ifstream>("./out.xak", std::ios::binary));
+			if(index.Size() != 3) throw std::runtime_error("Wrong amount of indexed assets!");
+			if(!index.Contains("aModel") || index.Contains("aTexture")) throw std::runtime_error("Wrong indexed assets!");
+			if(index.GetEntry("aModel").compressedSize >= modelData.size()) throw std::runtime_error("Model asset was not compressed!");
+			if(index.GetEntry("aShader").compression != libcacaoformats::PackedCodec::Stored) throw std::runtime_error("Shader asset was compressed!");
+			if(!std::ranges::equal(index.Fetch("some/nested/res.txt").buffer, resData)) throw std::runtime_error("Wrong indexed resource!");
+			libcacaoformats::PackedAsset model = index.Fetch("aModel");
+			if(model.kind != libcacaoformats::PackedAsset::Kind::Model || !std::ranges::equal(model.buffer, modelData)) throw std::runtime_error("Wrong indexed model asset!");
+			if(!std::ranges::equal(index.Fetch("aShader").buffer, shaderData)) throw std::runtime_error("Wrong indexed shader asset!");
+		}
+
+		//Read it through a memory mapping
+		{
+			libcacaoformats::PackedContainer container = libcacaoformats::PackedContainer::FromFile("./out.xak");
+			if(!container.payload.IsBorrowed()) throw std::runtime_error("Mapped asset pack payload was copied!");
+			libcacaoformats::PackedDecoder dec;
+			libcacaoformats::AssetPack pack = dec.DecodeAssetPack(container);
+			if(pack.size() != 3 || !std::ranges::equal(pack.at("aModel").buffer, modelData)) throw std::runtime_error("Wrong mapped assets!");
+
+			libcacaoformats::PackedAssetIndex index = libcacaoformats::PackedAssetIndex::FromFile("./out.xak");
+			if(index.Size() != 3) throw std::runtime_error("Wrong amount of mapped indexed assets!");
+			if(!std::ranges::equal(index.Fetch("aModel").buffer, modelData) || !std::ranges::equal(index.Fetch("aShader").buffer, shaderData)) throw std::runtime_error("Wrong mapped indexed assets!");
+		}
+
+		//Read it from memory
+		{
+			std::ifstream str("./out.xak", std::ios::binary);
+			std::vector<unsigned char> buf((std::istreambuf_iterator<char>(str)), std::istreambuf_iterator<char>());
+			str.close();
+			libcacaoformats::PackedContainer container = libcacaoformats::PackedContainer::FromMemory(buf);
+			if(!container.payload.IsBorrowed() || container.payload.data() < buf.data() || container.payload.end() > buf.data() + buf.size()) throw std::runtime_error("In-memory asset pack payload was copied!");
+			libcacaoformats::PackedDecoder dec;
+			if(!std::ranges::equal(dec.DecodeAssetPack(container).at("some/nested/res.txt").buffer, resData)) throw std::runtime_error("Wrong in-memory assets!");
+		}
+
+		//Nested containers should be views of the pack they came from
+		{
+			std::vector<unsigned char> nestedPayload = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+			std::vector<char> nested;
+			{
+				obytestream out(nested);
+				libcacaoformats::PackedContainer(libcacaoformats::PackedFormat::Material, 1, std::vector<unsigned char>(nestedPayload)).WithCodec(libcacaoformats::PackedCodec::Stored).ExportToStream(out);
+			}
+			libcacaoformats::AssetPack pack;
+			pack.insert_or_assign("aMaterial", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Material, .buffer = std::vector<unsigned char>(nested.begin(), nested.end())});
+			libcacaoformats::PackedEncoder enc;
+			libcacaoformats::PackedContainer packContainer = enc.EncodeAssetPack(pack);
+
+			libcacaoformats::PackedDecoder dec;
+			libcacaoformats::AssetPack decoded = dec.DecodeAssetPack(packContainer);
+			const libcacaoformats::PackedPayload& assetBuf = decoded.at("aMaterial").buffer;
+			if(assetBuf.data() < packContainer.payload.data() || assetBuf.end() > packContainer.payload.end()) throw std::runtime_error("Stored asset was copied out of the pack!");
+			libcacaoformats::PackedContainer material = libcacaoformats::PackedContainer::FromAsset(decoded.at("aMaterial"));
+			if(material.payload.data() < assetBuf.data() || material.payload.end() > assetBuf.end()) throw std::runtime_error("Nested container payload was copied out of the asset!");
+			if(!std::ranges::equal(material.payload, nestedPayload)) throw std::runtime_error("Wrong nested container payload!");
+		}
+
+		//Identical assets should only be stored once
+		{
+			libcacaoformats::AssetPack pack;
+			pack.insert_or_assign("models/a/tex.png", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Resource, .buffer = modelData});
+			pack.insert_or_assign("models/b/tex.png", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Resource, .buffer = modelData});
+			pack.insert_or_assign("aModel", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Model, .buffer = modelData});
+			pack.insert_or_assign("aShader", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Shader, .buffer = shaderData});
+			libcacaoformats::PackedEncoder enc;
+			libcacaoformats::PackedContainer packContainer = enc.EncodeAssetPack(pack);
+			libcacaoformats::AssetPack decoded = libcacaoformats::PackedDecoder().DecodeAssetPack(packContainer);
+			for(const std::string& name : {"models/b/tex.png", "aModel"}) {
+				if(decoded.at(name).buffer.data() != decoded.at("models/a/tex.png").buffer.data()) throw std::runtime_error("Deduplicated asset was decoded more than once!");
+			}
+			libcacaoformats::PackedAssetIndex index = libcacaoformats::PackedAssetIndex::FromContainer(packContainer);
+			if(index.GetEntry("models/a/tex.png").offset != index.GetEntry("models/b/tex.png").offset || index.GetEntry("aModel").offset != index.GetEntry("models/a/tex.png").offset) throw std::runtime_error("Identical assets were stored more than once!");
+			if(index.GetEntry("aShader").offset == index.GetEntry("aModel").offset) throw std::runtime_error("Different assets share stored data!");
+			for(const std::string& name : {"models/a/tex.png", "models/b/tex.png", "aModel"}) {
+				if(!std::ranges::equal(index.Fetch(name).buffer, modelData)) throw std::runtime_error("Wrong deduplicated asset!");
+			}
+			if(index.Fetch("aModel").kind != libcacaoformats::PackedAsset::Kind::Model) throw std::runtime_error("Wrong deduplicated asset kind!");
+		}
+
+		//Layer a patch over a pack
+		{
+			libcacaoformats::PackedEncoder enc;
+			libcacaoformats::AssetPack base;
+			base.insert_or_assign("aShader", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Shader, .buffer = shaderData});
+			base.insert_or_assign("aModel", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Model, .buffer = modelData});
+			base.insert_or_assign("some/nested/res.txt", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Resource, .buffer = resData});
+			libcacaoformats::AssetPack changed;
+			std::vector<unsigned char> newRes = {'b', 'y', 'e'};
+			changed.insert_or_assign("some/nested/res.txt", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Resource, .buffer = newRes});
+			changed.insert_or_assign("new.txt", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Resource, .buffer = resData});
+			libcacaoformats::PackedContainer patch = enc.EncodeAssetPackPatch(changed, {"aModel"});
+
+			libcacaoformats::PackedDecoder dec;
+			libcacaoformats::PackedAssetIndex patched = dec.OverlayAssetPack(enc.EncodeAssetPack(base), patch);
+			if(patched.Size() != 3) throw std::runtime_error("Wrong patched asset count!");
+			if(patched.Contains("aModel")) throw std::runtime_error("Deleted asset is still present in patched pack!");
+			if(!std::ranges::equal(patched.Fetch("aShader").buffer, shaderData)) throw std::runtime_error("Wrong unpatched asset!");
+			if(!std::ranges::equal(patched.Fetch("some/nested/res.txt").buffer, newRes)) throw std::runtime_error("Wrong patched asset!");
+			if(!std::ranges::equal(patched.Fetch("new.txt").buffer, resData)) throw std::runtime_error("Wrong added asset!");
+
+			//The patch on its own just holds its changes
+			libcacaoformats::AssetPack patchOnly = dec.DecodeAssetPack(patch);
+			if(patchOnly.size() != 2 || patchOnly.contains("aModel")) throw std::runtime_error("Tombstone was decoded as an asset!");
+		}
+
+		//Reject an archive-based pack whose entry claims to be larger than the archive
+		{
+			//A lone tar header for an 8 GiB file, followed by the end-of-archive blocks
+			std::vector<unsigned char> tarData(512 * 3, 0);
+			const auto putField = [&tarData](std::size_t offset, const std::string& value) { std::copy(value.begin(), value.end(), tarData.begin() + offset); };
+			putField(0, "asset");
+			putField(100, "0000644");
+			putField(108, "0000000");
+			putField(116, "0000000");
+			putField(124, "77777777777");
+			putField(136, "00000000000");
+			putField(148, "        ");
+			putField(156, "0");
+			putField(257, "ustar");
+			putField(263, "00");
+			unsigned int checksum = 0;
+			for(std::size_t i = 0; i < 512; ++i) checksum += tarData[i];
+			char checksumField[8] = {};
+			std::snprintf(checksumField, sizeof(checksumField), "%06o", checksum);
+			putField(148, checksumField);
+
+			bool threw = false;
+			try {
+				libcacaoformats::PackedDecoder().DecodeAssetPack(libcacaoformats::PackedContainer(libcacaoformats::PackedFormat::AssetPack, 1, std::move(tarData)));
+			} catch(const std::runtime_error& e) {
+				threw = std::string(e.what()).find("invalid size") != std::string::npos;
+			}
+			if(!threw) throw std::runtime_error("Archive entry larger than the archive was accepted!");
+		}
+
+		//Look up assets in a large pack
+		{
+			libcacaoformats::AssetPack pack;
+			for(int i = 0; i < 2000; ++i) {
+				std::string str = std::to_string(i);
+				pack.insert_or_assign("res/" + str, libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Resource, .buffer = std::vector<unsigned char>(str.begin(), str.end())});
+			}
+			pack.insert_or_assign("aShader", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Shader, .buffer = shaderData});
+			libcacaoformats::PackedEncoder enc;
+			libcacaoformats::PackedAssetIndex index = libcacaoformats::PackedAssetIndex::FromContainer(enc.EncodeAssetPack(pack));
+			if(index.Size() != 2001) throw std::runtime_error("Wrong large pack asset count!");
+			for(int i = 0; i < 2000; i += 7) {
+				std::string str = std::to_string(i);
+				if(!index.Contains("res/" + str)) throw std::runtime_error("Large pack is missing an asset!");
+				if(!std::ranges::equal(index.Fetch("res/" + str).buffer, str)) throw std::runtime_error("Wrong large pack asset!");
+			}
+			if(index.GetEntry("aShader").kind != libcacaoformats::PackedAsset::Kind::Shader) throw std::runtime_error("Wrong large pack asset kind!");
+			if(index.Contains("res/2000") || index.Contains("res/")) throw std::runtime_error("Large pack contains assets it shouldn't!");
+		}
+
+		//Build packed assets and images for the blocks below
+		const auto exportAsset = [](libcacaoformats::PackedContainer c) {
+			std::vector<char> bytes;
+			{
+				obytestream out(bytes);
+				c.ExportToStream(out);
+			}
+			return std::vector<unsigned char>(bytes.begin(), bytes.end());
+		};
+		const auto makeImage = [](unsigned char seed) {
+			libcacaoimage::Image img {.w = 4, .h = 4, .layout = libcacaoimage::Image::Layout::RGBA, .bitsPerChannel = 8, .data = std::vector<unsigned char>(64), .format = libcacaoimage::Image::Format::PNG, .quality = 100, .lossy = false};
+			for(std::size_t i = 0; i < img.data.size(); ++i) img.data[i] = static_cast<unsigned char>(seed + i);
+			return img;
+		};
+
+		//Decode every asset on a thread pool
+		{
+			libcacaoformats::PackedEncoder enc;
+			libcacaoformats::Material mat;
+			mat.shader = "aShader";
+			mat.keys.insert_or_assign("test_float", 2.5f);
+			std::array<libcacaoimage::Image, 6> faces;
+			for(unsigned char i = 0; i < 6; ++i) faces[i] = makeImage(i * 40);
+			libcacaoimage::Image tex = makeImage(7);
+			std::vector<char> texBytes;
+			{
+				obytestream out(texBytes);
+				libcacaoimage::encode::EncodePNG(tex, out);
+			}
+
+			//A mono 16-bit PCM WAV file with a handful of samples
+			const std::vector<short> samples = {0, 1000, -1000, 32767, -32768, 7};
+			std::vector<unsigned char> wavData;
+			{
+				const auto put = [&wavData](uint32_t value, std::size_t bytes) {
+					for(std::size_t b = 0; b < bytes; ++b) wavData.push_back(static_cast<unsigned char>(value >> (8 * b)));
+				};
+				const uint32_t dataSize = static_cast<uint32_t>(samples.size() * 2);
+				wavData.insert(wavData.end(), {'R', 'I', 'F', 'F'});
+				put(36 + dataSize, 4);
+				wavData.insert(wavData.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+				put(16, 4);
+				put(1, 2);
+				put(1, 2);
+				put(8000, 4);
+				put(16000, 4);
+				put(2, 2);
+				put(16, 2);
+				wavData.insert(wavData.end(), {'d', 'a', 't', 'a'});
+				put(dataSize, 4);
+				for(short sample : samples) put(static_cast<uint16_t>(sample), 2);
+			}
+
+			libcacaoformats::AssetPack pack;
+			pack.insert_or_assign("aShader", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Shader, .buffer = exportAsset(enc.EncodeShader(shaderData))});
+			pack.insert_or_assign("aMaterial", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Material, .buffer = exportAsset(enc.EncodeMaterial(mat))});
+			pack.insert_or_assign("aCubemap", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Cubemap, .buffer = exportAsset(enc.EncodeCubemap(faces))});
+			pack.insert_or_assign("aTex", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Tex2D, .buffer = std::vector<unsigned char>(texBytes.begin(), texBytes.end())});
+			pack.insert_or_assign("aModel", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Model, .buffer = modelData});
+			pack.insert_or_assign("aSound", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Sound, .buffer = wavData});
+
+			libcacaoformats::PackedDecoder dec;
+			libcacaoformats::DecodedAssetPack decoded = dec.DecodeAssetPackParallel(enc.EncodeAssetPack(pack), exathread::Pool::Create(4));
+			if(decoded.size() != 6) throw std::runtime_error("Wrong number of decoded assets!");
+			if(!std::ranges::equal(std::get<std::vector<unsigned char>>(decoded.at("aShader").data), shaderData)) throw std::runtime_error("Wrong decoded shader!");
+			if(std::get<libcacaoformats::Material>(decoded.at("aMaterial").data).shader.compare("aShader") != 0) throw std::runtime_error("Wrong decoded material!");
+			const auto& decodedFaces = std::get<std::array<libcacaoimage::Image, 6>>(decoded.at("aCubemap").data);
+			for(std::size_t i = 0; i < 6; ++i) {
+				if(decodedFaces[i].data != faces[i].data) throw std::runtime_error("Wrong decoded cubemap face!");
+			}
+			if(std::get<libcacaoimage::Image>(decoded.at("aTex").data).data != tex.data) throw std::runtime_error("Wrong decoded texture!");
+			const auto& decodedSound = std::get<libcacaoaudiodecode::Result>(decoded.at("aSound").data);
+			if(decodedSound.sampleRate != 8000 || decodedSound.channelCount != 1 || decodedSound.data != samples) throw std::runtime_error("Wrong decoded sound!");
+			if(decoded.at("aModel").kind != libcacaoformats::PackedAsset::Kind::Model || !std::ranges::equal(std::get<libcacaoformats::PackedPayload>(decoded.at("aModel").data), modelData)) throw std::runtime_error("Wrong passthrough asset!");
+		}
+
+		//Store cubemaps GPU-compressed, and decode image cubemap faces in parallel
+		{
+			libcacaoformats::PackedEncoder enc;
+			libcacaoformats::PackedDecoder dec;
+			std::array<libcacaoimage::Image, 6> faces;
+			for(unsigned char i = 0; i < 6; ++i) faces[i] = makeImage(i * 40);
+
+			//Every level of an 8x4 BC7 face is a whole number of 4x4 blocks
+			libcacaoformats::CompressedCubemap compressed {.compression = libcacaoformats::BlockCompression::BC7, .srgb = true, .w = 8, .h = 4, .faces = {}};
+			for(std::size_t i = 0; i < 6; ++i) {
+				for(std::size_t level = 0; level < 4; ++level) compressed.faces[i].push_back(std::vector<unsigned char>(compressed.LevelSize(level), static_cast<unsigned char>(i * 4 + level)));
+			}
+			if(compressed.LevelSize(0) != 32 || compressed.LevelSize(3) != 16) throw std::runtime_error("Wrong compressed level sizes!");
+
+			//Faces decode the same no matter how many threads they are spread across
+			libcacaoformats::PackedContainer imageCubemap = enc.EncodeCubemap(faces);
+			if(dec.IsCompressedCubemap(imageCubemap)) throw std::runtime_error("Image cubemap reported as compressed!");
+			std::array<libcacaoimage::Image, 6> parallelFaces = dec.DecodeCubemap(imageCubemap, 3);
+			for(std::size_t i = 0; i < 6; ++i) {
+				if(parallelFaces[i].data != faces[i].data) throw std::runtime_error("Wrong cubemap face decoded in parallel!");
+			}
+
+			//Compressed levels come back borrowed from the payload
+			libcacaoformats::PackedContainer compressedCubemap = enc.EncodeCubemap(compressed);
+			if(!dec.IsCompressedCubemap(compressedCubemap)) throw std::runtime_error("Compressed cubemap not reported as compressed!");
+			libcacaoformats::CompressedCubemap roundTrip = dec.DecodeCompressedCubemap(compressedCubemap);
+			if(roundTrip.compression != compressed.compression || !roundTrip.srgb || roundTrip.w != 8 || roundTrip.h != 4 || roundTrip.MipLevels() != 4) throw std::runtime_error("Wrong compressed cubemap header!");
+			for(std::size_t i = 0; i < 6; ++i) {
+				for(std::size_t level = 0; level < 4; ++level) {
+					if(!roundTrip.faces[i][level].IsBorrowed() || !std::ranges::equal(roundTrip.faces[i][level], compressed.faces[i][level])) throw std::runtime_error("Wrong compressed cubemap level!");
+				}
+			}
+			bool threw = false;
+			try {
+				dec.DecodeCubemap(compressedCubemap);
+			} catch(const std::runtime_error&) {
+				threw = true;
+			}
+			if(!threw) throw std::runtime_error("Compressed cubemap decoded as images!");
+			threw = false;
+			try {
+				compressed.faces[5].pop_back();
+				enc.EncodeCubemap(compressed);
+			} catch(const std::runtime_error&) {
+				threw = true;
+			}
+			if(!threw) throw std::runtime_error("Compressed cubemap with uneven mip chains encoded!");
+			compressed.faces[5].push_back(compressed.faces[4].back());
+
+			//Level sizes of huge faces don't wrap around, and such faces are rejected rather than sliced
+			libcacaoformats::CompressedCubemap huge {.compression = libcacaoformats::BlockCompression::BC7, .srgb = false, .w = UINT32_MAX, .h = UINT32_MAX, .faces = {}};
+			if(huge.LevelSize(0) != std::numeric_limits<uint64_t>::max() || huge.LevelSize(31) != 16) throw std::runtime_error("Wrong level size of huge compressed cubemap!");
+			std::vector<unsigned char> hugeHeader(16, 0);
+			hugeHeader[0] = 1;
+			hugeHeader[2] = 1;
+			std::memset(hugeHeader.data() + 4, 0xFF, 8);
+			threw = false;
+			try {
+				dec.DecodeCompressedCubemap(libcacaoformats::PackedContainer(libcacaoformats::PackedFormat::Cubemap, 2, std::move(hugeHeader)));
+			} catch(const std::runtime_error&) {
+				threw = true;
+			}
+			if(!threw) throw std::runtime_error("Compressed cubemap with huge faces decoded!");
+
+			//Compressed cubemaps in a pack are borrowed as-is by parallel decoding
+			libcacaoformats::AssetPack pack;
+			pack.insert_or_assign("aCubemap", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Cubemap, .buffer = exportAsset(enc.EncodeCubemap(faces))});
+			pack.insert_or_assign("aCompressedCubemap", libcacaoformats::PackedAsset {.kind = libcacaoformats::PackedAsset::Kind::Cubemap, .buffer = exportAsset(compressedCubemap)});
+			libcacaoformats::DecodedAssetPack decoded = dec.DecodeAssetPackParallel(enc.EncodeAssetPack(pack), exathread::Pool::Create(4));
+			const auto& decodedCompressed = std::get<libcacaoformats::CompressedCubemap>(decoded.at("aCompressedCubemap").data);
+			if(decodedCompressed.MipLevels() != 4 || !std::ranges::equal(decodedCompressed.faces[2][1], compressed.faces[2][1])) throw std::runtime_error("Wrong decoded compressed cubemap!");
+			if(std::get<std::array<libcacaoimage::Image, 6>>(decoded.at("aCubemap").data)[5].data != faces[5].data) throw std::runtime_error("Wrong image cubemap decoded next to a compressed one!");
+		}
+
+		return 0;
+	} catch(const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
\ No newline at end of file
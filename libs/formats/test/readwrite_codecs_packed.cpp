@@ -0,0 +1,171 @@
+#include "libcacaoformats.hpp"
+#include "libcacaocommon.hpp"
+
+#include "bzlib.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+int main() {
+	try {
+		//Byte streams start out usable and accept empty writes
+		{
+			std::vector<char> bytes;
+			{
+				obytestream out(bytes);
+				out.write("", 0);
+				out.write("abc", 3);
+				out.write("", 0);
+				if(!out.good()) throw std::runtime_error("Byte stream failed on an empty write!");
+			}
+			ibytestream in(bytes);
+			std::string read(3, '\0');
+			in.read(read.data(), 3);
+			if(read.compare("abc") != 0 || !in.good()) throw std::runtime_error("Wrong data read back from byte stream!");
+		}
+
+		//Generate some compressible payload data
+		std::string text;
+		for(int i = 0; i < 20000; ++i) text += "actor " + std::to_string(i % 17) + "\n";
+		std::vector<unsigned char> payload(text.begin(), text.end());
+
+		//Check the defaults
+		if(libcacaoformats::PackedContainer::DefaultCodec(libcacaoformats::PackedFormat::Cubemap) != libcacaoformats::PackedCodec::Stored) throw std::runtime_error("Cubemaps are compressed by default!");
+		if(libcacaoformats::PackedContainer::DefaultCodec(libcacaoformats::PackedFormat::Shader) != libcacaoformats::PackedCodec::LZ4) throw std::runtime_error("Shaders don't use LZ4 by default!");
+		if(libcacaoformats::PackedContainer(libcacaoformats::PackedFormat::World, 1, std::vector<unsigned char>(payload)).codec != libcacaoformats::PackedContainer::DefaultCodec(libcacaoformats::PackedFormat::World)) throw std::runtime_error("New container doesn't use the default codec!");
+
+		//Round-trip every codec
+		for(libcacaoformats::PackedCodec codec : {libcacaoformats::PackedCodec::Stored, libcacaoformats::PackedCodec::Bzip2, libcacaoformats::PackedCodec::Zstd, libcacaoformats::PackedCodec::LZ4}) {
+			std::vector<char> file;
+			{
+				obytestream out(file);
+				libcacaoformats::PackedContainer(libcacaoformats::PackedFormat::World, 1, std::vector<unsigned char>(payload)).WithCodec(codec).ExportToStream(out);
+			}
+			if(codec != libcacaoformats::PackedCodec::Stored && file.size() >= payload.size()) throw std::runtime_error("Payload was not compressed!");
+
+			ibytestream in(file);
+			libcacaoformats::PackedContainer container = libcacaoformats::PackedContainer::FromStream(in);
+			if(container.codec != codec || container.format != libcacaoformats::PackedFormat::World || container.version != 1) throw std::runtime_error("Wrong container header!");
+			if(!std::equal(container.payload.begin(), container.payload.end(), payload.begin(), payload.end())) throw std::runtime_error("Wrong payload from stream!");
+
+			ibytestream chunkIn(file);
+			std::vector<unsigned char> streamed;
+			std::size_t chunks = 0;
+			libcacaoformats::PackedContainer::Header header = libcacaoformats::PackedContainer::StreamPayload(chunkIn, [&](const libcacaoformats::PackedContainer::Header& h, std::span<const unsigned char> chunk) {
+				if(h.payloadSize != payload.size() || chunk.size() > libcacaoformats::PackedContainer::streamChunkSize) throw std::runtime_error("Wrong streamed chunk!");
+				streamed.insert(streamed.end(), chunk.begin(), chunk.end());
+				++chunks;
+			});
+			if(header.codec != codec || streamed != payload || chunks < 2) throw std::runtime_error("Wrong streamed payload!");
+
+			std::vector<char> truncated(file.begin(), file.begin() + file.size() / 2);
+			ibytestream truncIn(truncated);
+			bool threw = false;
+			try {
+				libcacaoformats::PackedContainer::FromStream(truncIn);
+			} catch(const std::runtime_error&) {
+				threw = true;
+			}
+			if(!threw) throw std::runtime_error("Truncated container was accepted!");
+
+			libcacaoformats::PackedContainer fromMem = libcacaoformats::PackedContainer::FromMemory(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(file.data()), file.size()));
+			if(!std::equal(fromMem.payload.begin(), fromMem.payload.end(), payload.begin(), payload.end())) throw std::runtime_error("Wrong payload from memory!");
+		}
+
+		//Split a large payload into blocks across threads
+		{
+			std::vector<unsigned char> large;
+			while(large.size() < libcacaoformats::PackedContainer::compressionBlockSize * 2 + 1234) large.insert(large.end(), payload.begin(), payload.end());
+			libcacaoformats::PackedContainer container(libcacaoformats::PackedFormat::World, 1, std::vector<unsigned char>(large));
+			std::vector<char> serial, parallel;
+			{
+				obytestream out(serial);
+				container.ExportToStream(out, 1);
+			}
+			{
+				obytestream out(parallel);
+				container.ExportToStream(out, 4);
+			}
+			if(serial != parallel) throw std::runtime_error("Parallel export differs from serial export!");
+
+			libcacaoformats::PackedContainer fromMem = libcacaoformats::PackedContainer::FromMemory(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(parallel.data()), parallel.size()), {}, 4);
+			if(!std::equal(fromMem.payload.begin(), fromMem.payload.end(), large.begin(), large.end())) throw std::runtime_error("Wrong blocked payload from memory!");
+			ibytestream in(parallel);
+			libcacaoformats::PackedContainer fromStream = libcacaoformats::PackedContainer::FromStream(in);
+			if(!std::equal(fromStream.payload.begin(), fromStream.payload.end(), large.begin(), large.end())) throw std::runtime_error("Wrong blocked payload from stream!");
+		}
+
+		//Reject a corrupt decompressed size before allocating for it
+		{
+			std::vector<char> file;
+			obytestream out(file);
+			libcacaoformats::PackedContainer(libcacaoformats::PackedFormat::World, 1, std::vector<unsigned char>(payload)).WithCodec(libcacaoformats::PackedCodec::Zstd).ExportToStream(out);
+
+			//Claim that the single block decompresses to 2 GiB (size at offset 7, block size at offset 15)
+			uint64_t size = 0x80000000;
+			uint32_t blockSize = 0x80000000;
+			std::memcpy(file.data() + 7, &size, 8);
+			std::memcpy(file.data() + 15, &blockSize, 4);
+			bool threw = false;
+			try {
+				libcacaoformats::PackedContainer::FromMemory(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(file.data()), file.size()));
+			} catch(const std::runtime_error& e) {
+				threw = std::string(e.what()).find("too small for its decompressed size") != std::string::npos;
+			}
+			if(!threw) throw std::runtime_error("Container with corrupt decompressed size was not rejected up front!");
+		}
+
+		//Reject a block table that can't fit in the input before allocating for it
+		{
+			std::vector<char> file;
+			{
+				obytestream out(file);
+				libcacaoformats::PackedContainer(libcacaoformats::PackedFormat::World, 1, std::vector<unsigned char>(payload)).WithCodec(libcacaoformats::PackedCodec::Zstd).ExportToStream(out);
+			}
+
+			//Claim 4 Gi one-byte blocks, whose sizes alone would take 32 GiB (size at offset 7, block size at offset 15, block count at offset 19)
+			uint64_t size = 0xFFFFFFFF;
+			uint32_t blockSize = 1, blockCount = 0xFFFFFFFF;
+			std::memcpy(file.data() + 7, &size, 8);
+			std::memcpy(file.data() + 15, &blockSize, 4);
+			std::memcpy(file.data() + 19, &blockCount, 4);
+			bool threw = false;
+			try {
+				libcacaoformats::PackedContainer::FromMemory(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(file.data()), file.size()));
+			} catch(const std::runtime_error& e) {
+				threw = std::string(e.what()).find("block table") != std::string::npos;
+			}
+			if(!threw) throw std::runtime_error("Container with an oversized block table was not rejected up front!");
+			threw = false;
+			try {
+				ibytestream in(file);
+				libcacaoformats::PackedContainer::FromStream(in);
+			} catch(const std::runtime_error& e) {
+				threw = std::string(e.what()).find("block table") != std::string::npos;
+			}
+			if(!threw) throw std::runtime_error("Streamed container with an oversized block table was not rejected up front!");
+		}
+
+		//Read a container written before codecs were selectable (always bzip2, no codec byte)
+		{
+			std::vector<char> file = {char(0xCA), char(0xCA), 0x00, 0x7A, 1, 0};
+			uint64_t size = payload.size();
+			file.insert(file.end(), reinterpret_cast<char*>(&size), reinterpret_cast<char*>(&size) + 8);
+			std::vector<char> compressed(payload.size() * 1.01 + 600);
+			unsigned int destSize = compressed.size();
+			if(BZ2_bzBuffToBuffCompress(compressed.data(), &destSize, reinterpret_cast<char*>(payload.data()), payload.size(), 9, 0, 30) != BZ_OK) throw std::runtime_error("Failed to make legacy container!");
+			file.insert(file.end(), compressed.begin(), compressed.begin() + destSize);
+
+			ibytestream in(file);
+			libcacaoformats::PackedContainer container = libcacaoformats::PackedContainer::FromStream(in);
+			if(container.codec != libcacaoformats::PackedCodec::Bzip2 || container.format != libcacaoformats::PackedFormat::World) throw std::runtime_error("Wrong legacy container header!");
+			if(!std::equal(container.payload.begin(), container.payload.end(), payload.begin(), payload.end())) throw std::runtime_error("Wrong legacy payload!");
+		}
+
+		return 0;
+	} catch(const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "libcacaoformats.hpp"
 
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
 
 int main() {
@@ -37,6 +39,93 @@ int main() {
 			if(testMat[0][0] != 2.4f || testMat[0][1] != 3.1f || testMat[1][0] != 66.1f || testMat[1][1] != 9.143f || testMat[2][0] != 100.0f || testMat[2][1] != 31.4f) throw std::runtime_error("\"testMat\" key contains wrong values!");
 		}
 
+		//Precompiled parameter block
+		{
+			libcacaoformats::Material mat;
+			mat.shader = "aShader";
+			mat.keys.insert_or_assign("a_float", 1.5f);
+			mat.keys.insert_or_assign("b_vec", libcacaoformats::Vec3<float> {.x = 1.0f, .y = 2.0f, .z = 3.0f});
+			libcacaoformats::Matrix<float, 2, 3> trix;
+			trix[0] = {2.4f, 3.1f};
+			trix[1] = {66.1f, 9.143f};
+			trix[2] = {100.0f, 31.4f};
+			mat.keys.insert_or_assign("c_mat", trix);
+			mat.keys.insert_or_assign("d_tex", libcacaoformats::Material::TextureRef {.path = "tex/albedo.xjt", .isCubemap = false});
+			mat.keys.insert_or_assign("e_sky", libcacaoformats::Material::TextureRef {.path = "tex/sky.xjc", .isCubemap = true});
+
+			//Check computed layouts
+			libcacaoformats::MaterialLayout std140 = libcacaoformats::ComputeMaterialLayout(mat, libcacaoformats::MaterialBlockRules::Std140);
+			if(std140.members.size() != 3 || std140.textures.size() != 2) throw std::runtime_error("Computed layout has wrong amount of parameters!");
+			if(std140.members[0].offset != 0 || std140.members[1].offset != 16 || std140.members[2].offset != 32 || std140.blockSize != 80) throw std::runtime_error("Computed std140 layout has wrong offsets!");
+			if(std140.textures[0].name != "d_tex" || std140.textures[0].slot != 0 || std140.textures[1].slot != 1 || !std140.textures[1].isCubemap) throw std::runtime_error("Computed layout has wrong texture slots!");
+			libcacaoformats::MaterialLayout std430 = libcacaoformats::ComputeMaterialLayout(mat, libcacaoformats::MaterialBlockRules::Std430);
+			if(std430.members[1].offset != 16 || std430.members[2].offset != 32 || std430.blockSize != 64) throw std::runtime_error("Computed std430 layout has wrong offsets!");
+
+			//Layouts survive a round trip through a shader
+			libcacaoformats::PackedEncoder enc;
+			libcacaoformats::PackedDecoder dec;
+			std140.textures[0].slot = 3;
+			libcacaoformats::PackedContainer shader = enc.EncodeShader({1, 2, 3, 4}, std140);
+			if(dec.DecodeShader(shader).size() != 4) throw std::runtime_error("Shader with layout has wrong code!");
+			std::optional<libcacaoformats::MaterialLayout> layout = dec.DecodeShaderMaterialLayout(shader);
+			if(!layout || layout->blockSize != 80 || layout->members.size() != 3 || layout->members[2].name != "c_mat" || layout->members[2].type != 13 || layout->textures[0].slot != 3) throw std::runtime_error("Shader material layout was not preserved!");
+			if(dec.DecodeShaderMaterialLayout(enc.EncodeShader({1, 2, 3, 4}))) throw std::runtime_error("Shader without layout has a material layout!");
+
+			//Check the block and texture table
+			libcacaoformats::PackedContainer container = enc.EncodeMaterial(mat, *layout);
+			libcacaoformats::PackedMaterialBlock block = libcacaoformats::PackedMaterialBlock::FromContainer(container);
+			if(block.GetShader() != "aShader" || block.GetRules() != libcacaoformats::MaterialBlockRules::Std140) throw std::runtime_error("Parameter block has wrong header!");
+			std::span<const unsigned char> data = block.GetData();
+			if(data.size() != 80) throw std::runtime_error("Parameter block has wrong size!");
+			float f = 0, column[2] = {};
+			std::memcpy(&f, data.data(), 4);
+			if(f != 1.5f) throw std::runtime_error("Parameter block has wrong scalar value!");
+			std::memcpy(&f, data.data() + 24, 4);
+			if(f != 3.0f) throw std::runtime_error("Parameter block has wrong vector value!");
+			std::memcpy(column, data.data() + 64, 8);
+			if(column[0] != 100.0f || column[1] != 31.4f) throw std::runtime_error("Parameter block has wrong matrix column!");
+			if(block.GetTextureCount() != 2) throw std::runtime_error("Parameter block has wrong amount of textures!");
+			libcacaoformats::PackedMaterialBlock::TextureSlot sky = block.GetTexture(0), albedo = block.GetTexture(1);
+			if(sky.slot != 1 || !sky.isCubemap || sky.path != "tex/sky.xjc" || albedo.slot != 3 || albedo.path != "tex/albedo.xjt") throw std::runtime_error("Parameter block has wrong textures!");
+
+			//Materials with a block are still regular materials
+			libcacaoformats::Material decoded = dec.DecodeMaterial(container);
+			if(decoded.keys.size() != 5 || std::get<2>(decoded.keys.at("a_float")) != 1.5f) throw std::runtime_error("Material with parameter block decoded wrong!");
+
+			//Materials that don't match the layout are rejected
+			mat.keys.insert_or_assign("a_float", 2);
+			bool threw = false;
+			try {
+				enc.EncodeMaterial(mat, *layout);
+			} catch(const std::runtime_error&) {
+				threw = true;
+			}
+			if(!threw) throw std::runtime_error("Material with mismatched parameter type was accepted!");
+		}
+
+		//Reject lengths that run past the end of the payload
+		{
+			libcacaoformats::PackedDecoder dec;
+			const auto rejects = [](const std::function<void()>& decode, const std::string& message) {
+				try {
+					decode();
+				} catch(const std::runtime_error& e) {
+					return std::string(e.what()).find(message) != std::string::npos;
+				}
+				return false;
+			};
+
+			//A 255-byte key name in a payload that ends right after it starts
+			std::vector<unsigned char> material = {7, 0, 'a', 'S', 'h', 'a', 'd', 'e', 'r', 1, 255, 'k', 0, 0};
+			if(!rejects([&]() { dec.DecodeMaterial(libcacaoformats::PackedContainer(libcacaoformats::PackedFormat::Material, 1, std::move(material))); }, "key name string"))
+				throw std::runtime_error("Material key name longer than the payload was accepted!");
+
+			//A code blob size that wraps around when the size field is added to it
+			std::vector<unsigned char> shader = {0xFF, 0xFF, 0xFF, 0xFF, 1};
+			if(!rejects([&]() { dec.DecodeShader(libcacaoformats::PackedContainer(libcacaoformats::PackedFormat::Shader, 1, std::move(shader))); }, "code blob"))
+				throw std::runtime_error("Shader code blob larger than the payload was accepted!");
+		}
+
 		return 0;
 	} catch(const std::exception& e) {
 		std::cerr << "Error: " << e.what() << std::endl;
@@ -2,6 +2,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 int main() {
 	try {
@@ -36,6 +37,43 @@ int main() {
 			if(testMat[0][0] != 2.4f || testMat[0][1] != 3.1f || testMat[1][0] != 66.1f || testMat[1][1] != 9.143f || testMat[2][0] != 100.0f || testMat[2][1] != 31.4f) throw std::runtime_error("\"testMat\" key contains wrong values!");
 		}
 
+		//Larger matrices and cubemap texture references
+		{
+			libcacaoformats::Material mat;
+			mat.shader = "aShader";
+			libcacaoformats::Matrix<float, 3, 3> trix3;
+			libcacaoformats::Matrix<float, 4, 3> trix43;
+			libcacaoformats::Matrix<float, 4, 4> trix4;
+			for(int c = 0; c < 3; c++) trix3[c] = {c * 3 + 0.5f, c * 3 + 1.5f, c * 3 + 2.5f};
+			for(int c = 0; c < 3; c++) trix43[c] = {c * 4 + 0.5f, c * 4 + 1.5f, c * 4 + 2.5f, c * 4 + 3.5f};
+			for(int c = 0; c < 4; c++) trix4[c] = {c * 4 + 0.25f, c * 4 + 1.25f, c * 4 + 2.25f, c * 4 + 3.25f};
+			mat.keys.insert_or_assign("mat3", trix3);
+			mat.keys.insert_or_assign("mat43", trix43);
+			mat.keys.insert_or_assign("mat4", trix4);
+			mat.keys.insert_or_assign("sky", libcacaoformats::Material::TextureRef {.path = "sky.ajc", .isCubemap = true});
+			mat.keys.insert_or_assign("albedo", libcacaoformats::Material::TextureRef {.path = "albedo.png", .isCubemap = false});
+			std::stringstream str;
+			libcacaoformats::UnpackedEncoder().EncodeMaterial(mat, str);
+			libcacaoformats::Material decoded = libcacaoformats::UnpackedDecoder().DecodeMaterial(str);
+			if(std::get<16>(decoded.keys.at("mat3")).data != trix3.data) throw std::runtime_error("\"mat3\" key contains wrong values!");
+			if(std::get<19>(decoded.keys.at("mat43")).data != trix43.data) throw std::runtime_error("\"mat43\" key contains wrong values!");
+			if(std::get<20>(decoded.keys.at("mat4")).data != trix4.data) throw std::runtime_error("\"mat4\" key contains wrong values!");
+			if(!std::get<21>(decoded.keys.at("sky")).isCubemap) throw std::runtime_error("Cubemap texture reference decoded as 2D!");
+			if(std::get<21>(decoded.keys.at("albedo")).isCubemap) throw std::runtime_error("2D texture reference decoded as cubemap!");
+		}
+
+		//Conversion errors are reported with the converter's own message
+		{
+			std::stringstream str("shader: aShader\ndata:\n  - name: bad\n    baseType: int\n    x: 1\n    y: 1\n    value: abc\n");
+			bool threw = false;
+			try {
+				libcacaoformats::UnpackedDecoder().DecodeMaterial(str);
+			} catch(const std::runtime_error& e) {
+				threw = std::string(e.what()).find("stoi") != std::string::npos;
+			}
+			if(!threw) throw std::runtime_error("Unconvertible material value was not reported!");
+		}
+
 		return 0;
 	} catch(const std::exception& e) {
 		std::cerr << "Error: " << e.what() << std::endl;
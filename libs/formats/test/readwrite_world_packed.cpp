@@ -2,6 +2,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <optional>
 
 int main() {
 	try {
@@ -57,6 +58,156 @@ int main() {
 			if(c2.reflection.compare("theVec:\n  x: 2.1\n  y: -8.47") != 0) throw std::runtime_error("Wrong second component reflection data!");
 		}
 
+		//Read it in column-oriented form
+		{
+			std::ifstream str("./out.xjw", std::ios::binary);
+			libcacaoformats::PackedDecoder dec;
+			libcacaoformats::PackedContainer container = libcacaoformats::PackedContainer::FromStream(str);
+			libcacaoformats::WorldColumns w;
+			dec.DecodeWorldColumns(container, w);
+			str.close();
+			if(w.skyboxRef.compare("aSkybox") != 0) throw std::runtime_error("Wrong column skybox reference!");
+			if(w.ActorCount() != 1) throw std::runtime_error("Wrong amount of column actors!");
+			if(xg::Guid(w.guids[0]) != xg::Guid("36f595e7-e072-4219-bd0d-7db2d9260eea")) throw std::runtime_error("Wrong column actor GUID!");
+			if(w.String(w.names[0]).compare("Honk") != 0) throw std::runtime_error("Wrong column actor name!");
+			if(w.scales[0].x != 2.0f || w.scales[0].y != 7.0f || w.scales[0].z != 3.0f) throw std::runtime_error("Wrong column actor scale!");
+			if(w.componentStarts[0] != 0 || w.componentStarts[1] != 2) throw std::runtime_error("Wrong column component range!");
+			if(w.String(w.componentTypes[1]).compare("aDifferentType") != 0) throw std::runtime_error("Wrong column component type ID!");
+			if(w.Reflection(0).compare("someProp: 1.3") != 0) throw std::runtime_error("Wrong column component reflection data!");
+		}
+
+		//Round-trip a world with no actors, whose columns are all empty
+		{
+			libcacaoformats::World w;
+			w.skyboxRef = "aSkybox";
+			libcacaoformats::PackedEncoder enc;
+			libcacaoformats::PackedDecoder dec;
+			libcacaoformats::WorldColumns columns;
+			dec.DecodeWorldColumns(enc.EncodeWorld(w), columns);
+			if(columns.ActorCount() != 0 || columns.skyboxRef.compare("aSkybox") != 0) throw std::runtime_error("Wrong empty world columns!");
+			if(!dec.DecodeWorld(enc.EncodeWorld(w)).actors.empty()) throw std::runtime_error("Empty world decoded with actors!");
+		}
+
+		//Round-trip a larger world with shared strings
+		{
+			libcacaoformats::World w;
+			for(int i = 0; i < 1000; ++i) {
+				libcacaoformats::World::Actor& e = w.actors.emplace_back();
+				e.name = "Actor" + std::to_string(i % 10);
+				e.guid = xg::newGuid();
+				e.parentGUID = i == 0 ? xg::Guid() : w.actors[0].guid;
+				e.initialPos = libcacaoformats::Vec3<float> {.x = float(i), .y = 0.0f, .z = 0.0f};
+				for(int j = 0; j < i % 3; ++j) e.components.push_back(libcacaoformats::World::Component {.typeID = "aType", .reflection = std::to_string(j)});
+			}
+			libcacaoformats::PackedEncoder enc;
+			libcacaoformats::PackedContainer container = enc.EncodeWorld(w);
+			libcacaoformats::PackedDecoder dec;
+			libcacaoformats::WorldColumns columns;
+			dec.DecodeWorldColumns(container, columns);
+			if(columns.stringStarts.size() != 12) throw std::runtime_error("World strings were not shared!");
+			libcacaoformats::World decoded = dec.DecodeWorld(container);
+			if(decoded.actors.size() != w.actors.size()) throw std::runtime_error("Wrong amount of actors in larger world!");
+			for(std::size_t i = 0; i < w.actors.size(); ++i) {
+				const libcacaoformats::World::Actor& a = w.actors[i];
+				const libcacaoformats::World::Actor& b = decoded.actors[i];
+				if(a.guid != b.guid || a.parentGUID != b.parentGUID || a.name != b.name || a.initialPos.x != b.initialPos.x || a.components.size() != b.components.size()) throw std::runtime_error("Wrong actor in larger world!");
+				for(std::size_t j = 0; j < a.components.size(); ++j) {
+					if(a.components[j].typeID != b.components[j].typeID || a.components[j].reflection != b.components[j].reflection) throw std::runtime_error("Wrong component in larger world!");
+				}
+			}
+		}
+
+		//Split a world into cells and decode them one at a time
+		{
+			libcacaoformats::World w;
+			w.skyboxRef = "aSkybox";
+			for(int i = 0; i < 100; ++i) {
+				libcacaoformats::World::Actor& e = w.actors.emplace_back();
+				e.name = "Actor" + std::to_string(i);
+				e.guid = xg::newGuid();
+				e.initialPos = libcacaoformats::Vec3<float> {.x = float(i) * 3.0f - 150.0f, .y = 0.0f, .z = 5.0f};
+				e.components.push_back(libcacaoformats::World::Component {.typeID = "aType", .reflection = std::to_string(i)});
+
+				//Children stay with their parent no matter where they start
+				libcacaoformats::World::Actor& child = w.actors.emplace_back();
+				child.name = "Child";
+				child.guid = xg::newGuid();
+				child.parentGUID = w.actors[w.actors.size() - 2].guid;
+				child.initialPos = libcacaoformats::Vec3<float> {.x = 1000.0f, .y = 0.0f, .z = 0.0f};
+			}
+			libcacaoformats::PackedEncoder enc;
+			libcacaoformats::PackedContainer container = enc.EncodeWorld(w, 30.0f);
+			if(container.version != 3) throw std::runtime_error("World was not partitioned!");
+			libcacaoformats::PackedWorldCells cells = libcacaoformats::PackedWorldCells::FromContainer(container);
+			if(cells.GetCellSize() != 30.0f || cells.GetSkyboxRef().compare("aSkybox") != 0) throw std::runtime_error("Wrong cell world header!");
+			if(cells.GetCells().size() != 10) throw std::runtime_error("Wrong amount of cells!");
+			std::optional<std::size_t> cellIdx = cells.FindCell(libcacaoformats::Vec3<int32_t> {.x = -5, .y = 0, .z = 0});
+			if(!cellIdx || cells.FindCell(libcacaoformats::Vec3<int32_t> {.x = -5, .y = 1, .z = 0})) throw std::runtime_error("Wrong cell lookup result!");
+			libcacaoformats::WorldColumns cell;
+			cells.DecodeCell(*cellIdx, cell);
+			if(cell.ActorCount() != 20 || cells.GetCells()[*cellIdx].actorCount != 20) throw std::runtime_error("Wrong amount of actors in cell!");
+			for(std::size_t i = 0; i < cell.ActorCount(); ++i) {
+				if(cell.positions[i].x != 1000.0f && (cell.positions[i].x < -150.0f || cell.positions[i].x >= -120.0f)) throw std::runtime_error("Actor placed in the wrong cell!");
+			}
+
+			//Decoding the whole world still gives every actor
+			libcacaoformats::PackedDecoder dec;
+			libcacaoformats::World decoded = dec.DecodeWorld(container);
+			if(decoded.actors.size() != w.actors.size() || decoded.skyboxRef.compare("aSkybox") != 0) throw std::runtime_error("Wrong amount of actors in partitioned world!");
+			std::size_t found = 0;
+			for(const libcacaoformats::World::Actor& a : decoded.actors) {
+				for(const libcacaoformats::World::Actor& b : w.actors) {
+					if(a.guid == b.guid && a.name == b.name && a.parentGUID == b.parentGUID && a.components.size() == b.components.size()) ++found;
+				}
+			}
+			if(found != w.actors.size()) throw std::runtime_error("Wrong actor in partitioned world!");
+
+			//Unpartitioned worlds are a single cell
+			libcacaoformats::PackedWorldCells single = libcacaoformats::PackedWorldCells::FromContainer(enc.EncodeWorld(w));
+			if(single.GetCellSize() != 0.0f || single.GetCells().size() != 1 || single.GetCells()[0].actorCount != w.actors.size()) throw std::runtime_error("Wrong cells in unpartitioned world!");
+		}
+
+		//Convert reflection data to binary and read it back without YAML
+		{
+			libcacaoformats::PackedEncoder enc;
+			std::string rfl = enc.EncodeReflection("theVec:\n  x: 2.1\n  y: -8.47\nname: 'abc'\ncode: \"007\"\nlist: [1, true, ~, text]");
+			if(!libcacaoformats::ReflectionView::IsBinary(rfl) || enc.EncodeReflection(rfl) != rfl) throw std::runtime_error("Reflection data was not converted to binary!");
+			libcacaoformats::ReflectionView root = libcacaoformats::ReflectionView::Open(rfl);
+			if(root.GetType() != libcacaoformats::ReflectionView::Type::Map || root.Size() != 4 || root.Key(2).compare("code") != 0) throw std::runtime_error("Wrong binary reflection map!");
+			std::optional<libcacaoformats::ReflectionView> vec = root.Find("theVec");
+			if(!vec || !vec->Find("y") || vec->Find("y")->AsFloat() != -8.47 || vec->Find("z")) throw std::runtime_error("Wrong binary reflection nested map!");
+			if(root.Find("name")->AsString().compare("abc") != 0 || root.Find("code")->AsString().compare("007") != 0) throw std::runtime_error("Wrong binary reflection string!");
+			std::vector<std::string_view> keys;
+			for(libcacaoformats::ReflectionView::Iterator it = root.begin(); it != root.end(); ++it) keys.push_back(it.Key());
+			if(keys != std::vector<std::string_view> {"theVec", "name", "code", "list"} || (*std::next(root.begin(), 3)).Size() != 4) throw std::runtime_error("Wrong binary reflection map iteration!");
+			libcacaoformats::ReflectionView list = *root.Find("list");
+			std::size_t visited = 0;
+			for(libcacaoformats::ReflectionView element : list) {
+				if(element.GetType() != list[visited++].GetType()) throw std::runtime_error("Wrong binary reflection sequence iteration!");
+			}
+			if(visited != 4) throw std::runtime_error("Wrong binary reflection sequence length!");
+			if(list.Size() != 4 || list[0].AsInt() != 1 || !list[1].AsBool() || list[2].GetType() != libcacaoformats::ReflectionView::Type::Null || list[3].AsString().compare("text") != 0) throw std::runtime_error("Wrong binary reflection sequence!");
+
+			//Binary reflection data survives a round trip through a packed world
+			libcacaoformats::World w;
+			libcacaoformats::World::Actor& e = w.actors.emplace_back();
+			e.name = "Honk";
+			e.guid = xg::newGuid();
+			e.components.push_back(libcacaoformats::World::Component {.typeID = "aType", .reflection = rfl});
+			libcacaoformats::PackedDecoder dec;
+			libcacaoformats::World decoded = dec.DecodeWorld(enc.EncodeWorld(w));
+			if(decoded.actors[0].components[0].reflection != rfl) throw std::runtime_error("Binary reflection data did not survive a round trip!");
+
+			//Malformed data is rejected
+			bool threw = false;
+			try {
+				libcacaoformats::ReflectionView::Open(rfl.substr(0, rfl.size() - 1));
+			} catch(const std::runtime_error&) {
+				threw = true;
+			}
+			if(!threw) throw std::runtime_error("Truncated binary reflection data was accepted!");
+		}
+
 		return 0;
 	} catch(const std::exception& e) {
 		std::cerr << "Error: " << e.what() << std::endl;
@@ -2,6 +2,8 @@
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
 
 int main() {
 	try {
@@ -56,6 +58,66 @@ int main() {
 			if(c2.reflection.compare("theVec:\n  x: 2.1\n  y: -8.47") != 0) throw std::runtime_error("Wrong second component reflection data!");
 		}
 
+		//Binary reflection data is written back out as YAML
+		{
+			libcacaoformats::World w;
+			libcacaoformats::World::Actor& e = w.actors.emplace_back();
+			e.name = "Honk";
+			e.guid = xg::Guid("36f595e7-e072-4219-bd0d-7db2d9260eea");
+			std::string rfl = libcacaoformats::PackedEncoder().EncodeReflection("theVec:\n  x: 2.1\n  y: -8.47\nname: abc\nwhole: 1.0\nscale: !!float 3\ncount: !!int 4\ncode: \"007\"\nflag: \"yes\"\ntruth: 'true'\nratio: \"1.5\"\nnothing: \"null\"\nempty: \"\"");
+			libcacaoformats::ReflectionView root = libcacaoformats::ReflectionView::Open(rfl);
+			if(root.Find("whole")->GetType() != libcacaoformats::ReflectionView::Type::Float || root.Find("scale")->GetType() != libcacaoformats::ReflectionView::Type::Float || root.Find("count")->GetType() != libcacaoformats::ReflectionView::Type::Int) throw std::runtime_error("Wrong reflection scalar types!");
+			for(const char* key : {"name", "code", "flag", "truth", "ratio", "nothing", "empty"}) {
+				if(root.Find(key)->GetType() != libcacaoformats::ReflectionView::Type::String) throw std::runtime_error("Quoted reflection scalar is not a string!");
+			}
+			e.components.push_back(libcacaoformats::World::Component {.typeID = "aType", .reflection = rfl});
+			std::stringstream str;
+			libcacaoformats::UnpackedEncoder().EncodeWorld(w, str);
+			libcacaoformats::World decoded = libcacaoformats::UnpackedDecoder().DecodeWorld(str);
+			if(libcacaoformats::ReflectionView::IsBinary(decoded.actors[0].components[0].reflection)) throw std::runtime_error("Reflection data was not written as YAML!");
+			if(libcacaoformats::PackedEncoder().EncodeReflection(decoded.actors[0].components[0].reflection) != rfl) throw std::runtime_error("Wrong reflection data from binary!");
+			if(decoded.actors[0].components[0].reflection.find("name: abc") == std::string::npos) throw std::runtime_error("Plain reflection string was tagged!");
+		}
+
+		//Later actors and keys can alias anchors from actors that have already been decoded
+		{
+			std::stringstream str;
+			str << "skybox: aSkybox\n"
+				   "actors:\n"
+				   "  - guid: 36f595e7-e072-4219-bd0d-7db2d9260eea\n"
+				   "    parent: 00000000-0000-0000-0000-000000000000\n"
+				   "    name: First\n"
+				   "    transform:\n"
+				   "      position: &origin {x: 1, y: 2, z: 3}\n"
+				   "      rotation: &rot {x: 0, y: 90, z: 0}\n"
+				   "      scale: {x: 1, y: 1, z: 1}\n"
+				   "    components:\n"
+				   "      - id: aType\n"
+				   "        rfl: &shared {angles: *rot, nested: &inner {someProp: 1.3}}\n"
+				   "  - guid: 7e2b6f0a-52c1-4b43-9a2f-0d3c5e1f9b11\n"
+				   "    parent: 36f595e7-e072-4219-bd0d-7db2d9260eea\n"
+				   "    name: Second\n"
+				   "    transform:\n"
+				   "      position: *origin\n"
+				   "      rotation: *rot\n"
+				   "      scale: {x: 2, y: 2, z: 2}\n"
+				   "    components:\n"
+				   "      - id: aType\n"
+				   "        rfl: *shared\n"
+				   "      - id: aDifferentType\n"
+				   "        rfl: *inner\n"
+				   "cam:\n"
+				   "  position: *origin\n"
+				   "  rotation: *rot\n";
+			libcacaoformats::World w = libcacaoformats::UnpackedDecoder().DecodeWorld(str);
+			if(w.actors.size() != 2) throw std::runtime_error("Wrong amount of actors with aliases!");
+			const libcacaoformats::World::Actor& second = w.actors[1];
+			if(second.initialPos.x != 1.0f || second.initialPos.y != 2.0f || second.initialPos.z != 3.0f || second.initialRot.y != 90.0f) throw std::runtime_error("Wrong aliased actor transform!");
+			if(second.components.size() != 2 || second.components[0].reflection != w.actors[0].components[0].reflection) throw std::runtime_error("Wrong aliased component reflection data!");
+						if(second.components[0].reflection != "{angles: {x: 0, y: 90, z: 0}, nested: {someProp: 1.3}}" || second.components[1].reflection != "{someProp: 1.3}") throw std::runtime_error("Wrong nested aliased reflection data!");
+			if(w.initialCamPos.z != 3.0f || w.initialCamRot.y != 90.0f) throw std::runtime_error("Wrong aliased camera transform!");
+		}
+
 		return 0;
 	} catch(const std::exception& e) {
 		std::cerr << "Error: " << e.what() << std::endl;
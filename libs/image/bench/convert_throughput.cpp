@@ -0,0 +1,119 @@
+#include "Kernels.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//An odd size so that every kernel also has to finish off a partial vector on each call
+constexpr std::size_t pixels = 1021 * 769;
+
+//Each case is run repeatedly until at least this much time has passed
+constexpr double minSeconds = 0.25;
+constexpr std::size_t minIterations = 3;
+
+struct Case {
+	std::string name;
+	std::size_t srcBytes, dstBytes;
+
+	//Runs the conversion with a set of kernels over a given number of pixels
+	std::function<void(const libcacaoimage::PixelKernels&, const unsigned char*, unsigned char*, std::size_t)> run;
+};
+
+template<typename T>
+void AddLayoutCases(std::vector<Case>& cases, const char* depth, libcacaoimage::LayoutKernels<T> libcacaoimage::PixelKernels::* set) {
+	using Kernel = void (*libcacaoimage::LayoutKernels<T>::*)(const T*, T*, std::size_t);
+	struct Conversion {
+		const char* name;
+		std::size_t in, out;
+		Kernel kernel;
+	};
+	const Conversion conversions[] = {
+		{"rgb_to_rgba", 3, 4, &libcacaoimage::LayoutKernels<T>::rgbToRgba},
+		{"rgba_to_rgb", 4, 3, &libcacaoimage::LayoutKernels<T>::rgbaToRgb},
+		{"gray_to_rgb", 1, 3, &libcacaoimage::LayoutKernels<T>::grayToRgb},
+		{"gray_to_rgba", 1, 4, &libcacaoimage::LayoutKernels<T>::grayToRgba},
+		{"rgb_to_gray", 3, 1, &libcacaoimage::LayoutKernels<T>::rgbToGray},
+		{"rgba_to_gray", 4, 1, &libcacaoimage::LayoutKernels<T>::rgbaToGray}};
+	for(const Conversion& c : conversions) {
+		cases.push_back({std::string(c.name) + "_" + depth, c.in * sizeof(T), c.out * sizeof(T), [set, kernel = c.kernel](const libcacaoimage::PixelKernels& k, const unsigned char* src, unsigned char* dst, std::size_t count) {
+							 ((k.*set).*kernel)(reinterpret_cast<const T*>(src), reinterpret_cast<T*>(dst), count);
+						 }});
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if(argc > 2) {
+		std::cerr << "Usage: " << argv[0] << " [case name filter]" << std::endl;
+		return 1;
+	}
+	std::string filter = (argc == 2 ? argv[1] : "");
+
+	std::vector<Case> cases;
+	AddLayoutCases<uint8_t>(cases, "8", &libcacaoimage::PixelKernels::u8);
+	AddLayoutCases<uint16_t>(cases, "16", &libcacaoimage::PixelKernels::u16);
+	cases.push_back({"depth_16_to_8", 2, 1, [](const libcacaoimage::PixelKernels& k, const unsigned char* src, unsigned char* dst, std::size_t count) { k.depth16To8(src, dst, count); }});
+
+	//The vertical pass of a 4-tap mip filter, one value per "pixel"
+	//Inputs are whole multiples of 1/256 and the weights are eighths, so every product and sum is exact whether or not it gets fused
+	std::vector<float> filterRows(pixels * 4);
+	std::mt19937 filterRng(5678);
+	for(float& f : filterRows) f = static_cast<float>(filterRng() & 0xFF) / 256.0f;
+	cases.push_back({"weighted_rows", 4 * sizeof(float), sizeof(float), [&filterRows](const libcacaoimage::PixelKernels& k, const unsigned char*, unsigned char* dst, std::size_t count) {
+						 const float* rows[4] = {filterRows.data(), filterRows.data() + pixels, filterRows.data() + 2 * pixels, filterRows.data() + 3 * pixels};
+						 const float weights[4] = {0.125f, 0.375f, 0.375f, 0.125f};
+						 k.weightedRows(rows, weights, 4, reinterpret_cast<float*>(dst), count);
+					 }});
+
+	const libcacaoimage::PixelKernels& scalar = libcacaoimage::ScalarKernels();
+	const libcacaoimage::PixelKernels& active = libcacaoimage::ActiveKernels();
+	std::printf("active kernels: %s\n", active.name);
+
+	//Random input covers every value, including the ones where truncation is closest to flipping
+	std::vector<unsigned char> src(pixels * 8);
+	std::mt19937 rng(1234);
+	for(unsigned char& b : src) b = static_cast<unsigned char>(rng());
+
+	try {
+		std::printf("%-20s %12s %12s %9s\n", "case", "scalar MB/s", "active MB/s", "speedup");
+		for(const Case& c : cases) {
+			if(c.name.find(filter) == std::string::npos) continue;
+
+			//The active kernels have to match the scalar ones exactly, including on every short tail
+			std::vector<unsigned char> expected(pixels * c.dstBytes), actual(pixels * c.dstBytes);
+			for(std::size_t count = 0; count <= pixels; count = (count < 100 ? count + 1 : count * 3 + 7)) {
+				std::memset(expected.data(), 0xA5, expected.size());
+				std::memset(actual.data(), 0xA5, actual.size());
+				c.run(scalar, src.data(), expected.data(), count);
+				c.run(active, src.data(), actual.data(), count);
+				if(expected != actual) throw std::runtime_error(c.name + " differs from the scalar kernel over " + std::to_string(count) + " pixels");
+			}
+
+			double rates[2] = {};
+			const libcacaoimage::PixelKernels* sets[2] = {&scalar, &active};
+			for(int s = 0; s < 2; ++s) {
+				//Warm up once, then time as many conversions as fit
+				c.run(*sets[s], src.data(), actual.data(), pixels);
+				std::size_t iterations = 0;
+				auto start = std::chrono::steady_clock::now();
+				double elapsed = 0;
+				do {
+					c.run(*sets[s], src.data(), actual.data(), pixels);
+					++iterations;
+					elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				} while(elapsed < minSeconds || iterations < minIterations);
+				rates[s] = (double(pixels * c.srcBytes) * iterations / 1e6) / elapsed;
+			}
+			std::printf("%-20s %12.1f %12.1f %8.2fx\n", c.name.c_str(), rates[0], rates[1], rates[1] / rates[0]);
+		}
+		return 0;
+	} catch(const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <istream>
 #include <ostream>
 #include <cstdint>
+#include <optional>
+#include <span>
 
 namespace libcacaoimage {
 	///@brief Decoded image representation
@@ -35,16 +37,43 @@ namespace libcacaoimage {
 
 	///@brief Image decoding functions
 	namespace decode {
+		/**
+		 * @brief Options for decoding an image straight into the form it's needed in
+		 *
+		 * Decoders apply as much of this as they can inside the codec, and handle the rest row by row as the image is decoded.
+		 * Reducing 16-bit channels to 8-bit uses the same mapping as Convert16To8BitColor, and widening 8-bit channels to 16-bit scales them to the full range.
+		 * Layout conversions follow the rules of ChangeChannelLayout, except that codecs producing grayscale themselves may use their own luma weights.
+		 */
+		struct DecodeOptions {
+			std::optional<Image::Layout> layout;		///<Channel layout to decode to, or the image's own if unset
+			std::optional<uint8_t> bitsPerChannel;	///<Color depth to decode to (8 or 16), or the image's own if unset
+			bool flip = false;						///<Whether to flip the image vertically, as graphics APIs like OpenGL want
+			unsigned int downscale = 1;				///<Factor to shrink both dimensions by (1, 2, 4, or 8), rounding partial pixels up
+		};
+
 		/**
 		 * @brief Decode an arbitrary image of an unknown format
 		 *
 		 * @param input An input stream to the encoded data
+		 * @param options How the decoded image should be laid out
 		 *
 		 * @return The decoded image data
 		 *
-		 * @throws std::runtime_error If the format cannot be determined or if decoding fails
+		 * @throws std::runtime_error If the format cannot be determined, if the options are invalid, or if decoding fails
 		 */
-		Image DecodeGeneric(std::istream& input);
+		Image DecodeGeneric(std::istream& input, const DecodeOptions& options = {});
+
+		/**
+		 * @brief Decode an arbitrary image of an unknown format from memory
+		 *
+		 * @param data The encoded data, which is decoded in place without being copied
+		 * @param options How the decoded image should be laid out
+		 *
+		 * @return The decoded image data
+		 *
+		 * @throws std::runtime_error If the format cannot be determined, if the options are invalid, or if decoding fails
+		 */
+		Image DecodeGeneric(std::span<const unsigned char> data, const DecodeOptions& options = {});
 
 		/**
 		 * @brief Decode a PNG image
@@ -52,12 +81,25 @@ namespace libcacaoimage {
 		 * If you know your image is PNG, this avoids the overhead of format determination
 		 *
 		 * @param input An input stream to the encoded data
+		 * @param options How the decoded image should be laid out
+		 *
+		 * @return The decoded image data
+		 *
+		 * @throws std::runtime_error If the data is not in PNG format, if the options are invalid, or if decoding fails
+		 */
+		Image DecodePNG(std::istream& input, const DecodeOptions& options = {});
+
+		/**
+		 * @brief Decode a PNG image from memory
+		 *
+		 * @param data The encoded data, which is decoded in place without being copied
+		 * @param options How the decoded image should be laid out
 		 *
 		 * @return The decoded image data
 		 *
-		 * @throws std::runtime_error If the data is not in PNG format or if decoding fails
+		 * @throws std::runtime_error If the data is not in PNG format, if the options are invalid, or if decoding fails
 		 */
-		Image DecodePNG(std::istream& input);
+		Image DecodePNG(std::span<const unsigned char> data, const DecodeOptions& options = {});
 
 		/**
 		 * @brief Decode a JPEG image
@@ -65,12 +107,25 @@ namespace libcacaoimage {
 		 * If you know your image is JPEG, this avoids the overhead of format determination
 		 *
 		 * @param input An input stream to the encoded data
+		 * @param options How the decoded image should be laid out
 		 *
 		 * @return The decoded image data
 		 *
-		 * @throws std::runtime_error If the data is not in JPEG format or if decoding fails
+		 * @throws std::runtime_error If the data is not in JPEG format, if the options are invalid, or if decoding fails
 		 */
-		Image DecodeJPEG(std::istream& input);
+		Image DecodeJPEG(std::istream& input, const DecodeOptions& options = {});
+
+		/**
+		 * @brief Decode a JPEG image from memory
+		 *
+		 * @param data The encoded data, which is decoded in place without being copied
+		 * @param options How the decoded image should be laid out
+		 *
+		 * @return The decoded image data
+		 *
+		 * @throws std::runtime_error If the data is not in JPEG format, if the options are invalid, or if decoding fails
+		 */
+		Image DecodeJPEG(std::span<const unsigned char> data, const DecodeOptions& options = {});
 
 		/**
 		 * @brief Decode a WebP image
@@ -78,12 +133,25 @@ namespace libcacaoimage {
 		 * If you know your image is WebP, this avoids the overhead of format determination
 		 *
 		 * @param input An input stream to the encoded data
+		 * @param options How the decoded image should be laid out
+		 *
+		 * @return The decoded image data
+		 *
+		 * @throws std::runtime_error If the data is not in WebP format, if the options are invalid, or if decoding fails
+		 */
+		Image DecodeWebP(std::istream& input, const DecodeOptions& options = {});
+
+		/**
+		 * @brief Decode a WebP image from memory
+		 *
+		 * @param data The encoded data, which is decoded in place without being copied
+		 * @param options How the decoded image should be laid out
 		 *
 		 * @return The decoded image data
 		 *
-		 * @throws std::runtime_error If the data is not in WebP format or if decoding fails
+		 * @throws std::runtime_error If the data is not in WebP format, if the options are invalid, or if decoding fails
 		 */
-		Image DecodeWebP(std::istream& input);
+		Image DecodeWebP(std::span<const unsigned char> data, const DecodeOptions& options = {});
 
 		/**
 		 * @brief Decode a TGA (Targa) image
@@ -91,12 +159,25 @@ namespace libcacaoimage {
 		 * If you know your image is TGA, this avoids the overhead of format determination
 		 *
 		 * @param input An input stream to the encoded data
+		 * @param options How the decoded image should be laid out
+		 *
+		 * @return The decoded image data
+		 *
+		 * @throws std::runtime_error If the data is not in TGA format, if the options are invalid, or if decoding fails
+		 */
+		Image DecodeTGA(std::istream& input, const DecodeOptions& options = {});
+
+		/**
+		 * @brief Decode a TGA (Targa) image from memory
+		 *
+		 * @param data The encoded data, which is decoded in place without being copied
+		 * @param options How the decoded image should be laid out
 		 *
 		 * @return The decoded image data
 		 *
-		 * @throws std::runtime_error If the data is not in TGA format or if decoding fails
+		 * @throws std::runtime_error If the data is not in TGA format, if the options are invalid, or if decoding fails
 		 */
-		Image DecodeTGA(std::istream& input);
+		Image DecodeTGA(std::span<const unsigned char> data, const DecodeOptions& options = {});
 
 		/**
 		 * @brief Decode a TIFF image
@@ -104,12 +185,25 @@ namespace libcacaoimage {
 		 * If you know your image is TIFF, this avoids the overhead of format determination
 		 *
 		 * @param input An input stream to the encoded data
+		 * @param options How the decoded image should be laid out
 		 *
 		 * @return The decoded image data
 		 *
-		 * @throws std::runtime_error If the data is not in TIFF format or if decoding fails
+		 * @throws std::runtime_error If the data is not in TIFF format, if the options are invalid, or if decoding fails
 		 */
-		Image DecodeTIFF(std::istream& input);
+		Image DecodeTIFF(std::istream& input, const DecodeOptions& options = {});
+
+		/**
+		 * @brief Decode a TIFF image from memory
+		 *
+		 * @param data The encoded data, which is decoded in place without being copied
+		 * @param options How the decoded image should be laid out
+		 *
+		 * @return The decoded image data
+		 *
+		 * @throws std::runtime_error If the data is not in TIFF format, if the options are invalid, or if decoding fails
+		 */
+		Image DecodeTIFF(std::span<const unsigned char> data, const DecodeOptions& options = {});
 	}
 
 	///@brief Image encoding functions
@@ -186,6 +280,27 @@ namespace libcacaoimage {
 	 */
 	Image Convert16To8BitColor(const Image& src);
 
+	/**
+	 * @brief Convert the pixels of an Image with a 16-bit color depth to an 8-bit color depth in a caller-provided buffer
+	 *
+	 * @param src The source 16-bit image
+	 * @param dst The buffer to write the 8-bit pixels to, which must hold at least half as many bytes as the source image's data buffer
+	 *
+	 * @throws std::runtime_error If the source image is not 16-bit or if the destination buffer is too small
+	 */
+	void Convert16To8BitColor(const Image& src, std::span<unsigned char> dst);
+
+	/**
+	 * @brief Convert an Image with a 16-bit color depth to an 8-bit color depth in place
+	 *
+	 * The data buffer keeps its capacity, so this never allocates.
+	 *
+	 * @param img The 16-bit image to convert
+	 *
+	 * @throws std::runtime_error If the image is not 16-bit
+	 */
+	void Convert16To8BitColorInPlace(Image& img);
+
 	/**
 	 * @brief Flip an Image's pixels vertically to accomodate graphics APIs like OpenGL
 	 *
@@ -195,6 +310,23 @@ namespace libcacaoimage {
 	 */
 	Image Flip(const Image& src);
 
+	/**
+	 * @brief Write an Image's pixels flipped vertically into a caller-provided buffer
+	 *
+	 * @param src The source image
+	 * @param dst The buffer to write the flipped pixels to, which must hold at least as many bytes as the source image's data buffer
+	 *
+	 * @throws std::runtime_error If the destination buffer is too small
+	 */
+	void Flip(const Image& src, std::span<unsigned char> dst);
+
+	/**
+	 * @brief Flip an Image's pixels vertically in place
+	 *
+	 * @param img The image to flip
+	 */
+	void FlipInPlace(Image& img);
+
 	/**
 	 * @brief Adjust the channel layout of an Image
 	 *
@@ -211,4 +343,77 @@ namespace libcacaoimage {
 	 * @throws std::runtime_error If the source image's layout is the same as the new layout
 	 */
 	Image ChangeChannelLayout(const Image& src, Image::Layout layout);
+
+	/**
+	 * @brief Write an Image's pixels with a different channel layout into a caller-provided buffer
+	 *
+	 * This follows the same conversion rules as the copying version.
+	 *
+	 * @param src The source image
+	 * @param layout The new image layout
+	 * @param dst The buffer to write the converted pixels to, which must be large enough for the image in the new layout
+	 *
+	 * @throws std::runtime_error If the source image's layout is the same as the new layout or if the destination buffer is too small
+	 */
+	void ChangeChannelLayout(const Image& src, Image::Layout layout, std::span<unsigned char> dst);
+
+	/**
+	 * @brief Adjust the channel layout of an Image in place
+	 *
+	 * This follows the same conversion rules as the copying version. The data buffer only reallocates if the new layout needs more room than its capacity.
+	 *
+	 * @param img The image to convert
+	 * @param layout The new image layout
+	 *
+	 * @throws std::runtime_error If the image's layout is the same as the new layout
+	 */
+	void ChangeChannelLayoutInPlace(Image& img, Image::Layout layout);
+
+	/**
+	 * @brief Bring an Image to 8-bit color depth and a given channel layout, optionally flipping it, in one pass over its pixels
+	 *
+	 * This is equivalent to calling Convert16To8BitColor, ChangeChannelLayout, and Flip as needed, but without any intermediate images.
+	 * It works in place when the result is no larger than the source and isn't flipped, and otherwise allocates the new data buffer once.
+	 *
+	 * @param img The image to normalize
+	 * @param layout The channel layout to end up with, which may be the current one
+	 * @param flip Whether to also flip the image vertically
+	 */
+	void Normalize(Image& img, Image::Layout layout, bool flip = false);
+
+	/**
+	 * @brief Write an Image's pixels at 8-bit color depth and a given channel layout, optionally flipped, into a caller-provided buffer
+	 *
+	 * @param src The source image
+	 * @param layout The channel layout to write, which may be the current one
+	 * @param flip Whether to also flip the image vertically
+	 * @param dst The buffer to write the pixels to, which must hold at least width * height * channels bytes
+	 *
+	 * @throws std::runtime_error If the destination buffer is too small
+	 */
+	void Normalize(const Image& src, Image::Layout layout, bool flip, std::span<unsigned char> dst);
+
+	///@brief Filters for shrinking mip levels
+	enum class MipFilter {
+		Box,  ///<Average of the pixels each output pixel covers, which is fast and never rings
+		Kaiser///<Kaiser-windowed sinc, which keeps more detail at the cost of slight ringing around sharp edges
+	};
+
+	/**
+	 * @brief Generate the mip levels below an Image, down to a single pixel
+	 *
+	 * Each level is half the size of the one above it, rounding down and stopping at one pixel, and is filtered from that level.
+	 * Filtering happens in linear light: with srgb set, 8-bit color channels are decoded from sRGB and encoded back afterwards,
+	 * while 16-bit channels and alpha are always linear, as elsewhere in this library. Levels keep the image's layout and color depth.
+	 *
+	 * @param src The full-size image, which isn't part of the result
+	 * @param filter The filter to shrink levels with
+	 * @param srgb Whether 8-bit color channels hold sRGB values (turn this off for data like normal maps)
+	 * @param threads The maximum number of threads to filter rows on (0 uses one per hardware thread)
+	 *
+	 * @return The mip levels from half size down to one pixel, which is empty for a one-pixel image
+	 *
+	 * @throws std::runtime_error If the image has zeroed dimensions, an invalid color depth, or a data buffer too small for its dimensions
+	 */
+	std::vector<Image> GenerateMipChain(const Image& src, MipFilter filter = MipFilter::Box, bool srgb = true, unsigned int threads = 1);
 }
\ No newline at end of file
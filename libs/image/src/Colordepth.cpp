@@ -1,12 +1,11 @@
 #include "libcacaoimage.hpp"
 #include "libcacaocommon.hpp"
 
-#include "colordepth_lut.hpp"
+#include "Convert.hpp"
+#include "Kernels.hpp"
 
 namespace libcacaoimage {
 	Image Convert16To8BitColor(const Image& src) {
-		CheckException(src.bitsPerChannel == 16, "Source image for 16 to 8-bit color conversion does not have a 16-bit color depth!");
-
 		//Setup image
 		Image out = {};
 		out.w = src.w;
@@ -17,26 +16,27 @@ namespace libcacaoimage {
 		out.lossy = src.lossy;
 		out.quality = src.quality;
 
-		//Prepare for conversion
+		//Convert data
 		out.data.resize(src.data.size() / 2);
-		const uint8_t channels = static_cast<uint8_t>(src.layout);
-		const std::size_t pixels = src.data.size() / channels / 2;
+		Convert16To8BitColor(src, out.data);
 
-		//Convert data
-		for(std::size_t px = 0; px < pixels; ++px) {
-			for(uint8_t channel = 0; channel < channels; ++channel) {
-				//Calculate index into input buffer
-				const std::size_t index = (px * channels + channel) * 2;
+		//Return result
+		return out;
+	}
+
+	void Convert16To8BitColor(const Image& src, std::span<unsigned char> dst) {
+		CheckException(src.bitsPerChannel == 16, "Source image for 16 to 8-bit color conversion does not have a 16-bit color depth!");
+		CheckException(dst.size() >= src.data.size() / 2, "Destination buffer is too small for the 8-bit image!");
 
-				//Get the 16-bit value
-				uint16_t value = static_cast<uint16_t>(src.data[index]) | (static_cast<uint16_t>(src.data[index + 1]) << 8);
+		ActiveKernels().depth16To8(src.data.data(), dst.data(), src.data.size() / 2);
+	}
 
-				//Convert to 8-bit and store
-				out.data[px * channels + channel] = lut[value];
-			}
-		}
+	void Convert16To8BitColorInPlace(Image& img) {
+		CheckException(img.bitsPerChannel == 16, "Image for 16 to 8-bit color conversion does not have a 16-bit color depth!");
 
-		//Return result
-		return out;
+		const std::size_t values = img.data.size() / 2;
+		ConvertInPlace(img.data.data(), values, 2, 1, ActiveKernels().depth16To8);
+		img.data.resize(values);
+		img.bitsPerChannel = 8;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "libcacaoimage.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//Conversion helpers shared by the public transforms
+namespace libcacaoimage {
+	///@brief Convert tightly packed pixels between channel layouts with the active kernels (the layouts must differ)
+	void ConvertChannels(uint8_t bitsPerChannel, Image::Layout from, Image::Layout to, const unsigned char* src, unsigned char* dst, std::size_t pixels);
+
+	/**
+	 * @brief Run a conversion over a buffer in place
+	 *
+	 * Output is staged through the stack in chunks, so the kernels never see overlapping buffers. Shrinking conversions walk
+	 * forwards and growing ones backwards, which keeps every chunk's output clear of the input that hasn't been read yet.
+	 * Growing conversions need the buffer to already be large enough for the output.
+	 *
+	 * @param data The buffer to convert
+	 * @param count How many units (pixels or channel values) to convert
+	 * @param inBytes Size of one unit of input
+	 * @param outBytes Size of one unit of output
+	 * @param convert The conversion, called as convert(src, dst, units)
+	 */
+	template<typename Convert>
+	void ConvertInPlace(unsigned char* data, std::size_t count, std::size_t inBytes, std::size_t outBytes, Convert&& convert) {
+		alignas(16) unsigned char staging[16384];
+		const std::size_t chunk = sizeof(staging) / outBytes;
+		if(outBytes <= inBytes) {
+			for(std::size_t start = 0; start < count; start += chunk) {
+				const std::size_t units = std::min(chunk, count - start);
+				convert(data + start * inBytes, staging, units);
+				std::memcpy(data + start * outBytes, staging, units * outBytes);
+			}
+		} else {
+			for(std::size_t end = count; end > 0;) {
+				const std::size_t units = std::min(chunk, end);
+				end -= units;
+				convert(data + end * inBytes, staging, units);
+				std::memcpy(data + end * outBytes, staging, units * outBytes);
+			}
+		}
+	}
+}
\ No newline at end of file
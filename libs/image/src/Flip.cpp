@@ -1,43 +1,60 @@
 #include "libcacaoimage.hpp"
 #include "libcacaocommon.hpp"
-#include <memory>
 
-namespace libcacaoimage {
-	Image Flip(const Image& src) {
-		//Validate input
-		CheckException(src.w > 0 && src.h > 0, "Cannot flip an image with zeroed dimensions!");
-		CheckException(src.bitsPerChannel == 8 || src.bitsPerChannel == 16, "Invalid color depth; only 8 and 16 are allowed.");
-		CheckException(src.data.size() > 0, "Cannot flip an image with a zero-sized data buffer!");
+#include <algorithm>
+#include <cstring>
 
-		//If the image is 1D, no flip can be done
-		if(src.h == 1) return src;
-
-		//Calculate row pitch
-		const std::size_t rowPitch = static_cast<std::size_t>(src.w) * src.h * static_cast<uint8_t>(src.layout) * (src.bitsPerChannel / 8);
+namespace libcacaoimage {
+	namespace {
+		//Validate a flip source and get its row pitch
+		std::size_t FlipRowPitch(const Image& src) {
+			CheckException(src.w > 0 && src.h > 0, "Cannot flip an image with zeroed dimensions!");
+			CheckException(src.bitsPerChannel == 8 || src.bitsPerChannel == 16, "Invalid color depth; only 8 and 16 are allowed.");
+			CheckException(src.data.size() > 0, "Cannot flip an image with a zero-sized data buffer!");
+
+			const std::size_t rowPitch = static_cast<std::size_t>(src.w) * static_cast<uint8_t>(src.layout) * (src.bitsPerChannel / 8);
+			CheckException(src.data.size() >= rowPitch * src.h, "Image data buffer is too small for its dimensions!");
+			return rowPitch;
+		}
+	}
 
-		//Allocate temporary row buffer
-		std::unique_ptr<unsigned char[]> tempRow = std::make_unique_for_overwrite<unsigned char[]>(rowPitch);
+	Image Flip(const Image& src) {
+		//Copy properties but not data
+		Image out = {};
+		out.w = src.w;
+		out.h = src.h;
+		out.format = src.format;
+		out.layout = src.layout;
+		out.bitsPerChannel = src.bitsPerChannel;
+		out.lossy = src.lossy;
+		out.quality = src.quality;
+
+		//Write flipped rows straight into the output buffer
+		out.data.resize(src.data.size());
+		Flip(src, out.data);
 
-		//Copy source image to output image to get properties
-		Image out = src;
+		//Return result
+		return out;
+	}
 
-		//Flip the rows
-		for(unsigned int y = 0; y < (src.h / 2); ++y) {
-			//Calculate pointers for copy
-			unsigned char* top = const_cast<unsigned char*>(src.data.data()) + static_cast<std::size_t>(y) * rowPitch;
-			unsigned char* bottom = const_cast<unsigned char*>(src.data.data()) + static_cast<std::size_t>(src.h - y - 1) * rowPitch;
+	void Flip(const Image& src, std::span<unsigned char> dst) {
+		const std::size_t rowPitch = FlipRowPitch(src);
+		CheckException(dst.size() >= rowPitch * src.h, "Destination buffer is too small for the flipped image!");
 
-			//Copy top row into the temporary row buffer
-			std::memcpy(tempRow.get(), top, rowPitch);
+		//Copy each row to its mirrored position
+		for(unsigned int y = 0; y < src.h; ++y) {
+			std::memcpy(dst.data() + static_cast<std::size_t>(src.h - y - 1) * rowPitch, src.data.data() + static_cast<std::size_t>(y) * rowPitch, rowPitch);
+		}
+	}
 
-			//Copy bottom row into the top row
-			std::memcpy(top, bottom, rowPitch);
+	void FlipInPlace(Image& img) {
+		const std::size_t rowPitch = FlipRowPitch(img);
 
-			//Copy saved top row in the temporary buffer to the bottom row
-			std::memcpy(bottom, tempRow.get(), rowPitch);
+		//Swap rows from the outside in (a single row has nothing to swap with)
+		for(unsigned int y = 0; y < (img.h / 2); ++y) {
+			unsigned char* top = img.data.data() + static_cast<std::size_t>(y) * rowPitch;
+			unsigned char* bottom = img.data.data() + static_cast<std::size_t>(img.h - y - 1) * rowPitch;
+			std::swap_ranges(top, top + rowPitch, bottom);
 		}
-
-		//Return result
-		return out;
 	}
 }
\ No newline at end of file
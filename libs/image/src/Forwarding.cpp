@@ -1,30 +1,19 @@
 #include "libcacaoimage.hpp"
 
+#include "Stream.hpp"
+
+#include <algorithm>
 #include <stdexcept>
 #include <array>
+#include <cerrno>
 #include <cstring>
 
 namespace libcacaoimage {
-	Image decode::DecodeGeneric(std::istream& input) {
-		//Read the first eighteen bytes (all detected types are within this range)
-		std::array<unsigned char, 18> rbuf;
-		input.read(reinterpret_cast<char*>(rbuf.data()), 18);
-		input.seekg(0);
+	namespace {
+		//Every detected format can be recognized from this many leading bytes
+		constexpr std::size_t detectBytes = 18;
 
-		//Check the bytes we got
-		if(rbuf[0] == 0xFF && rbuf[1] == 0xD8 && rbuf[2] == 0xFF) {
-			//JPEG
-			return DecodeJPEG(input);
-		} else if(rbuf[0] == 0x89 && rbuf[1] == 0x50 && rbuf[2] == 0x4E && rbuf[3] == 0x47 && rbuf[4] == 0x0D && rbuf[5] == 0x0A && rbuf[6] == 0x1A && rbuf[7] == 0x0A) {
-			//PNG
-			return DecodePNG(input);
-		} else if(rbuf[0] == 'R' && rbuf[1] == 'I' && rbuf[2] == 'F' && rbuf[3] == 'F' && rbuf[8] == 'W' && rbuf[9] == 'E' && rbuf[10] == 'B' && rbuf[11] == 'P') {
-			//WebP
-			return DecodeWebP(input);
-		} else if(rbuf[0] == 'I' && rbuf[1] == 'I' && rbuf[2] == '*' && rbuf[3] == 0) {
-			//TIFF
-			return DecodeTIFF(input);
-		} else {
+		bool IsTGA(const std::array<unsigned char, detectBytes>& rbuf) {
 #pragma pack(push, 1)
 			struct TGAHeader {
 				uint8_t idLen;
@@ -47,23 +36,84 @@ namespace libcacaoimage {
 			std::memcpy(&tga, rbuf.data(), sizeof(TGAHeader));
 
 			//Do checks to validate header (if this isn't TGA these should fail)
-			if(tga.colormapType > 1) goto no;
-			if(tga.imageType == 0) goto no;
-			if(tga.width < 1 || tga.height < 1) goto no;
-			if(tga.pixelDepth != 8 && tga.pixelDepth != 15 && tga.pixelDepth != 16 && tga.pixelDepth != 24 && tga.pixelDepth != 32) goto no;
+			if(tga.colormapType > 1) return false;
+			if(tga.imageType == 0) return false;
+			if(tga.width < 1 || tga.height < 1) return false;
+			if(tga.pixelDepth != 8 && tga.pixelDepth != 15 && tga.pixelDepth != 16 && tga.pixelDepth != 24 && tga.pixelDepth != 32) return false;
 			if(tga.colormapType == 1) {
-				if(tga.imageType != 1 && tga.imageType != 9) goto no;
-				if(tga.cmapEntrySz != 8 && tga.cmapEntrySz != 15 && tga.cmapEntrySz != 16 && tga.cmapEntrySz != 24 && tga.cmapEntrySz != 32) goto no;
+				if(tga.imageType != 1 && tga.imageType != 9) return false;
+				if(tga.cmapEntrySz != 8 && tga.cmapEntrySz != 15 && tga.cmapEntrySz != 16 && tga.cmapEntrySz != 24 && tga.cmapEntrySz != 32) return false;
 			} else {
-				if(tga.imageType != 2 && tga.imageType != 3 && tga.imageType != 10 && tga.imageType != 11) goto no;
+				if(tga.imageType != 2 && tga.imageType != 3 && tga.imageType != 10 && tga.imageType != 11) return false;
 			}
 
 			//If we made it this far it should be TGA
-			return DecodeTGA(input);
+			return true;
+		}
+
+		//Work out the format from the leading bytes, which are zero past the end of the data
+		Image::Format DetectFormat(const std::array<unsigned char, detectBytes>& rbuf) {
+			if(rbuf[0] == 0xFF && rbuf[1] == 0xD8 && rbuf[2] == 0xFF) return Image::Format::JPEG;
+			if(rbuf[0] == 0x89 && rbuf[1] == 0x50 && rbuf[2] == 0x4E && rbuf[3] == 0x47 && rbuf[4] == 0x0D && rbuf[5] == 0x0A && rbuf[6] == 0x1A && rbuf[7] == 0x0A) return Image::Format::PNG;
+			if(rbuf[0] == 'R' && rbuf[1] == 'I' && rbuf[2] == 'F' && rbuf[3] == 'F' && rbuf[8] == 'W' && rbuf[9] == 'E' && rbuf[10] == 'B' && rbuf[11] == 'P') return Image::Format::WebP;
+			if(rbuf[0] == 'I' && rbuf[1] == 'I' && rbuf[2] == '*' && rbuf[3] == 0) return Image::Format::TIFF;
+			if(IsTGA(rbuf)) return Image::Format::TGA;
+			throw std::runtime_error("Unknown file type!");
+		}
+	}
+
+	std::vector<unsigned char> ReadStream(std::istream& input, const char* failure) {
+		try {
+			//Grab size
+			input.clear();
+			input.exceptions(std::ios::failbit | std::ios::badbit);
+			input.seekg(0, std::ios::end);
+			auto size = input.tellg();
+			input.seekg(0, std::ios::beg);
+
+			//Read data
+			std::vector<unsigned char> contents(size);
+			input.read(reinterpret_cast<char*>(contents.data()), size);
+
+			return contents;
+		} catch(std::ios_base::failure& ios_failure) {
+			if(errno == 0) { throw ios_failure; }
+			throw std::runtime_error(failure);
 		}
+	}
+
+	Image decode::DecodeGeneric(std::istream& input, const DecodeOptions& options) {
+		//Read the first eighteen bytes (all detected types are within this range)
+		std::array<unsigned char, detectBytes> rbuf = {};
+		input.read(reinterpret_cast<char*>(rbuf.data()), detectBytes);
+		input.clear();
+		input.seekg(0);
 
-	no:
-		throw std::runtime_error("Unknown file type!");
+		//Check the bytes we got
+		switch(DetectFormat(rbuf)) {
+			case Image::Format::JPEG: return DecodeJPEG(input, options);
+			case Image::Format::PNG: return DecodePNG(input, options);
+			case Image::Format::WebP: return DecodeWebP(input, options);
+			case Image::Format::TIFF: return DecodeTIFF(input, options);
+			case Image::Format::TGA: return DecodeTGA(input, options);
+			default: throw std::runtime_error("Unknown file type!");
+		}
+	}
+
+	Image decode::DecodeGeneric(std::span<const unsigned char> data, const DecodeOptions& options) {
+		//Copy out the first eighteen bytes, leaving the rest zeroed if there aren't that many
+		std::array<unsigned char, detectBytes> rbuf = {};
+		std::copy_n(data.begin(), std::min(data.size(), detectBytes), rbuf.begin());
+
+		//Check the bytes we got
+		switch(DetectFormat(rbuf)) {
+			case Image::Format::JPEG: return DecodeJPEG(data, options);
+			case Image::Format::PNG: return DecodePNG(data, options);
+			case Image::Format::WebP: return DecodeWebP(data, options);
+			case Image::Format::TIFF: return DecodeTIFF(data, options);
+			case Image::Format::TGA: return DecodeTGA(data, options);
+			default: throw std::runtime_error("Unknown file type!");
+		}
 	}
 
 	std::size_t encode::Reencode(const Image& src, std::ostream& out) {
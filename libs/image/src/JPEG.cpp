@@ -1,89 +1,94 @@
 #include "libcacaoimage.hpp"
 #include "libcacaocommon.hpp"
 
+#include "RowWriter.hpp"
+#include "Stream.hpp"
+
 #include "turbojpeg.h"
 
-#include <array>
+#include <vector>
 
 namespace libcacaoimage {
-	Image decode::DecodeJPEG(std::istream& input) {
+	Image decode::DecodeJPEG(std::istream& input, const DecodeOptions& options) {
+		//TurboJPEG only decodes from memory, so read out buffer
+		return DecodeJPEG(ReadStream(input, "Failed to read JPEG image data stream to buffer!"), options);
+	}
+
+	Image decode::DecodeJPEG(std::span<const unsigned char> buffer, const DecodeOptions& options) {
 		//Quick check to confirm JPEG
-		std::array<unsigned char, 3> jpgSig;
-		input.read(reinterpret_cast<char*>(jpgSig.data()), 3);
-		CheckException(jpgSig[0] == 0xFF && jpgSig[1] == 0xD8 && jpgSig[2] == 0xFF, "Non-JPEG data passed to DecodeJPEG!");
-		input.seekg(0);
+		CheckException(buffer.size() >= 3 && buffer[0] == 0xFF && buffer[1] == 0xD8 && buffer[2] == 0xFF, "Non-JPEG data passed to DecodeJPEG!");
+		ValidateDecodeOptions(options);
 
 		//Initialize TurboJPEG
 		tjhandle tj = tj3Init(TJINIT_DECOMPRESS);
 		CheckException(tj, "Failed to initialize TurboJPEG!");
 
-		//Read out buffer
-		std::vector<unsigned char> buffer = [&input, &tj]() {
-			try {
-				//Grab size
-				input.clear();
-				input.exceptions(std::ios::failbit | std::ios::badbit);
-				input.seekg(0, std::ios::end);
-				auto size = input.tellg();
-				input.seekg(0, std::ios::beg);
-
-				//Read data
-				std::vector<unsigned char> contents(size);
-				input.read(reinterpret_cast<char*>(contents.data()), size);
-
-				return contents;
-			} catch(std::ios_base::failure& ios_failure) {
-				tj3Destroy(tj);
-				if(errno == 0) { throw ios_failure; }
-				throw std::runtime_error("Failed to read JPEG image data stream to buffer!");
-			}
-		}();
-
 		//Parse JPEG header
 		CheckException(tj3DecompressHeader(tj, buffer.data(), buffer.size()) == 0, "Failed to parse JPEG header!", [&tj]() { tj3Destroy(tj); });
 
 		//Get image information
 		Image img;
-		img.w = tj3Get(tj, TJPARAM_JPEGWIDTH);
-		img.h = tj3Get(tj, TJPARAM_JPEGHEIGHT);
 		img.format = Image::Format::JPEG;
+		unsigned int w = tj3Get(tj, TJPARAM_JPEGWIDTH);
+		unsigned int h = tj3Get(tj, TJPARAM_JPEGHEIGHT);
 		int bitdepth = tj3Get(tj, TJPARAM_PRECISION);
 		int colorspace = tj3Get(tj, TJPARAM_COLORSPACE);
 
 		//Can we handle this JPEG?
 		CheckException(bitdepth >= 8 && bitdepth <= 16, "Invalid bits per channel in JPEG!", [&tj]() { tj3Destroy(tj); });
 		CheckException(colorspace != TJCS_CMYK, "CMYK JPEGs are not supported!", [&tj]() { tj3Destroy(tj); });
-		img.layout = (colorspace == TJCS_GRAY ? Image::Layout::Grayscale : Image::Layout::RGB);
 
 		//Bits-per-channel normalization
-		img.bitsPerChannel = (bitdepth >= 9) ? 16 : 8;
+		const DecodeTarget target(options, colorspace == TJCS_GRAY ? Image::Layout::Grayscale : Image::Layout::RGB, (bitdepth >= 9) ? 16 : 8);
 		img.quality = 80;
-		img.lossy = img.bitsPerChannel == 8;
+		img.lossy = bitdepth == 8;
+
+		//TurboJPEG converts to any layout itself, taking grayscale straight from the luma plane
+		//Its alpha fill is the precision's maximum though, which isn't the 16-bit maximum, so higher precisions leave that to the row writer
+		Image::Layout rowLayout = target.layout;
+		if(bitdepth != 8 && rowLayout == Image::Layout::RGBA) rowLayout = Image::Layout::RGB;
+		const int pixelFormat = (rowLayout == Image::Layout::RGBA ? TJPF_RGBA : (rowLayout == Image::Layout::RGB ? TJPF_RGB : TJPF_GRAY));
+
+		//Lossy 8-bit JPEGs can be scaled down while decoding, which skips most of the work for the dropped pixels
+		unsigned int downscale = target.downscale;
+		if(downscale > 1 && bitdepth == 8 && !tj3Get(tj, TJPARAM_LOSSLESS)) {
+			const tjscalingfactor factor = {1, static_cast<int>(downscale)};
+			CheckException(tj3SetScalingFactor(tj, factor) == 0, "Failed to set JPEG scaling factor!", [&tj]() { tj3Destroy(tj); });
+			w = TJSCALED(w, factor);
+			h = TJSCALED(h, factor);
+			downscale = 1;
+		}
 
-		//Create output buffer
-		int pxSize = (img.layout == Image::Layout::RGB ? 3 : 1) * (img.bitsPerChannel / 8);
-		img.data = std::vector<unsigned char>(img.w * img.h * pxSize);
+		//Set up the image
+		RowWriter rows(img, {.w = w, .h = h, .layout = rowLayout, .bitsPerChannel = static_cast<uint8_t>(bitdepth == 8 ? 8 : 16)}, target.layout, target.bitsPerChannel, target.flip, downscale);
 
 		//Decode JPEG
-		if(img.bitsPerChannel == 8) {
-			CheckException(tj3Decompress8(tj, buffer.data(), buffer.size(), img.data.data(), img.w * pxSize, (img.layout == Image::Layout::RGB ? TJPF_RGB : TJPF_GRAY)) == 0,
-				"Failed to decode JPEG!", [&tj]() { tj3Destroy(tj); });
+		if(bitdepth == 8) {
+			if(rows.Direct()) {
+				//TurboJPEG can write the rows bottom-up, so the image can be decoded in place
+				CheckException(tj3Set(tj, TJPARAM_BOTTOMUP, target.flip) == 0, "Failed to set TurboJPEG row order!", [&tj]() { tj3Destroy(tj); });
+				CheckException(tj3Decompress8(tj, buffer.data(), buffer.size(), img.data.data(), 0, pixelFormat) == 0, "Failed to decode JPEG!", [&tj]() { tj3Destroy(tj); });
+			} else {
+				std::vector<unsigned char> decoded(rows.SourcePitch() * h);
+				CheckException(tj3Decompress8(tj, buffer.data(), buffer.size(), decoded.data(), 0, pixelFormat) == 0, "Failed to decode JPEG!", [&tj]() { tj3Destroy(tj); });
+				for(unsigned int y = 0; y < h; ++y) rows.Write(decoded.data() + y * rows.SourcePitch());
+			}
 		} else {
-			if(bitdepth > 12) {
-				//Create temporary buffer for 12-bit data
-				std::vector<int16_t> twelveBit(img.w * img.h * (pxSize / 2));
-				CheckException(tj3Decompress12(tj, buffer.data(), buffer.size(), twelveBit.data(), img.w * pxSize, (img.layout == Image::Layout::RGB ? TJPF_RGB : TJPF_GRAY)) == 0,
+			//Create temporary buffer for the samples, which TurboJPEG counts its pitch in
+			std::vector<uint16_t> samples(rows.SourcePitch() / 2 * h);
+			if(bitdepth <= 12) {
+				CheckException(tj3Decompress12(tj, buffer.data(), buffer.size(), reinterpret_cast<int16_t*>(samples.data()), 0, pixelFormat) == 0,
 					"Failed to decode JPEG!", [&tj]() { tj3Destroy(tj); });
-
-				//Map to 16-bit colorspace
-				uint16_t* imgDataSixteen = reinterpret_cast<uint16_t*>(img.data.data());
-				for(std::size_t i = 0; i < twelveBit.size(); ++i) {
-					imgDataSixteen[i] = uint16_t(twelveBit[i]) << 4;
-				}
 			} else {
-				CheckException(tj3Decompress16(tj, buffer.data(), buffer.size(), reinterpret_cast<uint16_t*>(img.data.data()), img.w * pxSize, (img.layout == Image::Layout::RGB ? TJPF_RGB : TJPF_GRAY)) == 0,
-					"Failed to decode JPEG!", [&tj]() { tj3Destroy(tj); });
+				CheckException(tj3Decompress16(tj, buffer.data(), buffer.size(), samples.data(), 0, pixelFormat) == 0, "Failed to decode JPEG!", [&tj]() { tj3Destroy(tj); });
+			}
+
+			//Map to 16-bit colorspace
+			const int shift = 16 - bitdepth;
+			if(shift > 0) {
+				for(uint16_t& sample : samples) sample = static_cast<uint16_t>(sample << shift);
 			}
+			for(unsigned int y = 0; y < h; ++y) rows.Write(reinterpret_cast<const unsigned char*>(samples.data()) + y * rows.SourcePitch());
 		}
 
 		//Cleanup
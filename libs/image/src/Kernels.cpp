@@ -0,0 +1,144 @@
+#include "Kernels.hpp"
+
+#include "colordepth_lut.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#ifdef LIBCACAOIMAGE_X86_KERNELS
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace libcacaoimage {
+	namespace {
+		template<typename T>
+		void ScalarRGBToRGBA(const T* src, T* dst, std::size_t pixels) {
+			for(std::size_t i = 0; i < pixels; ++i, src += 3, dst += 4) {
+				dst[0] = src[0];
+				dst[1] = src[1];
+				dst[2] = src[2];
+				dst[3] = std::numeric_limits<T>::max();
+			}
+		}
+
+		template<typename T>
+		void ScalarRGBAToRGB(const T* src, T* dst, std::size_t pixels) {
+			for(std::size_t i = 0; i < pixels; ++i, src += 4, dst += 3) {
+				dst[0] = src[0];
+				dst[1] = src[1];
+				dst[2] = src[2];
+			}
+		}
+
+		template<typename T>
+		void ScalarGrayToRGB(const T* src, T* dst, std::size_t pixels) {
+			for(std::size_t i = 0; i < pixels; ++i, dst += 3) {
+				dst[0] = dst[1] = dst[2] = src[i];
+			}
+		}
+
+		template<typename T>
+		void ScalarGrayToRGBA(const T* src, T* dst, std::size_t pixels) {
+			for(std::size_t i = 0; i < pixels; ++i, dst += 4) {
+				dst[0] = dst[1] = dst[2] = src[i];
+				dst[3] = std::numeric_limits<T>::max();
+			}
+		}
+
+		template<typename T, std::size_t Channels>
+		void ScalarToGray(const T* src, T* dst, std::size_t pixels) {
+			for(std::size_t i = 0; i < pixels; ++i, src += Channels) {
+				//Each weighted channel is truncated on its own, and the sum can't exceed the channel maximum
+				T r = static_cast<T>(lumaR * src[0]);
+				T g = static_cast<T>(lumaG * src[1]);
+				T b = static_cast<T>(lumaB * src[2]);
+				dst[i] = static_cast<T>(std::min<uint32_t>(uint32_t(r) + g + b, std::numeric_limits<T>::max()));
+			}
+		}
+
+		void ScalarDepth16To8(const unsigned char* src, unsigned char* dst, std::size_t values) {
+			for(std::size_t i = 0; i < values; ++i, src += 2) {
+				dst[i] = lut[static_cast<uint16_t>(src[0]) | (static_cast<uint16_t>(src[1]) << 8)];
+			}
+		}
+
+		void ScalarWeightedRows(const float* const* rows, const float* weights, std::size_t count, float* dst, std::size_t values) {
+			for(std::size_t i = 0; i < values; ++i) {
+				float sum = 0;
+				for(std::size_t r = 0; r < count; ++r) sum += weights[r] * rows[r][i];
+				dst[i] = sum;
+			}
+		}
+
+		template<typename T>
+		constexpr LayoutKernels<T> scalarLayout = {
+			.rgbToRgba = ScalarRGBToRGBA<T>,
+			.rgbaToRgb = ScalarRGBAToRGB<T>,
+			.grayToRgb = ScalarGrayToRGB<T>,
+			.grayToRgba = ScalarGrayToRGBA<T>,
+			.rgbToGray = ScalarToGray<T, 3>,
+			.rgbaToGray = ScalarToGray<T, 4>};
+
+		constexpr PixelKernels scalarKernels = {.name = "scalar", .u8 = scalarLayout<uint8_t>, .u16 = scalarLayout<uint16_t>, .depth16To8 = ScalarDepth16To8, .weightedRows = ScalarWeightedRows};
+
+#ifdef LIBCACAOIMAGE_X86_KERNELS
+		void CPUID(unsigned int leaf, unsigned int regs[4]) {
+#ifdef _MSC_VER
+			int out[4];
+			__cpuidex(out, static_cast<int>(leaf), 0);
+			for(int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned int>(out[i]);
+#else
+			__cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+		}
+
+		const PixelKernels* DetectX86Kernels() {
+			unsigned int regs[4] = {};
+			CPUID(0, regs);
+			const unsigned int maxLeaf = regs[0];
+			if(maxLeaf < 1) return nullptr;
+			CPUID(1, regs);
+			const bool ssse3 = regs[2] & (1u << 9);
+
+			//AVX2 also needs the OS to save the upper halves of the vector registers, which XGETBV reports
+			bool avx2 = false;
+			if(maxLeaf >= 7 && (regs[2] & (1u << 27)) && (regs[2] & (1u << 28))) {
+#ifdef _MSC_VER
+				const unsigned long long xcr0 = _xgetbv(0);
+#else
+				unsigned int xcr0Low, xcr0High;
+				__asm__ volatile("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+				const unsigned long long xcr0 = (static_cast<unsigned long long>(xcr0High) << 32) | xcr0Low;
+#endif
+				CPUID(7, regs);
+				avx2 = (xcr0 & 0x6) == 0x6 && (regs[1] & (1u << 5));
+			}
+
+			if(avx2) return &avx2Kernels;
+			if(ssse3) return &ssse3Kernels;
+			return nullptr;
+		}
+#endif
+	}
+
+	const PixelKernels& ScalarKernels() {
+		return scalarKernels;
+	}
+
+	const PixelKernels& ActiveKernels() {
+		static const PixelKernels& active = []() -> const PixelKernels& {
+#if defined(LIBCACAOIMAGE_X86_KERNELS)
+			if(const PixelKernels* kernels = DetectX86Kernels()) return *kernels;
+#elif defined(LIBCACAOIMAGE_NEON_KERNELS)
+			//NEON is part of the baseline on 64-bit ARM
+			return neonKernels;
+#endif
+			return scalarKernels;
+		}();
+		return active;
+	}
+}
\ No newline at end of file
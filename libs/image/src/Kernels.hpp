@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace libcacaoimage {
+	//Luminance weights from ITU recommendation BT.709, applied in double precision and truncated per channel
+	constexpr double lumaR = 0.2126;
+	constexpr double lumaG = 0.7152;
+	constexpr double lumaB = 0.0722;
+
+	/**
+	 * @brief Channel layout conversion kernels for one channel size
+	 *
+	 * Pixels are tightly packed and 16-bit channels are in native byte order. Source and destination must not overlap.
+	 */
+	template<typename T>
+	struct LayoutKernels {
+		void (*rgbToRgba)(const T* src, T* dst, std::size_t pixels);
+		void (*rgbaToRgb)(const T* src, T* dst, std::size_t pixels);
+		void (*grayToRgb)(const T* src, T* dst, std::size_t pixels);
+		void (*grayToRgba)(const T* src, T* dst, std::size_t pixels);
+		void (*rgbToGray)(const T* src, T* dst, std::size_t pixels);
+		void (*rgbaToGray)(const T* src, T* dst, std::size_t pixels);
+	};
+
+	/**
+	 * @brief Pixel conversion kernels for one instruction set
+	 *
+	 * Every set produces exactly the same output as the scalar one; vector kernels hand whatever doesn't fill a whole vector to the scalar kernels.
+	 */
+	struct PixelKernels {
+		const char* name;			///<Name of the instruction set
+		LayoutKernels<uint8_t> u8;	///<Kernels for 8-bit channels
+		LayoutKernels<uint16_t> u16;///<Kernels for 16-bit channels
+
+		///@brief Convert little-endian 16-bit linear channel values to 8-bit sRGB ones using the color depth LUT
+		void (*depth16To8)(const unsigned char* src, unsigned char* dst, std::size_t values);
+
+		/**
+		 * @brief Weigh and sum rows of values, as the vertical pass of a separable filter does
+		 *
+		 * Each value is dst[i] = weights[0] * rows[0][i] + weights[1] * rows[1][i] + ..., summed in that order. Where the compiler
+		 * fuses the scalar multiply and add but a vector set doesn't, the sums can differ in the last bit.
+		 */
+		void (*weightedRows)(const float* const* rows, const float* weights, std::size_t count, float* dst, std::size_t values);
+	};
+
+	///@brief Get the scalar kernels, which work everywhere
+	const PixelKernels& ScalarKernels();
+
+	///@brief Get the fastest kernels the running CPU supports, which are picked on the first call
+	const PixelKernels& ActiveKernels();
+
+	//Vector kernels, each living in its own translation unit built for its instruction set
+	//These are only tables so that no code from those units runs before ActiveKernels has checked the CPU
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LIBCACAOIMAGE_X86_KERNELS
+	extern const PixelKernels ssse3Kernels;
+	extern const PixelKernels avx2Kernels;
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define LIBCACAOIMAGE_NEON_KERNELS
+	extern const PixelKernels neonKernels;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "Kernels.hpp"
+
+#ifdef LIBCACAOIMAGE_X86_KERNELS
+#include "KernelsX86.hpp"
+
+#include "colordepth_lut.hpp"
+
+namespace libcacaoimage {
+	namespace {
+		void Depth16To8(const unsigned char* src, unsigned char* dst, std::size_t values) {
+			const __m256i alignMask = _mm256_set1_epi32(~3), byteMask = _mm256_set1_epi32(0xFF), three = _mm256_set1_epi32(3);
+			const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 0, 0, 0, 0);
+			std::size_t i = 0;
+			for(; i + 16 <= values; i += 16) {
+				const __m128i* in = reinterpret_cast<const __m128i*>(src + i * 2);
+				__m256i converted[2];
+				for(int half = 0; half < 2; ++half) {
+					//Gather the aligned dword holding each entry so the loads never leave the table, then shift the entry down
+					const __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128(in + half));
+					const __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(lut), _mm256_and_si256(v, alignMask), 1);
+					converted[half] = _mm256_and_si256(_mm256_srlv_epi32(words, _mm256_slli_epi32(_mm256_and_si256(v, three), 3)), byteMask);
+				}
+				const __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(converted[0], converted[1]), _mm256_setzero_si256());
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(packed, order)));
+			}
+			ScalarKernels().depth16To8(src + i * 2, dst + i, values - i);
+		}
+	}
+
+	const PixelKernels avx2Kernels = {.name = "AVX2", .u8 = vecLayout<V256, uint8_t>, .u16 = vecLayout<V256, uint16_t>, .depth16To8 = Depth16To8, .weightedRows = VecWeightedRows<V256>};
+}
+#endif
\ No newline at end of file
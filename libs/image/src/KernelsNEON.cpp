@@ -0,0 +1,213 @@
+#include "Kernels.hpp"
+
+#ifdef LIBCACAOIMAGE_NEON_KERNELS
+#include "colordepth_lut.hpp"
+
+#include <arm_neon.h>
+
+namespace libcacaoimage {
+	namespace {
+		//Structured loads and stores do the interleaving, so every layout kernel is a handful of instructions per vector
+		template<typename T>
+		struct Neon;
+
+		template<>
+		struct Neon<uint8_t> {
+			using V = uint8x16_t;
+			static constexpr std::size_t count = 16;
+			static V Load1(const uint8_t* p) {
+				return vld1q_u8(p);
+			}
+			static uint8x16x3_t Load3(const uint8_t* p) {
+				return vld3q_u8(p);
+			}
+			static uint8x16x4_t Load4(const uint8_t* p) {
+				return vld4q_u8(p);
+			}
+			static void Store1(uint8_t* p, V v) {
+				vst1q_u8(p, v);
+			}
+			static void Store3(uint8_t* p, V r, V g, V b) {
+				vst3q_u8(p, uint8x16x3_t {{r, g, b}});
+			}
+			static void Store4(uint8_t* p, V r, V g, V b, V a) {
+				vst4q_u8(p, uint8x16x4_t {{r, g, b, a}});
+			}
+			static V Opaque() {
+				return vdupq_n_u8(0xFF);
+			}
+		};
+
+		template<>
+		struct Neon<uint16_t> {
+			using V = uint16x8_t;
+			static constexpr std::size_t count = 8;
+			static V Load1(const uint16_t* p) {
+				return vld1q_u16(p);
+			}
+			static uint16x8x3_t Load3(const uint16_t* p) {
+				return vld3q_u16(p);
+			}
+			static uint16x8x4_t Load4(const uint16_t* p) {
+				return vld4q_u16(p);
+			}
+			static void Store1(uint16_t* p, V v) {
+				vst1q_u16(p, v);
+			}
+			static void Store3(uint16_t* p, V r, V g, V b) {
+				vst3q_u16(p, uint16x8x3_t {{r, g, b}});
+			}
+			static void Store4(uint16_t* p, V r, V g, V b, V a) {
+				vst4q_u16(p, uint16x8x4_t {{r, g, b, a}});
+			}
+			static V Opaque() {
+				return vdupq_n_u16(0xFFFF);
+			}
+		};
+
+		template<typename T>
+		const LayoutKernels<T>& Scalar() {
+			if constexpr(sizeof(T) == 1)
+				return ScalarKernels().u8;
+			else
+				return ScalarKernels().u16;
+		}
+
+		template<typename T>
+		void NeonRGBToRGBA(const T* src, T* dst, std::size_t pixels) {
+			using N = Neon<T>;
+			const typename N::V alpha = N::Opaque();
+			std::size_t i = 0;
+			for(; i + N::count <= pixels; i += N::count) {
+				const auto in = N::Load3(src + i * 3);
+				N::Store4(dst + i * 4, in.val[0], in.val[1], in.val[2], alpha);
+			}
+			Scalar<T>().rgbToRgba(src + i * 3, dst + i * 4, pixels - i);
+		}
+
+		template<typename T>
+		void NeonRGBAToRGB(const T* src, T* dst, std::size_t pixels) {
+			using N = Neon<T>;
+			std::size_t i = 0;
+			for(; i + N::count <= pixels; i += N::count) {
+				const auto in = N::Load4(src + i * 4);
+				N::Store3(dst + i * 3, in.val[0], in.val[1], in.val[2]);
+			}
+			Scalar<T>().rgbaToRgb(src + i * 4, dst + i * 3, pixels - i);
+		}
+
+		template<typename T>
+		void NeonGrayToRGB(const T* src, T* dst, std::size_t pixels) {
+			using N = Neon<T>;
+			std::size_t i = 0;
+			for(; i + N::count <= pixels; i += N::count) {
+				const typename N::V g = N::Load1(src + i);
+				N::Store3(dst + i * 3, g, g, g);
+			}
+			Scalar<T>().grayToRgb(src + i, dst + i * 3, pixels - i);
+		}
+
+		template<typename T>
+		void NeonGrayToRGBA(const T* src, T* dst, std::size_t pixels) {
+			using N = Neon<T>;
+			const typename N::V alpha = N::Opaque();
+			std::size_t i = 0;
+			for(; i + N::count <= pixels; i += N::count) {
+				const typename N::V g = N::Load1(src + i);
+				N::Store4(dst + i * 4, g, g, g, alpha);
+			}
+			Scalar<T>().grayToRgba(src + i, dst + i * 4, pixels - i);
+		}
+
+		//For 8-bit values, the high half of a 16-bit product with these multipliers truncates exactly like the double weights do
+		uint16x8_t Weigh8(uint8x8_t v, uint16x4_t weight) {
+			const uint16x8_t wide = vmovl_u8(v);
+			return vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(wide), weight), 16), vshrn_n_u32(vmull_u16(vget_high_u16(wide), weight), 16));
+		}
+
+		//No fixed point multiplier matches the double weights for every 16-bit value, so those are weighed in doubles
+		uint32x4_t Weigh16(uint16x4_t v, float64x2_t weight) {
+			const uint32x4_t wide = vmovl_u16(v);
+			const uint64x2_t lo = vcvtq_u64_f64(vmulq_f64(vcvtq_f64_u64(vmovl_u32(vget_low_u32(wide))), weight));
+			const uint64x2_t hi = vcvtq_u64_f64(vmulq_f64(vcvtq_f64_u64(vmovl_u32(vget_high_u32(wide))), weight));
+			return vcombine_u32(vmovn_u64(lo), vmovn_u64(hi));
+		}
+
+		uint8x16_t Luma(uint8x16_t r, uint8x16_t g, uint8x16_t b) {
+			const uint16x4_t wr = vdup_n_u16(13933), wg = vdup_n_u16(46871), wb = vdup_n_u16(4730);
+			const uint16x8_t lo = vaddq_u16(vaddq_u16(Weigh8(vget_low_u8(r), wr), Weigh8(vget_low_u8(g), wg)), Weigh8(vget_low_u8(b), wb));
+			const uint16x8_t hi = vaddq_u16(vaddq_u16(Weigh8(vget_high_u8(r), wr), Weigh8(vget_high_u8(g), wg)), Weigh8(vget_high_u8(b), wb));
+			return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+		}
+
+		uint16x8_t Luma(uint16x8_t r, uint16x8_t g, uint16x8_t b) {
+			const float64x2_t wr = vdupq_n_f64(lumaR), wg = vdupq_n_f64(lumaG), wb = vdupq_n_f64(lumaB);
+			const uint32x4_t lo = vaddq_u32(vaddq_u32(Weigh16(vget_low_u16(r), wr), Weigh16(vget_low_u16(g), wg)), Weigh16(vget_low_u16(b), wb));
+			const uint32x4_t hi = vaddq_u32(vaddq_u32(Weigh16(vget_high_u16(r), wr), Weigh16(vget_high_u16(g), wg)), Weigh16(vget_high_u16(b), wb));
+			return vcombine_u16(vmovn_u32(lo), vmovn_u32(hi));
+		}
+
+		template<typename T, std::size_t In>
+		void NeonToGray(const T* src, T* dst, std::size_t pixels) {
+			using N = Neon<T>;
+			std::size_t i = 0;
+			for(; i + N::count <= pixels; i += N::count) {
+				if constexpr(In == 3) {
+					const auto in = N::Load3(src + i * 3);
+					N::Store1(dst + i, Luma(in.val[0], in.val[1], in.val[2]));
+				} else {
+					const auto in = N::Load4(src + i * 4);
+					N::Store1(dst + i, Luma(in.val[0], in.val[1], in.val[2]));
+				}
+			}
+			if constexpr(In == 3)
+				Scalar<T>().rgbToGray(src + i * 3, dst + i, pixels - i);
+			else
+				Scalar<T>().rgbaToGray(src + i * 4, dst + i, pixels - i);
+		}
+
+		//There's no gather, so the lookups stay scalar but skip assembling each value from bytes
+		void NeonDepth16To8(const unsigned char* src, unsigned char* dst, std::size_t values) {
+			std::size_t i = 0;
+			for(; i + 8 <= values; i += 8) {
+				const uint16x8_t v = vreinterpretq_u16_u8(vld1q_u8(src + i * 2));
+				dst[i] = lut[vgetq_lane_u16(v, 0)];
+				dst[i + 1] = lut[vgetq_lane_u16(v, 1)];
+				dst[i + 2] = lut[vgetq_lane_u16(v, 2)];
+				dst[i + 3] = lut[vgetq_lane_u16(v, 3)];
+				dst[i + 4] = lut[vgetq_lane_u16(v, 4)];
+				dst[i + 5] = lut[vgetq_lane_u16(v, 5)];
+				dst[i + 6] = lut[vgetq_lane_u16(v, 6)];
+				dst[i + 7] = lut[vgetq_lane_u16(v, 7)];
+			}
+			ScalarKernels().depth16To8(src + i * 2, dst + i, values - i);
+		}
+
+		void NeonWeightedRows(const float* const* rows, const float* weights, std::size_t count, float* dst, std::size_t values) {
+			std::size_t i = 0;
+			for(; i + 4 <= values; i += 4) {
+				//A separate multiply and add, like the scalar kernel
+				float32x4_t sum = vdupq_n_f32(0);
+				for(std::size_t r = 0; r < count; ++r) sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(rows[r] + i), weights[r]));
+				vst1q_f32(dst + i, sum);
+			}
+			for(; i < values; ++i) {
+				float sum = 0;
+				for(std::size_t r = 0; r < count; ++r) sum += weights[r] * rows[r][i];
+				dst[i] = sum;
+			}
+		}
+
+		template<typename T>
+		constexpr LayoutKernels<T> neonLayout = {
+			.rgbToRgba = NeonRGBToRGBA<T>,
+			.rgbaToRgb = NeonRGBAToRGB<T>,
+			.grayToRgb = NeonGrayToRGB<T>,
+			.grayToRgba = NeonGrayToRGBA<T>,
+			.rgbToGray = NeonToGray<T, 3>,
+			.rgbaToGray = NeonToGray<T, 4>};
+	}
+
+	const PixelKernels neonKernels = {.name = "NEON", .u8 = neonLayout<uint8_t>, .u16 = neonLayout<uint16_t>, .depth16To8 = NeonDepth16To8, .weightedRows = NeonWeightedRows};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "Kernels.hpp"
+
+#ifdef LIBCACAOIMAGE_X86_KERNELS
+#include "KernelsX86.hpp"
+
+namespace libcacaoimage {
+	namespace {
+		//There's no gather before AVX2, so lookups stay scalar
+		void Depth16To8(const unsigned char* src, unsigned char* dst, std::size_t values) {
+			ScalarKernels().depth16To8(src, dst, values);
+		}
+	}
+
+	const PixelKernels ssse3Kernels = {.name = "SSSE3", .u8 = vecLayout<V128, uint8_t>, .u16 = vecLayout<V128, uint16_t>, .depth16To8 = Depth16To8, .weightedRows = VecWeightedRows<V128>};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,462 @@
+#pragma once
+
+//Shared body of the SSSE3 and AVX2 kernels
+//This is included by translation units built with different instruction set flags, so everything here has internal linkage
+//and nothing from the standard library is used; a shared inline function built for AVX2 could otherwise be picked by the linker for everyone
+
+#include "Kernels.hpp"
+
+#include <immintrin.h>
+
+namespace libcacaoimage {
+	namespace {
+		//A byte shuffle mask for one 128-bit lane, where a negative index zeroes the byte
+		struct alignas(16) ShuffleMask {
+			signed char idx[16];
+		};
+
+		/**
+		 * Both vector widths run the same kernels: every 128-bit lane works on its own block of pixels, which lines up with how
+		 * AVX2 byte shuffles work anyway. A lane's block is 16 bytes of gray input or output, 48 of RGB, and 64 of RGBA, which
+		 * is 16 pixels of 8-bit channels or 8 of 16-bit ones.
+		 */
+		struct V128 {
+			using Vec = __m128i;
+			static constexpr std::size_t lanes = 1;
+
+			static Vec Load(const unsigned char* p, std::size_t) {
+				return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			}
+			static void Store(unsigned char* p, std::size_t, Vec v) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+			}
+			static Vec Mask(const ShuffleMask& m) {
+				return _mm_load_si128(reinterpret_cast<const __m128i*>(m.idx));
+			}
+			static Vec Set64(long long v) {
+				return _mm_set1_epi64x(v);
+			}
+			static Vec Shuffle(Vec v, Vec m) {
+				return _mm_shuffle_epi8(v, m);
+			}
+			static Vec Or(Vec a, Vec b) {
+				return _mm_or_si128(a, b);
+			}
+			template<int N>
+			static Vec AlignR(Vec hi, Vec lo) {
+				return _mm_alignr_epi8(hi, lo, N);
+			}
+			template<int N>
+			static Vec ShiftLeftBytes(Vec v) {
+				return _mm_slli_si128(v, N);
+			}
+			template<int N>
+			static Vec ShiftRightBytes(Vec v) {
+				return _mm_srli_si128(v, N);
+			}
+			static Vec Zero() {
+				return _mm_setzero_si128();
+			}
+			static Vec Set16(short v) {
+				return _mm_set1_epi16(v);
+			}
+			static Vec Set32(int v) {
+				return _mm_set1_epi32(v);
+			}
+			static Vec UnpackLo8(Vec a, Vec b) {
+				return _mm_unpacklo_epi8(a, b);
+			}
+			static Vec UnpackHi8(Vec a, Vec b) {
+				return _mm_unpackhi_epi8(a, b);
+			}
+			static Vec UnpackLo16(Vec a, Vec b) {
+				return _mm_unpacklo_epi16(a, b);
+			}
+			static Vec UnpackHi16(Vec a, Vec b) {
+				return _mm_unpackhi_epi16(a, b);
+			}
+			static Vec MulHiU16(Vec a, Vec b) {
+				return _mm_mulhi_epu16(a, b);
+			}
+			static Vec Add16(Vec a, Vec b) {
+				return _mm_add_epi16(a, b);
+			}
+			static Vec Add32(Vec a, Vec b) {
+				return _mm_add_epi32(a, b);
+			}
+			static Vec PackUS16(Vec a, Vec b) {
+				return _mm_packus_epi16(a, b);
+			}
+			static Vec PackS32(Vec a, Vec b) {
+				return _mm_packs_epi32(a, b);
+			}
+			static Vec Xor(Vec a, Vec b) {
+				return _mm_xor_si128(a, b);
+			}
+
+			//Truncated product of four 32-bit integers and a weight, done in double precision like the scalar kernels
+			static Vec MulTrunc32(Vec v, __m128d weight) {
+				__m128i lo = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(v), weight));
+				__m128i hi = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(v, 8)), weight));
+				return _mm_unpacklo_epi64(lo, hi);
+			}
+			static __m128d Weight(double w) {
+				return _mm_set1_pd(w);
+			}
+
+			//Float rows for filtering
+			using FVec = __m128;
+			static constexpr std::size_t floats = 4;
+			static FVec LoadF(const float* p) {
+				return _mm_loadu_ps(p);
+			}
+			static void StoreF(float* p, FVec v) {
+				_mm_storeu_ps(p, v);
+			}
+			static FVec SetF(float v) {
+				return _mm_set1_ps(v);
+			}
+			static FVec AddF(FVec a, FVec b) {
+				return _mm_add_ps(a, b);
+			}
+			static FVec MulF(FVec a, FVec b) {
+				return _mm_mul_ps(a, b);
+			}
+		};
+
+#ifdef __AVX2__
+		struct V256 {
+			using Vec = __m256i;
+			static constexpr std::size_t lanes = 2;
+
+			static Vec Load(const unsigned char* p, std::size_t laneStride) {
+				__m256i v = _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+				return _mm256_inserti128_si256(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + laneStride)), 1);
+			}
+			static void Store(unsigned char* p, std::size_t laneStride, Vec v) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(v));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p + laneStride), _mm256_extracti128_si256(v, 1));
+			}
+			static Vec Mask(const ShuffleMask& m) {
+				return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(m.idx)));
+			}
+			static Vec Set64(long long v) {
+				return _mm256_set1_epi64x(v);
+			}
+			static Vec Shuffle(Vec v, Vec m) {
+				return _mm256_shuffle_epi8(v, m);
+			}
+			static Vec Or(Vec a, Vec b) {
+				return _mm256_or_si256(a, b);
+			}
+			template<int N>
+			static Vec AlignR(Vec hi, Vec lo) {
+				return _mm256_alignr_epi8(hi, lo, N);
+			}
+			template<int N>
+			static Vec ShiftLeftBytes(Vec v) {
+				return _mm256_bslli_epi128(v, N);
+			}
+			template<int N>
+			static Vec ShiftRightBytes(Vec v) {
+				return _mm256_bsrli_epi128(v, N);
+			}
+			static Vec Zero() {
+				return _mm256_setzero_si256();
+			}
+			static Vec Set16(short v) {
+				return _mm256_set1_epi16(v);
+			}
+			static Vec Set32(int v) {
+				return _mm256_set1_epi32(v);
+			}
+			static Vec UnpackLo8(Vec a, Vec b) {
+				return _mm256_unpacklo_epi8(a, b);
+			}
+			static Vec UnpackHi8(Vec a, Vec b) {
+				return _mm256_unpackhi_epi8(a, b);
+			}
+			static Vec UnpackLo16(Vec a, Vec b) {
+				return _mm256_unpacklo_epi16(a, b);
+			}
+			static Vec UnpackHi16(Vec a, Vec b) {
+				return _mm256_unpackhi_epi16(a, b);
+			}
+			static Vec MulHiU16(Vec a, Vec b) {
+				return _mm256_mulhi_epu16(a, b);
+			}
+			static Vec Add16(Vec a, Vec b) {
+				return _mm256_add_epi16(a, b);
+			}
+			static Vec Add32(Vec a, Vec b) {
+				return _mm256_add_epi32(a, b);
+			}
+			static Vec PackUS16(Vec a, Vec b) {
+				return _mm256_packus_epi16(a, b);
+			}
+			static Vec PackS32(Vec a, Vec b) {
+				return _mm256_packs_epi32(a, b);
+			}
+			static Vec Xor(Vec a, Vec b) {
+				return _mm256_xor_si256(a, b);
+			}
+			static Vec MulTrunc32(Vec v, __m256d weight) {
+				__m128i lo = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), weight));
+				__m128i hi = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), weight));
+				return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+			}
+			static __m256d Weight(double w) {
+				return _mm256_set1_pd(w);
+			}
+
+			//Float rows for filtering
+			using FVec = __m256;
+			static constexpr std::size_t floats = 8;
+			static FVec LoadF(const float* p) {
+				return _mm256_loadu_ps(p);
+			}
+			static void StoreF(float* p, FVec v) {
+				_mm256_storeu_ps(p, v);
+			}
+			static FVec SetF(float v) {
+				return _mm256_set1_ps(v);
+			}
+			static FVec AddF(FVec a, FVec b) {
+				return _mm256_add_ps(a, b);
+			}
+			static FVec MulF(FVec a, FVec b) {
+				return _mm256_mul_ps(a, b);
+			}
+		};
+#endif
+
+		//Shuffle mask builders, all working in elements of S bytes within one lane block
+
+		//Expand pixels with In channels to Out channels starting from an output element, leaving the missing channels zeroed
+		template<std::size_t S, std::size_t In, std::size_t Out>
+		constexpr ShuffleMask ExpandMask(std::size_t firstOutputElement) {
+			ShuffleMask m = {};
+			for(std::size_t b = 0; b < 16; ++b) {
+				const std::size_t element = firstOutputElement + b / S;
+				const std::size_t pixel = element / Out, channel = element % Out;
+				if(channel >= 3) {
+					m.idx[b] = -1;
+					continue;
+				}
+				const std::size_t srcElement = In == 1 ? pixel : pixel * In + channel;
+				m.idx[b] = static_cast<signed char>(srcElement * S + b % S);
+			}
+			return m;
+		}
+
+		//Drop the alpha of the four 8-bit or two 16-bit pixels in a block, packing them into the low 12 bytes
+		template<std::size_t S>
+		constexpr ShuffleMask DropAlphaMask() {
+			ShuffleMask m = {};
+			for(std::size_t b = 0; b < 16; ++b) {
+				const std::size_t element = b / S;
+				m.idx[b] = b < 12 ? static_cast<signed char>((element / 3 * 4 + element % 3) * S + b % S) : -1;
+			}
+			return m;
+		}
+
+		//Gather one channel of every pixel in a lane block from the 16 bytes of it starting at byte 16 * part
+		template<std::size_t S, std::size_t In>
+		constexpr ShuffleMask ChannelMask(std::size_t channel, std::size_t part) {
+			ShuffleMask m = {};
+			for(std::size_t b = 0; b < 16; ++b) {
+				const std::size_t srcByte = ((b / S) * In + channel) * S + b % S;
+				m.idx[b] = srcByte / 16 == part ? static_cast<signed char>(srcByte % 16) : -1;
+			}
+			return m;
+		}
+
+		//Opaque alpha in every fourth element
+		template<typename T>
+		constexpr long long alphaBits = static_cast<long long>(sizeof(T) == 1 ? 0xFF000000FF000000ULL : 0xFFFF000000000000ULL);
+
+		template<typename T>
+		const LayoutKernels<T>& Scalar() {
+			if constexpr(sizeof(T) == 1)
+				return ScalarKernels().u8;
+			else
+				return ScalarKernels().u16;
+		}
+
+		template<typename V, typename T>
+		void VecRGBToRGBA(const T* src, T* dst, std::size_t pixels) {
+			constexpr std::size_t S = sizeof(T), blockPixels = 16 / S, step = blockPixels * V::lanes;
+			constexpr ShuffleMask expand = ExpandMask<S, 3, 4>(0);
+			const auto mask = V::Mask(expand);
+			const auto alpha = V::Set64(alphaBits<T>);
+			const unsigned char* s = reinterpret_cast<const unsigned char*>(src);
+			unsigned char* d = reinterpret_cast<unsigned char*>(dst);
+			std::size_t i = 0;
+			for(; i + step <= pixels; i += step, s += step * 3 * S, d += step * 4 * S) {
+				//Line each quarter of the block up at the bottom of a vector before expanding it
+				const auto a = V::Load(s, 48), b = V::Load(s + 16, 48), c = V::Load(s + 32, 48);
+				V::Store(d, 64, V::Or(V::Shuffle(a, mask), alpha));
+				V::Store(d + 16, 64, V::Or(V::Shuffle(V::template AlignR<12>(b, a), mask), alpha));
+				V::Store(d + 32, 64, V::Or(V::Shuffle(V::template AlignR<8>(c, b), mask), alpha));
+				V::Store(d + 48, 64, V::Or(V::Shuffle(V::template ShiftRightBytes<4>(c), mask), alpha));
+			}
+			Scalar<T>().rgbToRgba(src + i * 3, dst + i * 4, pixels - i);
+		}
+
+		template<typename V, typename T>
+		void VecRGBAToRGB(const T* src, T* dst, std::size_t pixels) {
+			constexpr std::size_t S = sizeof(T), blockPixels = 16 / S, step = blockPixels * V::lanes;
+			const auto mask = V::Mask(DropAlphaMask<S>());
+			const unsigned char* s = reinterpret_cast<const unsigned char*>(src);
+			unsigned char* d = reinterpret_cast<unsigned char*>(dst);
+			std::size_t i = 0;
+			for(; i + step <= pixels; i += step, s += step * 4 * S, d += step * 3 * S) {
+				const auto a = V::Shuffle(V::Load(s, 64), mask), b = V::Shuffle(V::Load(s + 16, 64), mask);
+				const auto c = V::Shuffle(V::Load(s + 32, 64), mask), e = V::Shuffle(V::Load(s + 48, 64), mask);
+				V::Store(d, 48, V::Or(a, V::template ShiftLeftBytes<12>(b)));
+				V::Store(d + 16, 48, V::Or(V::template ShiftRightBytes<4>(b), V::template ShiftLeftBytes<8>(c)));
+				V::Store(d + 32, 48, V::Or(V::template ShiftRightBytes<8>(c), V::template ShiftLeftBytes<4>(e)));
+			}
+			Scalar<T>().rgbaToRgb(src + i * 4, dst + i * 3, pixels - i);
+		}
+
+		template<typename V, typename T>
+		void VecGrayToRGB(const T* src, T* dst, std::size_t pixels) {
+			constexpr std::size_t S = sizeof(T), blockPixels = 16 / S, step = blockPixels * V::lanes;
+			const auto m0 = V::Mask(ExpandMask<S, 1, 3>(0)), m1 = V::Mask(ExpandMask<S, 1, 3>(16 / S));
+			const auto m2 = V::Mask(ExpandMask<S, 1, 3>(32 / S));
+			const unsigned char* s = reinterpret_cast<const unsigned char*>(src);
+			unsigned char* d = reinterpret_cast<unsigned char*>(dst);
+			std::size_t i = 0;
+			for(; i + step <= pixels; i += step, s += step * S, d += step * 3 * S) {
+				const auto g = V::Load(s, 16);
+				V::Store(d, 48, V::Shuffle(g, m0));
+				V::Store(d + 16, 48, V::Shuffle(g, m1));
+				V::Store(d + 32, 48, V::Shuffle(g, m2));
+			}
+			Scalar<T>().grayToRgb(src + i, dst + i * 3, pixels - i);
+		}
+
+		template<typename V, typename T>
+		void VecGrayToRGBA(const T* src, T* dst, std::size_t pixels) {
+			constexpr std::size_t S = sizeof(T), blockPixels = 16 / S, step = blockPixels * V::lanes;
+			const auto m0 = V::Mask(ExpandMask<S, 1, 4>(0)), m1 = V::Mask(ExpandMask<S, 1, 4>(16 / S));
+			const auto m2 = V::Mask(ExpandMask<S, 1, 4>(32 / S)), m3 = V::Mask(ExpandMask<S, 1, 4>(48 / S));
+			const auto alpha = V::Set64(alphaBits<T>);
+			const unsigned char* s = reinterpret_cast<const unsigned char*>(src);
+			unsigned char* d = reinterpret_cast<unsigned char*>(dst);
+			std::size_t i = 0;
+			for(; i + step <= pixels; i += step, s += step * S, d += step * 4 * S) {
+				const auto g = V::Load(s, 16);
+				V::Store(d, 64, V::Or(V::Shuffle(g, m0), alpha));
+				V::Store(d + 16, 64, V::Or(V::Shuffle(g, m1), alpha));
+				V::Store(d + 32, 64, V::Or(V::Shuffle(g, m2), alpha));
+				V::Store(d + 48, 64, V::Or(V::Shuffle(g, m3), alpha));
+			}
+			Scalar<T>().grayToRgba(src + i, dst + i * 4, pixels - i);
+		}
+
+		template<std::size_t S, std::size_t In>
+		struct ChannelMasks {
+			ShuffleMask m[3][In];
+		};
+
+		template<std::size_t S, std::size_t In>
+		constexpr ChannelMasks<S, In> BuildChannelMasks() {
+			ChannelMasks<S, In> masks = {};
+			for(std::size_t channel = 0; channel < 3; ++channel)
+				for(std::size_t part = 0; part < In; ++part) masks.m[channel][part] = ChannelMask<S, In>(channel, part);
+			return masks;
+		}
+
+		//Splits the first three channels of lane blocks into one vector each
+		template<typename V, std::size_t S, std::size_t In>
+		struct Deinterleaver {
+			typename V::Vec masks[3][In];
+
+			Deinterleaver() {
+				constexpr ChannelMasks<S, In> built = BuildChannelMasks<S, In>();
+				for(std::size_t channel = 0; channel < 3; ++channel)
+					for(std::size_t part = 0; part < In; ++part) masks[channel][part] = V::Mask(built.m[channel][part]);
+			}
+
+			void Split(const unsigned char* s, typename V::Vec& r, typename V::Vec& g, typename V::Vec& b) const {
+				typename V::Vec parts[In];
+				for(std::size_t part = 0; part < In; ++part) parts[part] = V::Load(s + part * 16, In * 16);
+				r = Gather(parts, 0);
+				g = Gather(parts, 1);
+				b = Gather(parts, 2);
+			}
+
+			typename V::Vec Gather(const typename V::Vec (&parts)[In], std::size_t channel) const {
+				typename V::Vec out = V::Shuffle(parts[0], masks[channel][0]);
+				for(std::size_t part = 1; part < In; ++part) out = V::Or(out, V::Shuffle(parts[part], masks[channel][part]));
+				return out;
+			}
+		};
+
+		template<typename V, typename T, std::size_t In>
+		void VecToGray(const T* src, T* dst, std::size_t pixels) {
+			constexpr std::size_t S = sizeof(T), blockPixels = 16 / S, step = blockPixels * V::lanes;
+			const unsigned char* s = reinterpret_cast<const unsigned char*>(src);
+			unsigned char* d = reinterpret_cast<unsigned char*>(dst);
+			const Deinterleaver<V, S, In> split;
+			const auto zero = V::Zero();
+			typename V::Vec r, g, b;
+			std::size_t i = 0;
+			if constexpr(S == 1) {
+				//For 8-bit values, the high half of a 16-bit product with these multipliers truncates exactly like the double weights do (checked for all 256 values)
+				const auto wr = V::Set16(static_cast<short>(13933)), wg = V::Set16(static_cast<short>(46871)), wb = V::Set16(static_cast<short>(4730));
+				for(; i + step <= pixels; i += step, s += step * In, d += step) {
+					split.Split(s, r, g, b);
+					const auto lo = V::Add16(V::Add16(V::MulHiU16(V::UnpackLo8(r, zero), wr), V::MulHiU16(V::UnpackLo8(g, zero), wg)), V::MulHiU16(V::UnpackLo8(b, zero), wb));
+					const auto hi = V::Add16(V::Add16(V::MulHiU16(V::UnpackHi8(r, zero), wr), V::MulHiU16(V::UnpackHi8(g, zero), wg)), V::MulHiU16(V::UnpackHi8(b, zero), wb));
+					V::Store(d, 16, V::PackUS16(lo, hi));
+				}
+			} else {
+				//No fixed point multiplier matches the double weights for every 16-bit value, so this works in doubles like the scalar kernels
+				const auto wr = V::Weight(lumaR), wg = V::Weight(lumaG), wb = V::Weight(lumaB);
+				const auto bias = V::Set32(-32768), flip = V::Set16(static_cast<short>(0x8000));
+				for(; i + step <= pixels; i += step, s += step * In * S, d += step * S) {
+					split.Split(s, r, g, b);
+					auto lo = V::Add32(V::Add32(V::MulTrunc32(V::UnpackLo16(r, zero), wr), V::MulTrunc32(V::UnpackLo16(g, zero), wg)), V::MulTrunc32(V::UnpackLo16(b, zero), wb));
+					auto hi = V::Add32(V::Add32(V::MulTrunc32(V::UnpackHi16(r, zero), wr), V::MulTrunc32(V::UnpackHi16(g, zero), wg)), V::MulTrunc32(V::UnpackHi16(b, zero), wb));
+
+					//The sums never exceed 65535 so they pack exactly once shifted into signed range
+					V::Store(d, 16, V::Xor(V::PackS32(V::Add32(lo, bias), V::Add32(hi, bias)), flip));
+				}
+			}
+			if constexpr(In == 3)
+				Scalar<T>().rgbToGray(src + i * In, dst + i, pixels - i);
+			else
+				Scalar<T>().rgbaToGray(src + i * In, dst + i, pixels - i);
+		}
+
+		//Separate multiplies and adds, in the same order as the scalar kernel, keep the sums identical to it
+		template<typename V>
+		void VecWeightedRows(const float* const* rows, const float* weights, std::size_t count, float* dst, std::size_t values) {
+			std::size_t i = 0;
+			for(; i + V::floats <= values; i += V::floats) {
+				typename V::FVec sum = V::SetF(0);
+				for(std::size_t r = 0; r < count; ++r) sum = V::AddF(sum, V::MulF(V::SetF(weights[r]), V::LoadF(rows[r] + i)));
+				V::StoreF(dst + i, sum);
+			}
+
+			//The scalar kernel can't take a row offset, so the tail is summed here the same way
+			for(; i < values; ++i) {
+				float sum = 0;
+				for(std::size_t r = 0; r < count; ++r) sum += weights[r] * rows[r][i];
+				dst[i] = sum;
+			}
+		}
+
+		template<typename V, typename T>
+		constexpr LayoutKernels<T> vecLayout = {
+			.rgbToRgba = VecRGBToRGBA<V, T>,
+			.rgbaToRgb = VecRGBAToRGB<V, T>,
+			.grayToRgb = VecGrayToRGB<V, T>,
+			.grayToRgba = VecGrayToRGBA<V, T>,
+			.rgbToGray = VecToGray<V, T, 3>,
+			.rgbaToGray = VecToGray<V, T, 4>};
+	}
+}
\ No newline at end of file
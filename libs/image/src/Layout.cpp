@@ -1,104 +1,83 @@
 #include "libcacaoimage.hpp"
 #include "libcacaocommon.hpp"
 
-#include <algorithm>
+#include "Convert.hpp"
+#include "Kernels.hpp"
+
 #include <cstdint>
 
 namespace libcacaoimage {
-	Image ChangeChannelLayout(const Image& src, Image::Layout layout) {
-		CheckException(src.layout != layout, "Cannot change an image's channel layout to its current layout!");
-
-		//Create copy image for result
-		Image result = src;
-		result.layout = layout;
-
-		//Calculate some values we'll need later
-		uint8_t oldChannels = static_cast<uint8_t>(src.layout);
-		uint8_t newChannels = static_cast<uint8_t>(layout);
-		unsigned int newBytesPerPixel = static_cast<unsigned int>(newChannels) * (result.bitsPerChannel / 8);
-		std::size_t newPitch = static_cast<std::size_t>(newBytesPerPixel) * result.w;
-		std::size_t pixelCount = result.w * result.h;
-
-		//Reset result buffer
-		result.data.resize(newPitch * result.h);
-		result.data.shrink_to_fit();
+	namespace {
+		template<typename T>
+		void ConvertLayout(const LayoutKernels<T>& kernels, Image::Layout from, Image::Layout to, const T* src, T* dst, std::size_t pixels) {
+			if(to == Image::Layout::Grayscale) {
+				(from == Image::Layout::RGBA ? kernels.rgbaToGray : kernels.rgbToGray)(src, dst, pixels);
+			} else if(from == Image::Layout::Grayscale) {
+				(to == Image::Layout::RGBA ? kernels.grayToRgba : kernels.grayToRgb)(src, dst, pixels);
+			} else {
+				(to == Image::Layout::RGBA ? kernels.rgbToRgba : kernels.rgbaToRgb)(src, dst, pixels);
+			}
+		}
 
-		//Data conversion
-		//We use raw pointers since the buffer sizes are known
-		if(src.bitsPerChannel == 8) {
-			const unsigned char* srcp = src.data.data();
-			unsigned char* dstp = result.data.data();
-			for(std::size_t i = 0; i < pixelCount; ++i) {
-				//Special grayscale case
-				if(layout == Image::Layout::Grayscale) {
-					uint8_t r = (0.2126 * *srcp++);
-					uint8_t g = (0.7152 * *srcp++);
-					uint8_t b = (0.0722 * *srcp++);
-					if(src.layout == Image::Layout::RGBA) ++srcp;
-					uint16_t sum = r + g + b;
-					*dstp++ = static_cast<uint8_t>(std::clamp<uint16_t>(sum, 0, 255));
-					continue;
-				}
+		//Validate a layout change and get the pixel count
+		std::size_t LayoutChangePixels(const Image& src, Image::Layout layout) {
+			CheckException(src.layout != layout, "Cannot change an image's channel layout to its current layout!");
+			CheckException(src.bitsPerChannel == 8 || src.bitsPerChannel == 16, "Invalid color depth; only 8 and 16 are allowed.");
 
-				//This looks really funky but what it does is make sure that the correct number of bytes are copied
-				//The outer loop makes sure that for grayscale -> RGB(A) conversion, we copy the same byte enough
-				//The inner loop makes sure that the copy of each channel happens enough
-				//The break is to make sure that we don't copy twice when going RGB -> RGBA
-				uint8_t j = 0;
-				do {
-					for(uint8_t h = 0; h < std::min(oldChannels, newChannels); ++h) {
-						*dstp++ = *srcp;
-						srcp += std::clamp<uint8_t>(oldChannels - 1, 0, 1);
-					}
-					if(newChannels - oldChannels == 1) break;
-				} while((j += oldChannels) < std::clamp<uint8_t>(newChannels, 1, 3));
+			const std::size_t pixelCount = static_cast<std::size_t>(src.w) * src.h;
+			CheckException(src.data.size() >= pixelCount * static_cast<uint8_t>(src.layout) * (src.bitsPerChannel / 8), "Image data buffer is too small for its dimensions!");
+			return pixelCount;
+		}
+	}
 
-				//Add opaque alpha if needed
-				if(layout == Image::Layout::RGBA) {
-					*dstp++ = UINT8_MAX;
-				} else {
-					++srcp;
-				}
-			}
+	void ConvertChannels(uint8_t bitsPerChannel, Image::Layout from, Image::Layout to, const unsigned char* src, unsigned char* dst, std::size_t pixels) {
+		const PixelKernels& kernels = ActiveKernels();
+		if(bitsPerChannel == 8) {
+			ConvertLayout(kernels.u8, from, to, src, dst, pixels);
 		} else {
-			//This is the same thing as above pretty much, just 16-bit
-			const unsigned short* srcp = reinterpret_cast<const unsigned short*>(src.data.data());
-			unsigned short* dstp = reinterpret_cast<unsigned short*>(result.data.data());
-			for(std::size_t i = 0; i < pixelCount; ++i) {
-				//Special grayscale case
-				if(layout == Image::Layout::Grayscale) {
-					uint16_t r = (0.2126 * *srcp++);
-					uint16_t g = (0.7152 * *srcp++);
-					uint16_t b = (0.0722 * *srcp++);
-					if(src.layout == Image::Layout::RGBA) ++srcp;
-					uint32_t sum = r + g + b;
-					*dstp++ = static_cast<uint16_t>(std::clamp<uint32_t>(sum, 0, 255));
-					continue;
-				}
+			ConvertLayout(kernels.u16, from, to, reinterpret_cast<const uint16_t*>(src), reinterpret_cast<uint16_t*>(dst), pixels);
+		}
+	}
 
-				//This looks really funky but what it does is make sure that the correct number of bytes are copied
-				//The outer loop makes sure that for grayscale -> RGB(A) conversion, we copy the same byte enough
-				//The inner loop makes sure that the copy of each channel happens enough
-				//The break is to make sure that we don't copy twice when going RGB -> RGBA
-				uint8_t j = 0;
-				do {
-					for(uint8_t h = 0; h < std::min(oldChannels, newChannels); ++h) {
-						*dstp++ = *srcp;
-						srcp += std::clamp<uint8_t>(oldChannels - 1, 0, 1);
-					}
-					if(newChannels - oldChannels == 1) break;
-				} while((j += oldChannels) < std::clamp<uint8_t>(newChannels, 1, 3));
+	Image ChangeChannelLayout(const Image& src, Image::Layout layout) {
+		//Copy properties but not data
+		Image result = {};
+		result.w = src.w;
+		result.h = src.h;
+		result.format = src.format;
+		result.layout = layout;
+		result.bitsPerChannel = src.bitsPerChannel;
+		result.lossy = src.lossy;
+		result.quality = src.quality;
 
-				//Add opaque alpha if needed
-				if(layout == Image::Layout::RGBA) {
-					*dstp++ = UINT16_MAX;
-				} else {
-					++srcp;
-				}
-			}
-		}
+		//Convert straight into the result buffer
+		result.data.resize(static_cast<std::size_t>(src.w) * src.h * static_cast<uint8_t>(layout) * (src.bitsPerChannel / 8));
+		ChangeChannelLayout(src, layout, result.data);
 
 		//Return result
 		return result;
 	}
+
+	void ChangeChannelLayout(const Image& src, Image::Layout layout, std::span<unsigned char> dst) {
+		const std::size_t pixelCount = LayoutChangePixels(src, layout);
+		CheckException(dst.size() >= pixelCount * static_cast<uint8_t>(layout) * (src.bitsPerChannel / 8), "Destination buffer is too small for the new channel layout!");
+
+		ConvertChannels(src.bitsPerChannel, src.layout, layout, src.data.data(), dst.data(), pixelCount);
+	}
+
+	void ChangeChannelLayoutInPlace(Image& img, Image::Layout layout) {
+		const std::size_t pixelCount = LayoutChangePixels(img, layout);
+		const std::size_t channelBytes = img.bitsPerChannel / 8;
+		const std::size_t oldPixelBytes = static_cast<uint8_t>(img.layout) * channelBytes;
+		const std::size_t newPixelBytes = static_cast<uint8_t>(layout) * channelBytes;
+
+		//Growing conversions need the room up front, while shrinking ones can only trim afterwards
+		if(newPixelBytes > oldPixelBytes) img.data.resize(pixelCount * newPixelBytes);
+		ConvertInPlace(img.data.data(), pixelCount, oldPixelBytes, newPixelBytes, [&img, layout](const unsigned char* src, unsigned char* dst, std::size_t pixels) {
+			ConvertChannels(img.bitsPerChannel, img.layout, layout, src, dst, pixels);
+		});
+		if(newPixelBytes < oldPixelBytes) img.data.resize(pixelCount * newPixelBytes);
+
+		img.layout = layout;
+	}
 }
\ No newline at end of file
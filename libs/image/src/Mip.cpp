@@ -0,0 +1,269 @@
+#include "libcacaoimage.hpp"
+#include "libcacaocommon.hpp"
+
+#include "Kernels.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <numbers>
+#include <thread>
+
+namespace libcacaoimage {
+	namespace {
+		//Kaiser filter shape: lobes of the sinc on each side (in output pixels) and how sharply the window falls off
+		constexpr double kaiserWidth = 3.0;
+		constexpr double kaiserAlpha = 4.0;
+
+		//Levels with fewer pixels than this aren't worth spreading across threads
+		constexpr std::size_t parallelPixels = 64 * 64;
+
+		/**
+		 * @brief One axis of a separable filter
+		 *
+		 * Every output position reads a run of neighboring source positions, with edges clamped by folding the weight of anything
+		 * past them onto the edge pixel. Weights are normalized so each run sums to one.
+		 */
+		struct AxisFilter {
+			struct Run {
+				unsigned int first;	 ///<First source position
+				unsigned int count;	 ///<Number of source positions
+				std::size_t weights; ///<Offset of the run's weights in the weight list
+			};
+			std::vector<Run> runs;
+			std::vector<float> weights;
+			unsigned int longest = 0;
+		};
+
+		//Modified Bessel function of the first kind and order zero, from its power series
+		double BesselI0(double x) {
+			double sum = 1.0, term = 1.0;
+			for(int k = 1; k < 64 && term > sum * 1e-12; ++k) {
+				const double half = x / (2.0 * k);
+				term *= half * half;
+				sum += term;
+			}
+			return sum;
+		}
+
+		//Kaiser-windowed sinc at a distance in output pixels
+		double Kaiser(double x) {
+			if(std::abs(x) >= kaiserWidth) return 0.0;
+			const double sinc = x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+			const double t = x / kaiserWidth;
+			return sinc * BesselI0(kaiserAlpha * std::sqrt(1.0 - t * t)) / BesselI0(kaiserAlpha);
+		}
+
+		AxisFilter BuildAxisFilter(unsigned int from, unsigned int to, MipFilter filter) {
+			AxisFilter out;
+			out.runs.reserve(to);
+			const double scale = static_cast<double>(from) / to;
+			const double radius = filter == MipFilter::Box ? scale / 2.0 : kaiserWidth * scale;
+			std::vector<double> run;
+			for(unsigned int o = 0; o < to; ++o) {
+				//Source pixel i spans [i, i + 1), and output pixel o spans [o * scale, (o + 1) * scale)
+				const double center = (o + 0.5) * scale;
+				const long lo = static_cast<long>(std::floor(center - radius)), hi = static_cast<long>(std::ceil(center + radius)) - 1;
+				const long first = std::max(lo, 0L), last = std::min(hi, static_cast<long>(from) - 1);
+				run.assign(last - first + 1, 0.0);
+				for(long i = lo; i <= hi; ++i) {
+					double weight;
+					if(filter == MipFilter::Box)
+						weight = std::min<double>(i + 1, center + radius) - std::max<double>(i, center - radius);
+					else
+						weight = Kaiser((i + 0.5 - center) / scale);
+					run[std::clamp(i, first, last) - first] += weight;
+				}
+
+				double sum = 0.0;
+				for(double w : run) sum += w;
+				out.runs.push_back({static_cast<unsigned int>(first), static_cast<unsigned int>(run.size()), out.weights.size()});
+				for(double w : run) out.weights.push_back(static_cast<float>(w / sum));
+				out.longest = std::max(out.longest, static_cast<unsigned int>(run.size()));
+			}
+			return out;
+		}
+
+		//sRGB transfer function tables for 8-bit values
+		struct SrgbTables {
+			std::array<float, 256> toLinear;
+
+			//Linear value halfway between each level and the next in sRGB terms, so counting the ones below a value rounds it to the nearest level
+			std::array<float, 256> roundUp;
+		};
+
+		double SrgbToLinear(double s) {
+			return s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4);
+		}
+
+		const SrgbTables& Srgb() {
+			static const SrgbTables tables = []() {
+				SrgbTables t;
+				for(int i = 0; i < 256; ++i) {
+					t.toLinear[i] = static_cast<float>(SrgbToLinear(i / 255.0));
+					t.roundUp[i] = i < 255 ? static_cast<float>(SrgbToLinear((i + 0.5) / 255.0)) : std::numeric_limits<float>::infinity();
+				}
+				return t;
+			}();
+			return tables;
+		}
+
+		uint8_t LinearToSrgb8(float v, const SrgbTables& srgb) {
+			//Binary search for how many thresholds the value reaches
+			unsigned int level = 0;
+			for(unsigned int step = 128; step > 0; step >>= 1) {
+				if(srgb.roundUp[level + step - 1] <= v) level += step;
+			}
+			return static_cast<uint8_t>(level);
+		}
+
+		//How a level's channels are stored
+		struct Channels {
+			std::size_t count;	  ///<Channels per pixel
+			bool alpha;			  ///<Whether the last one is alpha
+			bool srgb;			  ///<Whether color channels are 8-bit sRGB
+			uint8_t bitsPerChannel;
+		};
+
+		void LoadRow(const Image& img, const Channels& ch, unsigned int y, float* out) {
+			const std::size_t values = img.w * ch.count;
+			if(ch.bitsPerChannel == 16) {
+				const uint16_t* in = reinterpret_cast<const uint16_t*>(img.data.data()) + y * values;
+				for(std::size_t i = 0; i < values; ++i) out[i] = in[i] / 65535.0f;
+				return;
+			}
+			const unsigned char* in = img.data.data() + y * values;
+			if(!ch.srgb) {
+				for(std::size_t i = 0; i < values; ++i) out[i] = in[i] / 255.0f;
+				return;
+			}
+			const std::array<float, 256>& toLinear = Srgb().toLinear;
+			for(std::size_t i = 0; i < values; i += ch.count) {
+				for(std::size_t c = 0; c < ch.count; ++c) out[i + c] = ch.alpha && c == ch.count - 1 ? in[i + c] / 255.0f : toLinear[in[i + c]];
+			}
+		}
+
+		void StoreRow(const float* in, const Channels& ch, Image& img, unsigned int y) {
+			const std::size_t values = img.w * ch.count;
+			if(ch.bitsPerChannel == 16) {
+				uint16_t* out = reinterpret_cast<uint16_t*>(img.data.data()) + y * values;
+				for(std::size_t i = 0; i < values; ++i) out[i] = static_cast<uint16_t>(std::clamp(in[i], 0.0f, 1.0f) * 65535.0f + 0.5f);
+				return;
+			}
+			unsigned char* out = img.data.data() + y * values;
+			if(!ch.srgb) {
+				for(std::size_t i = 0; i < values; ++i) out[i] = static_cast<unsigned char>(std::clamp(in[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+				return;
+			}
+			const SrgbTables& srgb = Srgb();
+			for(std::size_t i = 0; i < values; i += ch.count) {
+				for(std::size_t c = 0; c < ch.count; ++c) {
+					out[i + c] = ch.alpha && c == ch.count - 1 ? static_cast<unsigned char>(std::clamp(in[i + c], 0.0f, 1.0f) * 255.0f + 0.5f) : LinearToSrgb8(in[i + c], srgb);
+				}
+			}
+		}
+
+		//Filter rows [begin, end) of one level from the level above it
+		void FilterRows(const Image& from, Image& to, const Channels& ch, const AxisFilter& fx, const AxisFilter& fy, unsigned int begin, unsigned int end) {
+			const std::size_t srcValues = from.w * ch.count;
+
+			//Source rows are decoded once into a ring that holds every row one output row needs, since neighboring output rows share most of theirs
+			const unsigned int ringRows = fy.longest;
+			std::vector<float> ring(ringRows * srcValues);
+			std::vector<long> ringHolds(ringRows, -1);
+			std::vector<const float*> rows(ringRows);
+			std::vector<float> column(srcValues), out(to.w * ch.count);
+
+			const PixelKernels& kernels = ActiveKernels();
+			for(unsigned int y = begin; y < end; ++y) {
+				//Vertical pass, which does most of the arithmetic over whole rows
+				const AxisFilter::Run& vrun = fy.runs[y];
+				for(unsigned int r = 0; r < vrun.count; ++r) {
+					const unsigned int row = vrun.first + r, slot = row % ringRows;
+					float* held = ring.data() + slot * srcValues;
+					if(ringHolds[slot] != static_cast<long>(row)) {
+						LoadRow(from, ch, row, held);
+						ringHolds[slot] = row;
+					}
+					rows[r] = held;
+				}
+				kernels.weightedRows(rows.data(), fy.weights.data() + vrun.weights, vrun.count, column.data(), srcValues);
+
+				//Horizontal pass over the already shrunk row
+				for(unsigned int x = 0; x < to.w; ++x) {
+					const AxisFilter::Run& hrun = fx.runs[x];
+					const float* weights = fx.weights.data() + hrun.weights;
+					const float* px = column.data() + hrun.first * ch.count;
+					for(std::size_t c = 0; c < ch.count; ++c) {
+						float sum = 0;
+						for(unsigned int t = 0; t < hrun.count; ++t) sum += weights[t] * px[t * ch.count + c];
+						out[x * ch.count + c] = sum;
+					}
+				}
+				StoreRow(out.data(), ch, to, y);
+			}
+		}
+
+		//Split a level's rows into bands across threads, with the calling thread taking the last one
+		void FilterLevel(const Image& from, Image& to, const Channels& ch, MipFilter filter, unsigned int threads) {
+			const AxisFilter fx = BuildAxisFilter(from.w, to.w, filter), fy = BuildAxisFilter(from.h, to.h, filter);
+
+			if(static_cast<std::size_t>(to.w) * to.h < parallelPixels) threads = 1;
+			threads = std::min(threads, to.h);
+			if(threads <= 1) {
+				FilterRows(from, to, ch, fx, fy, 0, to.h);
+				return;
+			}
+
+			std::exception_ptr error;
+			std::mutex errorMtx;
+			const auto band = [&](unsigned int t) {
+				try {
+					FilterRows(from, to, ch, fx, fy, static_cast<std::size_t>(to.h) * t / threads, static_cast<std::size_t>(to.h) * (t + 1) / threads);
+				} catch(...) {
+					std::lock_guard lk(errorMtx);
+					if(!error) error = std::current_exception();
+				}
+			};
+			std::vector<std::thread> pool;
+			pool.reserve(threads - 1);
+			for(unsigned int t = 0; t + 1 < threads; ++t) pool.emplace_back(band, t);
+			band(threads - 1);
+			for(std::thread& t : pool) t.join();
+
+			if(error) std::rethrow_exception(error);
+		}
+	}
+
+	std::vector<Image> GenerateMipChain(const Image& src, MipFilter filter, bool srgb, unsigned int threads) {
+		CheckException(src.w > 0 && src.h > 0, "Cannot generate mip levels for an image with zeroed dimensions!");
+		CheckException(src.bitsPerChannel == 8 || src.bitsPerChannel == 16, "Invalid color depth; only 8 and 16 are allowed.");
+		CheckException(src.data.size() >= static_cast<std::size_t>(src.w) * src.h * static_cast<uint8_t>(src.layout) * (src.bitsPerChannel / 8), "Image data buffer is too small for its dimensions!");
+		if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+		const Channels ch = {
+			.count = static_cast<uint8_t>(src.layout),
+			.alpha = src.layout == Image::Layout::RGBA,
+			.srgb = srgb && src.bitsPerChannel == 8,
+			.bitsPerChannel = src.bitsPerChannel};
+
+		std::vector<Image> levels;
+		levels.reserve(std::bit_width(std::max(src.w, src.h)) - 1);
+		while(true) {
+			const Image& above = levels.empty() ? src : levels.back();
+			if(above.w == 1 && above.h == 1) break;
+
+			Image level = {.w = std::max(1u, above.w / 2), .h = std::max(1u, above.h / 2), .layout = src.layout, .bitsPerChannel = src.bitsPerChannel, .data = {}, .format = src.format, .quality = src.quality, .lossy = src.lossy};
+			level.data.resize(static_cast<std::size_t>(level.w) * level.h * ch.count * (ch.bitsPerChannel / 8));
+
+			//Each level is filtered from the one above, which is a quarter of the work of going back to the full-size image every time
+			FilterLevel(above, level, ch, filter, threads);
+			levels.push_back(std::move(level));
+		}
+		return levels;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "libcacaoimage.hpp"
+#include "libcacaocommon.hpp"
+
+#include "Convert.hpp"
+#include "Kernels.hpp"
+
+#include <cstring>
+#include <memory>
+
+namespace libcacaoimage {
+	namespace {
+		//Validate a normalization and get the source and destination row pitches
+		std::pair<std::size_t, std::size_t> NormalizePitches(const Image& src, Image::Layout layout) {
+			CheckException(src.bitsPerChannel == 8 || src.bitsPerChannel == 16, "Invalid color depth; only 8 and 16 are allowed.");
+
+			const std::size_t srcPitch = static_cast<std::size_t>(src.w) * static_cast<uint8_t>(src.layout) * (src.bitsPerChannel / 8);
+			CheckException(src.data.size() >= srcPitch * src.h, "Image data buffer is too small for its dimensions!");
+			return {srcPitch, static_cast<std::size_t>(src.w) * static_cast<uint8_t>(layout)};
+		}
+
+		//Bytes of scratch a row needs between the depth and layout conversions
+		std::size_t DepthRowBytes(const Image& src, Image::Layout layout) {
+			return src.bitsPerChannel == 16 && src.layout != layout ? static_cast<std::size_t>(src.w) * static_cast<uint8_t>(src.layout) : 0;
+		}
+
+		//Normalize one row, where out must not overlap in
+		void NormalizeRow(const Image& src, Image::Layout layout, const unsigned char* in, unsigned char* out, unsigned char* depthRow) {
+			const std::size_t values = static_cast<std::size_t>(src.w) * static_cast<uint8_t>(src.layout);
+			if(src.bitsPerChannel == 16) {
+				if(src.layout == layout) {
+					ActiveKernels().depth16To8(in, out, values);
+					return;
+				}
+				ActiveKernels().depth16To8(in, depthRow, values);
+				in = depthRow;
+			}
+
+			if(src.layout == layout) {
+				std::memcpy(out, in, values);
+			} else {
+				ConvertChannels(8, src.layout, layout, in, out, src.w);
+			}
+		}
+	}
+
+	void Normalize(const Image& src, Image::Layout layout, bool flip, std::span<unsigned char> dst) {
+		const auto [srcPitch, dstPitch] = NormalizePitches(src, layout);
+		CheckException(dst.size() >= dstPitch * src.h, "Destination buffer is too small for the normalized image!");
+
+		std::unique_ptr<unsigned char[]> depthRow = std::make_unique_for_overwrite<unsigned char[]>(DepthRowBytes(src, layout));
+		for(unsigned int y = 0; y < src.h; ++y) {
+			const unsigned int dstY = flip ? src.h - y - 1 : y;
+			NormalizeRow(src, layout, src.data.data() + y * srcPitch, dst.data() + dstY * dstPitch, depthRow.get());
+		}
+	}
+
+	void Normalize(Image& img, Image::Layout layout, bool flip) {
+		const auto [srcPitch, dstPitch] = NormalizePitches(img, layout);
+
+		//Nothing to convert, so this is at most a flip
+		if(img.bitsPerChannel == 8 && img.layout == layout) {
+			if(flip && img.h > 0 && img.w > 0) FlipInPlace(img);
+			return;
+		}
+
+		if(!flip && dstPitch <= srcPitch) {
+			//Each row's output ends before the next row starts, so rows can be converted through scratch and written back in order
+			const std::size_t depthRowBytes = DepthRowBytes(img, layout);
+			std::unique_ptr<unsigned char[]> scratch = std::make_unique_for_overwrite<unsigned char[]>(dstPitch + depthRowBytes);
+			for(unsigned int y = 0; y < img.h; ++y) {
+				NormalizeRow(img, layout, img.data.data() + y * srcPitch, scratch.get(), scratch.get() + dstPitch);
+				std::memcpy(img.data.data() + y * dstPitch, scratch.get(), dstPitch);
+			}
+			img.data.resize(dstPitch * img.h);
+		} else {
+			//Otherwise rows would overwrite ones that haven't been read yet, so the result gets its own buffer
+			std::vector<unsigned char> out(dstPitch * img.h);
+			Normalize(img, layout, flip, out);
+			img.data = std::move(out);
+		}
+
+		img.layout = layout;
+		img.bitsPerChannel = 8;
+	}
+}
\ No newline at end of file
@@ -1,102 +1,192 @@
 #include "libcacaoimage.hpp"
 #include "libcacaocommon.hpp"
 
+#include "RowWriter.hpp"
+
 #include "png.h"
 #include "zlib.h"
 
 #include <array>
 #include <bit>
+#include <cstring>
 
 namespace libcacaoimage {
-	Image decode::DecodePNG(std::istream& input) {
+	namespace {
+		//Where libpng reads encoded data from in memory
+		struct MemoryInput {
+			std::span<const unsigned char> data;
+			std::size_t offset;
+		};
+
+		//Run libpng reads with their errors turned into a return value, giving them a longjmp target that no buffers were created after
+		//Nothing in the calls may have a destructor, since errors jump straight out of them
+		template<typename Read>
+		bool ReadGuarded(png_structp png, Read&& read) {
+			if(setjmp(png_jmpbuf(png))) return false;
+			read();
+			return true;
+		}
+
+		//Decode a PNG whose signature has been checked, reading it through the given callback
+		Image DecodePNGFrom(void* io, png_rw_ptr read, const decode::DecodeOptions& options) {
+			ValidateDecodeOptions(options);
+
+			//Anything with a destructor has to exist before the longjmp target is set, since jumping back skips over whatever came after it
+			Image img;
+
+			//Initialize libpng
+			png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+			CheckException(png, "Failed to initialize libpng!");
+			png_infop info = png_create_info_struct(png);
+			CheckException(info, "Failed to set up libpng information!", [&png]() { png_destroy_read_struct(&png, nullptr, nullptr); });
+
+			//Configure libpng longjmp
+			int sj = setjmp(png_jmpbuf(png));
+			CheckException(sj == 0, "libpng read error!", [&png, &info]() { png_destroy_read_struct(&png, &info, nullptr); });
+
+			//Set up IO read callback
+			png_set_read_fn(png, io, read);
+
+			//Force sRGB
+			png_set_gamma(png, 2.2, 0.45455);
+
+			//Load PNG info
+			png_read_info(png, info);
+
+			//Get image characteristics
+			img.format = Image::Format::PNG;
+			img.lossy = false;
+			img.quality = 100;
+			unsigned int w = 0, h = 0;
+			int bitdepth = -1, colortype = -1;
+			png_get_IHDR(png, info, &w, &h, &bitdepth, &colortype, nullptr, nullptr, nullptr);
+
+			//No gray+alpha
+			CheckException(colortype != PNG_COLOR_TYPE_GA, "Grayscale images with alpha channels are unsupported!", [&png, &info]() { png_destroy_read_struct(&png, &info, nullptr); });
+
+			//De-paletteization
+			if(colortype == PNG_COLOR_TYPE_PALETTE) png_set_palette_to_rgb(png);
+
+			//Bit expansion
+			if(colortype == PNG_COLOR_TYPE_GRAY && bitdepth < 8) png_set_expand_gray_1_2_4_to_8(png);
+			png_set_packing(png);
+
+			//Work out the image's own layout and what the options want
+			const bool color = (colortype & PNG_COLOR_MASK_COLOR) != 0;
+			const bool tRNS = png_get_valid(png, info, PNG_INFO_tRNS) != 0;
+			const bool alpha = (colortype & PNG_COLOR_MASK_ALPHA) != 0 || (color && tRNS);
+			const DecodeTarget target(options, color ? (alpha ? Image::Layout::RGBA : Image::Layout::RGB) : Image::Layout::Grayscale, bitdepth == 16 ? 16 : 8);
+
+			//Reach the target layout with libpng's own transformations
+			//Its grayscale conversion works in linear light though, so reducing color to grayscale is left to the row writer to match ChangeChannelLayout
+			const bool narrowing = bitdepth == 16 && target.bitsPerChannel == 8;
+			Image::Layout rowLayout = target.layout;
+			if(target.layout == Image::Layout::Grayscale) {
+				if(color) rowLayout = alpha ? Image::Layout::RGBA : Image::Layout::RGB;
+				if(color && tRNS) png_set_tRNS_to_alpha(png);
+			} else {
+				if(!color) png_set_gray_to_rgb(png);
+				if(target.layout == Image::Layout::RGBA) {
+					//Turn tRNS info into alpha if needed, and fill alpha if there isn't any
+					if(tRNS) png_set_tRNS_to_alpha(png);
+					//When narrowing, the row writer adds it after the LUT so that it stays fully opaque
+					if(!alpha && !tRNS) {
+						if(narrowing)
+							rowLayout = Image::Layout::RGB;
+						else
+							png_set_add_alpha(png, target.bitsPerChannel == 16 ? 0xFFFF : 0xFF, PNG_FILLER_AFTER);
+					}
+				} else if(alpha) {
+					png_set_strip_alpha(png);
+				}
+			}
+
+			//Widening to 16-bit is native too, but narrowing to 8-bit is left to the row writer since it uses the color depth LUT
+			if(target.bitsPerChannel == 16 && bitdepth < 16) png_set_expand_16(png);
+
+			//PNG stores 16-bit values big-endian, so swap them into native order if necessary
+			if(bitdepth == 16 || target.bitsPerChannel == 16) {
+				if constexpr(std::endian::native == std::endian::little) png_set_swap(png);
+			}
+
+			//Process transformation data
+			const int passes = png_set_interlace_handling(png);
+			png_read_update_info(png, info);
+			png_get_IHDR(png, info, &w, &h, &bitdepth, &colortype, nullptr, nullptr, nullptr);
+
+			//Get channel layout
+			uint8_t channels = png_get_channels(png, info);
+			CheckException(channels == static_cast<uint8_t>(rowLayout), "Invalid channel layout detected!", [&png, &info]() { png_destroy_read_struct(&png, &info, nullptr); });
+
+			//Set up the image, flipping through the row order
+			RowWriter rows(img, {.w = w, .h = h, .layout = rowLayout, .bitsPerChannel = static_cast<uint8_t>(bitdepth == 16 ? 16 : 8)}, target.layout, target.bitsPerChannel, target.flip, target.downscale);
+			CheckException(png_get_rowbytes(png, info) == rows.SourcePitch(), "Unexpected PNG row size!", [&png, &info]() { png_destroy_read_struct(&png, &info, nullptr); });
+
+			//Set up where the decoded pixels go
+			//Interlaced rows aren't finished until the last pass, so those can't go straight through the row writer
+			std::vector<unsigned char> decoded(rows.Direct() ? 0 : rows.SourcePitch() * (passes == 1 ? 1 : h));
+			std::vector<png_bytep> rowPointers(rows.Direct() || passes > 1 ? h : 0);
+			for(unsigned int y = 0; y < rowPointers.size(); ++y) rowPointers[y] = rows.Direct() ? rows.Row(y) : decoded.data() + y * rows.SourcePitch();
+
+			//Read the decoded pixels
+			const bool decodedAll = ReadGuarded(png, [&]() {
+				if(rows.Direct()) {
+					png_read_image(png, rowPointers.data());
+				} else if(passes == 1) {
+					for(unsigned int y = 0; y < h; ++y) {
+						png_read_row(png, decoded.data(), nullptr);
+						rows.Write(decoded.data());
+					}
+				} else {
+					png_read_image(png, rowPointers.data());
+					for(unsigned int y = 0; y < h; ++y) rows.Write(rowPointers[y]);
+				}
+				png_read_end(png, info);
+			});
+			CheckException(decodedAll, "libpng read error!", [&png, &info]() { png_destroy_read_struct(&png, &info, nullptr); });
+
+			//Cleanup libpng
+			png_destroy_read_struct(&png, &info, nullptr);
+
+			//Return result
+			return img;
+		}
+	}
+
+	Image decode::DecodePNG(std::istream& input, const DecodeOptions& options) {
 		//Quick check to confirm PNG
 		std::array<unsigned char, 8> pngSig;
 		input.read(reinterpret_cast<char*>(pngSig.data()), 8);
 		CheckException(png_sig_cmp(pngSig.data(), 0, 8) == 0, "Non-PNG data passed to DecodePNG!");
 		input.seekg(0);
 
-		//Initialize libpng
-		png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-		CheckException(png, "Failed to initialize libpng!");
-		png_infop info = png_create_info_struct(png);
-		CheckException(info, "Failed to set up libpng information!", [&png]() { png_destroy_read_struct(&png, nullptr, nullptr); });
-
-		//Configure libpng longjmp
-		int sj = setjmp(png_jmpbuf(png));
-		CheckException(sj == 0, "libpng read error!", [&png, &info]() { png_destroy_read_struct(&png, &info, nullptr); });
-
-		//Set up IO read callback
-		png_set_read_fn(png, &input, [](png_structp png, png_bytep bytesOut, png_size_t readBytes) {
+		//Stream the data through libpng
+		return DecodePNGFrom(&input, [](png_structp png, png_bytep bytesOut, png_size_t readBytes) {
 			//Obtain the stream
 			std::istream* stream = static_cast<std::istream*>(png_get_io_ptr(png));
 			if(!stream) png_error(png, "Failed to retrieve input data stream!");
 
 			//Get the data
 			if(!stream->read(reinterpret_cast<char*>(bytesOut), readBytes)) png_error(png, "Failed to read data from input stream!");
-		});
-
-		//Force sRGB
-		png_set_gamma(png, 2.2, 0.45455);
-
-		//Load PNG info
-		png_read_info(png, info);
-
-		//Get image characteristics
-		Image img;
-		img.format = Image::Format::PNG;
-		img.lossy = false;
-		img.quality = 100;
-		int bitdepth = -1, colortype = -1;
-		png_get_IHDR(png, info, &img.w, &img.h, &bitdepth, &colortype, nullptr, nullptr, nullptr);
-
-		//De-paletteization
-		if(colortype == PNG_COLOR_TYPE_PALETTE) png_set_palette_to_rgb(png);
-
-		//Bit expansion
-		if(colortype == PNG_COLOR_TYPE_GRAY && bitdepth < 8) png_set_expand_gray_1_2_4_to_8(png);
-		png_set_packing(png);
-
-		//No gray+alpha
-		CheckException(colortype != PNG_COLOR_TYPE_GA, "Grayscale images with alpha channels are unsupported!", [&png, &info]() { png_destroy_read_struct(&png, &info, nullptr); });
-
-		//Turn tRNS info into alpha if needed
-		if(png_get_valid(png, info, PNG_INFO_tRNS)) png_set_tRNS_to_alpha(png);
-
-		//Fill alpha if there isn't any
-		png_set_add_alpha(png, bitdepth == 8 ? 0xFF : 0xFFFF, PNG_FILLER_AFTER);
-
-		//Swap byte order for endianness if necessary
-		if(bitdepth == 16) {
-			if constexpr(std::endian::native == std::endian::big) png_set_swap(png);
-		}
-
-		//Process transformation data
-		png_read_update_info(png, info);
-		png_get_IHDR(png, info, &img.w, &img.h, &bitdepth, &colortype, nullptr, nullptr, nullptr);
-		img.bitsPerChannel = bitdepth == 16 ? 16 : 8;
-
-		//Get channel layout
-		uint8_t channels = png_get_channels(png, info);
-		CheckException(channels <= 4 && channels > 0 && channels != 2, "Invalid channel layout detected!", [&png, &info]() { png_destroy_read_struct(&png, &info, nullptr); });
-		img.layout = Image::Layout(channels);
-
-		//Prepare data buffer
-		std::size_t bytesPerRow = png_get_rowbytes(png, info);
-		img.data.resize(bytesPerRow * img.h);
-		std::vector<png_bytep> rowPointers(img.h);
-		for(std::size_t y = 0; y < img.h; ++y) {
-			rowPointers[y] = img.data.data() + (y * bytesPerRow);
-		}
-
-		//Read the decoded pixels
-		png_read_image(png, rowPointers.data());
-		png_read_end(png, info);
-
-		//Cleanup libpng
-		png_destroy_read_struct(&png, &info, nullptr);
+		}, options);
+	}
 
-		//Return result
-		return img;
+	Image decode::DecodePNG(std::span<const unsigned char> data, const DecodeOptions& options) {
+		//Quick check to confirm PNG
+		CheckException(data.size() >= 8 && png_sig_cmp(data.data(), 0, 8) == 0, "Non-PNG data passed to DecodePNG!");
+
+		//Hand libpng the data straight from memory
+		MemoryInput input = {.data = data, .offset = 0};
+		return DecodePNGFrom(&input, [](png_structp png, png_bytep bytesOut, png_size_t readBytes) {
+			//Obtain the data
+			MemoryInput* input = static_cast<MemoryInput*>(png_get_io_ptr(png));
+			if(!input) png_error(png, "Failed to retrieve input data!");
+
+			//Copy out the next bytes
+			if(readBytes > input->data.size() - input->offset) png_error(png, "Unexpected end of PNG data!");
+			std::memcpy(bytesOut, input->data.data() + input->offset, readBytes);
+			input->offset += readBytes;
+		}, options);
 	}
 
 	std::size_t encode::EncodePNG(const Image& src, std::ostream& out) {
@@ -172,7 +262,7 @@ namespace libcacaoimage {
 		png_set_rows(png, info, rowPointers.data());
 
 		//Do we need to swap byte order for endianness?
-		bool swapBytes = std::endian::native == std::endian::big && src.bitsPerChannel == 16;
+		bool swapBytes = std::endian::native == std::endian::little && src.bitsPerChannel == 16;
 
 		//Write the image
 		png_write_png(png, info, (swapBytes ? PNG_TRANSFORM_SWAP_ENDIAN : PNG_TRANSFORM_IDENTITY), nullptr);
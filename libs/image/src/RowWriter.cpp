@@ -0,0 +1,91 @@
+#include "RowWriter.hpp"
+#include "libcacaocommon.hpp"
+
+#include "Convert.hpp"
+#include "Kernels.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace libcacaoimage {
+	void ValidateDecodeOptions(const decode::DecodeOptions& options) {
+		CheckException(!options.bitsPerChannel || *options.bitsPerChannel == 8 || *options.bitsPerChannel == 16, "Invalid decode color depth; only 8 and 16 are allowed.");
+		CheckException(!options.layout || *options.layout == Image::Layout::Grayscale || *options.layout == Image::Layout::RGB || *options.layout == Image::Layout::RGBA, "Invalid decode channel layout!");
+		const unsigned int d = options.downscale;
+		CheckException(d == 1 || d == 2 || d == 4 || d == 8, "Invalid decode downscale factor; only 1, 2, 4, and 8 are allowed.");
+	}
+
+	DecodeTarget::DecodeTarget(const decode::DecodeOptions& options, Image::Layout layout, uint8_t bitsPerChannel)
+	  : layout(options.layout.value_or(layout)), bitsPerChannel(options.bitsPerChannel.value_or(bitsPerChannel)), flip(options.flip), downscale(options.downscale) {}
+
+	RowWriter::RowWriter(Image& img, RowFormat rows, Image::Layout layout, uint8_t bitsPerChannel, bool flip, unsigned int downscale)
+	  : img(img), rows(rows), flip(flip), downscale(downscale), nextRow(0) {
+		//Partial blocks at the edges still make a pixel
+		img.w = (rows.w + downscale - 1) / downscale;
+		img.h = (rows.h + downscale - 1) / downscale;
+		img.layout = layout;
+		img.bitsPerChannel = bitsPerChannel;
+
+		srcPitch = static_cast<std::size_t>(rows.w) * static_cast<uint8_t>(rows.layout) * (rows.bitsPerChannel / 8);
+		dstPitch = static_cast<std::size_t>(img.w) * static_cast<uint8_t>(layout) * (bitsPerChannel / 8);
+		img.data.resize(dstPitch * img.h);
+
+		direct = rows.layout == layout && rows.bitsPerChannel == bitsPerChannel && downscale == 1;
+		if(rows.bitsPerChannel != bitsPerChannel) depthRow.resize(static_cast<std::size_t>(rows.w) * static_cast<uint8_t>(rows.layout) * (bitsPerChannel / 8));
+		if(rows.layout != layout) layoutRow.resize(static_cast<std::size_t>(rows.w) * static_cast<uint8_t>(layout) * (bitsPerChannel / 8));
+		if(downscale > 1) sums.resize(static_cast<std::size_t>(img.w) * static_cast<uint8_t>(layout));
+	}
+
+	void RowWriter::Write(const unsigned char* row) {
+		CheckException(nextRow < rows.h, "Decoder produced more rows than the image has!");
+		const std::size_t srcValues = static_cast<std::size_t>(rows.w) * static_cast<uint8_t>(rows.layout);
+
+		//Color depth first, so that layout conversion happens at the final depth
+		if(rows.bitsPerChannel == 16 && img.bitsPerChannel == 8) {
+			ActiveKernels().depth16To8(row, depthRow.data(), srcValues);
+			row = depthRow.data();
+		} else if(rows.bitsPerChannel == 8 && img.bitsPerChannel == 16) {
+			//Repeating the byte maps 0-255 onto the full 0-65535 range
+			uint16_t* wide = reinterpret_cast<uint16_t*>(depthRow.data());
+			for(std::size_t i = 0; i < srcValues; ++i) wide[i] = static_cast<uint16_t>(row[i] * 257);
+			row = depthRow.data();
+		}
+
+		//Then channel layout
+		if(rows.layout != img.layout) {
+			ConvertChannels(img.bitsPerChannel, rows.layout, img.layout, row, layoutRow.data(), rows.w);
+			row = layoutRow.data();
+		}
+
+		const unsigned int y = nextRow++;
+		if(downscale == 1) {
+			std::memcpy(Row(y), row, dstPitch);
+			return;
+		}
+
+		//Sum each block of pixels, and write out their averages when the band of rows is complete
+		const std::size_t channels = static_cast<uint8_t>(img.layout);
+		for(unsigned int x = 0; x < rows.w; ++x) {
+			uint32_t* sum = sums.data() + (x / downscale) * channels;
+			for(std::size_t c = 0; c < channels; ++c) {
+				sum[c] += img.bitsPerChannel == 8 ? row[x * channels + c] : reinterpret_cast<const uint16_t*>(row)[x * channels + c];
+			}
+		}
+		if((y + 1) % downscale != 0 && y + 1 != rows.h) return;
+
+		const unsigned int bandRows = y % downscale + 1;
+		unsigned char* out = Row(y / downscale);
+		for(unsigned int x = 0; x < img.w; ++x) {
+			const uint32_t count = std::min(downscale, rows.w - x * downscale) * bandRows;
+			for(std::size_t c = 0; c < channels; ++c) {
+				const std::size_t i = x * channels + c;
+				const uint32_t value = (sums[i] + count / 2) / count;
+				if(img.bitsPerChannel == 8)
+					out[i] = static_cast<unsigned char>(value);
+				else
+					reinterpret_cast<uint16_t*>(out)[i] = static_cast<uint16_t>(value);
+				sums[i] = 0;
+			}
+		}
+	}
+}
\ No newline at end of file
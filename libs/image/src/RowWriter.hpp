@@ -0,0 +1,93 @@
+#pragma once
+
+#include "libcacaoimage.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libcacaoimage {
+	///@brief Layout and size of the rows a codec produces
+	struct RowFormat {
+		unsigned int w;			   ///<Row width in pixels
+		unsigned int h;			   ///<Number of rows
+		Image::Layout layout;	   ///<Channel layout of each row
+		uint8_t bitsPerChannel;	   ///<Color depth of each row (8 or 16)
+	};
+
+	/**
+	 * @brief Check decode options before any codec state exists
+	 *
+	 * @throws std::runtime_error If the options are invalid
+	 */
+	void ValidateDecodeOptions(const decode::DecodeOptions& options);
+
+	///@brief Decode options resolved against an image
+	struct DecodeTarget {
+		Image::Layout layout;	  ///<Final channel layout
+		uint8_t bitsPerChannel;	  ///<Final color depth
+		bool flip;				  ///<Whether the image ends up flipped
+		unsigned int downscale;	  ///<Factor the image ends up shrunk by
+
+		/**
+		 * @brief Resolve validated decode options for an image
+		 *
+		 * @param options The options given to the decoder
+		 * @param layout The image's own channel layout
+		 * @param bitsPerChannel The image's own color depth
+		 */
+		DecodeTarget(const decode::DecodeOptions& options, Image::Layout layout, uint8_t bitsPerChannel);
+	};
+
+	/**
+	 * @brief Writes decoded rows into an image, finishing whatever the codec couldn't do itself
+	 *
+	 * Codecs apply what they can of the decode target, and describe the rows they end up producing along with what's left.
+	 * If nothing is left, rows can be decoded straight into the image. Otherwise each row is converted and downscaled as it
+	 * arrives, so there's never a second pass over a whole image.
+	 */
+	class RowWriter {
+	  public:
+		/**
+		 * @brief Set up an image for decoding into
+		 *
+		 * @param img The image to fill, whose format, quality, and lossiness the caller sets; everything else is set here
+		 * @param rows The rows the codec produces, which can't be empty
+		 * @param layout The channel layout still to convert to
+		 * @param bitsPerChannel The color depth still to convert to
+		 * @param flip Whether rows still need to be written bottom-up
+		 * @param downscale The factor the rows still need to be shrunk by
+		 */
+		RowWriter(Image& img, RowFormat rows, Image::Layout layout, uint8_t bitsPerChannel, bool flip, unsigned int downscale);
+
+		///@brief Whether the codec's rows are already in final form, so they can be decoded straight into the image with Row
+		bool Direct() const {
+			return direct;
+		}
+
+		///@brief Get where final row y goes in the image
+		unsigned char* Row(unsigned int y) {
+			return img.data.data() + static_cast<std::size_t>(flip ? img.h - y - 1 : y) * dstPitch;
+		}
+
+		///@brief Get the size of one of the codec's rows in bytes
+		std::size_t SourcePitch() const {
+			return srcPitch;
+		}
+
+		///@brief Hand over the codec's next row (rows must come in top-down order)
+		void Write(const unsigned char* row);
+
+	  private:
+		Image& img;
+		RowFormat rows;
+		bool flip, direct;
+		unsigned int downscale;
+		std::size_t srcPitch, dstPitch;
+		unsigned int nextRow;
+
+		//Scratch for the depth and layout steps, and the running sums of a band of rows being downscaled
+		std::vector<unsigned char> depthRow, layoutRow;
+		std::vector<uint32_t> sums;
+	};
+}
\ No newline at end of file
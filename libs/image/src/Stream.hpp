@@ -0,0 +1,16 @@
+#pragma once
+
+#include <istream>
+#include <vector>
+
+namespace libcacaoimage {
+	/**
+	 * @brief Read the whole of an input stream into memory, for codecs that can only decode from a buffer
+	 *
+	 * @param input The stream to read from its beginning
+	 * @param failure The message to throw with if reading fails
+	 *
+	 * @return The stream's contents
+	 */
+	std::vector<unsigned char> ReadStream(std::istream& input, const char* failure);
+}
\ No newline at end of file
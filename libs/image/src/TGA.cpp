@@ -2,6 +2,8 @@
 #include "libcacaocommon.hpp"
 #include <cstddef>
 
+#include "RowWriter.hpp"
+
 #include "tga.h"
 
 namespace libcacaoimage {
@@ -59,7 +61,7 @@ namespace libcacaoimage {
 		} mode;
 	};
 
-	Image decode::DecodeTGA(std::istream& input) {
+	Image decode::DecodeTGA(std::istream& input, const DecodeOptions& options) {
 		//Create interface and decoder
 		StreamFileInterface sfi(input);
 		tga::Decoder dec(&sfi);
@@ -67,57 +69,48 @@ namespace libcacaoimage {
 		//Read header to confirm TGA
 		tga::Header head;
 		CheckException(dec.readHeader(head), "Non-TGA data passed to DecodeTGA!");
+		ValidateDecodeOptions(options);
 
 		//Set image properties
 		Image img;
-		img.w = head.width;
-		img.h = head.height;
 		img.format = Image::Format::TGA;
 		img.lossy = false;
 		img.quality = 100;
-		img.bitsPerChannel = 8;
-		img.layout = (head.isRgb() ? (dec.hasAlpha() ? Image::Layout::RGBA : Image::Layout::RGB) : Image::Layout::Grayscale);
+		const DecodeTarget target(options, (head.isRgb() ? (dec.hasAlpha() ? Image::Layout::RGBA : Image::Layout::RGB) : Image::Layout::Grayscale), 8);
+
+		//The TGA library always gives RGB data as RGBA, even if alpha is opaque
+		//So if this IS opaque, the row writer removes the extra info along with any other conversion
+		const Image::Layout rowLayout = head.isRgb() ? Image::Layout::RGBA : Image::Layout::Grayscale;
+		RowWriter rows(img, {.w = head.width, .h = head.height, .layout = rowLayout, .bitsPerChannel = 8}, target.layout, target.bitsPerChannel, target.flip, target.downscale);
 
-		//Decode image data
+		//Decode image data, straight into the image if nothing's left to do
+		const bool inPlace = rows.Direct() && !target.flip;
 		tga::Image tga;
 		tga.bytesPerPixel = head.bytesPerPixel();
 		tga.rowstride = head.width * tga.bytesPerPixel;
-		std::vector<unsigned char> buffer(tga.rowstride * head.height);
-		tga.pixels = buffer.data();
+		std::vector<unsigned char> buffer(inPlace ? 0 : tga.rowstride * head.height);
+		tga.pixels = inPlace ? img.data.data() : buffer.data();
+		CheckException(tga.rowstride == rows.SourcePitch(), "Unexpected TGA row size!");
 		CheckException(dec.readImage(head, tga), "Failed to decode TGA image data!");
 
 		//Post-process image data to fix up alpha
 		dec.postProcessImage(head, tga);
 
-		//If this image is opaque, we want to remove the alpha info
-		//The TGA library always gives RGB data as RGBA, even if alpha is opaque
-		//So if this IS opaque, we'd like to remove the extra info
-		//This is why we don't write to the buffer immediately
-		if(img.layout == Image::Layout::RGB) {
-			//Setup output buffer
-			const std::size_t pixels = head.width * head.height;
-			img.data.resize(pixels * 3);
-
-			//We're copying using raw pointers here because it's faster and also we know the buffer sizes are okay so we don't need bounds checking
-			const unsigned char* src = buffer.data();
-			unsigned char* dst = img.data.data();
-			for(std::size_t i = 0; i < pixels; ++i) {
-				//Copy R, G, and B values
-				*dst++ = *src++;
-				*dst++ = *src++;
-				*dst++ = *src++;
-
-				//Skip the A
-				++src;
-			}
-		} else {
-			img.data = std::move(buffer);
+		//Hand the rows over if they weren't decoded in place
+		if(!inPlace) {
+			for(unsigned int y = 0; y < head.height; ++y) rows.Write(buffer.data() + static_cast<std::size_t>(y) * tga.rowstride);
 		}
 
 		//Return result
 		return img;
 	}
 
+	Image decode::DecodeTGA(std::span<const unsigned char> data, const DecodeOptions& options) {
+		//The TGA library reads through a stream interface, so view the data as one without copying it
+		ispanstream input(data);
+		return DecodeTGA(input, options);
+	}
+
 	std::size_t encode::EncodeTGA(const Image& src, std::ostream& out) {
 		//Input validation
 		CheckException(src.w > 0 && src.h > 0, "Cannot encode an image with zeroed dimensions!");
@@ -1,21 +1,26 @@
 #include "libcacaoimage.hpp"
 #include "libcacaocommon.hpp"
 
+#include "RowWriter.hpp"
+
 #include "tiff.h"
 #include "tiffio.h"
 #include "tiffio.hxx"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <iostream>
 #include <memory>
-#include <array>
 
 namespace libcacaoimage {
-	Image decode::DecodeTIFF(std::istream& input) {
+	Image decode::DecodeTIFF(std::istream& input, const DecodeOptions& options) {
 		//Quick check to confirm TIFF
 		std::array<unsigned char, 4> tiffSig;
 		input.read(reinterpret_cast<char*>(tiffSig.data()), 4);
 		CheckException(tiffSig[0] == 'I' && tiffSig[1] == 'I' && tiffSig[2] == '*' && tiffSig[3] == 0, "Non-TIFF data passed to DecodeTIFF!");
 		input.seekg(0);
+		ValidateDecodeOptions(options);
 
 		//Open TIFF stream
 		std::unique_ptr<TIFF, decltype(&TIFFClose)> tiff(TIFFStreamOpen("__memtiff", &input), TIFFClose);
@@ -34,21 +39,19 @@ namespace libcacaoimage {
 
 		//Store data in Image
 		Image img;
-		img.w = width;
-		img.h = height;
 		img.format = Image::Format::TIFF;
 		img.lossy = false;
 		img.quality = 100;
 		CheckException(bitsPerSample == 8 || bitsPerSample == 16, "Unsupported sample bitdepth state; only 8 or 16-bit color is allowed!");
-		img.bitsPerChannel = static_cast<uint8_t>(bitsPerSample);
 		CheckException(samplesPerPixel <= 4 && samplesPerPixel >= 1 && samplesPerPixel != 2, "Unsupported sample-per-pixel state; only 8 or 16-bit color is allowed!");
-		img.layout = Image::Layout(static_cast<uint8_t>(samplesPerPixel));
+		const Image::Layout layout = Image::Layout(static_cast<uint8_t>(samplesPerPixel));
+		const DecodeTarget target(options, layout, static_cast<uint8_t>(bitsPerSample));
+		RowWriter rows(img, {.w = width, .h = height, .layout = layout, .bitsPerChannel = static_cast<uint8_t>(bitsPerSample)}, target.layout, target.bitsPerChannel, target.flip, target.downscale);
 
 		//Calculate data for read
 		const uint8_t bytesPerChnl = (bitsPerSample / 8);
 		const std::size_t bytesPerPxl = samplesPerPixel * bytesPerChnl;
-		const std::size_t pitch = bytesPerPxl * width;
-		img.data.resize(pitch * height);
+		const std::size_t pitch = rows.SourcePitch();
 
 		//Tiled or scanlines?
 		if(TIFFIsTiled(tiff.get())) {
@@ -56,35 +59,43 @@ namespace libcacaoimage {
 
 			//Get tile dimensions
 			unsigned int wtile = 0, htile = 0;
-			CheckException(TIFFGetField(tiff.get(), TIFFTAG_TILEWIDTH, &width) == 1, "Failed to get image tile width!");
-			CheckException(TIFFGetField(tiff.get(), TIFFTAG_TILELENGTH, &height) == 1, "Failed to get image tile height!");
+			CheckException(TIFFGetField(tiff.get(), TIFFTAG_TILEWIDTH, &wtile) == 1 && wtile > 0, "Failed to get image tile width!");
+			CheckException(TIFFGetField(tiff.get(), TIFFTAG_TILELENGTH, &htile) == 1 && htile > 0, "Failed to get image tile height!");
 
-			//Allocate tile storage buffer
+			//Allocate tile storage buffer, and a band of rows to assemble tiles in if they can't go straight into the image
 			std::vector<unsigned char> tile(TIFFTileSize(tiff.get()));
+			std::vector<unsigned char> band(rows.Direct() ? 0 : pitch * htile);
 
 			//Read tiles
 			for(unsigned int y = 0; y < height; y += htile) {
+				const unsigned int hcpy = std::min(htile, height - y);
 				for(unsigned int x = 0; x < width; x += wtile) {
 					//Read tile
-					CheckException(TIFFReadEncodedTile(tiff.get(), TIFFComputeTile(tiff.get(), x, y, 0, 0), tile.data(), tile.size()) == 1, "Failed to read TIFF tile!");
+					CheckException(TIFFReadEncodedTile(tiff.get(), TIFFComputeTile(tiff.get(), x, y, 0, 0), tile.data(), tile.size()) != -1, "Failed to read TIFF tile!");
 
 					//Compute copy location
 					const unsigned int wcpy = std::min(wtile, width - x);
-					const unsigned int hcpy = std::min(htile, height - y);
 
 					//Copy each tile row into the output buffer
 					for(unsigned int r = 0; r < hcpy; ++r) {
-						unsigned char* destination = img.data.data() + ((y + r) * pitch) + (x * bytesPerPxl);
+						unsigned char* destination = (rows.Direct() ? rows.Row(y + r) : band.data() + (r * pitch)) + (x * bytesPerPxl);
 						const unsigned char* source = tile.data() + (r * wtile * bytesPerPxl);
 						std::memcpy(destination, source, wcpy * bytesPerPxl);
 					}
 				}
+
+				//Hand over the finished band
+				if(!rows.Direct()) {
+					for(unsigned int r = 0; r < hcpy; ++r) rows.Write(band.data() + (r * pitch));
+				}
 			}
 		} else {
 			//Scanlines (much more fun)
+			std::vector<unsigned char> scanline(rows.Direct() ? 0 : pitch);
 			for(unsigned int y = 0; y < height; ++y) {
-				uint8_t* cpyDest = img.data.data() + (y * pitch);
+				uint8_t* cpyDest = rows.Direct() ? rows.Row(y) : scanline.data();
 				CheckException(TIFFReadScanline(tiff.get(), cpyDest, y, 0) == 1, "Failed to read TIFF scanline!");
+				if(!rows.Direct()) rows.Write(scanline.data());
 			}
 		}
 
@@ -92,6 +103,12 @@ namespace libcacaoimage {
 		return img;
 	}
 
+	Image decode::DecodeTIFF(std::span<const unsigned char> data, const DecodeOptions& options) {
+		//libtiff reads through a stream, so view the data as one without copying it
+		ispanstream input(data);
+		return DecodeTIFF(input, options);
+	}
+
 	std::size_t encode::EncodeTIFF(const Image& src, std::ostream& out) {
 		//Input validation
 		CheckException(src.w > 0 && src.h > 0, "Cannot encode an image with zeroed dimensions!");
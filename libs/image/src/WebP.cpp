@@ -1,44 +1,31 @@
 #include "libcacaoimage.hpp"
 #include "libcacaocommon.hpp"
 
+#include "RowWriter.hpp"
+#include "Stream.hpp"
+
 #include "webp/decode.h"
 #include "webp/encode.h"
 
-#include <array>
+#include <cstddef>
+#include <vector>
 
 namespace libcacaoimage {
-	Image decode::DecodeWebP(std::istream& input) {
+	Image decode::DecodeWebP(std::istream& input, const DecodeOptions& options) {
+		//libwebp only decodes from memory, so read data into buffer
+		return DecodeWebP(ReadStream(input, "Failed to read WebP image data stream to buffer!"), options);
+	}
+
+	Image decode::DecodeWebP(std::span<const unsigned char> buffer, const DecodeOptions& options) {
 		//Quick check to confirm WebP
-		std::array<unsigned char, 12> wpSig;
-		input.read(reinterpret_cast<char*>(wpSig.data()), 12);
-		CheckException(wpSig[0] == 'R' && wpSig[1] == 'I' && wpSig[2] == 'F' && wpSig[3] == 'F' && wpSig[8] == 'W' && wpSig[9] == 'E' && wpSig[10] == 'B' && wpSig[11] == 'P', "Non-WebP data passed to DecodeWebP!");
-		input.seekg(0);
+		CheckException(buffer.size() >= 12 && buffer[0] == 'R' && buffer[1] == 'I' && buffer[2] == 'F' && buffer[3] == 'F' && buffer[8] == 'W' && buffer[9] == 'E' && buffer[10] == 'B' && buffer[11] == 'P',
+			"Non-WebP data passed to DecodeWebP!");
+		ValidateDecodeOptions(options);
 
 		//Create decoding configuration object
 		WebPDecoderConfig cfg;
 		CheckException(WebPInitDecoderConfig(&cfg), "Failed to create libwebp decoder configuration!");
 
-		//Read data into buffer
-		std::vector<unsigned char> buffer = [&input]() {
-			try {
-				//Grab size
-				input.clear();
-				input.exceptions(std::ios::failbit | std::ios::badbit);
-				input.seekg(0, std::ios::end);
-				auto size = input.tellg();
-				input.seekg(0, std::ios::beg);
-
-				//Read data
-				std::vector<unsigned char> contents(size);
-				input.read(reinterpret_cast<char*>(contents.data()), size);
-
-				return contents;
-			} catch(std::ios_base::failure& ios_failure) {
-				if(errno == 0) { throw ios_failure; }
-				throw std::runtime_error("Failed to read WebP image data stream to buffer!");
-			}
-		}();
-
 		//Get image features
 		WebPBitstreamFeatures features;
 		CheckException(WebPGetFeatures(buffer.data(), buffer.size(), &features) == VP8_STATUS_OK, "Failed to detect WebP image features!");
@@ -46,24 +33,49 @@ namespace libcacaoimage {
 
 		//Setup image object
 		Image img;
-		img.w = features.width;
-		img.h = features.height;
 		img.format = Image::Format::WebP;
-		img.bitsPerChannel = 8;
-		img.layout = features.has_alpha ? Image::Layout::RGBA : Image::Layout::RGB;
 		img.quality = 80;
 		img.lossy = true;
+		const DecodeTarget target(options, features.has_alpha ? Image::Layout::RGBA : Image::Layout::RGB, 8);
 
 		//Setup decoder configuration
+		//libwebp flips and scales itself, so only grayscale and 16-bit output are left to the row writer
+		const Image::Layout rowLayout = target.layout == Image::Layout::Grayscale ? Image::Layout::RGB : target.layout;
 		cfg.options.no_fancy_upsampling = false;
 		cfg.options.use_threads = true;
-		cfg.output.colorspace = features.has_alpha ? MODE_RGBA : MODE_RGB;
+		cfg.options.flip = target.flip;
+		if(target.downscale > 1) {
+			cfg.options.use_scaling = true;
+			cfg.options.scaled_width = (features.width + target.downscale - 1) / target.downscale;
+			cfg.options.scaled_height = (features.height + target.downscale - 1) / target.downscale;
+		}
+		cfg.output.colorspace = rowLayout == Image::Layout::RGBA ? MODE_RGBA : MODE_RGB;
+
+		//Set up the image
+		const unsigned int w = target.downscale > 1 ? cfg.options.scaled_width : features.width;
+		const unsigned int h = target.downscale > 1 ? cfg.options.scaled_height : features.height;
+		RowWriter rows(img, {.w = w, .h = h, .layout = rowLayout, .bitsPerChannel = 8}, target.layout, target.bitsPerChannel, false, 1);
+
+		//Decode straight into the image if possible
+		if(rows.Direct()) {
+			cfg.output.is_external_memory = true;
+			cfg.output.u.RGBA.rgba = img.data.data();
+			cfg.output.u.RGBA.stride = static_cast<int>(rows.SourcePitch());
+			cfg.output.u.RGBA.size = img.data.size();
+		}
 
 		//Decode the image
-		CheckException(WebPDecode(buffer.data(), buffer.size(), &cfg) == VP8_STATUS_OK, "Failed to decode WebP data!");
+		CheckException(WebPDecode(buffer.data(), buffer.size(), &cfg) == VP8_STATUS_OK, "Failed to decode WebP data!", [&cfg]() { WebPFreeDecBuffer(&cfg.output); });
 
-		//Extract data
-		img.data.assign(cfg.output.u.RGBA.rgba, cfg.output.u.RGBA.rgba + cfg.output.u.RGBA.size);
+		//Extract data (libwebp flips by pointing at the last row with a negative stride, so the offset must stay signed)
+		if(!rows.Direct()) {
+			try {
+				for(unsigned int y = 0; y < h; ++y) rows.Write(cfg.output.u.RGBA.rgba + static_cast<std::ptrdiff_t>(y) * cfg.output.u.RGBA.stride);
+			} catch(...) {
+				WebPFreeDecBuffer(&cfg.output);
+				throw;
+			}
+		}
 
 		//Cleanup
 		WebPFreeDecBuffer(&cfg.output);
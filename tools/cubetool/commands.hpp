@@ -19,6 +19,11 @@ class CreateCmd {
 	CLI::App* cmd;
 	std::filesystem::path inPath;
 	std::filesystem::path outPath;
+	unsigned int threads = 1;
+	std::filesystem::path cacheDir;
+	bool cacheLink = false;
+
+	CompileResult Create();
 };
 
 class ExtractCmd {
@@ -33,4 +38,5 @@ class ExtractCmd {
 	std::vector<uint8_t> faces;
 	std::filesystem::path inPath;
 	std::filesystem::path out;
+	unsigned int threads = 1;
 };
\ No newline at end of file
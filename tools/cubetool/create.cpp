@@ -2,10 +2,21 @@
 
 #include <filesystem>
 #include <string>
+#include <optional>
+#include <stdexcept>
 
 #include "libcacaoformats.hpp"
 #include "libcacaoimage.hpp"
 
+#include "yaml-cpp/yaml.h"
+
+#ifndef CACAO_VER
+#define CACAO_VER "unknown"
+#endif
+#ifndef TOOL_VER
+#define TOOL_VER "unknown"
+#endif
+
 CreateCmd::CreateCmd(CLI::App& app) {
 	//Create the command CLI
 	cmd = app.add_subcommand("create", "Create a new cubemap");
@@ -23,6 +34,13 @@ CreateCmd::CreateCmd(CLI::App& app) {
 		return "The output file must either be a file to overwrite or a nonexistent file!";
 	});
 
+	//Threading
+	cmd->add_option("-t,--threads", threads, "Number of threads to encode faces on (0 uses all available cores)");
+
+	//Build cache
+	CLI::Option* cacheOpt = cmd->add_option("--cache-dir", cacheDir, "Build cache directory to reuse an unchanged output from and store a new output in");
+	cmd->add_flag("--cache-link", cacheLink, "Hard-link an output restored from the build cache instead of copying it")->needs(cacheOpt);
+
 	//Register command callback function
 	cmd->callback([this]() {
 		this->Callback();
@@ -30,12 +48,36 @@ CreateCmd::CreateCmd(CLI::App& app) {
 }
 
 void CreateCmd::Callback() {
+	//Open the build cache if requested
+	if(!cacheDir.empty() && !EnableBuildCache(cacheDir, cacheLink)) exit(1);
+
+	//The output depends on the definition file, the face images it references and the tool version
+	//If the definition can't be read here, skip the cache and let the decoder report the problem
+	std::optional<BuildCacheKey> key;
+	if(buildCache.Enabled()) {
+		key.emplace().Add("cubetool create").Add(TOOL_VER).Add(CACAO_VER);
+		try {
+			if(!key->AddFile(inPath)) throw std::runtime_error("");
+			YAML::Node root = YAML::LoadFile(inPath.string());
+			for(const char* face : {"right", "left", "top", "bottom", "front", "back"}) {
+				if(!root[face].IsScalar() || !key->AddFile(inPath.parent_path() / root[face].Scalar())) throw std::runtime_error("");
+			}
+		} catch(const std::exception&) {
+			key.reset();
+		}
+	}
+	//Failures come back as results so that a failed output is never stored in the cache
+	CompileResult result = key ? CompileWithCache(*key, outPath, [this]() { return Create(); }) : CompileWithoutCache(outPath, [this]() { return Create(); });
+	if(!result.first) {
+		CUBE_ERROR(result.second)
+	}
+}
+
+CompileResult CreateCmd::Create() {
 	//Load the input file
 	VLOG_NONL("Opening input file " << inPath << "... ");
 	std::ifstream in(inPath);
-	if(!in.is_open()) {
-		CUBE_ERROR("Failed to open input file stream for reading!")
-	}
+	CompileCheck(in.is_open(), "Failed to open input file stream for reading!")
 	VLOG("Done.")
 
 	//Create the loader function
@@ -48,17 +90,13 @@ void CreateCmd::Callback() {
 		std::filesystem::current_path(cur);
 
 		//Ensure the file exists
-		if(!std::filesystem::exists(p)) {
-			CUBE_ERROR("Input file specifies a nonexistent file!")
-		}
+		if(!std::filesystem::exists(p)) throw std::runtime_error("Input file specifies a nonexistent file!");
 		VLOG("Done.")
 
 		//Open the stream
 		VLOG_NONL("\tOpening file stream... ")
 		std::unique_ptr<std::ifstream> in = std::make_unique<std::ifstream>(p);
-		if(!in->is_open()) {
-			CUBE_ERROR("Failed to open face file stream for reading!")
-		}
+		if(!in->is_open()) throw std::runtime_error("Failed to open face file stream for reading!");
 		VLOG("Done.")
 
 		//Convert pointer to std::istream and return
@@ -72,7 +110,7 @@ void CreateCmd::Callback() {
 	try {
 		decoded = dec.DecodeCubemap(in, loaderFunc);
 	} catch(const std::runtime_error& e) {
-		CUBE_ERROR(e.what());
+		return {false, e.what()};
 	}
 	//Encode the file
 	VLOG_NONL("Generating output... ")
@@ -80,23 +118,22 @@ void CreateCmd::Callback() {
 	std::pair<bool, std::string> pcGetErr = {true, ""};
 	libcacaoformats::PackedContainer pc = [&]() {
 		try {
-			return enc.EncodeCubemap(decoded);
+			return enc.EncodeCubemap(decoded, threads);
 		} catch(const std::runtime_error& e) {
 			pcGetErr = {false, e.what()};
 			return libcacaoformats::PackedContainer();
 		}
 	}();
-	if(!pcGetErr.first) {
-		CUBE_ERROR(pcGetErr.second)
-	}
+	if(!pcGetErr.first) return pcGetErr;
 	VLOG("Done.")
 
 	//Write it out
 	VLOG_NONL("Writing output file " << outPath << "... ");
 	std::ofstream out(outPath, std::ios::binary);
-	if(!in.is_open()) {
-		CUBE_ERROR("Failed to open output file stream for writing!")
-	}
-	pc.ExportToStream(out);
+	CompileCheck(out.is_open(), "Failed to open output file stream for writing!")
+	pc.ExportToStream(out, threads);
+	out.close();
+	CompileCheck(out.good(), "Failed to write output file!")
 	VLOG("Done.")
+	return {true, ""};
 }
\ No newline at end of file
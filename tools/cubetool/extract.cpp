@@ -41,6 +41,9 @@ ExtractCmd::ExtractCmd(CLI::App& app) {
 		return std::filesystem::absolute(path).string();
 	});
 
+	//Threading
+	cmd->add_option("-t,--threads", threads, "Number of threads to decode faces on (0 uses all available cores)");
+
 	//Command behavior
 	cmd->callback([this]() {
 		this->Callback();
@@ -70,7 +73,7 @@ void ExtractCmd::Callback() {
 	std::array<libcacaoimage::Image, 6> decoded;
 	try {
 		libcacaoformats::PackedContainer pc = libcacaoformats::PackedContainer::FromStream(in);
-		decoded = dec.DecodeCubemap(pc);
+		decoded = dec.DecodeCubemap(pc, threads);
 	} catch(const std::runtime_error& e) {
 		CUBE_ERROR(e.what());
 	}
@@ -6,6 +6,13 @@
 #include <iostream>
 #include <unordered_map>
 #include <string>
+#include <memory>
+#include <algorithm>
+#include <optional>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <string_view>
 
 #include "toolutil.hpp"
 
@@ -20,7 +27,11 @@
 #define COMPILER_VER "unknown"
 #endif
 
-std::pair<bool, std::string> compile(const std::filesystem::path& in, const std::filesystem::path& out) {
+//Parameter block settings
+std::filesystem::path shaderRoot;
+libcacaoformats::MaterialBlockRules blockRules = libcacaoformats::MaterialBlockRules::Std140;
+
+std::pair<bool, std::string> build(const std::filesystem::path& in, const std::filesystem::path& out) {
 	//Create decoder
 	//Yes, I do know the message says otherwise. I just think this sounds better. Deal with it.
 	CVLOG_NONL("\tCreating parser... ");
@@ -44,13 +55,28 @@ std::pair<bool, std::string> compile(const std::filesystem::path& in, const std:
 	libcacaoformats::PackedEncoder enc;
 	CVLOG("Done.");
 
+	//Use the layout of the compiled shader if we can find it, otherwise lay out the parameters ourselves
+	CVLOG_NONL("\tResolving parameter layout... ");
+	std::optional<libcacaoformats::MaterialLayout> layout;
+	if(!shaderRoot.empty() && std::filesystem::exists(shaderRoot / m.shader)) {
+		std::ifstream shaderStream(shaderRoot / m.shader, std::ios::binary);
+		CompileCheck(shaderStream.is_open(), "Failed to open shader stream!");
+		try {
+			layout = libcacaoformats::PackedDecoder().DecodeShaderMaterialLayout(libcacaoformats::PackedContainer::FromStream(shaderStream));
+		} catch(const std::runtime_error& e) {
+			return {false, e.what()};
+		}
+	}
+	if(!layout) layout = libcacaoformats::ComputeMaterialLayout(m, blockRules);
+	CVLOG("Done.");
+
 	//Compile the material (weird function stuff is because of the try catch)
 	CVLOG_NONL("\tCompiling material... ");
 	std::pair<bool, std::string> pcGetErr;
 	libcacaoformats::PackedContainer pc = [&]() {
 		try {
 			pcGetErr = {true, ""};
-			return enc.EncodeMaterial(m);
+			return enc.EncodeMaterial(m, *layout);
 		} catch(const std::runtime_error& e) {
 			pcGetErr = {false, e.what()};
 			return libcacaoformats::PackedContainer();
@@ -71,6 +97,53 @@ std::pair<bool, std::string> compile(const std::filesystem::path& in, const std:
 	return {true, ""};
 }
 
+/**
+ * @brief Find the shader address of a material from its source text without parsing the whole document
+ *
+ * Only a plain or simply quoted top-level "shader" key is recognized, so that the result always matches what the YAML parser reads.
+ *
+ * @return The shader address, or nothing if it couldn't be found this way
+ */
+std::optional<std::string> ScanShaderAddress(const std::string& src) {
+	static const std::regex shaderLine(R"(^shader[ \t]*:[ \t]*(.*?)[ \t]*\r?$)");
+	std::stringstream lines(src);
+	std::string line;
+	while(std::getline(lines, line)) {
+		std::smatch match;
+		if(!std::regex_match(line, match, shaderLine)) continue;
+		std::string value = match[1].str();
+		if(value.size() >= 2 && (value.front() == '\'' || value.front() == '"') && value.back() == value.front()) value = value.substr(1, value.size() - 2);
+
+		//Anything the YAML parser might read differently (comments, escapes, flow collections, tags, anchors, block scalars) is left to it
+		if(value.empty() || value.find_first_of("#\\'\"") != std::string::npos || std::string_view("{[&*!|>%@`").find(value.front()) != std::string_view::npos) return std::nullopt;
+		return value;
+	}
+	return std::nullopt;
+}
+
+std::pair<bool, std::string> compile(const std::filesystem::path& in, const std::filesystem::path& out) {
+	if(!buildCache.Enabled()) return CompileWithoutCache(out, [&]() { return build(in, out); });
+
+	//The output depends on the source, the compiled shader it uses for its layout (if there is one), the layout settings and the compiler version
+	//This is all found from the raw bytes so that a cache hit never has to parse anything
+	std::ifstream input(in, std::ios::binary);
+	CompileCheck(input.is_open(), "Failed to open source stream!");
+	std::string src(std::istreambuf_iterator<char>(input), {});
+	CompileCheck(!input.bad(), "Failed to read source file!");
+	std::optional<std::string> shader = ScanShaderAddress(src);
+	if(!shader) return CompileWithoutCache(out, [&]() { return build(in, out); });
+
+	BuildCacheKey key;
+	key.Add("matc").Add(COMPILER_VER).Add(CACAO_VER).Add(src);
+	key.Add(blockRules == libcacaoformats::MaterialBlockRules::Std430 ? "std430" : "std140").Add(shaderRoot.string());
+	if(!shaderRoot.empty() && std::filesystem::exists(shaderRoot / *shader)) {
+		CompileCheck(key.AddFile(shaderRoot / *shader), "Failed to read shader file!");
+	} else {
+		key.Add("no shader");
+	}
+	return CompileWithCache(key, out, [&]() { return build(in, out); });
+}
+
 int main(int argc, char* argv[]) {
 	//Configure CLI
 	CLI::App app("Cacao Engine Material Compiler", std::filesystem::path(argv[0]).filename().string());
@@ -98,6 +171,20 @@ int main(int argc, char* argv[]) {
 	});
 	outOpt->excludes(autoOutOpt);
 
+	//Parameter block args
+	app.add_option("-S,--shader-root", shaderRoot, "Directory to resolve shader addresses against; materials whose compiled shader is found there use its parameter layout")->check(CLI::ExistingDirectory);
+	app.add_flag_callback("--std430", []() { blockRules = libcacaoformats::MaterialBlockRules::Std430; }, "Lay out parameter blocks with std430 rules instead of std140 when the shader layout is not available");
+
+	//Parallelism arg
+	unsigned int jobs = 1;
+	app.add_option("-j,--jobs", jobs, "Number of inputs to compile at once (0 to use one per hardware thread)")->check(CLI::NonNegativeNumber);
+
+	//Build cache args
+	std::filesystem::path cacheDir;
+	bool cacheLink = false;
+	CLI::Option* cacheOpt = app.add_option("--cache-dir", cacheDir, "Build cache directory to reuse unchanged outputs from and store new outputs in");
+	app.add_flag("--cache-link", cacheLink, "Hard-link outputs restored from the build cache instead of copying them")->needs(cacheOpt);
+
 	//Output control
 	outputLvl = OutputLevel::Normal;
 	app.add_flag_callback("-q,--quiet", []() { outputLvl = OutputLevel::Silent; }, "Suppress all output from the compiler");
@@ -112,6 +199,9 @@ int main(int argc, char* argv[]) {
 	//Parse the CLI
 	CLI11_PARSE(app, argc, argv);
 
+	//Open the build cache if requested
+	if(!cacheDir.empty() && !EnableBuildCache(cacheDir, cacheLink)) return 1;
+
 	//Calculate auto-output paths if requested
 	if(app.count("-A") > 0) {
 		for(auto& in : input) {
@@ -134,41 +224,43 @@ int main(int argc, char* argv[]) {
 
 	//Merge input and output vectors
 	VLOG_NONL("Preparing tasks list... ")
-	std::unordered_map<std::filesystem::path, std::filesystem::path> tasks;
-	for(unsigned int i = 0; i < input.size(); ++i) {
-		if(!std::filesystem::exists(output[i].parent_path())) {
-			std::filesystem::create_directories(output[i].parent_path());
-		}
-		tasks[input[i]] = output[i];
-	}
+	std::optional<std::vector<CompileTask>> tasks = MakeCompileTasks(input, output);
+	if(!tasks) return 1;
 	VLOG("Done.")
 
 	//Compile
 	std::unique_ptr<jms::Spinner> s;
-	for(const auto& [in, out] : tasks) {
+	if(outputLvl != OutputLevel::Silent) {
 		std::stringstream taskDesc;
-		taskDesc << "Compiling " << in << "...";
-		if(outputLvl != OutputLevel::Silent) {
-			s = std::make_unique<jms::Spinner>(taskDesc.str(), jms::dots);
-			s->start();
-		}
-		auto [result, log] = compile(in, out);
-		if(outputLvl != OutputLevel::Silent) {
-			taskDesc.str("");
-			if(result) {
-				taskDesc << "Compiled " << in << ".";
-				s->finish(jms::FinishedState::SUCCESS, taskDesc.str());
-			} else {
-				taskDesc << "Failed to compile " << in << ".";
-				s->finish(jms::FinishedState::FAILURE, taskDesc.str());
-			}
-		}
-		if(!result) {
-			ERROR("Failed to compile one or more materials: " << log)
-			return 1;
+		if(tasks->size() == 1)
+			taskDesc << "Compiling " << tasks->front().first << "...";
+		else
+			taskDesc << "Compiling " << tasks->size() << " materials...";
+		s = std::make_unique<jms::Spinner>(taskDesc.str(), jms::dots);
+		s->start();
+	}
+	std::vector<std::optional<CompileResult>> results = RunCompileTasks(*tasks, ResolveJobCount(jobs), []() { return compile; });
+	std::size_t failures = std::count_if(results.begin(), results.end(), [](const std::optional<CompileResult>& r) { return r && !r->first; });
+	if(outputLvl != OutputLevel::Silent) {
+		std::stringstream taskDesc;
+		if(failures == 0) {
+			if(tasks->size() == 1)
+				taskDesc << "Compiled " << tasks->front().first << ".";
+			else
+				taskDesc << "Compiled " << tasks->size() << " materials.";
+			s->finish(jms::FinishedState::SUCCESS, taskDesc.str());
+		} else {
+			taskDesc << "Failed to compile " << failures << " of " << tasks->size() << " materials.";
+			s->finish(jms::FinishedState::FAILURE, taskDesc.str());
 		}
 	}
 
+	//Report failures in input order
+	for(std::size_t i = 0; i < tasks->size(); ++i) {
+		if(results[i] && !results[i]->first) ERROR("Failed to compile " << (*tasks)[i].first << ": " << results[i]->second)
+	}
+	if(failures > 0) return 1;
+
 	if(outputLvl != OutputLevel::Silent) {
 		std::cout << "Done." << std::endl;
 	}
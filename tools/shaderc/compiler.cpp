@@ -6,6 +6,7 @@
 
 #include <sstream>
 #include <fstream>
+#include <string_view>
 
 CacaoShaderCompiler::CacaoShaderCompiler() {
 	//Initialize global session
@@ -15,6 +16,31 @@ CacaoShaderCompiler::CacaoShaderCompiler() {
 	VLOG("Done.");
 }
 
+//Map a Slang parameter type to its index in libcacaoformats::Material::ValueContainer
+static std::optional<uint8_t> MaterialTypeIndex(slang::TypeReflection* type) {
+	int base = -1;
+	switch(type->getScalarType()) {
+		case slang::TypeReflection::ScalarType::Int32: base = 0; break;
+		case slang::TypeReflection::ScalarType::UInt32: base = 1; break;
+		case slang::TypeReflection::ScalarType::Float32: base = 2; break;
+		default: return std::nullopt;
+	}
+	switch(type->getKind()) {
+		case slang::TypeReflection::Kind::Scalar: return uint8_t(base);
+		case slang::TypeReflection::Kind::Vector: {
+			std::size_t n = type->getElementCount();
+			if(n < 2 || n > 4) return std::nullopt;
+			return uint8_t(3 + base * 3 + (n - 2));
+		}
+		case slang::TypeReflection::Kind::Matrix: {
+			unsigned int rows = type->getRowCount(), cols = type->getColumnCount();
+			if(base != 2 || rows < 2 || rows > 4 || cols < 2 || cols > 4) return std::nullopt;
+			return uint8_t(12 + (rows - 2) * 3 + (cols - 2));
+		}
+		default: return std::nullopt;
+	}
+}
+
 std::pair<bool, std::string> CacaoShaderCompiler::compile(const std::filesystem::path& in, const std::filesystem::path& out) {
 	CVLOG_SINGLE("Compiling " << in << ": ")
 
@@ -162,10 +188,10 @@ std::pair<bool, std::string> CacaoShaderCompiler::compile(const std::filesystem:
 	}
 	CVLOG("Done.");
 
-	//Link program (we don't store this, we just need to ensure it links to avoid errors at runtime)
+	//Link program (we don't store this, but we need to ensure it links to avoid errors at runtime, and we reflect the material layout from it)
 	CVLOG_NONL("\tLinking shader program... ");
+	ComPtr<slang::IComponentType> linked;
 	{
-		ComPtr<slang::IComponentType> linked;
 		ComPtr<slang::IBlob> diagnosticsBlob;
 		SlangResult r = composed->link(linked.writeRef(), diagnosticsBlob.writeRef());
 		if(r != SLANG_OK || !linked) {
@@ -182,6 +208,35 @@ std::pair<bool, std::string> CacaoShaderCompiler::compile(const std::filesystem:
 	}
 	CVLOG("Done.");
 
+	//Reflect material parameters
+	//Non-texture parameters come from the "material" constant buffer, and textures are bound individually
+	CVLOG_NONL("\tReflecting material layout... ");
+	libcacaoformats::MaterialLayout layout {.rules = libcacaoformats::MaterialBlockRules::Std140, .blockSize = 0, .members = {}, .textures = {}};
+	{
+		slang::ProgramLayout* programLayout = linked->getLayout();
+		CompileCheck(programLayout, "Failed to fetch shader program layout!");
+		for(unsigned int i = 0; i < programLayout->getParameterCount(); ++i) {
+			slang::VariableLayoutReflection* param = programLayout->getParameterByIndex(i);
+			slang::TypeLayoutReflection* typeLayout = param->getTypeLayout();
+			std::string_view name = param->getName() ? param->getName() : "";
+			if(name == "material" && (typeLayout->getKind() == slang::TypeReflection::Kind::ConstantBuffer || typeLayout->getKind() == slang::TypeReflection::Kind::ParameterBlock)) {
+				slang::TypeLayoutReflection* block = typeLayout->getElementTypeLayout();
+				layout.blockSize = (uint32_t)block->getSize();
+				for(unsigned int f = 0; f < block->getFieldCount(); ++f) {
+					slang::VariableLayoutReflection* field = block->getFieldByIndex(f);
+					std::optional<uint8_t> type = MaterialTypeIndex(field->getTypeLayout()->getType());
+					CompileCheck(type, "Material parameter \"" << field->getName() << "\" has a type that materials cannot store!");
+					layout.members.push_back({.name = field->getName(), .type = *type, .offset = (uint32_t)field->getOffset()});
+				}
+			} else if(typeLayout->getKind() == slang::TypeReflection::Kind::Resource) {
+				SlangResourceShape shape = SlangResourceShape(typeLayout->getType()->getResourceShape() & SLANG_RESOURCE_BASE_SHAPE_MASK);
+				if(shape != SLANG_TEXTURE_2D && shape != SLANG_TEXTURE_CUBE) continue;
+				layout.textures.push_back({.name = std::string(name), .slot = param->getBindingIndex(), .isCubemap = shape == SLANG_TEXTURE_CUBE});
+			}
+		}
+	}
+	CVLOG("Done.");
+
 	//Generate shader object for writing
 	CVLOG_NONL("\tSerializing IR blob... ")
 	ComPtr<ISlangBlob> irBlob;
@@ -202,7 +257,11 @@ std::pair<bool, std::string> CacaoShaderCompiler::compile(const std::filesystem:
 	std::ofstream outStream(out, std::ios::binary);
 	CompileCheck(outStream.is_open(), "Failed to open output file!");
 	libcacaoformats::PackedEncoder encoder;
-	encoder.EncodeShader(shader).ExportToStream(outStream);
+	try {
+		encoder.EncodeShader(shader, layout).ExportToStream(outStream);
+	} catch(const std::runtime_error& e) {
+		return {false, e.what()};
+	}
 	CVLOG("Done.");
 
 	return {true, ""};
@@ -6,6 +6,9 @@
 #include <iostream>
 #include <unordered_map>
 #include <string>
+#include <memory>
+#include <algorithm>
+#include <optional>
 
 #define SHADER_FILE_EXTENSION ".xjs"
 
@@ -19,6 +22,67 @@
 #include "compiler.hpp"
 #include "toolutil.hpp"
 
+#include <fstream>
+#include <regex>
+#include <set>
+
+/**
+ * @brief Add every module a source file imports or includes, found the way Slang looks for them, to its cache key
+ *
+ * Modules are searched for next to the file that imports them and then in the working directory, and are followed recursively.
+ * The built-in Cacao module is part of the compiler, so it is covered by the compiler version instead.
+ *
+ * @return Whether every import could be found, since the output can't be cached safely otherwise
+ */
+static bool AddImportsToKey(BuildCacheKey& key, const std::filesystem::path& in, std::set<std::filesystem::path>& visited) {
+	std::ifstream src(in);
+	if(!src.is_open()) return false;
+
+	//Anything that looks like an import counts, even inside a block comment, since an extra dependency only costs a cache miss
+	static const std::regex importLine(R"re(^\s*(?:import|__include)\s+(?:"([^"]+)"|([A-Za-z0-9_.\-]+))\s*;)re");
+	static const std::regex includeLine(R"re(^\s*#\s*include\s*"([^"]+)")re");
+	std::string line;
+	while(std::getline(src, line)) {
+		std::smatch match;
+		std::vector<std::filesystem::path> candidates;
+		if(std::regex_search(line, match, importLine)) {
+			if(match[1].matched) {
+				candidates.emplace_back(match[1].str());
+			} else {
+				if(match[2].str() == "cacaoshaderbase") continue;
+
+				//Dots in module names separate directories, and underscores may stand for hyphens in file names
+				std::string name = match[2].str();
+				std::replace(name.begin(), name.end(), '.', '/');
+				candidates.emplace_back(name + ".slang");
+				std::replace(name.begin(), name.end(), '_', '-');
+				candidates.emplace_back(name + ".slang");
+			}
+		} else if(std::regex_search(line, match, includeLine)) {
+			candidates.emplace_back(match[1].str());
+		} else {
+			continue;
+		}
+
+		std::optional<std::filesystem::path> found;
+		for(const std::filesystem::path& dir : {in.parent_path(), std::filesystem::current_path()}) {
+			for(const std::filesystem::path& candidate : candidates) {
+				std::error_code ec;
+				if(std::filesystem::is_regular_file(dir / candidate, ec)) {
+					found = std::filesystem::weakly_canonical(dir / candidate, ec);
+					break;
+				}
+			}
+			if(found) break;
+		}
+		if(!found) return false;
+		if(!visited.insert(*found).second) continue;
+		key.Add(found->string());
+		if(!key.AddFile(*found) || !AddImportsToKey(key, *found, visited)) return false;
+	}
+	return true;
+}
+
 int main(int argc, char* argv[]) {
 	//Configure CLI
 	CLI::App app("Cacao Engine Shader Compiler", std::filesystem::path(argv[0]).filename().string());
@@ -46,6 +110,16 @@ int main(int argc, char* argv[]) {
 	});
 	outOpt->excludes(autoOutOpt);
 
+	//Parallelism arg
+	unsigned int jobs = 1;
+	app.add_option("-j,--jobs", jobs, "Number of inputs to compile at once (0 to use one per hardware thread)")->check(CLI::NonNegativeNumber);
+
+	//Build cache args
+	std::filesystem::path cacheDir;
+	bool cacheLink = false;
+	CLI::Option* cacheOpt = app.add_option("--cache-dir", cacheDir, "Build cache directory to reuse unchanged outputs from and store new outputs in");
+	app.add_flag("--cache-link", cacheLink, "Hard-link outputs restored from the build cache instead of copying them")->needs(cacheOpt);
+
 	//Output control
 	outputLvl = OutputLevel::Normal;
 	app.add_flag_callback("-q,--quiet", []() { outputLvl = OutputLevel::Silent; }, "Suppress all output from the compiler");
@@ -60,6 +134,9 @@ int main(int argc, char* argv[]) {
 	//Parse the CLI
 	CLI11_PARSE(app, argc, argv);
 
+	//Open the build cache if requested
+	if(!cacheDir.empty() && !EnableBuildCache(cacheDir, cacheLink)) return 1;
+
 	//Calculate auto-output paths if requested
 	if(app.count("-A") > 0) {
 		for(auto& in : input) {
@@ -82,52 +159,64 @@ int main(int argc, char* argv[]) {
 
 	//Merge input and output vectors
 	VLOG_NONL("Preparing tasks list... ")
-	std::unordered_map<std::filesystem::path, std::filesystem::path> tasks;
-	for(unsigned int i = 0; i < input.size(); ++i) {
-		if(!std::filesystem::exists(output[i].parent_path())) {
-			std::filesystem::create_directories(output[i].parent_path());
-		}
-		tasks[input[i]] = output[i];
-	}
+	std::optional<std::vector<CompileTask>> tasks = MakeCompileTasks(input, output);
+	if(!tasks) return 1;
 	VLOG("Done.")
 
-	//Compilation
-	try {
-		//Create compiler object
-		CacaoShaderCompiler csc;
-
-		//Compile
-		std::unique_ptr<jms::Spinner> s;
-		for(const auto& [in, out] : tasks) {
-			std::stringstream taskDesc;
-			taskDesc << "Compiling " << in << "...";
-			if(outputLvl != OutputLevel::Silent) {
-				s = std::make_unique<jms::Spinner>(taskDesc.str(), jms::dots);
-				s->start();
-			}
-			auto [result, log] = csc.compile(in, out);
-			if(outputLvl != OutputLevel::Silent) {
-				taskDesc.str("");
-				if(result) {
-					taskDesc << "Compiled " << in << ".";
-					s->finish(jms::FinishedState::SUCCESS, taskDesc.str());
-				} else {
-					taskDesc << "Failed to compile " << in << ".";
-					s->finish(jms::FinishedState::FAILURE, taskDesc.str());
-				}
-			}
-			if(!result) {
-				ERROR("Failed to compile one or more shaders!")
-				std::cerr << "====== ERROR LOG ======\n"
-						  << log << "\n=======================" << std::endl;
-				return 1;
-			}
+	//Compile
+	std::unique_ptr<jms::Spinner> s;
+	if(outputLvl != OutputLevel::Silent) {
+		std::stringstream taskDesc;
+		if(tasks->size() == 1)
+			taskDesc << "Compiling " << tasks->front().first << "...";
+		else
+			taskDesc << "Compiling " << tasks->size() << " shaders...";
+		s = std::make_unique<jms::Spinner>(taskDesc.str(), jms::dots);
+		s->start();
+	}
+	std::vector<std::optional<CompileResult>> results = RunCompileTasks(*tasks, ResolveJobCount(jobs), []() {
+		//Slang global sessions aren't thread-safe, so each worker gets its own
+		return [csc = std::unique_ptr<CacaoShaderCompiler>()](const std::filesystem::path& in, const std::filesystem::path& out) mutable -> CompileResult {
+			//Creating a global session is slow, so wait until there's something to compile
+			const auto compile = [&]() {
+				if(!csc) csc = std::make_unique<CacaoShaderCompiler>();
+				return csc->compile(in, out);
+			};
+
+			//The output depends on the source, every module it imports, and the compiler version
+			//If an import can't be found here, skip the cache and let the compiler report the problem
+			BuildCacheKey key;
+			key.Add("shaderc").Add(COMPILER_VER).Add(CACAO_VER);
+			CompileCheck(key.AddFile(in), "Failed to read source file!");
+			std::set<std::filesystem::path> visited;
+			if(!buildCache.Enabled() || !AddImportsToKey(key, in, visited)) return CompileWithoutCache(out, compile);
+			return CompileWithCache(key, out, compile);
+		};
+	});
+	std::size_t failures = std::count_if(results.begin(), results.end(), [](const std::optional<CompileResult>& r) { return r && !r->first; });
+	if(outputLvl != OutputLevel::Silent) {
+		std::stringstream taskDesc;
+		if(failures == 0) {
+			if(tasks->size() == 1)
+				taskDesc << "Compiled " << tasks->front().first << ".";
+			else
+				taskDesc << "Compiled " << tasks->size() << " shaders.";
+			s->finish(jms::FinishedState::SUCCESS, taskDesc.str());
+		} else {
+			taskDesc << "Failed to compile " << failures << " of " << tasks->size() << " shaders.";
+			s->finish(jms::FinishedState::FAILURE, taskDesc.str());
 		}
-	} catch(const std::exception& e) {
-		ERROR("Exception caught during compilation: " << e.what())
-		return 1;
 	}
 
+	//Report failures in input order
+	for(std::size_t i = 0; i < tasks->size(); ++i) {
+		if(!results[i] || results[i]->first) continue;
+		ERROR("Failed to compile " << (*tasks)[i].first << "!")
+		std::cerr << "====== ERROR LOG ======\n"
+				  << results[i]->second << "\n=======================" << std::endl;
+	}
+	if(failures > 0) return 1;
+
 	if(outputLvl != OutputLevel::Silent) {
 		std::cout << "Done." << std::endl;
 	}
@@ -2,6 +2,21 @@
 
 #include <iostream>
 #include <sstream>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unordered_map>
+#include <optional>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <string_view>
+#include <cstdint>
+#include <random>
+#include <system_error>
 
 enum class OutputLevel {
 	Silent,
@@ -19,7 +34,8 @@ inline OutputLevel outputLvl;
 #define ERROR(...) \
 	std::cerr << "\x1b[0m\x1b[1;91mERROR: \x1b[0m" << __VA_ARGS__ << std::endl;
 
-inline std::stringstream lastMsg;
+//Each compile worker tracks its own last message
+inline thread_local std::stringstream lastMsg;
 
 #define CVLOG_NONL(...)                    \
 	VLOG_NONL("\x1b[2K\r" << __VA_ARGS__); \
@@ -33,4 +49,278 @@ inline std::stringstream lastMsg;
 		std::stringstream s;         \
 		s << __VA_ARGS__;            \
 		return {false, s.str()};     \
-	}
\ No newline at end of file
+	}
+
+///@brief An input file and the output file to compile it to
+using CompileTask = std::pair<std::filesystem::path, std::filesystem::path>;
+
+///@brief Whether a compile task succeeded, and the error message if it didn't
+using CompileResult = std::pair<bool, std::string>;
+
+/**
+ * @brief Compile a list of tasks with up to a given number of tasks running at once
+ *
+ * Each worker thread calls makeWorker once, before its first task, to get the function it compiles tasks with (called as fn(in, out)).
+ * This lets a worker reuse expensive state across tasks. Exceptions from either are caught and turned into a failed result.
+ * Once a task fails, no new tasks are started.
+ *
+ * @param tasks The tasks to compile
+ * @param jobs The maximum number of tasks to run at once
+ * @param makeWorker Function that creates the compile function of a worker
+ *
+ * @return The result of each task, in the same order as the tasks (tasks that were never started have no result)
+ */
+template<typename MakeWorker>
+std::vector<std::optional<CompileResult>> RunCompileTasks(const std::vector<CompileTask>& tasks, unsigned int jobs, MakeWorker makeWorker) {
+	std::vector<std::optional<CompileResult>> results(tasks.size());
+	std::atomic_size_t next = 0;
+	std::atomic_bool failed = false;
+	auto work = [&]() {
+		std::optional<decltype(makeWorker())> compile;
+		for(std::size_t i = next++; i < tasks.size() && !failed; i = next++) {
+			try {
+				if(!compile) compile.emplace(makeWorker());
+				results[i] = (*compile)(tasks[i].first, tasks[i].second);
+			} catch(const std::exception& e) {
+				results[i] = CompileResult {false, e.what()};
+			}
+			if(!results[i]->first) failed = true;
+		}
+	};
+
+	//The calling thread is one of the workers
+	std::vector<std::jthread> threads;
+	for(std::size_t i = 1; i < std::min<std::size_t>(jobs, tasks.size()); ++i) threads.emplace_back(work);
+	work();
+	threads.clear();
+
+	return results;
+}
+
+/**
+ * @brief Resolve the value of a -j option
+ *
+ * @param jobs The requested number of jobs, where 0 means one per hardware thread
+ */
+inline unsigned int ResolveJobCount(unsigned int jobs) {
+	if(jobs > 0) return jobs;
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Build the list of compile tasks from matching input and output lists, creating output directories as needed
+ *
+ * @return The tasks, or nothing if two inputs would be compiled to the same output
+ */
+inline std::optional<std::vector<CompileTask>> MakeCompileTasks(const std::vector<std::filesystem::path>& input, const std::vector<std::filesystem::path>& output) {
+	std::vector<CompileTask> tasks;
+	std::unordered_map<std::filesystem::path, std::filesystem::path> outputOwners;
+	for(std::size_t i = 0; i < input.size(); ++i) {
+		//Tasks run at the same time, so they can't share an output
+		if(auto [owner, inserted] = outputOwners.try_emplace(output[i], input[i]); !inserted) {
+			ERROR("Both " << owner->second << " and " << input[i] << " would be compiled to " << output[i] << "!")
+			return std::nullopt;
+		}
+		if(!std::filesystem::exists(output[i].parent_path())) {
+			std::filesystem::create_directories(output[i].parent_path());
+		}
+		tasks.emplace_back(input[i], output[i]);
+	}
+	return tasks;
+}
+
+/**
+ * @brief Hash of everything that goes into a compiled output, used to look it up in a BuildCache
+ *
+ * This is 128-bit FNV-1a over every piece of data added, with each piece prefixed by its length so that different splits of the same bytes don't collide.
+ */
+class BuildCacheKey {
+  public:
+	///@brief Add a piece of data to the key
+	BuildCacheKey& Add(std::string_view data) {
+		uint64_t len = data.size();
+		Mix(reinterpret_cast<const unsigned char*>(&len), sizeof(len));
+		Mix(reinterpret_cast<const unsigned char*>(data.data()), data.size());
+		return *this;
+	}
+
+	/**
+	 * @brief Add the contents of a file to the key
+	 *
+	 * @return Whether the file could be read
+	 */
+	bool AddFile(const std::filesystem::path& path) {
+		std::ifstream in(path, std::ios::binary);
+		if(!in.is_open()) return false;
+		std::string contents(std::istreambuf_iterator<char>(in), {});
+		if(in.bad()) return false;
+		Add(contents);
+		return true;
+	}
+
+	///@brief Get the key as a hex string
+	std::string String() const {
+		constexpr const char* digits = "0123456789abcdef";
+		std::string out(32, '0');
+		for(int i = 0; i < 16; ++i) {
+			out[i] = digits[(hi >> (60 - 4 * i)) & 0xF];
+			out[16 + i] = digits[(lo >> (60 - 4 * i)) & 0xF];
+		}
+		return out;
+	}
+
+  private:
+	//128-bit FNV offset basis
+	uint64_t hi = 0x6c62272e07bb0142;
+	uint64_t lo = 0x62b821756295c58d;
+
+	void Mix(const unsigned char* data, std::size_t size) {
+		for(std::size_t i = 0; i < size; ++i) {
+			lo ^= data[i];
+
+			//Multiply by the 128-bit FNV prime (2^88 + 0x13B), modulo 2^128
+			uint64_t lowPart = (lo & 0xFFFFFFFF) * 0x13B;
+			uint64_t highPart = (lo >> 32) * 0x13B;
+			uint64_t newLo = lowPart + (highPart << 32);
+			uint64_t carry = (highPart >> 32) + (newLo < lowPart ? 1 : 0);
+			hi = hi * 0x13B + carry + (lo << 24);
+			lo = newLo;
+		}
+	}
+};
+
+/**
+ * @brief On-disk cache of compiled outputs, shared between tools and runs
+ *
+ * Entries are stored as <cache dir>/<first two key digits>/<key>. They are written to a temporary file and renamed into place,
+ * so several tools can share a cache at once. Entries are never removed by the tools; delete the directory to clear the cache.
+ */
+class BuildCache {
+  public:
+	///@brief How outputs are restored from the cache
+	enum class RestoreMode {
+		Copy,	///<Copy the cached file
+		HardLink///<Hard-link the cached file, falling back to a copy if that fails (such as when the cache is on another filesystem)
+	};
+
+	///@brief Create a disabled cache
+	BuildCache() {}
+
+	/**
+	 * @brief Open a cache, creating its directory if needed
+	 *
+	 * @param dir The cache directory
+	 * @param mode How to restore outputs
+	 */
+	BuildCache(const std::filesystem::path& dir, RestoreMode mode)
+	  : dir(std::filesystem::absolute(dir)), mode(mode) {
+		std::filesystem::create_directories(this->dir);
+	}
+
+	///@brief Check if the cache is enabled
+	bool Enabled() const {
+		return !dir.empty();
+	}
+
+	/**
+	 * @brief Restore a cached output
+	 *
+	 * @return Whether there was an entry for the key and it was restored to the output path
+	 */
+	bool Restore(const BuildCacheKey& key, const std::filesystem::path& out) const {
+		if(!Enabled()) return false;
+		std::error_code ec;
+		std::filesystem::path entry = EntryPath(key);
+		if(!std::filesystem::exists(entry, ec)) return false;
+		std::filesystem::remove(out, ec);
+		if(mode == RestoreMode::HardLink) {
+			std::filesystem::create_hard_link(entry, out, ec);
+			if(!ec) return true;
+		}
+		return std::filesystem::copy_file(entry, out, std::filesystem::copy_options::overwrite_existing, ec) && !ec;
+	}
+
+	/**
+	 * @brief Add an output to the cache
+	 *
+	 * Failing to add the output is not an error, it will just be compiled again next time.
+	 */
+	void Store(const BuildCacheKey& key, const std::filesystem::path& out) const {
+		if(!Enabled()) return;
+		std::error_code ec;
+		std::filesystem::path entry = EntryPath(key);
+		std::filesystem::create_directories(entry.parent_path(), ec);
+		std::filesystem::path temp = entry;
+		temp += "." + std::to_string(std::random_device {}()) + ".tmp";
+		if(std::filesystem::copy_file(out, temp, ec) && !ec) std::filesystem::rename(temp, entry, ec);
+		if(ec) std::filesystem::remove(temp, ec);
+	}
+
+  private:
+	std::filesystem::path dir;
+	RestoreMode mode = RestoreMode::Copy;
+
+	std::filesystem::path EntryPath(const BuildCacheKey& key) const {
+		std::string str = key.String();
+		return dir / str.substr(0, 2) / str;
+	}
+};
+
+///@brief The build cache used by the tool, which is disabled unless the tool enables it
+inline BuildCache buildCache;
+
+/**
+ * @brief Compile an output without looking it up in the build cache, for outputs whose dependencies can't all be found up front
+ *
+ * The output may be hard-linked to a cache entry from an earlier run, so it is removed first instead of being written into.
+ *
+ * @param out The output path
+ * @param compile Function that compiles the output, returning a CompileResult
+ *
+ * @return The result of the compile function
+ */
+template<typename Compile>
+CompileResult CompileWithoutCache(const std::filesystem::path& out, Compile&& compile) {
+	std::error_code ec;
+	std::filesystem::remove(out, ec);
+	return compile();
+}
+
+/**
+ * @brief Compile an output unless it is in the build cache, and add it to the cache if it was compiled
+ *
+ * @param key The key of the output, which must cover everything that affects the output
+ * @param out The output path
+ * @param compile Function that compiles the output, returning a CompileResult
+ *
+ * @return The result of the compile function, or success if the output was restored from the cache
+ */
+template<typename Compile>
+CompileResult CompileWithCache(const BuildCacheKey& key, const std::filesystem::path& out, Compile&& compile) {
+	if(buildCache.Restore(key, out)) {
+		CVLOG_SINGLE("Using cached output for " << out << ".")
+		return {true, ""};
+	}
+
+	CompileResult result = CompileWithoutCache(out, compile);
+	if(result.first) buildCache.Store(key, out);
+	return result;
+}
+
+/**
+ * @brief Enable the build cache
+ *
+ * @param dir The cache directory
+ * @param hardLink Whether to hard-link restored outputs instead of copying them
+ *
+ * @return Whether the cache could be opened
+ */
+inline bool EnableBuildCache(const std::filesystem::path& dir, bool hardLink) {
+	try {
+		buildCache = BuildCache(dir, hardLink ? BuildCache::RestoreMode::HardLink : BuildCache::RestoreMode::Copy);
+		return true;
+	} catch(const std::filesystem::filesystem_error& e) {
+		ERROR("Failed to open build cache: " << e.what())
+		return false;
+	}
+}
\ No newline at end of file
@@ -6,6 +6,11 @@
 #include <iostream>
 #include <unordered_map>
 #include <string>
+#include <memory>
+#include <algorithm>
+#include <optional>
+#include <bit>
+#include <cstdint>
 
 #include "toolutil.hpp"
 
@@ -20,6 +25,8 @@
 #define COMPILER_VER "unknown"
 #endif
 
+float cellSize = 0.0f;
+
 std::pair<bool, std::string> compile(const std::filesystem::path& in, const std::filesystem::path& out) {
 	//Create decoder
 	//Yes, I do know the message says otherwise. I just think this sounds better. Deal with it.
@@ -44,13 +51,24 @@ std::pair<bool, std::string> compile(const std::filesystem::path& in, const std:
 	libcacaoformats::PackedEncoder enc;
 	CVLOG("Done.");
 
+	//Convert component reflection data to binary so that it can be read without parsing YAML
+	CVLOG_NONL("\tConverting reflection data... ");
+	try {
+		for(libcacaoformats::World::Actor& actor : w.actors) {
+			for(libcacaoformats::World::Component& component : actor.components) component.reflection = enc.EncodeReflection(component.reflection);
+		}
+	} catch(const std::runtime_error& e) {
+		return {false, e.what()};
+	}
+	CVLOG("Done.");
+
 	//Compile the world
 	CVLOG_NONL("\tCompiling world... ");
 	std::pair<bool, std::string> pcGetErr;
 	libcacaoformats::PackedContainer pc = [&]() {
 		try {
 			pcGetErr = {true, ""};
-			return enc.EncodeWorld(w);
+			return enc.EncodeWorld(w, cellSize);
 		} catch(const std::runtime_error& e) {
 			pcGetErr = {false, e.what()};
 			return libcacaoformats::PackedContainer();
@@ -71,6 +89,14 @@ std::pair<bool, std::string> compile(const std::filesystem::path& in, const std:
 	return {true, ""};
 }
 
+std::pair<bool, std::string> compileCached(const std::filesystem::path& in, const std::filesystem::path& out) {
+	//The output only depends on the source, the cell size, and the compiler version
+	BuildCacheKey key;
+	key.Add("worldc").Add(COMPILER_VER).Add(CACAO_VER).Add(std::to_string(std::bit_cast<uint32_t>(cellSize)));
+	CompileCheck(key.AddFile(in), "Failed to read source file!");
+	return CompileWithCache(key, out, [&]() { return compile(in, out); });
+}
+
 int main(int argc, char* argv[]) {
 	//Configure CLI
 	CLI::App app("Cacao Engine World Compiler", std::filesystem::path(argv[0]).filename().string());
@@ -98,6 +124,19 @@ int main(int argc, char* argv[]) {
 	});
 	outOpt->excludes(autoOutOpt);
 
+	//Cell partitioning arg
+	app.add_option("-c,--cell-size", cellSize, "Edge length of the grid cells to partition actors into for streaming (0 to not partition the world)")->check(CLI::NonNegativeNumber);
+
+	//Parallelism arg
+	unsigned int jobs = 1;
+	app.add_option("-j,--jobs", jobs, "Number of inputs to compile at once (0 to use one per hardware thread)")->check(CLI::NonNegativeNumber);
+
+	//Build cache args
+	std::filesystem::path cacheDir;
+	bool cacheLink = false;
+	CLI::Option* cacheOpt = app.add_option("--cache-dir", cacheDir, "Build cache directory to reuse unchanged outputs from and store new outputs in");
+	app.add_flag("--cache-link", cacheLink, "Hard-link outputs restored from the build cache instead of copying them")->needs(cacheOpt);
+
 	//Output control
 	outputLvl = OutputLevel::Normal;
 	app.add_flag_callback("-q,--quiet", []() { outputLvl = OutputLevel::Silent; }, "Suppress all output from the compiler");
@@ -112,6 +151,9 @@ int main(int argc, char* argv[]) {
 	//Parse the CLI
 	CLI11_PARSE(app, argc, argv);
 
+	//Open the build cache if requested
+	if(!cacheDir.empty() && !EnableBuildCache(cacheDir, cacheLink)) return 1;
+
 	//Calculate auto-output paths if requested
 	if(app.count("-A") > 0) {
 		for(auto& in : input) {
@@ -134,41 +176,43 @@ int main(int argc, char* argv[]) {
 
 	//Merge input and output vectors
 	VLOG_NONL("Preparing tasks list... ")
-	std::unordered_map<std::filesystem::path, std::filesystem::path> tasks;
-	for(unsigned int i = 0; i < input.size(); ++i) {
-		if(!std::filesystem::exists(output[i].parent_path())) {
-			std::filesystem::create_directories(output[i].parent_path());
-		}
-		tasks[input[i]] = output[i];
-	}
+	std::optional<std::vector<CompileTask>> tasks = MakeCompileTasks(input, output);
+	if(!tasks) return 1;
 	VLOG("Done.")
 
 	//Compile
 	std::unique_ptr<jms::Spinner> s;
-	for(const auto& [in, out] : tasks) {
+	if(outputLvl != OutputLevel::Silent) {
 		std::stringstream taskDesc;
-		taskDesc << "Compiling " << in << "...";
-		if(outputLvl != OutputLevel::Silent) {
-			s = std::make_unique<jms::Spinner>(taskDesc.str(), jms::dots);
-			s->start();
-		}
-		auto [result, log] = compile(in, out);
-		if(outputLvl != OutputLevel::Silent) {
-			taskDesc.str("");
-			if(result) {
-				taskDesc << "Compiled " << in << ".";
-				s->finish(jms::FinishedState::SUCCESS, taskDesc.str());
-			} else {
-				taskDesc << "Failed to compile " << in << ".";
-				s->finish(jms::FinishedState::FAILURE, taskDesc.str());
-			}
-		}
-		if(!result) {
-			ERROR("Failed to compile one or more materials: " << log)
-			return 1;
+		if(tasks->size() == 1)
+			taskDesc << "Compiling " << tasks->front().first << "...";
+		else
+			taskDesc << "Compiling " << tasks->size() << " worlds...";
+		s = std::make_unique<jms::Spinner>(taskDesc.str(), jms::dots);
+		s->start();
+	}
+	std::vector<std::optional<CompileResult>> results = RunCompileTasks(*tasks, ResolveJobCount(jobs), []() { return compileCached; });
+	std::size_t failures = std::count_if(results.begin(), results.end(), [](const std::optional<CompileResult>& r) { return r && !r->first; });
+	if(outputLvl != OutputLevel::Silent) {
+		std::stringstream taskDesc;
+		if(failures == 0) {
+			if(tasks->size() == 1)
+				taskDesc << "Compiled " << tasks->front().first << ".";
+			else
+				taskDesc << "Compiled " << tasks->size() << " worlds.";
+			s->finish(jms::FinishedState::SUCCESS, taskDesc.str());
+		} else {
+			taskDesc << "Failed to compile " << failures << " of " << tasks->size() << " worlds.";
+			s->finish(jms::FinishedState::FAILURE, taskDesc.str());
 		}
 	}
 
+	//Report failures in input order
+	for(std::size_t i = 0; i < tasks->size(); ++i) {
+		if(results[i] && !results[i]->first) ERROR("Failed to compile " << (*tasks)[i].first << ": " << results[i]->second)
+	}
+	if(failures > 0) return 1;
+
 	if(outputLvl != OutputLevel::Silent) {
 		std::cout << "Done." << std::endl;
 	}
@@ -7,6 +7,10 @@
 #define PACK_FILE_EXTENSION ".xak"
 
 #include <filesystem>
+#include <set>
+#include <utility>
+
+#include "libcacaoformats.hpp"
 
 inline bool fail = false;
 
@@ -20,6 +24,29 @@ inline bool fail = false;
 	fail = true;                  \
 	return r;
 
+//Describe how much space was saved by storing identical assets only once, for the end of a command's finish message
+//This is empty if nothing was deduplicated, and is only computed when there will be a spinner to show it on
+inline std::string DeduplicationNote(const libcacaoformats::PackedContainer& pc) {
+	if(outputLvl == OutputLevel::Silent) return "";
+
+	//Entries that point at data another entry already uses are duplicates
+	libcacaoformats::PackedAssetIndex index = libcacaoformats::PackedAssetIndex::FromContainer(pc);
+	std::set<std::pair<uint64_t, uint64_t>> blobs;
+	std::size_t dupes = 0;
+	uint64_t saved = 0;
+	for(const std::string& name : index.List()) {
+		libcacaoformats::PackedAssetIndex::Entry entry = index.GetEntry(name);
+		if(!blobs.emplace(entry.offset, entry.compressedSize).second) {
+			++dupes;
+			saved += entry.compressedSize;
+		}
+	}
+	if(dupes == 0) return "";
+	std::stringstream note;
+	note << " Deduplicated " << dupes << " asset(s), saving " << saved << " bytes.";
+	return note.str();
+}
+
 class CreateCmd {
   public:
 	CreateCmd(CLI::App&);
@@ -31,6 +58,8 @@ class CreateCmd {
 	std::filesystem::path resRoot;
 	std::filesystem::path outPath;
 	std::filesystem::path addrMapPath;
+	unsigned int threads = 1;
+	std::string dedupNote;
 };
 
 class ListCmd {
@@ -66,6 +95,7 @@ class MergeCmd {
 	CLI::App* cmd;
 	std::vector<std::filesystem::path> inPaks;
 	std::filesystem::path outPath;
+	std::string dedupNote;
 };
 
 class DelCmd {
@@ -77,4 +107,17 @@ class DelCmd {
 	CLI::App* cmd;
 	std::filesystem::path inPath;
 	std::vector<std::string> toDelete;
+	std::string dedupNote;
+};
+class DiffCmd {
+  public:
+	DiffCmd(CLI::App&);
+	void Callback();
+
+  private:
+	CLI::App* cmd;
+	std::filesystem::path oldPath;
+	std::filesystem::path newPath;
+	std::filesystem::path outPath;
+	unsigned int threads = 1;
 };
\ No newline at end of file
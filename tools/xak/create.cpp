@@ -52,6 +52,9 @@ CreateCmd::CreateCmd(CLI::App& app) {
 	res->needs(out);
 	assetsDirHelp->excludes(out);
 
+	//Threading
+	cmd->add_option("-t,--threads", threads, "Number of threads to compress assets on (0 uses all available cores)");
+
 	//Register command callback function
 	cmd->callback([this, assets, assetsDirHelp]() {
 		if(assets->count() <= 0 && assetsDirHelp->count() <= 0) {
@@ -73,7 +76,7 @@ CreateCmd::CreateCmd(CLI::App& app) {
 				s->finish(jms::FinishedState::FAILURE, taskDesc.str());
 				exit(1);
 			} else {
-				taskDesc << "Created pack " << outPath << ".";
+				taskDesc << "Created pack " << outPath << "." << dedupNote;
 				s->finish(jms::FinishedState::SUCCESS, taskDesc.str());
 			}
 		}
@@ -317,7 +320,7 @@ asset_process:
 				//glTF binary model
 				pa.kind = libcacaoformats::PackedAsset::Kind::Model;
 				goto asset_ok;
-			} else if(pa.buffer[0] == 0xCA && pa.buffer[1] == 0xCA && pa.buffer[2] == 0x00) {
+			} else if(pa.buffer[0] == 0xCA && pa.buffer[1] == 0xCA && pa.buffer[2] <= 0x02) {
 				//Cacao packed container (still need to check type)
 				if(pa.buffer[3] == 0xC4) {
 					//Cubemap
@@ -477,10 +480,10 @@ asset_process:
 encode:
 	//Encode asset pack
 	CVLOG_NONL("Encoding pack... ")
-	libcacaoformats::PackedContainer pc = [&assetTable]() {
+	libcacaoformats::PackedContainer pc = [this, &assetTable]() {
 		try {
 			libcacaoformats::PackedEncoder enc;
-			return enc.EncodeAssetPack(assetTable);
+			return enc.EncodeAssetPack(assetTable, threads);
 		} catch(const std::exception& e) {
 			XAK_ERROR_NONVOID(libcacaoformats::PackedContainer {}, "Failed to encode asset pack: \"" << e.what() << "\"!")
 		}
@@ -499,6 +502,9 @@ encode:
 	if(!outStream.is_open()) {
 		XAK_ERROR("Failed to open output file stream!")
 	}
-	pc.ExportToStream(outStream);
+	pc.ExportToStream(outStream, threads);
 	CVLOG("Done.")
+
+	//Note deduplication savings for the finish message
+	dedupNote = DeduplicationNote(pc);
 }
\ No newline at end of file
@@ -37,7 +37,7 @@ DelCmd::DelCmd(CLI::App& app) {
 				s->finish(jms::FinishedState::FAILURE, taskDesc.str());
 				exit(1);
 			} else {
-				taskDesc << "Deleted assets from " << inPath << ".";
+				taskDesc << "Deleted assets from " << inPath << "." << dedupNote;
 				s->finish(jms::FinishedState::SUCCESS, taskDesc.str());
 			}
 		}
@@ -109,4 +109,7 @@ void DelCmd::Callback() {
 	}
 	pc.ExportToStream(outStream);
 	CVLOG("Done.")
+
+	//Note deduplication savings for the finish message
+	dedupNote = DeduplicationNote(pc);
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "commands.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "libcacaoformats.hpp"
+#include "spinners.hpp"
+
+DiffCmd::DiffCmd(CLI::App& app) {
+	//Diff the command CLI
+	cmd = app.add_subcommand("diff", "Create a patch pack holding the changes between two versions of a pack");
+
+	//Inputs
+	cmd->add_option("old", oldPath, "Path to the original asset pack")->required()->check(CLI::ExistingFile);
+	cmd->add_option("new", newPath, "Path to the updated asset pack")->required()->check(CLI::ExistingFile);
+
+	//Output
+	CLI::Option* out = cmd->add_option("-o", outPath, "Output patch file path")->required()->check([](const std::string& outfile) {
+		if(CLI::NonexistentPath(outfile).compare("") == 0) return "";
+		if(CLI::ExistingFile(outfile).compare("") == 0) return "";
+		return "The output file must either be a file to overwrite or a nonexistent file!";
+	});
+	out->transform([](const std::string& p) {
+		std::filesystem::path path(p);
+		return std::filesystem::absolute(path).string();
+	});
+
+	//Threading
+	cmd->add_option("-t,--threads", threads, "Number of threads to compress assets on (0 uses all available cores)");
+
+	//Register command callback function
+	cmd->callback([this]() {
+		std::unique_ptr<jms::Spinner> s;
+		std::stringstream taskDesc;
+		taskDesc << "Creating patch...";
+		if(outputLvl != OutputLevel::Silent) {
+			s = std::make_unique<jms::Spinner>(taskDesc.str(), jms::dots);
+			s->start();
+		}
+		this->Callback();
+		if(outputLvl != OutputLevel::Silent) {
+			taskDesc.str("");
+			if(fail) {
+				taskDesc << "Failed to create patch!";
+				s->finish(jms::FinishedState::FAILURE, taskDesc.str());
+				exit(1);
+			} else {
+				taskDesc << "Created patch " << outPath << ".";
+				s->finish(jms::FinishedState::SUCCESS, taskDesc.str());
+			}
+		}
+	});
+}
+
+void DiffCmd::Callback() {
+	//Open both packs (only their tables of contents are read here)
+	CVLOG_NONL("Reading packs... ")
+	std::optional<libcacaoformats::PackedAssetIndex> oldPak, newPak;
+	try {
+		oldPak.emplace(libcacaoformats::PackedAssetIndex::FromFile(oldPath));
+		newPak.emplace(libcacaoformats::PackedAssetIndex::FromFile(newPath));
+	} catch(const std::exception& e) {
+		XAK_ERROR("Failed to open asset pack: \"" << e.what() << "\"!")
+	}
+	CVLOG("Done.")
+
+	//Find added and changed assets
+	CVLOG_NONL("Comparing packs... ")
+	libcacaoformats::AssetPack changed;
+	std::vector<std::string> removed;
+	try {
+		for(const std::string& name : newPak->List()) {
+			if(oldPak->Contains(name)) {
+				//Assets whose records match still get their contents compared, to be sure
+				libcacaoformats::PackedAssetIndex::Entry before = oldPak->GetEntry(name), after = newPak->GetEntry(name);
+				if(before.kind == after.kind && before.size == after.size && before.checksum == after.checksum && std::ranges::equal(oldPak->Fetch(name).buffer, newPak->Fetch(name).buffer)) continue;
+			}
+			changed.insert_or_assign(name, newPak->Fetch(name));
+		}
+
+		//Find deleted assets
+		for(const std::string& name : oldPak->List()) {
+			if(!newPak->Contains(name)) removed.push_back(name);
+		}
+		std::sort(removed.begin(), removed.end());
+	} catch(const std::exception& e) {
+		XAK_ERROR("Failed to compare asset packs: \"" << e.what() << "\"!")
+	}
+	if(changed.empty() && removed.empty()) {
+		XAK_ERROR("The packs have no differences!")
+	}
+	CVLOG("Done (" << changed.size() << " added or changed, " << removed.size() << " deleted).")
+
+	//Encode patch
+	CVLOG_NONL("Encoding patch... ")
+	libcacaoformats::PackedContainer pc = [this, &changed, &removed]() {
+		try {
+			libcacaoformats::PackedEncoder enc;
+			return enc.EncodeAssetPackPatch(changed, removed, threads);
+		} catch(const std::exception& e) {
+			XAK_ERROR_NONVOID(libcacaoformats::PackedContainer {}, "Failed to encode patch: \"" << e.what() << "\"!")
+		}
+	}();
+	if(fail) return;
+	CVLOG("Done.")
+
+	//Make output directory if it doesn't exist
+	if(!std::filesystem::exists(outPath.parent_path())) {
+		std::filesystem::create_directories(outPath.parent_path());
+	}
+
+	//Write patch to output file
+	CVLOG_NONL("Writing output file " << outPath << "... ")
+	std::ofstream outStream(outPath, std::ios::binary);
+	if(!outStream.is_open()) {
+		XAK_ERROR("Failed to open output file stream!")
+	}
+	pc.ExportToStream(outStream, threads);
+	CVLOG("Done.")
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "commands.hpp"
 
 #include <string>
+#include <algorithm>
+#include <utility>
 
 #include "libcacaoformats.hpp"
 
@@ -33,31 +35,36 @@ ListCmd::ListCmd(CLI::App& app) {
 }
 
 void ListCmd::Callback() {
-	//Open input file
-	std::ifstream in(inPath, std::ios::binary);
-	if(!in.is_open()) {
-		XAK_ERROR("Failed to open input file stream for reading!")
-	}
-
-	//Decode the file
-	libcacaoformats::PackedDecoder dec;
-	libcacaoformats::AssetPack decoded;
+	//Read the asset list
+	//Indexed packs only need their table of contents, which is read straight out of the mapped file
+	std::vector<std::pair<std::string, libcacaoformats::PackedAsset::Kind>> entries;
 	try {
-		libcacaoformats::PackedContainer pc = libcacaoformats::PackedContainer::FromStream(in);
-		decoded = dec.DecodeAssetPack(pc);
+		libcacaoformats::PackedContainer pc = libcacaoformats::PackedContainer::FromFile(inPath);
+		if(pc.version >= 2) {
+			libcacaoformats::PackedAssetIndex index = libcacaoformats::PackedAssetIndex::FromContainer(pc);
+			for(std::string& addr : index.List()) {
+				libcacaoformats::PackedAsset::Kind kind = index.GetEntry(addr).kind;
+				entries.emplace_back(std::move(addr), kind);
+			}
+		} else {
+			libcacaoformats::PackedDecoder dec;
+			for(const auto& [addr, pa] : dec.DecodeAssetPack(pc)) entries.emplace_back(addr, pa.kind);
+		}
 	} catch(const std::runtime_error& e) {
 		XAK_ERROR(e.what());
 	}
+	std::sort(entries.begin(), entries.end());
 
 	//Sort files by type
-	std::vector<std::string> a, r;
-	for(const auto& [addr, pa] : decoded) {
-		if(pa.kind == libcacaoformats::PackedAsset::Kind::Resource && doResources) {
-			r.push_back(addr);
+	std::vector<std::pair<std::string, libcacaoformats::PackedAsset::Kind>> a;
+	std::vector<std::string> r;
+	for(const auto& [addr, kind] : entries) {
+		if(kind == libcacaoformats::PackedAsset::Kind::Resource) {
+			if(doResources) r.push_back(addr);
 			continue;
 		}
 		if(doAssets) {
-			a.push_back(addr);
+			a.emplace_back(addr, kind);
 			continue;
 		}
 	}
@@ -65,11 +72,11 @@ void ListCmd::Callback() {
 	//Results
 	if(a.size() > 0) {
 		std::cout << "Assets:" << std::endl;
-		for(const std::string& asset : a) {
+		for(const auto& [asset, kind] : a) {
 			std::cout << asset;
 			if(assetMeta) {
 				std::cout << " (";
-				switch(decoded[asset].kind) {
+				switch(kind) {
 					case libcacaoformats::PackedAsset::Kind::Cubemap:
 						std::cout << "Cubemap)";
 						break;
@@ -34,6 +34,7 @@ int main(int argc, char* argv[]) {
 	ExtractCmd e(app);
 	MergeCmd m(app);
 	DelCmd d(app);
+	DiffCmd df(app);
 	app.require_subcommand(1);
 
 	//Parse the CLI (this will trigger execution of the commands)
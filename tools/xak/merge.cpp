@@ -45,7 +45,7 @@ MergeCmd::MergeCmd(CLI::App& app) {
 				s->finish(jms::FinishedState::FAILURE, taskDesc.str());
 				exit(1);
 			} else {
-				taskDesc << "Merged to " << outPath << ".";
+				taskDesc << "Merged to " << outPath << "." << dedupNote;
 				s->finish(jms::FinishedState::SUCCESS, taskDesc.str());
 			}
 		}
@@ -134,4 +134,7 @@ void MergeCmd::Callback() {
 	}
 	pc.ExportToStream(outStream);
 	CVLOG("Done.")
+
+	//Note deduplication savings for the finish message
+	dedupNote = DeduplicationNote(pc);
 }
\ No newline at end of file